@@ -26,6 +26,7 @@
 
 // Convert a DDS into a custom layout
 // also converts v2 XeT to latest format
+// or, with -generate, writes a procedural texture (see SyntheticTexture.h)
 
 #include <fstream>
 #include <iostream>
@@ -40,6 +41,7 @@
 
 #include "XeTv2.h"
 #include "XetFileHeader.h"
+#include "SyntheticTexture.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -74,6 +76,8 @@ UINT32 m_compressionFormat{ 1 };
 
 bool m_convertFromXet2{ false };
 
+std::unique_ptr<SyntheticTexture> m_synthetic; // if set, generate tile data instead of reading it
+
 ComPtr<IDStorageCompressionCodec> m_compressor;
 //DSTORAGE_COMPRESSION m_compressionLevel = DSTORAGE_COMPRESSION_FASTEST;
 DSTORAGE_COMPRESSION m_compressionLevel = DSTORAGE_COMPRESSION_BEST_RATIO;
@@ -302,7 +306,11 @@ void WriteTiles(const XetFileHeader& in_header, const BYTE* in_pSrc)
             {
                 tile.resize(D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES); // reset to standard tile size
 
-                if (m_convertFromXet2)
+                if (m_synthetic)
+                {
+                    m_synthetic->FillTile(tile.data(), D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+                }
+                else if (m_convertFromXet2)
                 {
                     memcpy(tile.data(), in_pSrc, D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
                     in_pSrc += D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
@@ -412,6 +420,38 @@ UINT WritePackedMips(const XetFileHeader& in_header, BYTE* in_pBytes, size_t in_
     return numBytesPadded;
 }
 
+//-----------------------------------------------------------------------------
+// header for a generated texture, as if read from a DX10 DDS
+//-----------------------------------------------------------------------------
+void SetSyntheticHeader(XetFileHeader& out_header, UINT in_width, UINT in_height, UINT in_mipCount, const std::wstring& in_format)
+{
+    DXGI_FORMAT format = DXGI_FORMAT_BC7_UNORM;
+    if ((L"BC1" == in_format) || (L"bc1" == in_format)) { format = DXGI_FORMAT_BC1_UNORM; }
+    else if ((L"BC7" != in_format) && (L"bc7" != in_format)) { Error(L"Unsupported format, use BC1 or BC7"); }
+
+    if ((0 == in_width) || (0 == in_height)) { Error(L"-width and -height are required"); }
+
+    // 0: full mip chain
+    UINT maxMipCount = 1;
+    while ((in_width >> maxMipCount) || (in_height >> maxMipCount)) { maxMipCount++; }
+    if ((0 == in_mipCount) || (in_mipCount > maxMipCount)) { in_mipCount = maxMipCount; }
+
+    out_header.m_ddsHeader = DirectX::DDS_HEADER{};
+    out_header.m_ddsHeader.size = sizeof(DirectX::DDS_HEADER);
+    out_header.m_ddsHeader.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+    out_header.m_ddsHeader.width = in_width;
+    out_header.m_ddsHeader.height = in_height;
+    out_header.m_ddsHeader.depth = 1;
+    out_header.m_ddsHeader.mipMapCount = in_mipCount;
+    out_header.m_ddsHeader.ddspf = DirectX::DDSPF_DX10;
+    out_header.m_ddsHeader.caps = DDS_SURFACE_FLAGS_TEXTURE | DDS_SURFACE_FLAGS_MIPMAP;
+
+    out_header.m_extensionHeader = DirectX::DDS_HEADER_DXT10{};
+    out_header.m_extensionHeader.dxgiFormat = format;
+    out_header.m_extensionHeader.resourceDimension = DirectX::DDS_DIMENSION_TEXTURE2D;
+    out_header.m_extensionHeader.arraySize = 1;
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 int main()
@@ -423,77 +463,107 @@ int main()
     argParser.AddArg(L"-in", inFileName);
     argParser.AddArg(L"-out", outFileName);
     argParser.AddArg(L"-compress", m_compressionFormat, L"compression format");
-    argParser.Parse();
-
-    //--------------------------
-    // read dds file
-    //--------------------------
-    HANDLE inFileHandle = CreateFile(inFileName.data(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (NULL == inFileHandle)
-    {
-        Error(L"Failed to open file");
-    }
 
-    HANDLE inFileMapping = CreateFileMapping(inFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
-    if (NULL == inFileMapping)
-    {
-        Error(L"Failed to create mapping");
-    }
-    BYTE* pInFileBytes = (BYTE*)MapViewOfFile(inFileMapping, FILE_MAP_READ, 0, 0, 0);
-    if (NULL == pInFileBytes)
-    {
-        Error(L"Failed to map file");
-    }
+    // synthetic textures. the same parameters produce the same file
+    bool generate = false;
+    UINT width = 0, height = 0, mipCount = 0;
+    std::wstring format = L"BC7";
+    SyntheticTexture::Params syntheticParams;
+    argParser.AddArg(L"-generate", generate, L"generate a procedural texture instead of reading -in");
+    argParser.AddArg(L"-width", width, L"generated texture width");
+    argParser.AddArg(L"-height", height, L"generated texture height");
+    argParser.AddArg(L"-mips", mipCount, L"generated mip count, 0 for a full mip chain");
+    argParser.AddArg(L"-format", format, L"generated format: BC1 or BC7");
+    argParser.AddArg(L"-seed", syntheticParams.m_seed, L"random seed for generated data");
+    argParser.AddArg(L"-entropy", syntheticParams.m_entropy, L"fraction of generated blocks that are random. 1 is incompressible");
+    argParser.AddArg(L"-varyEntropy", syntheticParams.m_varyEntropy, L"vary entropy per tile between 0 and 2x -entropy");
+    argParser.AddArg(L"-constant", syntheticParams.m_constantFraction, L"fraction of generated tiles that are a single color");
+    argParser.AddArg(L"-duplicate", syntheticParams.m_duplicateFraction, L"fraction of generated tiles that duplicate an earlier tile");
+    argParser.Parse();
 
     XetFileHeader header;
     header.m_compressionFormat = m_compressionFormat;
 
-    //--------------------------
-    // interpret contents based on dds header
-    //--------------------------
-    BYTE* pBits = pInFileBytes;
-    if (DirectX::DDS_MAGIC == *(UINT32*)pBits)
-    {
-        pBits += sizeof(UINT32);
-        header.m_ddsHeader = *(DirectX::DDS_HEADER*)pBits;
-        pBits += header.m_ddsHeader.size;
+    HANDLE inFileHandle = NULL;
+    HANDLE inFileMapping = NULL;
+    BYTE* pInFileBytes = nullptr;
+    BYTE* pBits = nullptr;
 
-        if ((header.m_ddsHeader.ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header.m_ddsHeader.ddspf.fourCC))
+    if (generate)
+    {
+        SetSyntheticHeader(header, width, height, mipCount, format);
+        syntheticParams.m_blockSize = (DXGI_FORMAT_BC1_UNORM == header.m_extensionHeader.dxgiFormat) ? 8 : 16;
+        m_synthetic = std::make_unique<SyntheticTexture>(syntheticParams);
+    }
+    else
+    {
+        //--------------------------
+        // read dds file
+        //--------------------------
+        inFileHandle = CreateFile(inFileName.data(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (NULL == inFileHandle)
         {
-            header.m_extensionHeader = *(DirectX::DDS_HEADER_DXT10*)pBits;
-            pBits += sizeof(DirectX::DDS_HEADER_DXT10);
+            Error(L"Failed to open file");
         }
-        else
+
+        inFileMapping = CreateFileMapping(inFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (NULL == inFileMapping)
         {
-            DirectX::DDS_HEADER_DXT10 extensionHeader{};
-            header.m_extensionHeader = extensionHeader;
-            header.m_extensionHeader.dxgiFormat = GetFormatFromHeader(header.m_ddsHeader);
+            Error(L"Failed to create mapping");
         }
-    }
-    else
-    {
-        XetFileHeaderV2 srcHeader = *(XetFileHeaderV2*)pBits;
-        if (XetFileHeaderV2::GetMagic() != srcHeader.m_magic)
+        pInFileBytes = (BYTE*)MapViewOfFile(inFileMapping, FILE_MAP_READ, 0, 0, 0);
+        if (NULL == pInFileBytes)
         {
-            Error(L"Not a valid DDS or XET file");
+            Error(L"Failed to map file");
         }
 
-        if (XetFileHeaderV2::GetVersion() != srcHeader.m_version)
+        //--------------------------
+        // interpret contents based on dds header
+        //--------------------------
+        pBits = pInFileBytes;
+        if (DirectX::DDS_MAGIC == *(UINT32*)pBits)
         {
-            Error(L"Not a valid XET version");
+            pBits += sizeof(UINT32);
+            header.m_ddsHeader = *(DirectX::DDS_HEADER*)pBits;
+            pBits += header.m_ddsHeader.size;
+
+            if ((header.m_ddsHeader.ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header.m_ddsHeader.ddspf.fourCC))
+            {
+                header.m_extensionHeader = *(DirectX::DDS_HEADER_DXT10*)pBits;
+                pBits += sizeof(DirectX::DDS_HEADER_DXT10);
+            }
+            else
+            {
+                DirectX::DDS_HEADER_DXT10 extensionHeader{};
+                header.m_extensionHeader = extensionHeader;
+                header.m_extensionHeader.dxgiFormat = GetFormatFromHeader(header.m_ddsHeader);
+            }
         }
+        else
+        {
+            XetFileHeaderV2 srcHeader = *(XetFileHeaderV2*)pBits;
+            if (XetFileHeaderV2::GetMagic() != srcHeader.m_magic)
+            {
+                Error(L"Not a valid DDS or XET file");
+            }
 
-        m_convertFromXet2 = true; // changes behavior within WriteTiles()
+            if (XetFileHeaderV2::GetVersion() != srcHeader.m_version)
+            {
+                Error(L"Not a valid XET version");
+            }
 
-        header.m_ddsHeader = srcHeader.m_ddsHeader;
-        header.m_extensionHeader = srcHeader.m_extensionHeader;
+            m_convertFromXet2 = true; // changes behavior within WriteTiles()
 
-        XetFileHeaderV2::TileData* pTileData = (XetFileHeaderV2::TileData*)pBits;
-        size_t numBytes = sizeof(XetFileHeaderV2);
-        numBytes += sizeof(XetFileHeaderV2::TileData) * srcHeader.m_mipInfo.m_numTilesForStandardMips;
-        size_t alignment = XetFileHeaderV2::GetAlignment() - 1;
-        auto aligned = (numBytes + alignment) & (~alignment);
-        pBits += aligned;
+            header.m_ddsHeader = srcHeader.m_ddsHeader;
+            header.m_extensionHeader = srcHeader.m_extensionHeader;
+
+            XetFileHeaderV2::TileData* pTileData = (XetFileHeaderV2::TileData*)pBits;
+            size_t numBytes = sizeof(XetFileHeaderV2);
+            numBytes += sizeof(XetFileHeaderV2::TileData) * srcHeader.m_mipInfo.m_numTilesForStandardMips;
+            size_t alignment = XetFileHeaderV2::GetAlignment() - 1;
+            auto aligned = (numBytes + alignment) & (~alignment);
+            pBits += aligned;
+        }
     }
 
     // NOTE: pBits now points at beginning of DDS data
@@ -502,11 +572,28 @@ int main()
     // find offsets and rowpitch in source data
     FillSubresourceData(m_subresourceData, header);
 
+    // generated source has the layout of dds data, but only the packed mips (which are last) are used
+    std::vector<BYTE> syntheticSource;
+    if (m_synthetic)
+    {
+        for (const auto& s : m_subresourceData) { syntheticSource.resize(syntheticSource.size() + s.m_slicePitch); }
+        const UINT firstPackedMip = header.m_mipInfo.m_numStandardMips;
+        if (firstPackedMip < m_subresourceData.size())
+        {
+            const UINT packedOffset = m_subresourceData[firstPackedMip].m_offset;
+            m_synthetic->Fill(&syntheticSource[packedOffset], syntheticSource.size() - packedOffset);
+        }
+        pInFileBytes = syntheticSource.data();
+    }
+
     //--------------------------
     // reserve output space
     //--------------------------
-    std::filesystem::path inFilePath(inFileName);
-    auto fileSize = std::filesystem::file_size(inFilePath);
+    size_t fileSize = syntheticSource.size();
+    if (!m_synthetic)
+    {
+        fileSize = std::filesystem::file_size(std::filesystem::path(inFileName));
+    }
 
     m_textureData.reserve(fileSize); // reserve enough space to hold the whole uncompressed source
     m_offsets.reserve(header.m_mipInfo.m_numTilesForStandardMips + 1);
@@ -558,9 +645,12 @@ int main()
     outFile.write((char*)m_textureData.data(), (UINT)m_textureData.size());
     outFile.write((char*)m_packedMipData.data(), (UINT)m_packedMipData.size());
 
-    UnmapViewOfFile(pInFileBytes);
-    CloseHandle(inFileMapping);
-    CloseHandle(inFileHandle);
+    if (!m_synthetic)
+    {
+        UnmapViewOfFile(pInFileBytes);
+        CloseHandle(inFileMapping);
+        CloseHandle(inFileHandle);
+    }
 
     return 0;
 }
@@ -0,0 +1,130 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================
+// procedural BCn tile data, for benchmark media that can be regenerated anywhere
+//
+// a tile is a sequence of blocks. each block is either new random bytes (with probability "entropy")
+// or a copy of the previous block, so entropy 1 is incompressible and entropy 0 is a constant color
+// some tiles can be made constant, or exact duplicates of an earlier tile
+//
+// only the raw output of std::mt19937_64 is used, never std:: distributions,
+// whose results differ between standard library implementations
+//=============================================================================
+class SyntheticTexture
+{
+public:
+    struct Params
+    {
+        UINT64 m_seed{ 1 };
+        UINT m_blockSize{ 16 };          // bytes per BCn block: 8 for BC1, 16 for BC7
+        float m_entropy{ 0.5f };         // fraction of blocks that are random
+        bool m_varyEntropy{ false };     // if set, each tile's entropy is uniform in [0, 2 * m_entropy], clamped to 1
+        float m_constantFraction{ 0 };   // fraction of tiles that are a single color
+        float m_duplicateFraction{ 0 };  // fraction of tiles that are copies of an earlier tile
+    };
+
+    SyntheticTexture(const Params& in_params) : m_params(in_params), m_gen(in_params.m_seed) {}
+
+    // fills the next tile of the texture
+    void FillTile(BYTE* out_pTile, UINT in_tileSize)
+    {
+        TileSource source{ m_gen(), m_params.m_entropy };
+
+        float r = GetFraction();
+        if ((r < m_params.m_duplicateFraction) && m_tiles.size())
+        {
+            source = m_tiles[m_gen() % m_tiles.size()];
+        }
+        else
+        {
+            if (r < m_params.m_duplicateFraction + m_params.m_constantFraction)
+            {
+                source.m_entropy = 0;
+            }
+            else if (m_params.m_varyEntropy)
+            {
+                source.m_entropy = std::min(1.0f, 2 * m_params.m_entropy * GetFraction());
+            }
+            m_tiles.push_back(source);
+        }
+
+        std::mt19937_64 tileGen(source.m_seed);
+        FillBlocks(tileGen, out_pTile, in_tileSize, source.m_entropy);
+    }
+
+    // for data that is not tiled, e.g. packed mips
+    void Fill(BYTE* out_pDst, size_t in_numBytes)
+    {
+        FillBlocks(m_gen, out_pDst, in_numBytes, m_params.m_entropy);
+    }
+private:
+    const Params m_params;
+    std::mt19937_64 m_gen;
+
+    // duplicates are regenerated from the same seed rather than copied
+    struct TileSource
+    {
+        UINT64 m_seed;
+        float m_entropy;
+    };
+    std::vector<TileSource> m_tiles;
+
+    // [0, 1) from the top 24 bits
+    float GetFraction() { return float(m_gen() >> 40) / float(1 << 24); }
+
+    void FillBlocks(std::mt19937_64& in_gen, BYTE* out_pDst, size_t in_numBytes, float in_entropy)
+    {
+        const UINT blockSize = m_params.m_blockSize;
+        const UINT64 threshold = UINT64(double(in_entropy) * double(1 << 24));
+
+        for (size_t offset = 0; offset < in_numBytes; offset += blockSize)
+        {
+            size_t numBytes = std::min(size_t(blockSize), in_numBytes - offset);
+            bool random = (0 == offset) || ((in_gen() >> 40) < threshold);
+            if (random)
+            {
+                for (size_t i = 0; i < numBytes; i += sizeof(UINT64))
+                {
+                    UINT64 bits = in_gen();
+                    memcpy(&out_pDst[offset + i], &bits, std::min(sizeof(UINT64), numBytes - i));
+                }
+            }
+            else
+            {
+                memcpy(&out_pDst[offset], &out_pDst[offset - blockSize], numBytes);
+            }
+        }
+    }
+};
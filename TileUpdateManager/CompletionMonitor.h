@@ -0,0 +1,232 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+
+#include <d3d12.h>
+#include <vector>
+#include <atomic>
+#include <immintrin.h> // for _mm_pause()
+
+//==================================================
+// CompletionMonitor lets a single thread wait for forward progress on a set of fences
+//
+// the waiting thread first spins, checking the watched fence values and a notification flag.
+// if nothing completes within the spin count, the thread parks in WaitForMultipleObjects().
+// SetEventOnCompletion() is expensive, so it is only called when parking, and at most once per fence
+// for the lowest outstanding value (watches are batched: many in-flight values become 1 registration)
+//
+// Notify() wakes the thread for progress that is not expressed as a fence value,
+// e.g. new work or a copy fence value that just became valid
+//==================================================
+namespace Streaming
+{
+    //--------------------------------------------------
+    // anything with a monotonically increasing completed value that can signal an event, e.g. a DeviceFence
+    //--------------------------------------------------
+    class CompletionSource
+    {
+    public:
+        virtual ~CompletionSource() {}
+        virtual UINT64 GetCompletedValue() const = 0;
+        virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) = 0;
+    };
+
+    //--------------------------------------------------
+    //--------------------------------------------------
+    class CompletionMonitor
+    {
+    public:
+        CompletionMonitor(UINT in_numSources, UINT in_spinCount = 1024) :
+            m_spinCount(in_spinCount), m_sources(in_numSources), m_handles(in_numSources + 1)
+        {
+            m_handles[0] = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            for (UINT i = 0; i < in_numSources; i++)
+            {
+                m_sources[i].m_event = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+                m_handles[i + 1] = m_sources[i].m_event;
+            }
+        }
+
+        ~CompletionMonitor()
+        {
+            for (auto h : m_handles) { ::CloseHandle(h); }
+        }
+
+        // sources may only be changed while no thread is waiting
+        void SetSource(UINT in_index, CompletionSource* in_pSource)
+        {
+            auto& s = m_sources[in_index];
+            s.m_pSource = in_pSource;
+            s.m_watchValue = NONE;
+            s.m_registeredValue = NONE;
+            ::ResetEvent(s.m_event);
+        }
+
+        // waiting thread: wake when source reaches value. only the lowest value per source is retained
+        void Watch(UINT in_index, UINT64 in_value)
+        {
+            auto& s = m_sources[in_index];
+            s.m_watchValue = std::min(s.m_watchValue, in_value);
+        }
+
+        // any thread: wake the waiting thread. cheap unless the waiter is parked
+        void Notify()
+        {
+            m_notified = true;
+            if (m_parked)
+            {
+                ::SetEvent(m_handles[0]);
+            }
+        }
+
+        // waiting thread: spin, then park until notified or a watched value has completed
+        // watches are cleared on return, the caller re-arms them after processing
+        void Wait()
+        {
+            for (UINT i = 0; i < m_spinCount; i++)
+            {
+                if (IsReady())
+                {
+                    ClearWatches();
+                    return;
+                }
+                _mm_pause();
+            }
+
+            RegisterWatches();
+
+            // Notify() may have run between the spin and setting m_parked
+            m_parked = true;
+            if (!IsReady())
+            {
+                ::WaitForMultipleObjects((DWORD)m_handles.size(), m_handles.data(), FALSE, INFINITE);
+                m_numParks++;
+            }
+            m_parked = false;
+            m_notified = false;
+
+            ClearWatches();
+        }
+
+        //-------------------------------------------
+        // for a waiter that doesn't block in Wait(), e.g. a JobSystem::Service that is kicked when GetHandles() are signaled
+        //-------------------------------------------
+        // before processing: clear the previous watches
+        void Disarm()
+        {
+            m_parked = false;
+            m_notified = false;
+            ClearWatches();
+        }
+
+        // after processing: returns true if ready now, otherwise registers events and returns false
+        bool Arm()
+        {
+            RegisterWatches();
+
+            m_parked = true;
+            if (IsReady())
+            {
+                Disarm();
+                return true;
+            }
+            m_numParks++;
+            return false;
+        }
+
+        // auto-reset events: [0] is Notify(), followed by one per source
+        const std::vector<HANDLE>& GetHandles() const { return m_handles; }
+
+        //-------------------------------------------
+        // statistics
+        //-------------------------------------------
+        UINT64 GetNumParks() const { return m_numParks; }
+        UINT64 GetNumRegistrations() const { return m_numRegistrations; }
+    private:
+        static constexpr UINT64 NONE{ UINT64(-1) };
+
+        struct Source
+        {
+            CompletionSource* m_pSource{ nullptr };
+            HANDLE m_event{ nullptr };
+            UINT64 m_watchValue{ NONE };
+            UINT64 m_registeredValue{ NONE }; // value passed to the most recent SetEventOnCompletion()
+        };
+
+        const UINT m_spinCount;
+        std::vector<Source> m_sources;
+        std::vector<HANDLE> m_handles; // [0] is the notification event, followed by one event per source
+
+        std::atomic<bool> m_notified{ false };
+        std::atomic<bool> m_parked{ false };
+
+        UINT64 m_numParks{ 0 };
+        UINT64 m_numRegistrations{ 0 };
+
+        // register events only for values that aren't already registered
+        void RegisterWatches()
+        {
+            for (auto& s : m_sources)
+            {
+                if (NONE == s.m_watchValue) { continue; }
+
+                // a registration for a lower value that hasn't completed will wake us first
+                if ((NONE != s.m_registeredValue) && (s.m_registeredValue <= s.m_watchValue) &&
+                    (s.m_pSource->GetCompletedValue() < s.m_registeredValue))
+                {
+                    continue;
+                }
+
+                ::ResetEvent(s.m_event); // discard stale signal from a previous registration
+                s.m_pSource->SetEventOnCompletion(s.m_watchValue, s.m_event);
+                s.m_registeredValue = s.m_watchValue;
+                m_numRegistrations++;
+            }
+        }
+
+        bool IsReady()
+        {
+            if (m_notified.exchange(false))
+            {
+                return true;
+            }
+            for (const auto& s : m_sources)
+            {
+                if ((NONE != s.m_watchValue) && (s.m_pSource->GetCompletedValue() >= s.m_watchValue))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void ClearWatches()
+        {
+            for (auto& s : m_sources) { s.m_watchValue = NONE; }
+        }
+    };
+}
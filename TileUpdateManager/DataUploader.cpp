@@ -30,41 +30,56 @@
 #include "StreamingResourceDU.h"
 #include "FileStreamerReference.h"
 #include "FileStreamerDS.h"
+#include "FileStreamerSoftware.h"
 #include "StreamingHeap.h"
 
 //=============================================================================
 // Internal class that uploads texture data into a reserved resource
 //=============================================================================
 Streaming::DataUploader::DataUploader(
-    ID3D12Device* in_pDevice,
+    Device* in_pDevice,
     UINT in_maxCopyBatches,                  // maximum number of batches
     UINT in_stagingBufferSizeMB,             // upload buffer size
     UINT in_maxTileMappingUpdatesPerApiCall, // some HW/drivers seem to have a limit
-    int in_threadPriority) :
+    int in_threadPriority,
+    JobSystem* in_pJobSystem) :
     m_updateLists(in_maxCopyBatches)
     , m_updateListAllocator(in_maxCopyBatches)
     , m_stagingBufferSizeMB(in_stagingBufferSizeMB)
-    , m_gpuTimer(in_pDevice, in_maxCopyBatches, D3D12GpuTimer::TimerType::Copy)
+    , m_pDevice(in_pDevice)
     , m_mappingUpdater(in_maxTileMappingUpdatesPerApiCall)
     , m_threadPriority(in_threadPriority)
+    , m_pJobSystem(in_pJobSystem)
     , m_submitTaskAlloc(in_maxCopyBatches), m_submitTasks(in_maxCopyBatches)
     , m_monitorTaskAlloc(in_maxCopyBatches), m_monitorTasks(in_maxCopyBatches)
+    , m_fenceMonitor(FENCE_NUM_FENCES, m_fenceMonitorSpinCount)
+    , m_fenceScheduler(FENCE_NUM_FENCES)
 {
     // copy queue just for UpdateTileMappings() on reserved resources
     {
-        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
-        ThrowIfFailed(in_pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_mappingCommandQueue)));
-        m_mappingCommandQueue->SetName(L"DataUploader::m_mappingCommandQueue");
+        m_mappingQueue = in_pDevice->CreateCopyQueue(L"DataUploader::m_mappingQueue");
 
         // fence exclusively for mapping command queue
-        ThrowIfFailed(in_pDevice->CreateFence(m_mappingFenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_mappingFence)));
-        m_mappingFence->SetName(L"DataUploader::m_mappingFence");
+        m_mappingFence = in_pDevice->CreateFence(m_mappingFenceValue, L"DataUploader::m_mappingFence");
         m_mappingFenceValue++;
     }
 
-    InitDirectStorage(in_pDevice);
+    m_memoryFence = in_pDevice->CreateFence(m_memoryFenceValue, L"DataUploader::m_memoryFence");
+    m_memoryFenceValue++;
+
+    ID3D12Device* pDevice = in_pDevice->GetD3D12Device();
+    if (pDevice)
+    {
+        m_pGpuTimer = std::make_unique<D3D12GpuTimer>(pDevice, in_maxCopyBatches, D3D12GpuTimer::TimerType::Copy);
+        InitDirectStorage(pDevice);
+    }
+    else
+    {
+        m_memoryCopyQueue = in_pDevice->CreateCopyQueue(L"DataUploader::m_memoryCopyQueue");
+    }
+
+    m_fenceMonitor.SetSource(FENCE_MAPPING, m_mappingFence.get());
+    m_fenceMonitor.SetSource(FENCE_MEMORY, m_memoryFence.get());
 
     //NOTE: TileUpdateManager must call SetStreamer() to start streaming
     //SetStreamer(StreamerType::Reference);
@@ -100,9 +115,6 @@ void Streaming::DataUploader::InitDirectStorage(ID3D12Device* in_pDevice)
     queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_MEMORY;
     queueDesc.Device = in_pDevice;
     ThrowIfFailed(m_dsFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&m_memoryQueue)));
-
-    ThrowIfFailed(in_pDevice->CreateFence(m_memoryFenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_memoryFence)));
-    m_memoryFenceValue++;
 }
 
 //-----------------------------------------------------------------------------
@@ -111,6 +123,14 @@ void Streaming::DataUploader::InitDirectStorage(ID3D12Device* in_pDevice)
 //-----------------------------------------------------------------------------
 void Streaming::DataUploader::LoadTextureFromMemory(Streaming::UpdateList& out_updateList)
 {
+    out_updateList.m_copyFenceValue = m_memoryFenceValue;
+
+    // software device: nothing to copy to
+    if (nullptr == m_memoryQueue)
+    {
+        return;
+    }
+
     UINT uncompressedSize = 0;
     auto& textureBytes = out_updateList.m_pStreamingResource->GetPaddedPackedMips(uncompressedSize);
 
@@ -124,7 +144,6 @@ void Streaming::DataUploader::LoadTextureFromMemory(Streaming::UpdateList& out_u
     request.Destination.MultipleSubresources.FirstSubresource = out_updateList.m_pStreamingResource->GetPackedMipInfo().NumStandardMips;
     request.Options.CompressionFormat = (DSTORAGE_COMPRESSION_FORMAT)out_updateList.m_pStreamingResource->GetTextureFileInfo()->GetCompressionFormat();
 
-    out_updateList.m_copyFenceValue = m_memoryFenceValue;
     m_memoryQueue->EnqueueRequest(&request);
 }
 
@@ -132,8 +151,15 @@ void Streaming::DataUploader::LoadTextureFromMemory(Streaming::UpdateList& out_u
 //-----------------------------------------------------------------------------
 void Streaming::DataUploader::SubmitTextureLoadsFromMemory()
 {
-    m_memoryQueue->EnqueueSignal(m_memoryFence.Get(), m_memoryFenceValue);
-    m_memoryQueue->Submit();
+    if (m_memoryQueue)
+    {
+        m_memoryQueue->EnqueueSignal(m_memoryFence->GetD3D12Fence(), m_memoryFenceValue);
+        m_memoryQueue->Submit();
+    }
+    else
+    {
+        m_memoryCopyQueue->Signal(m_memoryFence.get(), m_memoryFenceValue);
+    }
     m_memoryFenceValue++;
 }
 
@@ -145,24 +171,33 @@ Streaming::FileStreamer* Streaming::DataUploader::SetStreamer(StreamerType in_st
 {
     StopThreads();
 
-    ComPtr<ID3D12Device> device;
-    m_mappingCommandQueue->GetDevice(IID_PPV_ARGS(&device));
-
     Streaming::FileStreamer* pOldStreamer = m_pFileStreamer.release();
+    if (pOldStreamer)
+    {
+        pOldStreamer->SetCompletionMonitor(nullptr);
+    }
 
-    if (StreamerType::Reference == in_streamerType)
+    if (nullptr == m_pDevice->GetD3D12Device())
+    {
+        m_pFileStreamer = std::make_unique<Streaming::FileStreamerSoftware>(m_pDevice);
+    }
+    else if (StreamerType::Reference == in_streamerType)
     {
         // buffer size in megabytes * 1024 * 1024 bytes / (tile size = 64 * 1024 bytes)
         UINT maxTileCopiesInFlight = m_stagingBufferSizeMB * (1024 / 64);
 
-        m_pFileStreamer = std::make_unique<Streaming::FileStreamerReference>(device.Get(),
-            (UINT)m_updateLists.size(), maxTileCopiesInFlight);
+        m_pFileStreamer = std::make_unique<Streaming::FileStreamerReference>(m_pDevice,
+            (UINT)m_updateLists.size(), maxTileCopiesInFlight, m_pJobSystem);
     }
     else
     {
-        m_pFileStreamer = std::make_unique<Streaming::FileStreamerDS>(device.Get(), m_dsFactory.Get());
+        m_pFileStreamer = std::make_unique<Streaming::FileStreamerDS>(m_pDevice, m_dsFactory.Get());
     }
 
+    // the file streamer wakes the fence monitor thread via its copy fence or, for cpu-side progress, Notify()
+    m_pFileStreamer->SetCompletionMonitor(&m_fenceMonitor);
+    m_fenceMonitor.SetSource(FENCE_COPY, m_pFileStreamer.get());
+
     StartThreads();
 
     return pOldStreamer;
@@ -176,6 +211,30 @@ void Streaming::DataUploader::StartThreads()
     ASSERT(false == m_threadsRunning);
     m_threadsRunning = true;
 
+    if (m_pJobSystem)
+    {
+        m_pFenceThreadTimer = &m_cpuTimer;
+
+        m_pSubmitService = std::make_unique<JobSystem::Service>(*m_pJobSystem, [this]
+            {
+                SubmitThread();
+                return false;
+            }, m_threadPriority);
+
+        // instead of parking in m_fenceMonitor.Wait(), the job system waits on its events
+        m_pFenceMonitorService = std::make_unique<JobSystem::Service>(*m_pJobSystem, [this]
+            {
+                m_fenceMonitor.Disarm();
+                FenceMonitorThread();
+                return m_fenceMonitor.Arm(); // true: something completed while arming, run again
+            }, m_threadPriority);
+
+        const auto& handles = m_fenceMonitor.GetHandles();
+        m_pJobSystem->WatchEvents(handles.data(), (UINT)handles.size(), m_pFenceMonitorService.get());
+        m_pFenceMonitorService->Kick();
+        return;
+    }
+
     m_submitThread = std::thread([&]
         {
             while (m_threadsRunning)
@@ -194,13 +253,10 @@ void Streaming::DataUploader::StartThreads()
 
             while (m_threadsRunning)
             {
-                // if no outstanding work, sleep
-                if (0 == m_updateListAllocator.GetAllocated())
-                {
-                    m_fenceMonitorFlag.Wait();
-                }
-
+                // FenceMonitorThread() watches fence values for the UpdateLists it is waiting on
+                // if there is no outstanding work, the thread parks until notified
                 FenceMonitorThread();
+                m_fenceMonitor.Wait();
             }
         });
 
@@ -216,9 +272,19 @@ void Streaming::DataUploader::StopThreads()
     {
         m_threadsRunning = false;
 
+        if (m_pJobSystem)
+        {
+            m_pJobSystem->UnwatchEvents(m_pFenceMonitorService.get());
+            m_pSubmitService->WaitIdle();
+            m_pFenceMonitorService->WaitIdle();
+            m_pSubmitService.reset();
+            m_pFenceMonitorService.reset();
+            return;
+        }
+
         // wake up threads so they can exit
         m_submitFlag.Set();
-        m_fenceMonitorFlag.Set();
+        m_fenceMonitor.Notify();
 
         // stop submitting new work
         if (m_submitThread.joinable())
@@ -244,8 +310,8 @@ void Streaming::DataUploader::FlushCommands()
         DebugPrint("DataUploader waiting on ", m_updateListAllocator.GetAllocated(), " tasks to complete\n");
         while (m_updateListAllocator.GetAllocated()) // wait so long as there is outstanding work
         {
-            m_submitFlag.Set(); // (paranoia)
-            m_fenceMonitorFlag.Set(); // (paranoia)
+            WakeSubmit(); // (paranoia)
+            m_fenceMonitor.Notify(); // (paranoia)
             _mm_pause();
         }
     }
@@ -268,21 +334,16 @@ Streaming::UpdateList* Streaming::DataUploader::AllocateUpdateList(Streaming::St
 {
     UpdateList* pUpdateList = nullptr;
 
-    if (m_updateListAllocator.GetAvailable())
+    // any thread may allocate. only the fence monitor thread frees
+    UINT index = 0;
+    if (m_updateListAllocator.Allocate(index))
     {
-        UINT index = m_updateListAllocator.Allocate();
         pUpdateList = &m_updateLists[index];
         ASSERT(UpdateList::State::STATE_FREE == pUpdateList->m_executionState);
 
         pUpdateList->Reset(in_pStreamingResource);
         pUpdateList->m_executionState = UpdateList::State::STATE_ALLOCATED;
-
-        // start fence polling thread now
-        {
-            m_monitorTasks[m_monitorTaskAlloc.GetWriteIndex()] = pUpdateList;
-            m_monitorTaskAlloc.Allocate();
-            m_fenceMonitorFlag.Set();
-        }
+        in_pStreamingResource->AddUpdateList();
     }
 
     return pUpdateList;
@@ -293,6 +354,9 @@ Streaming::UpdateList* Streaming::DataUploader::AllocateUpdateList(Streaming::St
 //-----------------------------------------------------------------------------
 void Streaming::DataUploader::FreeUpdateList(Streaming::UpdateList& in_updateList)
 {
+    // the resource may be removed once it has no UpdateLists in flight
+    in_updateList.m_pStreamingResource->ReleaseUpdateList();
+
     // NOTE: updatelist is deliberately not cleared until after allocation
     // otherwise there can be a race with the mapping thread
     in_updateList.m_executionState = UpdateList::State::STATE_FREE;
@@ -317,131 +381,183 @@ void Streaming::DataUploader::SubmitUpdateList(Streaming::UpdateList& in_updateL
         m_pFileStreamer->StreamTexture(in_updateList);
     }
 
-    // add to submit task queue
+    // add to submit task queue. may be called from multiple threads
     {
-        m_submitTasks[m_submitTaskAlloc.GetWriteIndex()] = &in_updateList;
-        m_submitTaskAlloc.Allocate();
-        m_submitFlag.Set();
+        UINT taskIndex = 0;
+        bool allocated = m_submitTaskAlloc.Allocate(taskIndex);
+        ASSERT(allocated);
+        m_submitTasks[taskIndex] = &in_updateList;
+        m_submitTaskAlloc.Publish(taskIndex);
+        WakeSubmit();
     }
 }
 
 //-----------------------------------------------------------------------------
-// check necessary fences to determine completion status
-// possibilities:
-// 1. packed tiles, submitted state, mapping done, move to uploading state
-// 2. packed tiles, copy pending state, copy complete
-// 3. standard tiles, copy pending state, mapping started and complete, copy complete
-// 4. no tiles, mapping started and complete
-// all cases: state > allocated
+// wait for a fence value as part of an UpdateList's life cycle
+// returns true if the value has already completed, in which case the UpdateList continues immediately
+// otherwise the UpdateList is suspended, and Resume() will be called when the fence reaches the value
 //-----------------------------------------------------------------------------
-void Streaming::DataUploader::FenceMonitorThread()
+bool Streaming::DataUploader::Await(Streaming::UpdateList& in_updateList, FenceIndex in_fence, UINT64 in_value)
 {
-    bool loadPackedMips = false;
-
-    const UINT numTasks = m_monitorTaskAlloc.GetReadyToRead();
-    if (0 == numTasks)
+    if (m_completedValues[in_fence] >= in_value)
     {
-        return;
+        return true;
     }
+    m_fenceScheduler.Await(in_fence, in_value, &in_updateList);
+    return false;
+}
 
-    const UINT startIndex = m_monitorTaskAlloc.GetReadIndex();
-    for (UINT i = startIndex; i < (startIndex + numTasks); i++)
-    {
-        ASSERT(numTasks != 0);
-        auto& updateList = *m_monitorTasks[i % m_monitorTasks.size()];
-
-        bool freeUpdateList = false;
-
-        // assign a start time to every in-flight update list. this will give us an upper bound on latency.
-        // latency is only measured for tile uploads
-        if ((UpdateList::State::STATE_FREE != updateList.m_executionState) && (0 == updateList.m_copyLatencyTimer))
-        {
-            updateList.m_copyLatencyTimer = m_pFenceThreadTimer->GetTime();
-        }
+//-----------------------------------------------------------------------------
+// run an UpdateList until it has to wait for a fence, or is done
+// each stage ends by awaiting the fence that gates the next stage:
+// 1. packed tiles: mapping complete -> upload packed mips -> copy complete -> notify
+// 2. standard tiles: copy fence valid -> copy complete -> mapping complete -> notify
+// 3. evictions and/or tiles mapped from shared storage: mapping complete -> notify
+// to add a stage, add a state and the fence it awaits
+//-----------------------------------------------------------------------------
+void Streaming::DataUploader::Resume(Streaming::UpdateList& in_updateList)
+{
+    auto& updateList = in_updateList;
 
+    while (1)
+    {
         switch (updateList.m_executionState)
         {
-
         case UpdateList::State::STATE_PACKED_MAPPING:
             ASSERT(0 == updateList.GetNumStandardUpdates());
             ASSERT(0 == updateList.GetNumEvictions());
 
             // wait for mapping complete before streaming packed tiles
-            if (m_mappingFence->GetCompletedValue() >= updateList.m_mappingFenceValue)
-            {
-                LoadTextureFromMemory(updateList);
+            if (!Await(updateList, FENCE_MAPPING, updateList.m_mappingFenceValue)) { return; }
 
-                loadPackedMips = true; // set flag to signal fence
-                updateList.m_executionState = UpdateList::State::STATE_PACKED_COPY_PENDING;
-            }
+            LoadTextureFromMemory(updateList);
+            m_loadPackedMips = true; // set flag to signal fence
+            updateList.m_executionState = UpdateList::State::STATE_PACKED_COPY_PENDING;
             break;
 
         case UpdateList::State::STATE_PACKED_COPY_PENDING:
             ASSERT(0 == updateList.GetNumStandardUpdates());
             ASSERT(0 == updateList.GetNumEvictions());
 
-            if (m_memoryFence->GetCompletedValue() >= updateList.m_copyFenceValue)
-            {
-                updateList.m_pStreamingResource->NotifyPackedMips();
-                freeUpdateList = true;
-            }
-            break;
+            if (!Await(updateList, FENCE_MEMORY, updateList.m_copyFenceValue)) { return; }
+
+            updateList.m_pStreamingResource->NotifyPackedMips();
+            FreeUpdateList(updateList);
+            return;
 
         case UpdateList::State::STATE_UPLOADING:
             ASSERT(0 != updateList.GetNumStandardUpdates());
 
             // only check copy fence if the fence has been set (avoid race condition)
-            if ((updateList.m_copyFenceValid) && (m_pFileStreamer->GetCompleted(updateList)))
+            // if the copy fence isn't valid yet, the file streamer will Notify() when it is
+            if (!updateList.m_copyFenceValid)
             {
-                updateList.m_executionState = UpdateList::State::STATE_MAP_PENDING;
-            }
-            else
-            {
-                break;
+                m_copyFenceNotValid.push_back(&updateList);
+                return;
             }
-            [[fallthrough]];
+            if (!Await(updateList, FENCE_COPY, updateList.m_copyFenceValue)) { return; }
+
+            updateList.m_executionState = UpdateList::State::STATE_MAP_PENDING;
+            break;
 
         case UpdateList::State::STATE_MAP_PENDING:
-            if (updateList.m_mappingFenceValue <= m_mappingFence->GetCompletedValue())
+            if (!Await(updateList, FENCE_MAPPING, updateList.m_mappingFenceValue)) { return; }
+
+            // notify evictions
+            if (updateList.GetNumEvictions())
             {
-                // notify evictions
-                if (updateList.GetNumEvictions())
-                {
-                    updateList.m_pStreamingResource->NotifyEvicted(updateList.m_evictCoords);
+                updateList.m_pStreamingResource->NotifyEvicted(updateList.m_evictCoords);
 
-                    m_numTotalEvictions.fetch_add(updateList.GetNumEvictions(), std::memory_order_relaxed);
-                }
+                m_numTotalEvictions.fetch_add(updateList.GetNumEvictions(), std::memory_order_relaxed);
+            }
 
-                // notify regular tiles
-                if (updateList.GetNumStandardUpdates())
-                {
-                    updateList.m_pStreamingResource->NotifyCopyComplete(updateList.m_coords);
+            // notify regular tiles
+            if (updateList.GetNumStandardUpdates())
+            {
+                updateList.m_pStreamingResource->NotifyCopyComplete(updateList.m_coords);
 
-                    auto updateLatency = m_pFenceThreadTimer->GetTime() - updateList.m_copyLatencyTimer;
-                    m_totalTileCopyLatency.fetch_add(updateLatency * updateList.GetNumStandardUpdates(), std::memory_order_relaxed);
+                auto updateLatency = m_pFenceThreadTimer->GetTime() - updateList.m_copyLatencyTimer;
+                m_totalTileCopyLatency.fetch_add(updateLatency * updateList.GetNumStandardUpdates(), std::memory_order_relaxed);
 
-                    m_numTotalUploads.fetch_add(updateList.GetNumStandardUpdates(), std::memory_order_relaxed);
+                m_numTotalUploads.fetch_add(updateList.GetNumStandardUpdates(), std::memory_order_relaxed);
+            }
 
-                }
+            // notify tiles mapped from shared storage. no upload, so not included in latency
+            if (updateList.GetNumMapOnly())
+            {
+                updateList.m_pStreamingResource->NotifyMapped(updateList.m_mapCoords);
 
-                freeUpdateList = true;
+                m_numTotalSharedMappings.fetch_add(updateList.GetNumMapOnly(), std::memory_order_relaxed);
             }
-        break;
+
+            FreeUpdateList(updateList);
+            return;
 
         default:
-            break;
+            ASSERT(0);
+            return;
         }
+    }
+}
 
-        if (freeUpdateList)
+//-----------------------------------------------------------------------------
+// advance UpdateLists whose fences have progressed
+// only UpdateLists that were just submitted or whose awaited fence value has completed are visited
+// suspended UpdateLists cost nothing
+//-----------------------------------------------------------------------------
+void Streaming::DataUploader::FenceMonitorThread()
+{
+    m_loadPackedMips = false;
+
+    m_completedValues[FENCE_MAPPING] = m_mappingFence->GetCompletedValue();
+    m_completedValues[FENCE_MEMORY] = m_memoryFence->GetCompletedValue();
+    m_completedValues[FENCE_COPY] = m_pFileStreamer->GetCompletedValue();
+
+    // start UpdateLists handed over by the submit thread
+    const UINT numTasks = m_monitorTaskAlloc.GetReadyToRead();
+    for (UINT i = 0; i < numTasks; i++)
+    {
+        auto& updateList = *m_monitorTasks[m_monitorTaskAlloc.GetReadIndex(i)];
+
+        // assign a start time to every in-flight update list. this will give us an upper bound on latency.
+        // latency is only measured for tile uploads
+        updateList.m_copyLatencyTimer = m_pFenceThreadTimer->GetTime();
+
+        Resume(updateList);
+    }
+    if (numTasks)
+    {
+        m_monitorTaskAlloc.Free(numTasks);
+    }
+
+    // copy fence values set since the last pass (see FileStreamerReference)
+    if (m_copyFenceNotValid.size())
+    {
+        std::vector<UpdateList*> copyFenceNotValid;
+        copyFenceNotValid.swap(m_copyFenceNotValid);
+        for (auto p : copyFenceNotValid)
         {
-            // O(1) array compaction: move the first element to the position of the element to be freed, then reduce size by 1.
-            m_monitorTasks[i % m_monitorTasks.size()] = m_monitorTasks[m_monitorTaskAlloc.GetReadIndex()];
-            m_monitorTaskAlloc.Free();
-            FreeUpdateList(updateList);
+            Resume(*p);
         }
-    } // end loop over updatelists
+    }
+
+    // resume UpdateLists whose fences have completed
+    for (UINT i = 0; i < FENCE_NUM_FENCES; i++)
+    {
+        m_fenceScheduler.Resume(i, m_completedValues[i], [&](UpdateList* p) { Resume(*p); });
+    }
 
-    if (loadPackedMips)
+    // wake when the next awaited value of each fence completes
+    for (UINT i = 0; i < FENCE_NUM_FENCES; i++)
+    {
+        UINT64 nextValue = m_fenceScheduler.GetNextValue(i);
+        if (FenceScheduler<UpdateList>::NONE != nextValue)
+        {
+            m_fenceMonitor.Watch(i, nextValue);
+        }
+    }
+
+    if (m_loadPackedMips)
     {
         SubmitTextureLoadsFromMemory();
     }
@@ -475,7 +591,7 @@ void Streaming::DataUploader::SubmitThread()
         // unmap tiles that are being evicted
         if (updateList.GetNumEvictions())
         {
-            m_mappingUpdater.UnMap(GetMappingQueue(), updateList.m_pStreamingResource->GetTiledResource(), updateList.m_evictCoords);
+            m_mappingUpdater.UnMap(GetMappingQueue(), updateList.m_pStreamingResource->GetDeviceTiledResource(), updateList.m_evictCoords);
 
             // this will skip the uploading state unless there are uploads
             updateList.m_executionState = UpdateList::State::STATE_MAP_PENDING;
@@ -486,25 +602,52 @@ void Streaming::DataUploader::SubmitThread()
         if (updateList.GetNumStandardUpdates())
         {
             m_mappingUpdater.Map(GetMappingQueue(),
-                updateList.m_pStreamingResource->GetTiledResource(),
-                updateList.m_pStreamingResource->GetHeap()->GetHeap(),
+                updateList.m_pStreamingResource->GetDeviceTiledResource(),
+                updateList.m_pStreamingResource->GetHeap()->GetDeviceHeap(),
                 updateList.m_coords, updateList.m_heapIndices);
 
             updateList.m_executionState = UpdateList::State::STATE_UPLOADING;
         }
 
         // no uploads or evictions? must be mapping packed mips
-        else if (0 == updateList.GetNumEvictions())
+        else if ((0 == updateList.GetNumEvictions()) && (0 == updateList.GetNumMapOnly()))
         {
             updateList.m_pStreamingResource->MapPackedMips(GetMappingQueue());
 
             updateList.m_executionState = UpdateList::State::STATE_PACKED_MAPPING;
         }
+
+        // map tiles another resource has already loaded. complete when mapping completes
+        if (updateList.GetNumMapOnly())
+        {
+            m_mappingUpdater.Map(GetMappingQueue(),
+                updateList.m_pStreamingResource->GetDeviceTiledResource(),
+                updateList.m_pStreamingResource->GetHeap()->GetDeviceHeap(),
+                updateList.m_mapCoords, updateList.m_mapHeapIndices);
+
+            if (0 == updateList.GetNumStandardUpdates())
+            {
+                updateList.m_executionState = UpdateList::State::STATE_MAP_PENDING;
+            }
+        }
+
+        // hand off to the fence monitor thread
+        // can't fail: there are as many monitor task slots as UpdateLists, and each is handed off once
+        {
+            UINT taskIndex = 0;
+            bool allocated = m_monitorTaskAlloc.Allocate(taskIndex);
+            ASSERT(allocated);
+            m_monitorTasks[taskIndex] = &updateList;
+            m_monitorTaskAlloc.Publish(taskIndex);
+        }
     }
 
     if (signalMap)
     {
-        m_mappingCommandQueue->Signal(m_mappingFence.Get(), m_mappingFenceValue);
+        m_mappingQueue->Signal(m_mappingFence.get(), m_mappingFenceValue);
         m_mappingFenceValue++;
+
+        // UpdateLists have advanced out of the submitted state, fence monitor can start watching their fences
+        m_fenceMonitor.Notify();
     }
 }
@@ -31,6 +31,10 @@
 #include "UpdateList.h"
 #include "MappingUpdater.h"
 #include "FileStreamer.h"
+#include "Device.h"
+#include "CompletionMonitor.h"
+#include "FenceScheduler.h"
+#include "JobSystem.h"
 #include "D3D12GpuTimer.h"
 #include "Timer.h"
 
@@ -50,11 +54,12 @@ namespace Streaming
     {
     public:
         DataUploader(
-            ID3D12Device* in_pDevice,
+            Device* in_pDevice,
             UINT in_maxCopyBatches,                     // maximum number of batches
             UINT in_stagingBufferSizeMB,                // upload buffer size
             UINT in_maxTileMappingUpdatesPerApiCall,    // some HW/drivers seem to have a limit
-            int in_threadPriority
+            int in_threadPriority,
+            JobSystem* in_pJobSystem = nullptr          // if set, run the submit and fence monitor loops as services instead of threads
         );
         ~DataUploader();
 
@@ -63,14 +68,14 @@ namespace Streaming
         // wait for all outstanding commands to complete. 
         void FlushCommands();
 
-        ID3D12CommandQueue* GetMappingQueue() const { return m_mappingCommandQueue.Get(); }
+        DeviceQueue* GetMappingQueue() const { return m_mappingQueue.get(); }
 
         UINT GetNumUpdateListsAvailable() const { return m_updateListAllocator.GetAvailable(); }
 
-        // may return null. called by StreamingResource.
+        // may return null. called by StreamingResource, from any thread.
         UpdateList* AllocateUpdateList(StreamingResourceDU* in_pStreamingResource);
 
-        // StreamingResource requests tiles to be uploaded
+        // StreamingResource requests tiles to be uploaded, from any thread
         void SubmitUpdateList(Streaming::UpdateList& in_updateList);
 
         // TUM requests file streamer to signal its fence after StreamingResources have queued tile uploads
@@ -81,14 +86,16 @@ namespace Streaming
             Reference,
             DirectStorage
         };
+        // with a software device, the streamer is always FileStreamerSoftware
         Streaming::FileStreamer* SetStreamer(StreamerType in_streamerType);
 
         //----------------------------------
         // statistics and visualization
         //----------------------------------
-        float GetGpuStreamingTime() const { return m_gpuTimer.GetTimes()[0].first; }
+        float GetGpuStreamingTime() const { return m_pGpuTimer ? m_pGpuTimer->GetTimes()[0].first : 0; }
 
         UINT GetTotalNumUploads() const { return m_numTotalUploads; }
+        UINT GetTotalNumSharedMappings() const { return m_numTotalSharedMappings; }
         void AddEvictions(UINT in_numEvictions) { m_numTotalEvictions += in_numEvictions; }
         UINT GetTotalNumEvictions() const { return m_numTotalEvictions; }
         float GetApproximateTileCopyLatency() const { return m_pFenceThreadTimer->GetSecondsFromDelta(m_totalTileCopyLatency); } // sum of per-tile latencies so far
@@ -99,18 +106,20 @@ namespace Streaming
         // upload buffer size
         const UINT m_stagingBufferSizeMB{ 0 };
 
-        D3D12GpuTimer m_gpuTimer;
+        Device* const m_pDevice;
+
+        std::unique_ptr<D3D12GpuTimer> m_pGpuTimer; // only with a d3d12 device
         RawCpuTimer m_cpuTimer;
 
         // fence to monitor forward progress of the mapping queue. independent of the frame queue
-        ComPtr<ID3D12Fence> m_mappingFence;
+        std::unique_ptr<DeviceFence> m_mappingFence;
         UINT64 m_mappingFenceValue{ 0 };
         // copy queue just for mapping UpdateTileMappings() on reserved resource
-        ComPtr<ID3D12CommandQueue> m_mappingCommandQueue;
+        std::unique_ptr<DeviceQueue> m_mappingQueue;
 
         // pool of all updatelists
         std::vector<UpdateList> m_updateLists;
-        Streaming::AllocatorMT m_updateListAllocator;
+        Streaming::AllocatorMPSC m_updateListAllocator;
 
         // only the fence thread (which looks for final completion) frees UpdateLists
         void FreeUpdateList(Streaming::UpdateList& in_updateList);
@@ -126,29 +135,53 @@ namespace Streaming
         std::thread m_submitThread;
         Streaming::SynchronizationFlag m_submitFlag; // sleeps until flag set
         std::vector<UpdateList*> m_submitTasks;
-        RingBuffer m_submitTaskAlloc;
+        RingBufferMPSC m_submitTaskAlloc;
 
-        // thread to poll copy and mapping fences
-        // this thread could have been designed using WaitForMultipleObjects, but it was found that SetEventOnCompletion() was expensive in a tight thread loop
-        // compromise solution is to keep this thread awake so long as there are live UpdateLists.
+        // thread to monitor copy and mapping fences
+        // SetEventOnCompletion() is expensive in a tight thread loop, so the thread spins briefly then parks
+        // with one registration per fence for the lowest outstanding value. see CompletionMonitor
+        // UpdateLists are handed over by the submit thread, then suspended in m_fenceScheduler between stages
         void FenceMonitorThread();
         std::thread m_fenceMonitorThread;
-        Streaming::SynchronizationFlag m_fenceMonitorFlag; // sleeps until flag set
+        enum FenceIndex : UINT
+        {
+            FENCE_MAPPING = 0,
+            FENCE_MEMORY,
+            FENCE_COPY, // the file streamer
+            FENCE_NUM_FENCES
+        };
+        Streaming::CompletionMonitor m_fenceMonitor;
+        static const UINT m_fenceMonitorSpinCount{ 1024 }; // spin iterations before parking
         RawCpuTimer* m_pFenceThreadTimer{ nullptr }; // init timer on the thread that uses it. can't really worry about thread migration.
         std::vector<UpdateList*> m_monitorTasks;
-        RingBuffer m_monitorTaskAlloc;
+        RingBufferMPSC m_monitorTaskAlloc;
+
+        // UpdateList life cycle, executed by the fence monitor thread
+        void Resume(UpdateList& in_updateList);
+        bool Await(UpdateList& in_updateList, FenceIndex in_fence, UINT64 in_value);
+        Streaming::FenceScheduler<UpdateList> m_fenceScheduler;
+        UINT64 m_completedValues[FENCE_NUM_FENCES]{}; // sampled once per pass of the fence monitor thread
+        std::vector<UpdateList*> m_copyFenceNotValid; // uploading, but the file streamer hasn't assigned a copy fence value yet
+        bool m_loadPackedMips{ false }; // packed mips were queued this pass, signal the memory queue
 
         void StartThreads();
         void StopThreads();
         std::atomic<bool> m_threadsRunning{ false };
         const int m_threadPriority{ 0 };
 
+        // alternative to m_submitThread and m_fenceMonitorThread
+        JobSystem* const m_pJobSystem{ nullptr };
+        std::unique_ptr<JobSystem::Service> m_pSubmitService;
+        std::unique_ptr<JobSystem::Service> m_pFenceMonitorService; // kicked by the events of m_fenceMonitor
+        void WakeSubmit() { if (m_pSubmitService) { m_pSubmitService->Kick(); } else { m_submitFlag.Set(); } }
+
         // DS memory queue used just for loading packed mips
         // separate memory queue means needing a second fence - can't wait across DS queues
         void InitDirectStorage(ID3D12Device* in_pDevice);
         ComPtr<IDStorageFactory> m_dsFactory;
         ComPtr<IDStorageQueue> m_memoryQueue;
-        ComPtr<ID3D12Fence> m_memoryFence;
+        std::unique_ptr<DeviceFence> m_memoryFence;
+        std::unique_ptr<DeviceQueue> m_memoryCopyQueue; // software device: no DS, the packed mips are already in memory. only signals
         UINT64 m_memoryFenceValue{ 0 };
         void LoadTextureFromMemory(UpdateList& out_updateList);
         void SubmitTextureLoadsFromMemory();
@@ -158,6 +191,7 @@ namespace Streaming
         //-------------------------------------------
         std::atomic<UINT> m_numTotalEvictions{ 0 };
         std::atomic<UINT> m_numTotalUploads{ 0 };
+        std::atomic<UINT> m_numTotalSharedMappings{ 0 }; // tiles mapped from shared storage instead of uploaded
         std::atomic<UINT> m_numTotalUpdateListsProcessed{ 0 };
         std::atomic<INT64> m_totalTileCopyLatency{ 0 }; // total approximate latency for all copies. divide by m_numTotalUploads then get the time with m_cpuTimer.GetSecondsFromDelta() 
     };
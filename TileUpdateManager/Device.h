@@ -0,0 +1,115 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <memory>
+
+#include "CompletionMonitor.h"
+
+//==================================================
+// Device is the thin layer between the streaming library and D3D12
+// it covers what the cpu pipeline needs from the gpu: fences, queues that update tile mappings and signal fences,
+// tile heaps, and reserved resources with their tiling
+//
+// CreateD3D12Device() wraps the device of the application's direct queue
+// CreateSoftwareDevice() emulates one on the cpu, so the pipeline (feedback -> queue -> I/O -> notify -> min-mip map)
+// can run and be profiled headless:
+//     queues complete work (signal fences) a fixed latency after it was submitted
+//     tile mappings are tables in memory, checked for consistency
+//     there are no gpu objects: GetD3D12*() return null, feedback and the residency map are host memory
+// only the gpu is abstracted. the library still uses Win32 events, threads, and file I/O, and D3D12 types,
+// so the software device runs on Windows machines without a suitable gpu, not on other platforms
+//==================================================
+namespace Streaming
+{
+    class XeTexture;
+
+    // a fence is the completion source for the work of the queue(s) that signal it
+    class DeviceFence : public CompletionSource
+    {
+    public:
+        virtual ID3D12Fence* GetD3D12Fence() const = 0;
+    };
+
+    // heap of 64KB tiles
+    class DeviceHeap
+    {
+    public:
+        virtual ~DeviceHeap() {}
+        virtual ID3D12Heap* GetD3D12Heap() const = 0;
+    };
+
+    // reserved resource
+    class DeviceTiledResource
+    {
+    public:
+        virtual ~DeviceTiledResource() {}
+        virtual ID3D12Resource* GetD3D12Resource() const = 0;
+
+        // same as ID3D12Device::GetResourceTiling() for all subresources
+        virtual void GetTiling(UINT* out_pNumTilesTotal, D3D12_PACKED_MIP_INFO* out_pPackedMipInfo,
+            D3D12_TILE_SHAPE* out_pTileShape, UINT in_numSubresources, D3D12_SUBRESOURCE_TILING* out_pTiling) const = 0;
+    };
+
+    class DeviceQueue
+    {
+    public:
+        virtual ~DeviceQueue() {}
+
+        // map single tiles to heap indices. if the heap is null, unmap them (heap indices are ignored)
+        virtual void UpdateTileMappings(DeviceTiledResource* in_pResource, UINT in_numTiles,
+            const D3D12_TILED_RESOURCE_COORDINATE* in_pCoords, DeviceHeap* in_pHeap, const UINT* in_pHeapIndices) = 0;
+
+        // packed mips are mapped as one region of tiles starting at the first packed subresource
+        virtual void MapPackedMips(DeviceTiledResource* in_pResource, UINT in_firstSubresource, UINT in_numTiles,
+            DeviceHeap* in_pHeap, const UINT* in_pHeapIndices) = 0;
+
+        // the fence reaches the value when the work submitted before it has completed
+        virtual void Signal(DeviceFence* in_pFence, UINT64 in_value) = 0;
+
+        virtual ID3D12CommandQueue* GetD3D12Queue() const = 0;
+    };
+
+    class Device
+    {
+    public:
+        virtual ~Device() {}
+        virtual ID3D12Device8* GetD3D12Device() const = 0; // null for a software device
+
+        virtual std::unique_ptr<DeviceFence> CreateFence(UINT64 in_initialValue, const wchar_t* in_pName) = 0;
+        virtual std::unique_ptr<DeviceQueue> CreateCopyQueue(const wchar_t* in_pName) = 0;
+        virtual std::unique_ptr<DeviceHeap> CreateHeap(UINT in_numTiles) = 0;
+        virtual std::unique_ptr<DeviceTiledResource> CreateTiledResource(const XeTexture& in_textureFileInfo) = 0;
+
+        // the application's render queue. signals the frame fence
+        virtual DeviceQueue* GetDirectQueue() = 0;
+    };
+
+    std::unique_ptr<Device> CreateD3D12Device(ID3D12CommandQueue* in_pDirectQueue);
+    std::unique_ptr<Device> CreateSoftwareDevice(float in_latencyMs);
+}
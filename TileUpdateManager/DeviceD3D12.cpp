@@ -0,0 +1,238 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include "Device.h"
+#include "XeTexture.h"
+
+//=============================================================================
+// Device implemented with D3D12
+//=============================================================================
+namespace Streaming
+{
+    //-----------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------
+    class FenceD3D12 : public DeviceFence
+    {
+    public:
+        FenceD3D12(ID3D12Device* in_pDevice, UINT64 in_initialValue, const wchar_t* in_pName)
+        {
+            ThrowIfFailed(in_pDevice->CreateFence(in_initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+            m_fence->SetName(in_pName);
+        }
+
+        virtual UINT64 GetCompletedValue() const override { return m_fence->GetCompletedValue(); }
+        virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) override { m_fence->SetEventOnCompletion(in_value, in_event); }
+        virtual ID3D12Fence* GetD3D12Fence() const override { return m_fence.Get(); }
+    private:
+        ComPtr<ID3D12Fence> m_fence;
+    };
+
+    //-----------------------------------------------------------------------------
+    // heap to store streaming tiles. should be smaller than the entire surface
+    //-----------------------------------------------------------------------------
+    class HeapD3D12 : public DeviceHeap
+    {
+    public:
+        HeapD3D12(ID3D12Device* in_pDevice, UINT in_numTiles)
+        {
+            const UINT64 heapSize = UINT64(in_numTiles) * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+            CD3DX12_HEAP_DESC heapDesc(heapSize, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_DENY_BUFFERS | D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES);
+            ThrowIfFailed(in_pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+        }
+
+        virtual ID3D12Heap* GetD3D12Heap() const override { return m_heap.Get(); }
+    private:
+        ComPtr<ID3D12Heap> m_heap;
+    };
+
+    //-----------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------
+    class TiledResourceD3D12 : public DeviceTiledResource
+    {
+    public:
+        TiledResourceD3D12(ID3D12Device* in_pDevice, const XeTexture& in_textureFileInfo) : m_pDevice(in_pDevice)
+        {
+            D3D12_RESOURCE_DESC rd = CD3DX12_RESOURCE_DESC::Tex2D(
+                in_textureFileInfo.GetFormat(),
+                in_textureFileInfo.GetImageWidth(),
+                in_textureFileInfo.GetImageHeight(), 1,
+                (UINT16)in_textureFileInfo.GetMipCount()
+            );
+
+            // Layout must be D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE when creating reserved resources
+            rd.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+
+            ThrowIfFailed(in_pDevice->CreateReservedResource(
+                &rd,
+                // application is allowed to use before packed mips are loaded, but it's really a copy dest
+                D3D12_RESOURCE_STATE_COMMON,
+                nullptr,
+                IID_PPV_ARGS(&m_resource)));
+
+            static UINT m_streamingResourceID = 0;
+
+            std::wstringstream name;
+            name << "m_streamingTexture" << m_streamingResourceID++;
+            m_resource->SetName(name.str().c_str());
+        }
+
+        virtual ID3D12Resource* GetD3D12Resource() const override { return m_resource.Get(); }
+
+        virtual void GetTiling(UINT* out_pNumTilesTotal, D3D12_PACKED_MIP_INFO* out_pPackedMipInfo,
+            D3D12_TILE_SHAPE* out_pTileShape, UINT in_numSubresources, D3D12_SUBRESOURCE_TILING* out_pTiling) const override
+        {
+            m_pDevice->GetResourceTiling(m_resource.Get(), out_pNumTilesTotal, out_pPackedMipInfo, out_pTileShape, &in_numSubresources, 0, out_pTiling);
+        }
+    private:
+        ID3D12Device* m_pDevice;
+        ComPtr<ID3D12Resource> m_resource;
+    };
+
+    //-----------------------------------------------------------------------------
+    // tile mappings are updated one tile per region, so the range arrays are constant
+    // a queue is only used by one thread at a time, so they grow on demand
+    //-----------------------------------------------------------------------------
+    class QueueD3D12 : public DeviceQueue
+    {
+    public:
+        QueueD3D12(ID3D12CommandQueue* in_pQueue) : m_queue(in_pQueue) {}
+
+        virtual void UpdateTileMappings(DeviceTiledResource* in_pResource, UINT in_numTiles,
+            const D3D12_TILED_RESOURCE_COORDINATE* in_pCoords, DeviceHeap* in_pHeap, const UINT* in_pHeapIndices) override
+        {
+            if (m_rangeTileCounts.size() < in_numTiles)
+            {
+                m_rangeFlagsMap.assign(in_numTiles, D3D12_TILE_RANGE_FLAG_NONE);
+                m_rangeFlagsUnMap.assign(in_numTiles, D3D12_TILE_RANGE_FLAG_NULL);
+                m_rangeTileCounts.assign(in_numTiles, 1);
+            }
+
+            m_queue->UpdateTileMappings(
+                in_pResource->GetD3D12Resource(),
+                in_numTiles,
+                in_pCoords,
+                nullptr,
+                in_pHeap ? in_pHeap->GetD3D12Heap() : nullptr,
+                in_numTiles,
+                in_pHeap ? m_rangeFlagsMap.data() : m_rangeFlagsUnMap.data(),
+                in_pHeap ? in_pHeapIndices : nullptr,
+                m_rangeTileCounts.data(),
+                D3D12_TILE_MAPPING_FLAG_NONE
+            );
+        }
+
+        virtual void MapPackedMips(DeviceTiledResource* in_pResource, UINT in_firstSubresource, UINT in_numTiles,
+            DeviceHeap* in_pHeap, const UINT* in_pHeapIndices) override
+        {
+            std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags(in_numTiles, D3D12_TILE_RANGE_FLAG_NONE);
+
+            // if the number of standard (not packed) mips is n, then start updating at subresource n
+            D3D12_TILED_RESOURCE_COORDINATE resourceRegionStartCoordinates{ 0, 0, 0, in_firstSubresource };
+            D3D12_TILE_REGION_SIZE resourceRegionSizes{ in_numTiles, FALSE, 0, 0, 0 };
+
+            m_queue->UpdateTileMappings(
+                in_pResource->GetD3D12Resource(),
+                1, // numRegions
+                &resourceRegionStartCoordinates,
+                &resourceRegionSizes,
+                in_pHeap->GetD3D12Heap(),
+                in_numTiles,
+                rangeFlags.data(),
+                in_pHeapIndices,
+                nullptr,
+                D3D12_TILE_MAPPING_FLAG_NONE
+            );
+        }
+
+        virtual void Signal(DeviceFence* in_pFence, UINT64 in_value) override
+        {
+            m_queue->Signal(in_pFence->GetD3D12Fence(), in_value);
+        }
+
+        virtual ID3D12CommandQueue* GetD3D12Queue() const override { return m_queue.Get(); }
+    private:
+        ComPtr<ID3D12CommandQueue> m_queue;
+
+        std::vector<D3D12_TILE_RANGE_FLAGS> m_rangeFlagsMap;   // all NONE
+        std::vector<D3D12_TILE_RANGE_FLAGS> m_rangeFlagsUnMap; // all NULL
+        std::vector<UINT> m_rangeTileCounts; // all 1s
+    };
+
+    //-----------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------
+    class DeviceD3D12 : public Device
+    {
+    public:
+        DeviceD3D12(ID3D12CommandQueue* in_pDirectQueue) : m_directQueue(in_pDirectQueue)
+        {
+            in_pDirectQueue->GetDevice(IID_PPV_ARGS(&m_device));
+        }
+
+        virtual ID3D12Device8* GetD3D12Device() const override { return m_device.Get(); }
+
+        virtual std::unique_ptr<DeviceFence> CreateFence(UINT64 in_initialValue, const wchar_t* in_pName) override
+        {
+            return std::make_unique<FenceD3D12>(m_device.Get(), in_initialValue, in_pName);
+        }
+
+        virtual std::unique_ptr<DeviceQueue> CreateCopyQueue(const wchar_t* in_pName) override
+        {
+            D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+            queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+            queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+
+            ComPtr<ID3D12CommandQueue> queue;
+            ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue)));
+            queue->SetName(in_pName);
+            return std::make_unique<QueueD3D12>(queue.Get());
+        }
+
+        virtual std::unique_ptr<DeviceHeap> CreateHeap(UINT in_numTiles) override
+        {
+            return std::make_unique<HeapD3D12>(m_device.Get(), in_numTiles);
+        }
+
+        virtual std::unique_ptr<DeviceTiledResource> CreateTiledResource(const XeTexture& in_textureFileInfo) override
+        {
+            return std::make_unique<TiledResourceD3D12>(m_device.Get(), in_textureFileInfo);
+        }
+
+        virtual DeviceQueue* GetDirectQueue() override { return &m_directQueue; }
+    private:
+        ComPtr<ID3D12Device8> m_device;
+        QueueD3D12 m_directQueue;
+    };
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+std::unique_ptr<Streaming::Device> Streaming::CreateD3D12Device(ID3D12CommandQueue* in_pDirectQueue)
+{
+    return std::make_unique<Streaming::DeviceD3D12>(in_pDirectQueue);
+}
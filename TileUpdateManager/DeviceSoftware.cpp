@@ -0,0 +1,304 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+#include "Device.h"
+#include "XeTexture.h"
+
+//=============================================================================
+// Device emulated on the cpu, for headless benchmarking on Windows machines without a suitable gpu
+// there is no gpu work to do, only its timing: a queue completes its work a fixed latency after submission
+//=============================================================================
+namespace Streaming
+{
+    //-----------------------------------------------------------------------------
+    // completed value is advanced by a software queue
+    //-----------------------------------------------------------------------------
+    class FenceSoftware : public DeviceFence
+    {
+    public:
+        FenceSoftware(UINT64 in_initialValue) : m_completedValue(in_initialValue) {}
+
+        virtual UINT64 GetCompletedValue() const override { return m_completedValue; }
+
+        virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) override
+        {
+            m_lock.Acquire();
+            if (m_completedValue >= in_value)
+            {
+                ::SetEvent(in_event);
+            }
+            else
+            {
+                m_events.push_back({ in_value, in_event });
+            }
+            m_lock.Release();
+        }
+
+        virtual ID3D12Fence* GetD3D12Fence() const override { return nullptr; }
+
+        // called by a software queue
+        void Signal(UINT64 in_value)
+        {
+            m_lock.Acquire();
+            m_completedValue = in_value;
+            auto i = std::remove_if(m_events.begin(), m_events.end(), [&](const auto& e)
+                {
+                    if (e.first > in_value) { return false; }
+                    ::SetEvent(e.second);
+                    return true;
+                });
+            m_events.erase(i, m_events.end());
+            m_lock.Release();
+        }
+    private:
+        std::atomic<UINT64> m_completedValue;
+        std::vector<std::pair<UINT64, HANDLE>> m_events;
+        Lock m_lock;
+    };
+
+    //-----------------------------------------------------------------------------
+    // only tracks its size, to validate heap indices
+    //-----------------------------------------------------------------------------
+    class HeapSoftware : public DeviceHeap
+    {
+    public:
+        HeapSoftware(UINT in_numTiles) : m_numTiles(in_numTiles) {}
+
+        virtual ID3D12Heap* GetD3D12Heap() const override { return nullptr; }
+        UINT GetNumTiles() const { return m_numTiles; }
+    private:
+        const UINT m_numTiles;
+    };
+
+    //-----------------------------------------------------------------------------
+    // tiling comes from the file, mappings are a table of tile coordinate -> heap index
+    //-----------------------------------------------------------------------------
+    class TiledResourceSoftware : public DeviceTiledResource
+    {
+    public:
+        TiledResourceSoftware(const XeTexture& in_textureFileInfo) : m_numSubresources(in_textureFileInfo.GetMipCount())
+        {
+            m_tiling.resize(m_numSubresources);
+            in_textureFileInfo.GetTiling(&m_numTilesTotal, &m_packedMipInfo, &m_tileShape, m_numSubresources, m_tiling.data());
+        }
+
+        virtual ID3D12Resource* GetD3D12Resource() const override { return nullptr; }
+
+        virtual void GetTiling(UINT* out_pNumTilesTotal, D3D12_PACKED_MIP_INFO* out_pPackedMipInfo,
+            D3D12_TILE_SHAPE* out_pTileShape, UINT in_numSubresources, D3D12_SUBRESOURCE_TILING* out_pTiling) const override
+        {
+            *out_pNumTilesTotal = m_numTilesTotal;
+            *out_pPackedMipInfo = m_packedMipInfo;
+            *out_pTileShape = m_tileShape;
+            std::copy(m_tiling.begin(), m_tiling.begin() + std::min(in_numSubresources, m_numSubresources), out_pTiling);
+        }
+
+        void Map(const D3D12_TILED_RESOURCE_COORDINATE& in_coord, UINT in_heapIndex)
+        {
+            ASSERT(in_coord.Subresource < m_numSubresources);
+            ASSERT(in_coord.X < m_tiling[in_coord.Subresource].WidthInTiles);
+            ASSERT(in_coord.Y < m_tiling[in_coord.Subresource].HeightInTiles);
+            m_mappings[GetKey(in_coord)] = in_heapIndex;
+        }
+
+        void UnMap(const D3D12_TILED_RESOURCE_COORDINATE& in_coord) { m_mappings.erase(GetKey(in_coord)); }
+
+        void MapPackedMips(UINT in_numTiles, const UINT* in_pHeapIndices)
+        {
+            ASSERT(in_numTiles == m_packedMipInfo.NumTilesForPackedMips);
+            m_packedMipHeapIndices.assign(in_pHeapIndices, in_pHeapIndices + in_numTiles);
+        }
+    private:
+        const UINT m_numSubresources;
+        UINT m_numTilesTotal{ 0 };
+        D3D12_PACKED_MIP_INFO m_packedMipInfo{};
+        D3D12_TILE_SHAPE m_tileShape{};
+        std::vector<D3D12_SUBRESOURCE_TILING> m_tiling;
+
+        static UINT64 GetKey(const D3D12_TILED_RESOURCE_COORDINATE& in_coord)
+        {
+            return (UINT64(in_coord.Subresource) << 48) | (UINT64(in_coord.Y) << 24) | in_coord.X;
+        }
+        std::unordered_map<UINT64, UINT> m_mappings;
+        std::vector<UINT> m_packedMipHeapIndices;
+    };
+
+    //-----------------------------------------------------------------------------
+    // mappings are applied when submitted. they aren't observable until a subsequent fence signal completes anyway
+    // signals complete on the queue's thread, in order, a fixed latency after they were submitted
+    //-----------------------------------------------------------------------------
+    class QueueSoftware : public DeviceQueue
+    {
+    public:
+        QueueSoftware(float in_latencyMs) :
+            m_latency(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(in_latencyMs)))
+        {
+            m_thread = std::thread([&] { SignalThread(); });
+        }
+
+        virtual ~QueueSoftware()
+        {
+            m_threadRunning = false;
+            m_signalFlag.Set();
+            m_thread.join();
+        }
+
+        virtual void UpdateTileMappings(DeviceTiledResource* in_pResource, UINT in_numTiles,
+            const D3D12_TILED_RESOURCE_COORDINATE* in_pCoords, DeviceHeap* in_pHeap, const UINT* in_pHeapIndices) override
+        {
+            auto pResource = (TiledResourceSoftware*)in_pResource;
+            if (in_pHeap)
+            {
+                for (UINT i = 0; i < in_numTiles; i++)
+                {
+                    ASSERT(in_pHeapIndices[i] < ((HeapSoftware*)in_pHeap)->GetNumTiles());
+                    pResource->Map(in_pCoords[i], in_pHeapIndices[i]);
+                }
+            }
+            else
+            {
+                for (UINT i = 0; i < in_numTiles; i++)
+                {
+                    pResource->UnMap(in_pCoords[i]);
+                }
+            }
+        }
+
+        virtual void MapPackedMips(DeviceTiledResource* in_pResource, UINT, UINT in_numTiles,
+            DeviceHeap*, const UINT* in_pHeapIndices) override
+        {
+            ((TiledResourceSoftware*)in_pResource)->MapPackedMips(in_numTiles, in_pHeapIndices);
+        }
+
+        virtual void Signal(DeviceFence* in_pFence, UINT64 in_value) override
+        {
+            m_signalLock.Acquire();
+            m_signals.push_back({ Clock::now() + m_latency, (FenceSoftware*)in_pFence, in_value });
+            m_signalLock.Release();
+            m_signalFlag.Set();
+        }
+
+        virtual ID3D12CommandQueue* GetD3D12Queue() const override { return nullptr; }
+    private:
+        using Clock = std::chrono::steady_clock;
+        const Clock::duration m_latency;
+
+        struct PendingSignal
+        {
+            Clock::time_point m_time;
+            FenceSoftware* m_pFence;
+            UINT64 m_value;
+        };
+        std::deque<PendingSignal> m_signals;
+        Lock m_signalLock;
+
+        SynchronizationFlag m_signalFlag;
+        std::atomic<bool> m_threadRunning{ true };
+        std::thread m_thread;
+
+        void SignalThread()
+        {
+            while (m_threadRunning)
+            {
+                m_signalFlag.Wait();
+
+                while (m_threadRunning)
+                {
+                    m_signalLock.Acquire();
+                    if (m_signals.empty())
+                    {
+                        m_signalLock.Release();
+                        break;
+                    }
+                    PendingSignal s = m_signals.front();
+                    m_signalLock.Release();
+
+                    // latency is constant, so the oldest signal is always the next to complete
+                    auto now = Clock::now();
+                    if (s.m_time > now)
+                    {
+                        std::this_thread::sleep_for(s.m_time - now);
+                    }
+
+                    s.m_pFence->Signal(s.m_value);
+
+                    m_signalLock.Acquire();
+                    m_signals.pop_front();
+                    m_signalLock.Release();
+                }
+            }
+        }
+    };
+
+    //-----------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------
+    class DeviceSoftware : public Device
+    {
+    public:
+        DeviceSoftware(float in_latencyMs) : m_latencyMs(in_latencyMs), m_directQueue(in_latencyMs) {}
+
+        virtual ID3D12Device8* GetD3D12Device() const override { return nullptr; }
+
+        virtual std::unique_ptr<DeviceFence> CreateFence(UINT64 in_initialValue, const wchar_t*) override
+        {
+            return std::make_unique<FenceSoftware>(in_initialValue);
+        }
+
+        virtual std::unique_ptr<DeviceQueue> CreateCopyQueue(const wchar_t*) override
+        {
+            return std::make_unique<QueueSoftware>(m_latencyMs);
+        }
+
+        virtual std::unique_ptr<DeviceHeap> CreateHeap(UINT in_numTiles) override
+        {
+            return std::make_unique<HeapSoftware>(in_numTiles);
+        }
+
+        virtual std::unique_ptr<DeviceTiledResource> CreateTiledResource(const XeTexture& in_textureFileInfo) override
+        {
+            return std::make_unique<TiledResourceSoftware>(in_textureFileInfo);
+        }
+
+        virtual DeviceQueue* GetDirectQueue() override { return &m_directQueue; }
+    private:
+        const float m_latencyMs;
+        QueueSoftware m_directQueue;
+    };
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+std::unique_ptr<Streaming::Device> Streaming::CreateSoftwareDevice(float in_latencyMs)
+{
+    return std::make_unique<Streaming::DeviceSoftware>(in_latencyMs);
+}
@@ -0,0 +1,80 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include "FeedbackCapture.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Streaming::FeedbackCapture::FeedbackCapture(const std::wstring& in_filename) :
+    m_file(in_filename, std::ios::out | std::ios::binary | std::ios::trunc)
+{
+    Write(FileHeader());
+}
+
+Streaming::FeedbackCapture::~FeedbackCapture()
+{
+    m_file.close();
+}
+
+//-----------------------------------------------------------------------------
+// the feedback is copied into the file buffer, so the lock is held only briefly
+// the heap and resource records are written the first time they are referenced
+//-----------------------------------------------------------------------------
+void Streaming::FeedbackCapture::Append(UINT32& inout_resourceID, const std::wstring& in_filename,
+    const void* in_pHeap, UINT in_heapNumTiles, UINT64 in_frame,
+    UINT in_width, UINT in_height, const UINT8* in_pMinMips, UINT in_rowPitch)
+{
+    m_lock.Acquire();
+
+    if (INVALID_ID == inout_resourceID)
+    {
+        auto h = m_heapIDs.find(in_pHeap);
+        if (m_heapIDs.end() == h)
+        {
+            h = m_heapIDs.insert({ in_pHeap, (UINT32)m_heapIDs.size() }).first;
+            Write(RecordType::HEAP);
+            Write(HeapRecord{ h->second, in_heapNumTiles });
+        }
+
+        inout_resourceID = m_numResources++;
+        Write(RecordType::RESOURCE);
+        Write(ResourceRecord{ inout_resourceID, h->second, (UINT32)in_filename.size() });
+        m_file.write((const char*)in_filename.data(), in_filename.size() * sizeof(wchar_t));
+    }
+
+    Write(RecordType::FEEDBACK);
+    Write(FeedbackRecord{ in_frame, inout_resourceID, (UINT16)in_width, (UINT16)in_height });
+    for (UINT y = 0; y < in_height; y++)
+    {
+        m_file.write((const char*)in_pMinMips, in_width);
+        in_pMinMips += in_rowPitch;
+    }
+
+    m_lock.Release();
+}
@@ -0,0 +1,109 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+
+#include "Streaming.h"
+
+//=============================================================================
+// binary log of the resolved feedback consumed by StreamingResource::ProcessFeedback()
+// for tuning feedback processing offline, e.g. with the feedbackReplay tool
+//
+// file: FileHeader, then a sequence of records, each starting with a RecordType
+//     HEAP:     HeapRecord
+//     RESOURCE: ResourceRecord, then m_filenameLength wchar_t (not terminated)
+//     FEEDBACK: FeedbackRecord, then m_width * m_height bytes of min mips (rows are tightly packed)
+// a heap or resource record precedes the first feedback that refers to it
+//=============================================================================
+namespace Streaming
+{
+    class FeedbackCapture
+    {
+    public:
+        static constexpr UINT32 MAGIC = 0x4b424653; // "SFBK"
+        static constexpr UINT32 VERSION = 1;
+
+        enum class RecordType : UINT32
+        {
+            HEAP = 1,
+            RESOURCE,
+            FEEDBACK
+        };
+
+        struct FileHeader
+        {
+            UINT32 m_magic{ MAGIC };
+            UINT32 m_version{ VERSION };
+        };
+
+        struct HeapRecord
+        {
+            UINT32 m_heapID;
+            UINT32 m_numTiles;
+        };
+
+        struct ResourceRecord
+        {
+            UINT32 m_resourceID;
+            UINT32 m_heapID;
+            UINT32 m_filenameLength;
+        };
+
+        struct FeedbackRecord
+        {
+            UINT64 m_frame; // frame fence value of the frame that wrote the feedback
+            UINT32 m_resourceID;
+            UINT16 m_width;
+            UINT16 m_height;
+        };
+
+        static const UINT32 INVALID_ID = UINT32(-1);
+
+        FeedbackCapture(const std::wstring& in_filename);
+        ~FeedbackCapture();
+
+        // called by ProcessFeedback, possibly by multiple threads for different resources
+        // inout_resourceID: per-resource storage, initially INVALID_ID. assigned on first use
+        void Append(UINT32& inout_resourceID, const std::wstring& in_filename,
+            const void* in_pHeap, UINT in_heapNumTiles, UINT64 in_frame,
+            UINT in_width, UINT in_height, const UINT8* in_pMinMips, UINT in_rowPitch);
+    private:
+        std::ofstream m_file;
+        Lock m_lock;
+
+        std::unordered_map<const void*, UINT32> m_heapIDs;
+        UINT32 m_numResources{ 0 };
+
+        template<typename T> void Write(const T& in_value) { m_file.write((const char*)&in_value, sizeof(T)); }
+    };
+}
@@ -0,0 +1,92 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <vector>
+#include <queue>
+
+//==================================================
+// FenceScheduler holds tasks that are suspended until a fence reaches a value
+// e.g. an UpdateList that has been mapped and is waiting for its copy to complete
+//
+// each source (fence) has a min-heap ordered by awaited value. a suspended task costs nothing
+// until its fence advances: Resume() visits only tasks whose values have completed, lowest first
+// instead of polling every in-flight task. GetNextValue() is the value to watch, e.g. with CompletionMonitor
+//
+// not thread safe: tasks are suspended and resumed on a single thread
+//==================================================
+namespace Streaming
+{
+    template<typename T> class FenceScheduler
+    {
+    public:
+        FenceScheduler(UINT in_numSources) : m_waiting(in_numSources) {}
+
+        static constexpr UINT64 NONE{ UINT64(-1) };
+
+        // suspend a task until the source reaches the value
+        void Await(UINT in_source, UINT64 in_value, T* in_pTask)
+        {
+            m_waiting[in_source].push(Waiter{ in_value, in_pTask });
+        }
+
+        // call in_resume() for every task awaiting a value <= in_completedValue
+        // in_resume() may Await() again, including on the same source for a greater value
+        // returns the number of tasks resumed
+        template<typename F> UINT Resume(UINT in_source, UINT64 in_completedValue, F in_resume)
+        {
+            auto& waiting = m_waiting[in_source];
+            UINT numResumed = 0;
+            while (waiting.size() && (waiting.top().m_value <= in_completedValue))
+            {
+                T* pTask = waiting.top().m_pTask;
+                waiting.pop();
+                in_resume(pTask);
+                numResumed++;
+            }
+            return numResumed;
+        }
+
+        // lowest value awaited on this source, or NONE
+        UINT64 GetNextValue(UINT in_source) const
+        {
+            const auto& waiting = m_waiting[in_source];
+            return waiting.size() ? waiting.top().m_value : NONE;
+        }
+
+        UINT GetNumWaiting(UINT in_source) const { return (UINT)m_waiting[in_source].size(); }
+    private:
+        struct Waiter
+        {
+            UINT64 m_value;
+            T* m_pTask;
+            bool operator > (const Waiter& in_other) const { return m_value > in_other.m_value; }
+        };
+        std::vector<std::priority_queue<Waiter, std::vector<Waiter>, std::greater<Waiter>>> m_waiting;
+    };
+}
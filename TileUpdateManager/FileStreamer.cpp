@@ -33,7 +33,7 @@
 //-----------------------------------------------------------------------------
 bool Streaming::FileStreamer::GetCompleted(const Streaming::UpdateList& in_updateList) const
 {
-    return in_updateList.m_copyFenceValue <= m_copyFence->GetCompletedValue();
+    return in_updateList.m_copyFenceValue <= GetCompletedValue();
 }
 
 //-----------------------------------------------------------------------------
@@ -71,10 +71,9 @@ BYTE Streaming::FileStreamer::m_BC1[Streaming::FileStreamer::m_lutSize][D3D12_TI
 //-----------------------------------------------------------------------------
 // constructor
 //-----------------------------------------------------------------------------
-Streaming::FileStreamer::FileStreamer(ID3D12Device* in_pDevice)
+Streaming::FileStreamer::FileStreamer(Device* in_pDevice)
 {
-    in_pDevice->CreateFence(m_copyFenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copyFence));
-    m_copyFence->SetName(L"FileStreamer::m_copyFence");
+    m_copyFence = in_pDevice->CreateFence(m_copyFenceValue, L"FileStreamer::m_copyFence");
     m_copyFenceValue++;
 
     static bool firstTimeInit = true;
@@ -98,32 +97,28 @@ Streaming::FileStreamer::FileStreamer(ID3D12Device* in_pDevice)
 
 Streaming::FileStreamer::~FileStreamer()
 {
-    // write trace file
-    if (m_captureTrace)
-    {
-        UINT resourceIndex = 0;
-        for (const auto& d : m_tracingResources)
-        {
-            auto& r = m_trace.GetRoot()["resources"][resourceIndex];
-            r["rsrc"] = (UINT64)d.first;
-            r["fmt"] = (UINT32)d.second.Format;
-            r["dim"][0] = (UINT32)d.second.Width;
-            r["dim"][1] = (UINT32)d.second.Height;
-            r["dim"][2] = (UINT32)d.second.MipLevels;
-            resourceIndex++;
-        }
+}
 
+//-----------------------------------------------------------------------------
+// the trace file is opened the first time capture is enabled
+// requests/submits made while capture is disabled are not recorded
+//-----------------------------------------------------------------------------
+void Streaming::FileStreamer::CaptureTraceFile(bool in_captureTrace)
+{
+    if (in_captureTrace && (nullptr == m_pTraceWriter))
+    {
         int index = 0;
         while (1)
         {
-            std::wstring unique = L"uploadTraceFile_" + std::to_wstring(++index) + L".json";
+            std::wstring unique = L"uploadTraceFile_" + std::to_wstring(++index) + L".bin";
             if (!std::filesystem::exists(unique))
             {
-                m_trace.Write(unique);
+                m_pTraceWriter = std::make_unique<TraceWriter>(unique);
                 break;
             }
         }
     }
+    m_captureTrace = in_captureTrace;
 }
 
 //-----------------------------------------------------------------------------
@@ -133,27 +128,9 @@ void Streaming::FileStreamer::TraceRequest(
     ID3D12Resource* in_pDstResource, const D3D12_TILED_RESOURCE_COORDINATE& in_dstCoord,
     const std::wstring& in_srcFilename, UINT64 in_srcOffset, UINT32 in_srcNumBytes, UINT32 in_compressionFormat)
 {
-    auto& r = m_trace.GetRoot()["submits"][m_traceSubmitIndex][m_traceRequestIndex++];
-    r["rsrc"] = (UINT64)in_pDstResource;
-    r["coord"][0] = in_dstCoord.X;
-    r["coord"][1] = in_dstCoord.Y;
-    r["coord"][2] = in_dstCoord.Subresource;
-
-    std::string filename;
-    int buf_len = ::WideCharToMultiByte(CP_UTF8, 0, in_srcFilename.c_str(), -1, NULL, 0, NULL, NULL);
-    filename.resize(buf_len);
-    ::WideCharToMultiByte(CP_UTF8, 0, in_srcFilename.c_str(), -1, filename.data(), buf_len, NULL, NULL);
-    r["file"] = filename;
-
-    r["off"] = in_srcOffset;
-    r["size"] = in_srcNumBytes;
-    if (in_compressionFormat) { r["comp"] = in_compressionFormat; }
-
-    auto desc = m_tracingResources.find(in_pDstResource);
-    if (m_tracingResources.end() == desc)
-    {
-        m_tracingResources[in_pDstResource] = in_pDstResource->GetDesc();
-    }
+    m_pTraceWriter->Request(m_traceSubmitIndex, in_pDstResource, in_dstCoord,
+        in_srcFilename, in_srcOffset, in_srcNumBytes, in_compressionFormat);
+    m_traceRequestIndex++;
 }
 
 //-----------------------------------------------------------------------------
@@ -168,6 +145,7 @@ void Streaming::FileStreamer::TraceSubmit()
         return;
     }
     ASSERT(0 != m_traceRequestIndex); // should never call Submit() without any requests
+    m_pTraceWriter->Submit(m_traceSubmitIndex, m_traceRequestIndex);
     m_traceRequestIndex = 0;
     m_traceSubmitIndex++;
 }
@@ -27,8 +27,9 @@
 #pragma once
 
 #include "Streaming.h"
-#include "ConfigurationParser.h"
-#include <unordered_map>
+#include "CompletionMonitor.h"
+#include "Device.h"
+#include "TraceWriter.h"
 
 namespace Streaming
 {
@@ -41,10 +42,11 @@ namespace Streaming
         virtual ~FileHandle() {}
     };
 
-    class FileStreamer
+    // the copy fence is the file streamer's completion source
+    class FileStreamer : public CompletionSource
     {
     public:
-        FileStreamer(ID3D12Device* in_pDevice);
+        FileStreamer(Device* in_pDevice);
         virtual ~FileStreamer();
 
         virtual FileHandle* OpenFile(const std::wstring& in_path) = 0;
@@ -63,12 +65,20 @@ namespace Streaming
 
         bool GetCompleted(const UpdateList& in_updateList) const;
 
-        void CaptureTraceFile(bool in_captureTrace) { m_captureTrace = in_captureTrace; } // enable/disable writing requests/submits to a trace file
+        virtual UINT64 GetCompletedValue() const override { return m_copyFence->GetCompletedValue(); }
+        virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) override { m_copyFence->SetEventOnCompletion(in_value, in_event); }
+
+        // wake the monitor when progress happens on the cpu, e.g. an UpdateList copy fence value becomes valid
+        void SetCompletionMonitor(CompletionMonitor* in_pMonitor) { m_pCompletionMonitor = in_pMonitor; }
+
+        void CaptureTraceFile(bool in_captureTrace); // enable/disable writing requests/submits to a trace file
     protected:
         // copy queue fence
-        ComPtr<ID3D12Fence> m_copyFence;
+        std::unique_ptr<DeviceFence> m_copyFence;
         UINT64 m_copyFenceValue{ 0 };
 
+        CompletionMonitor* m_pCompletionMonitor{ nullptr };
+
         // Visualization
         VisualizationMode m_visualizationMode{ VisualizationMode::DATA_VIZ_NONE };
 
@@ -85,7 +95,7 @@ namespace Streaming
         void InitializeBC1();
 
         // trace file
-        bool m_captureTrace{ false };
+        std::atomic<bool> m_captureTrace{ false };
 
         void TraceRequest(
             ID3D12Resource* in_pDstResource, const D3D12_TILED_RESOURCE_COORDINATE& in_dstCoord,
@@ -93,9 +103,8 @@ namespace Streaming
         void TraceSubmit();
     private:
         bool m_firstSubmit{ true };
-        ConfigurationParser m_trace; // array of submits, each submit is an array of requests
+        std::unique_ptr<TraceWriter> m_pTraceWriter; // created on first capture, written until the streamer is destroyed
         UINT m_traceSubmitIndex{ 0 };
         UINT m_traceRequestIndex{ 0 };
-        std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_DESC> m_tracingResources;
     };
 }
@@ -42,7 +42,7 @@ Streaming::FileStreamerDS::FileHandleDS::FileHandleDS(IDStorageFactory* in_pFact
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-Streaming::FileStreamerDS::FileStreamerDS(ID3D12Device* in_pDevice, IDStorageFactory* in_pDSfactory) :
+Streaming::FileStreamerDS::FileStreamerDS(Device* in_pDevice, IDStorageFactory* in_pDSfactory) :
     m_pFactory(in_pDSfactory),
     Streaming::FileStreamer(in_pDevice)
 {
@@ -50,7 +50,7 @@ Streaming::FileStreamerDS::FileStreamerDS(ID3D12Device* in_pDevice, IDStorageFac
     queueDesc.Capacity = DSTORAGE_MAX_QUEUE_CAPACITY;
     queueDesc.Priority = DSTORAGE_PRIORITY_NORMAL;
     queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
-    queueDesc.Device = in_pDevice;
+    queueDesc.Device = in_pDevice->GetD3D12Device();
 
     ThrowIfFailed(in_pDSfactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&m_fileQueue)));
 
@@ -86,6 +86,8 @@ void Streaming::FileStreamerDS::StreamTexture(Streaming::UpdateList& in_updateLi
     DXGI_FORMAT textureFormat = pTextureFileInfo->GetFormat();
     auto pDstHeap = in_updateList.m_pStreamingResource->GetHeap();
 
+    m_lock.Acquire();
+
     DSTORAGE_REQUEST request{};
     request.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_TILES;
     request.Destination.Tiles.TileRegionSize = D3D12_TILE_REGION_SIZE{ 1, FALSE, 0, 0, 0 };
@@ -114,8 +116,7 @@ void Streaming::FileStreamerDS::StreamTexture(Streaming::UpdateList& in_updateLi
 
             if (m_captureTrace)
             {
-                std::wstring fileName = std::filesystem::path(in_updateList.m_pStreamingResource->GetFileName()).filename();
-                TraceRequest(pAtlas, coord, fileName,
+                TraceRequest(pAtlas, coord, in_updateList.m_pStreamingResource->GetFileName(),
                     request.Source.File.Offset,
                     (UINT32)request.Source.File.Size,
                     (UINT32)request.Options.CompressionFormat);
@@ -145,26 +146,32 @@ void Streaming::FileStreamerDS::StreamTexture(Streaming::UpdateList& in_updateLi
 
     in_updateList.m_copyFenceValue = m_copyFenceValue;
     in_updateList.m_copyFenceValid = true;
+
+    m_lock.Release();
 }
 
 //-----------------------------------------------------------------------------
 // signal to submit a set of batches
-// must be executed in the same thread as the load methods above to avoid atomic m_copyFenceValue
+// serialized with StreamTexture(), which may be called from other threads
 //-----------------------------------------------------------------------------
 void Streaming::FileStreamerDS::Signal()
 {
+    m_lock.Acquire();
+
     if (VisualizationMode::DATA_VIZ_NONE == m_visualizationMode)
     {
-        m_fileQueue->EnqueueSignal(m_copyFence.Get(), m_copyFenceValue);
+        m_fileQueue->EnqueueSignal(m_copyFence->GetD3D12Fence(), m_copyFenceValue);
         m_fileQueue->Submit();
 
         if (m_captureTrace) { TraceSubmit(); }
     }
     else
     {
-        m_memoryQueue->EnqueueSignal(m_copyFence.Get(), m_copyFenceValue);
+        m_memoryQueue->EnqueueSignal(m_copyFence->GetD3D12Fence(), m_copyFenceValue);
         m_memoryQueue->Submit();
     }
 
     m_copyFenceValue++;
+
+    m_lock.Release();
 }
@@ -35,7 +35,7 @@ namespace Streaming
     class FileStreamerDS : public FileStreamer
     {
     public:
-        FileStreamerDS(ID3D12Device* in_pDevice, IDStorageFactory* in_pFactory);
+        FileStreamerDS(Device* in_pDevice, IDStorageFactory* in_pFactory);
         virtual ~FileStreamerDS();
 
         virtual FileHandle* OpenFile(const std::wstring& in_path) override;
@@ -64,5 +64,9 @@ namespace Streaming
         ComPtr<IDStorageQueue> m_memoryQueue;
 
         static IDStorageFile* GetFileHandle(const FileHandle* in_pHandle);
+
+        // UpdateLists may be streamed from multiple threads
+        // requests and the fence value they are assigned must not be separated by a Signal()
+        Streaming::Lock m_lock;
     };
 };
@@ -37,20 +37,23 @@ static const  D3D12_COMMAND_LIST_TYPE g_commandListType = D3D12_COMMAND_LIST_TYP
 //-----------------------------------------------------------------------------
 // Constructor
 //-----------------------------------------------------------------------------
-Streaming::FileStreamerReference::FileStreamerReference(ID3D12Device* in_pDevice,
+Streaming::FileStreamerReference::FileStreamerReference(Device* in_pDevice,
     UINT in_maxNumCopyBatches,                // maximum number of in-flight batches
-    UINT in_maxTileCopiesInFlight):           // upload buffer size. 1024 would become a 64MB upload buffer
+    UINT in_maxTileCopiesInFlight,            // upload buffer size. 1024 would become a 64MB upload buffer
+    JobSystem* in_pJobSystem):
     Streaming::FileStreamer(in_pDevice),
     m_copyBatches(in_maxNumCopyBatches + 2)   // padded by a couple to try to help with observed issue perhaps due to OS thread sched.
     , m_uploadAllocator(in_maxTileCopiesInFlight)
     , m_requests(in_maxTileCopiesInFlight)    // pre-allocate an array of event handles corresponding to # of tiles that can fit in the upload heap
 {
-    m_uploadBuffer.Allocate(in_pDevice, in_maxTileCopiesInFlight * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+    ID3D12Device* pDevice = in_pDevice->GetD3D12Device();
+
+    m_uploadBuffer.Allocate(pDevice, in_maxTileCopiesInFlight * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
 
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
     queueDesc.Type = g_commandListType;
-    ThrowIfFailed(in_pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_copyCommandQueue)));
+    ThrowIfFailed(pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_copyCommandQueue)));
     m_copyCommandQueue->SetName(L"FileStreamerReference::m_copyCommandQueue");
 
     //---------------------------------------
@@ -59,7 +62,7 @@ Streaming::FileStreamerReference::FileStreamerReference(ID3D12Device* in_pDevice
     UINT copyBatchIndex = 0;
     for (auto& copyBatch : m_copyBatches)
     {
-        copyBatch.Init(in_pDevice);
+        copyBatch.Init(pDevice);
 
         std::wstringstream name;
         name << "CopyBatch[" << copyBatchIndex << "]::m_commandAllocator";
@@ -68,13 +71,26 @@ Streaming::FileStreamerReference::FileStreamerReference(ID3D12Device* in_pDevice
         copyBatchIndex++;
     }
 
-    ThrowIfFailed(in_pDevice->CreateCommandList(0, queueDesc.Type, m_copyBatches[0].GetCommandAllocator(), nullptr, IID_PPV_ARGS(&m_copyCommandList)));
+    ThrowIfFailed(pDevice->CreateCommandList(0, queueDesc.Type, m_copyBatches[0].GetCommandAllocator(), nullptr, IID_PPV_ARGS(&m_copyCommandList)));
     m_copyCommandList->SetName(L"FileStreamerReference::m_copyCommandList");
     m_copyCommandList->Close();
 
     // launch copy thread
     ASSERT(false == m_copyThreadRunning);
     m_copyThreadRunning = true;
+
+    // with a job system, poll only while there are CopyBatches in flight
+    if (in_pJobSystem)
+    {
+        m_pCopyService = std::make_unique<JobSystem::Service>(*in_pJobSystem, [this]
+            {
+                if (!m_copyThreadRunning) { return false; }
+                CopyThread();
+                return GetBusy();
+            }, 0);
+        return;
+    }
+
     m_copyThread = std::thread([&]
         {
             DebugPrint(L"Created Copy Thread\n");
@@ -89,6 +105,10 @@ Streaming::FileStreamerReference::FileStreamerReference(ID3D12Device* in_pDevice
 Streaming::FileStreamerReference::~FileStreamerReference()
 {
     m_copyThreadRunning = false;
+    if (m_pCopyService)
+    {
+        m_pCopyService->WaitIdle();
+    }
     if (m_copyThread.joinable())
     {
         m_copyThread.join();
@@ -147,9 +167,8 @@ void Streaming::FileStreamerReference::StreamTexture(Streaming::UpdateList& in_u
     while (1)
     {
         // by allocating the least-recently-used, measured ~100% success on first try
-        // might have a race here with multiple threads, but it'll never read out-of-bounds
-        auto& batch = m_copyBatches[m_batchAllocIndex];
-        m_batchAllocIndex = (m_batchAllocIndex + 1) % numBatches;
+        // producers on several threads each claim a distinct start index. the CAS below decides ownership
+        auto& batch = m_copyBatches[m_batchAllocIndex.fetch_add(1, std::memory_order_relaxed) % numBatches];
 
         // multiple threads may be trying to allocate a CopyBatch
         CopyBatch::State expected = CopyBatch::State::FREE;
@@ -168,6 +187,26 @@ void Streaming::FileStreamerReference::StreamTexture(Streaming::UpdateList& in_u
             break;
         }
     }
+
+    if (m_pCopyService)
+    {
+        m_pCopyService->Kick();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// are any CopyBatches loading, copying, or waiting for their copies to complete?
+//-----------------------------------------------------------------------------
+bool Streaming::FileStreamerReference::GetBusy() const
+{
+    for (const auto& c : m_copyBatches)
+    {
+        if (CopyBatch::State::FREE != c.m_state)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 //-----------------------------------------------------------------------------
@@ -261,7 +300,7 @@ void Streaming::FileStreamerReference::ExecuteCopyCommandList(ID3D12GraphicsComm
     in_pCmdList->Close();
     ID3D12CommandList* pCmdLists[] = { in_pCmdList };
     m_copyCommandQueue->ExecuteCommandLists(1, pCmdLists);
-    m_copyCommandQueue->Signal(m_copyFence.Get(), m_copyFenceValue);
+    m_copyCommandQueue->Signal(m_copyFence->GetD3D12Fence(), m_copyFenceValue);
 }
 
 //-----------------------------------------------------------------------------
@@ -340,6 +379,7 @@ void Streaming::FileStreamerReference::CopyThread()
             {
                 c.m_pUpdateList->m_copyFenceValue = c.m_copyFenceValue;
                 c.m_pUpdateList->m_copyFenceValid = true;
+                if (m_pCompletionMonitor) { m_pCompletionMonitor->Notify(); }
                 c.m_pUpdateList = nullptr; // clear for debugging purposes. the updatelist can be re-cycled before the copyBatch
                 c.m_state = CopyBatch::State::WAIT_COMPLETE;
             }
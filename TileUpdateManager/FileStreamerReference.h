@@ -29,6 +29,7 @@
 #include "Timer.h"
 
 #include "SimpleAllocator.h"
+#include "JobSystem.h"
 
 //=======================================================================================
 //=======================================================================================
@@ -37,9 +38,10 @@ namespace Streaming
     class FileStreamerReference : public FileStreamer
     {
     public:
-        FileStreamerReference(ID3D12Device* in_pDevice,
+        FileStreamerReference(Device* in_pDevice,
             UINT in_maxNumCopyBatches,               // maximum number of in-flight batches
-            UINT in_maxTileCopiesInFlight);          // upload buffer size. 1024 would become a 64MB upload buffer
+            UINT in_maxTileCopiesInFlight,           // upload buffer size. 1024 would become a 64MB upload buffer
+            JobSystem* in_pJobSystem = nullptr);     // if set, copies are driven by a service instead of a dedicated thread
         virtual ~FileStreamerReference();
 
         virtual FileHandle* OpenFile(const std::wstring& in_path) override;
@@ -113,7 +115,7 @@ namespace Streaming
         void ExecuteCopyCommandList(ID3D12GraphicsCommandList* in_pCmdList);
 
         std::vector<CopyBatch> m_copyBatches;
-        UINT m_batchAllocIndex{ 0 }; // allocation optimization
+        std::atomic<UINT> m_batchAllocIndex{ 0 }; // allocation optimization. wraps modulo the number of batches
 
         // structure for finding space to upload tiles
         Streaming::SimpleAllocator m_uploadAllocator;
@@ -122,6 +124,8 @@ namespace Streaming
         void CopyThread();
         std::atomic<bool> m_copyThreadRunning{ false };
         std::thread m_copyThread;
+        std::unique_ptr<JobSystem::Service> m_pCopyService; // runs while any CopyBatch is in use, kicked by StreamTexture()
+        bool GetBusy() const;
 
         void LoadTexture(CopyBatch& in_copyBatch, UINT in_numtilesToLoad);
         void CopyTiles(ID3D12GraphicsCommandList* out_pCopyCmdList, ID3D12Resource* in_pSrcResource,
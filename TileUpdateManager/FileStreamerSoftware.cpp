@@ -0,0 +1,141 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include "FileStreamerSoftware.h"
+#include "StreamingResourceDU.h"
+#include "UpdateList.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Streaming::FileStreamerSoftware::FileStreamerSoftware(Device* in_pDevice) :
+    Streaming::FileStreamer(in_pDevice)
+    , m_copyQueue(in_pDevice->CreateCopyQueue(L"FileStreamerSoftware::m_copyQueue"))
+    , m_readBuffer(D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES)
+{
+    m_readThread = std::thread([&] { ReadThread(); });
+}
+
+Streaming::FileStreamerSoftware::~FileStreamerSoftware()
+{
+    m_readThreadRunning = false;
+    m_readFlag.Set();
+    m_readThread.join();
+}
+
+//-----------------------------------------------------------------------------
+// buffered reads: tile offsets are not sector aligned, and there is no upload buffer to read into
+//-----------------------------------------------------------------------------
+Streaming::FileHandle* Streaming::FileStreamerSoftware::OpenFile(const std::wstring& in_path)
+{
+    HANDLE fileHandle = CreateFile(in_path.c_str(), GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_READONLY,
+        nullptr);
+
+    if (INVALID_HANDLE_VALUE == fileHandle)
+    {
+        std::wstringstream s;
+        s << "File not found: " << in_path.c_str();
+        MessageBox(0, s.str().c_str(), L"Error", MB_OK);
+        exit(-1);
+    }
+
+    return new FileHandleSoftware(fileHandle);
+}
+
+//-----------------------------------------------------------------------------
+// the copy fence value is valid immediately. the read thread signals it after the reads complete
+//-----------------------------------------------------------------------------
+void Streaming::FileStreamerSoftware::StreamTexture(Streaming::UpdateList& in_updateList)
+{
+    ASSERT(in_updateList.GetNumStandardUpdates());
+
+    ReadBatch batch;
+    if (VisualizationMode::DATA_VIZ_NONE == m_visualizationMode)
+    {
+        auto pTextureFileInfo = in_updateList.m_pStreamingResource->GetTextureFileInfo();
+        batch.m_fileHandle = dynamic_cast<const FileHandleSoftware*>(in_updateList.m_pStreamingResource->GetFileHandle())->GetHandle();
+        batch.m_offsets.reserve(in_updateList.m_coords.size());
+        for (const auto& c : in_updateList.m_coords)
+        {
+            batch.m_offsets.push_back(pTextureFileInfo->GetFileOffset(c));
+        }
+    }
+
+    m_lock.Acquire();
+
+    batch.m_copyFenceValue = m_copyFenceValue;
+    in_updateList.m_copyFenceValue = m_copyFenceValue;
+    in_updateList.m_copyFenceValid = true;
+    m_copyFenceValue++;
+
+    m_readBatches.push_back(std::move(batch));
+
+    m_lock.Release();
+
+    m_readFlag.Set();
+}
+
+//-----------------------------------------------------------------------------
+// batches are read in order, so the copy fence is signaled in order
+//-----------------------------------------------------------------------------
+void Streaming::FileStreamerSoftware::ReadThread()
+{
+    while (m_readThreadRunning)
+    {
+        m_readFlag.Wait();
+
+        while (1)
+        {
+            m_lock.Acquire();
+            if (m_readBatches.empty())
+            {
+                m_lock.Release();
+                break;
+            }
+            ReadBatch batch = std::move(m_readBatches.front());
+            m_readBatches.pop_front();
+            m_lock.Release();
+
+            for (const auto& o : batch.m_offsets)
+            {
+                if (m_readBuffer.size() < o.numBytes) { m_readBuffer.resize(o.numBytes); }
+
+                OVERLAPPED overlapped{};
+                overlapped.Offset = o.offset;
+                DWORD numBytesRead = 0;
+                ::ReadFile(batch.m_fileHandle, m_readBuffer.data(), o.numBytes, &numBytesRead, &overlapped);
+                ASSERT(numBytesRead == o.numBytes);
+            }
+
+            m_copyQueue->Signal(m_copyFence.get(), batch.m_copyFenceValue);
+        }
+    }
+}
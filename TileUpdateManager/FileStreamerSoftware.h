@@ -0,0 +1,84 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <deque>
+
+#include "FileStreamer.h"
+#include "XeTexture.h"
+
+//=======================================================================================
+// file streamer for a software Device
+// tile data is read from the file, then discarded: there is no gpu memory to copy it to
+// the copy fence is signaled through a software queue, which adds the device latency
+//=======================================================================================
+namespace Streaming
+{
+    class FileStreamerSoftware : public FileStreamer
+    {
+    public:
+        FileStreamerSoftware(Device* in_pDevice);
+        virtual ~FileStreamerSoftware();
+
+        virtual FileHandle* OpenFile(const std::wstring& in_path) override;
+
+        virtual void StreamTexture(Streaming::UpdateList& in_updateList) override;
+
+        virtual void Signal() override {} // each UpdateList is signaled after its tiles have been read
+    private:
+        class FileHandleSoftware : public FileHandle
+        {
+        public:
+            FileHandleSoftware(HANDLE in_handle) : m_handle(in_handle) {}
+            virtual ~FileHandleSoftware() { ::CloseHandle(m_handle); }
+
+            HANDLE GetHandle() const { return m_handle; }
+        private:
+            const HANDLE m_handle;
+        };
+
+        std::unique_ptr<DeviceQueue> m_copyQueue;
+
+        // the reads for one UpdateList
+        struct ReadBatch
+        {
+            HANDLE m_fileHandle{ nullptr }; // null: nothing to read (visualization mode)
+            std::vector<XeTexture::FileOffset> m_offsets;
+            UINT64 m_copyFenceValue{ 0 };
+        };
+        std::deque<ReadBatch> m_readBatches;
+        Streaming::Lock m_lock; // StreamTexture() may be called from multiple threads
+
+        std::vector<BYTE> m_readBuffer;
+
+        void ReadThread();
+        SynchronizationFlag m_readFlag;
+        std::atomic<bool> m_readThreadRunning{ true };
+        std::thread m_readThread;
+    };
+}
@@ -32,46 +32,39 @@
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 Streaming::InternalResources::InternalResources(
-    ID3D12Device8* in_pDevice,
+    Device* in_pDevice,
     const XeTexture& m_textureFileInfo,
     // need the swap chain count so we can create per-frame upload buffers
     UINT in_swapChainBufferCount) :
     m_packedMipInfo{}, m_tileShape{}, m_numTilesTotal(0)
 {
     // create reserved resource
-    {
-        D3D12_RESOURCE_DESC rd = CD3DX12_RESOURCE_DESC::Tex2D(
-            m_textureFileInfo.GetFormat(),
-            m_textureFileInfo.GetImageWidth(),
-            m_textureFileInfo.GetImageHeight(), 1,
-            (UINT16)m_textureFileInfo.GetMipCount()
-        );
-
-        // Layout must be D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE when creating reserved resources
-        rd.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
-
-        ThrowIfFailed(in_pDevice->CreateReservedResource(
-            &rd,
-            // application is allowed to use before packed mips are loaded, but it's really a copy dest
-            D3D12_RESOURCE_STATE_COMMON,
-            nullptr,
-            IID_PPV_ARGS(&m_tiledResource)));
-
-        NameStreamingTexture();
-    }
+    m_tiledResource = in_pDevice->CreateTiledResource(m_textureFileInfo);
 
     // query the reserved resource for its tile properties
     // allocate data structure according to tile properties
     {
-        UINT subresourceCount = GetTiledResource()->GetDesc().MipLevels;
+        UINT subresourceCount = m_textureFileInfo.GetMipCount();
         m_tiling.resize(subresourceCount);
-        in_pDevice->GetResourceTiling(GetTiledResource(), &m_numTilesTotal, &m_packedMipInfo, &m_tileShape, &subresourceCount, 0, &m_tiling[0]);
+        m_tiledResource->GetTiling(&m_numTilesTotal, &m_packedMipInfo, &m_tileShape, subresourceCount, &m_tiling[0]);
+    }
+
+    // no gpu: feedback is written by the application to host memory. initially nothing has been sampled
+    ID3D12Device8* pDevice = in_pDevice->GetD3D12Device();
+    if (nullptr == pDevice)
+    {
+        m_softwareFeedback.resize(in_swapChainBufferCount);
+        for (auto& f : m_softwareFeedback)
+        {
+            f.assign(GetNumTilesWidth() * GetNumTilesHeight(), 0xff);
+        }
+        return;
     }
 
     // create the feedback map
     // the dimensions of the feedback map must match the size of the streaming texture
     {
-        auto desc = m_tiledResource->GetDesc();
+        auto desc = GetTiledResource()->GetDesc();
         D3D12_RESOURCE_DESC1 sfbDesc = CD3DX12_RESOURCE_DESC1::Tex2D(
             DXGI_FORMAT_SAMPLER_FEEDBACK_MIN_MIP_OPAQUE,
             desc.Width, desc.Height, desc.DepthOrArraySize, desc.MipLevels);
@@ -82,7 +75,7 @@ Streaming::InternalResources::InternalResources(
         sfbDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
         const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-        ThrowIfFailed(in_pDevice->CreateCommittedResource2(
+        ThrowIfFailed(pDevice->CreateCommittedResource2(
             &heapProperties, D3D12_HEAP_FLAG_NONE,
             &sfbDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
             nullptr, // not a render target, so optimized clear value illegal. That's ok, clear value is ignored on feedback maps
@@ -96,15 +89,15 @@ Streaming::InternalResources::InternalResources(
         desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
         desc.NumDescriptors = 1; // only need the one for the single feedback map
         desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-        ThrowIfFailed(in_pDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_clearUavHeap)));
+        ThrowIfFailed(pDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_clearUavHeap)));
         m_clearUavHeap->SetName(L"m_clearUavHeap");
     }
 
     // now that both feedback map and paired texture have been created,
     // can create the sampler feedback view
     {
-        in_pDevice->CreateSamplerFeedbackUnorderedAccessView(
-            m_tiledResource.Get(),
+        pDevice->CreateSamplerFeedbackUnorderedAccessView(
+            GetTiledResource(),
             m_feedbackResource.Get(),
             m_clearUavHeap->GetCPUDescriptorHandleForHeapStart());
     }
@@ -117,7 +110,7 @@ Streaming::InternalResources::InternalResources(
 
         const auto textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8_UINT, GetNumTilesWidth(), GetNumTilesHeight(), 1, 1);
 
-        ThrowIfFailed(in_pDevice->CreateCommittedResource(
+        ThrowIfFailed(pDevice->CreateCommittedResource(
             &heapProperties,
             D3D12_HEAP_FLAG_NONE,
             &textureDesc,
@@ -145,7 +138,7 @@ Streaming::InternalResources::InternalResources(
 
         for (auto& b : m_resolvedReadback)
         {
-            ThrowIfFailed(in_pDevice->CreateCommittedResource(
+            ThrowIfFailed(pDevice->CreateCommittedResource(
                 &resolvedHeapProperties,
                 D3D12_HEAP_FLAG_NONE,
                 &rd,
@@ -161,6 +154,44 @@ Streaming::InternalResources::InternalResources(
     }
 }
 
+//-----------------------------------------------------------------------------
+// the readback buffer may have a larger pitch to satisfy CopyTextureRegion()
+//-----------------------------------------------------------------------------
+const UINT8* Streaming::InternalResources::MapFeedback(UINT in_index, UINT& out_rowPitch)
+{
+    out_rowPitch = GetNumTilesWidth();
+
+    if (m_softwareFeedback.size())
+    {
+        return m_softwareFeedback[in_index].data();
+    }
+
+#if RESOLVE_TO_TEXTURE
+    out_rowPitch = (out_rowPitch + 0x0ff) & ~0x0ff;
+#endif
+
+    UINT8* pResolvedData = nullptr;
+    m_resolvedReadback[in_index]->Map(0, nullptr, (void**)&pResolvedData);
+    return pResolvedData;
+}
+
+void Streaming::InternalResources::UnmapFeedback(UINT in_index)
+{
+    if (m_softwareFeedback.empty())
+    {
+        D3D12_RANGE emptyRange{ 0,0 };
+        m_resolvedReadback[in_index]->Unmap(0, &emptyRange);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::InternalResources::WriteFeedback(UINT in_index, const BYTE* in_pMinMips)
+{
+    auto& f = m_softwareFeedback[in_index];
+    memcpy(f.data(), in_pMinMips, f.size());
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 void Streaming::InternalResources::ClearFeedback(
@@ -229,14 +260,3 @@ void Streaming::InternalResources::ReadbackFeedback(ID3D12GraphicsCommandList* o
         nullptr);
 }
 #endif
-
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-void Streaming::InternalResources::NameStreamingTexture()
-{
-    static UINT m_streamingResourceID = 0;
-
-    std::wstringstream name;
-    name << "m_streamingTexture" << m_streamingResourceID++;
-    m_tiledResource->SetName(name.str().c_str());
-}
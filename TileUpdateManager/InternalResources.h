@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "Streaming.h"
+#include "Device.h"
 
 #include "SamplerFeedbackStreaming.h" // for RESOLVE_TO_TEXTURE
 
@@ -37,11 +38,12 @@ namespace Streaming
     class InternalResources
     {
     public:
-        InternalResources(ID3D12Device8* in_pDevice, const class XeTexture& m_textureFileInfo,
+        InternalResources(Device* in_pDevice, const class XeTexture& m_textureFileInfo,
             // need the swap chain count so we can create per-frame upload buffers
             UINT in_swapChainBufferCount);
 
-        ID3D12Resource* GetTiledResource() const { return m_tiledResource.Get(); }
+        ID3D12Resource* GetTiledResource() const { return m_tiledResource->GetD3D12Resource(); }
+        DeviceTiledResource* GetDeviceTiledResource() const { return m_tiledResource.get(); }
 
         ID3D12Resource* GetResolvedReadback(UINT in_index) const { return m_resolvedReadback[in_index].Get(); }
 #if RESOLVE_TO_TEXTURE
@@ -60,6 +62,13 @@ namespace Streaming
         const D3D12_SUBRESOURCE_TILING* GetTiling() const { return m_tiling.data(); }
         UINT GetNumTilesVirtual() const { return m_numTilesTotal; }
 
+        // cpu access to resolved feedback: 1 byte per region, out_rowPitch bytes per row
+        const UINT8* MapFeedback(UINT in_index, UINT& out_rowPitch);
+        void UnmapFeedback(UINT in_index);
+
+        // software device: feedback comes from the application instead of a resolve
+        void WriteFeedback(UINT in_index, const BYTE* in_pMinMips);
+
         void ClearFeedback(ID3D12GraphicsCommandList* out_pCmdList, const D3D12_GPU_DESCRIPTOR_HANDLE in_gpuDescriptor);
 
         void ResolveFeedback(ID3D12GraphicsCommandList1* out_pCmdList, UINT in_index);
@@ -68,7 +77,7 @@ namespace Streaming
 #endif
 
     private:
-        ComPtr<ID3D12Resource> m_tiledResource;
+        std::unique_ptr<DeviceTiledResource> m_tiledResource;
         ComPtr<ID3D12Resource> m_tiledResourceAlloc;     // notify thread creates new tiled resource, to be swapped in later
         ComPtr<ID3D12Resource> m_tiledResourceDelete;    // resource in pergatory is moved here to be deleted by notify thread
 
@@ -82,11 +91,12 @@ namespace Streaming
         // per-swap-buffer cpu readable resolved feedback
         std::vector<ComPtr<ID3D12Resource>> m_resolvedReadback;
 
+        // per-swap-buffer feedback in host memory, when there is no d3d12 device
+        std::vector<std::vector<BYTE>> m_softwareFeedback;
+
         D3D12_PACKED_MIP_INFO m_packedMipInfo; // last n mips may be packed into a single tile
         D3D12_TILE_SHAPE m_tileShape;          // e.g. a 64K tile may contain 128x128 texels @ 4B/pixel
         UINT m_numTilesTotal;
         std::vector<D3D12_SUBRESOURCE_TILING> m_tiling;
-
-        void NameStreamingTexture();
     };
 }
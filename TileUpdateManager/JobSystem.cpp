@@ -0,0 +1,480 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include "JobSystem.h"
+
+namespace
+{
+    // the job system and worker that the current thread belongs to, if any
+    thread_local Streaming::JobSystem* t_pJobSystem{ nullptr };
+    thread_local UINT t_workerIndex{ 0 };
+
+    // same semantics as Streaming::SetThreadPriority(), but 0 restores the default
+    // because a worker may have been set to a different priority class by a previous task
+    void ApplyPriority(int in_priority)
+    {
+        THREAD_POWER_THROTTLING_STATE throttlingState{ THREAD_POWER_THROTTLING_CURRENT_VERSION, 0, 0 };
+        if (in_priority)
+        {
+            throttlingState.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+            if (-1 == in_priority) { throttlingState.StateMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED; } // speed, speed = prefer e cores
+        }
+        ::SetThreadInformation(::GetCurrentThread(), ThreadPowerThrottling, &throttlingState, sizeof(throttlingState));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Streaming::JobSystem::JobSystem(UINT in_numWorkers, UINT64 in_affinityMask, UINT in_spinCount) :
+    m_spinCount(in_spinCount)
+{
+    const UINT numWorkers = std::max(in_numWorkers, (UINT)1);
+
+    m_wake = ::CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+    m_watchesChanged = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    // create every worker before starting any, so they can steal from each other
+    for (UINT i = 0; i < numWorkers; i++)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (UINT i = 0; i < numWorkers; i++)
+    {
+        auto& t = m_workers[i]->m_thread;
+        t = std::thread([this, i] { WorkerThread(i); });
+        if (in_affinityMask)
+        {
+            ::SetThreadAffinityMask(t.native_handle(), (DWORD_PTR)in_affinityMask);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// tasks that have not run are dropped. services should have been stopped already
+//-----------------------------------------------------------------------------
+Streaming::JobSystem::~JobSystem()
+{
+    m_exit = true;
+    ::ReleaseSemaphore(m_wake, (LONG)m_workers.size(), nullptr);
+
+    for (auto& w : m_workers)
+    {
+        w->m_thread.join();
+    }
+
+    ::CloseHandle(m_wake);
+    ::CloseHandle(m_watchesChanged);
+}
+
+//-----------------------------------------------------------------------------
+// workers push to their own queue, other threads to the shared queue
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Enqueue(Task&& in_task)
+{
+    // count first, so a worker that is about to park sees the task
+    m_numQueued++;
+
+    if (this == t_pJobSystem)
+    {
+        auto& w = *m_workers[t_workerIndex];
+        w.m_lock.Acquire();
+        w.m_tasks.push_back(std::move(in_task));
+        w.m_lock.Release();
+    }
+    else
+    {
+        m_sharedLock.Acquire();
+        m_sharedTasks.push_back(std::move(in_task));
+        m_sharedLock.Release();
+    }
+
+    if (m_numParked)
+    {
+        ::ReleaseSemaphore(m_wake, 1, nullptr);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// newest from own queue, then oldest from the shared queue, then steal the oldest from another worker
+// in_pWorker may be null for threads outside the pool
+//-----------------------------------------------------------------------------
+bool Streaming::JobSystem::TryGetTask(Worker* in_pWorker, UINT in_workerIndex, Task& out_task)
+{
+    if (0 == m_numQueued)
+    {
+        return false;
+    }
+
+    if (in_pWorker)
+    {
+        auto& w = *in_pWorker;
+        w.m_lock.Acquire();
+        bool found = w.m_tasks.size();
+        if (found)
+        {
+            out_task = std::move(w.m_tasks.back());
+            w.m_tasks.pop_back();
+        }
+        w.m_lock.Release();
+        if (found)
+        {
+            m_numQueued--;
+            return true;
+        }
+    }
+
+    {
+        m_sharedLock.Acquire();
+        bool found = m_sharedTasks.size();
+        if (found)
+        {
+            out_task = std::move(m_sharedTasks.front());
+            m_sharedTasks.pop_front();
+        }
+        m_sharedLock.Release();
+        if (found)
+        {
+            m_numQueued--;
+            return true;
+        }
+    }
+
+    const UINT numWorkers = (UINT)m_workers.size();
+    for (UINT i = 1; i <= numWorkers; i++)
+    {
+        auto& w = *m_workers[(in_workerIndex + i) % numWorkers];
+        if (&w == in_pWorker)
+        {
+            continue;
+        }
+
+        w.m_lock.Acquire();
+        bool found = w.m_tasks.size();
+        if (found)
+        {
+            out_task = std::move(w.m_tasks.front());
+            w.m_tasks.pop_front();
+        }
+        w.m_lock.Release();
+        if (found)
+        {
+            m_numQueued--;
+            m_numSteals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::RunTask(Worker* in_pWorker, Task& in_task)
+{
+    if (in_pWorker && (in_pWorker->m_priority != in_task.m_priority))
+    {
+        in_pWorker->m_priority = in_task.m_priority;
+        ApplyPriority(in_task.m_priority);
+    }
+
+    in_task.m_function();
+    in_task.m_function = nullptr; // release captures now, not when the next task is moved in
+
+    m_numTasksRun.fetch_add(1, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// sleep until there is work
+// the first worker to park also waits on the watched events, and kicks their services
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Park()
+{
+    // Enqueue() increments m_numQueued, then reads m_numParked. we do the opposite, so no wake is lost
+    m_numParked++;
+    if (m_numQueued || m_exit)
+    {
+        m_numParked--;
+        return;
+    }
+
+    if (!m_waiterTaken.exchange(true))
+    {
+        // [watched events..., m_watchesChanged, m_wake]. events first: WaitForMultipleObjects() reports the lowest index
+        std::vector<HANDLE> handles;
+        m_watchLock.Acquire();
+        for (const auto& w : m_watches) { handles.push_back(w.m_event); }
+        m_waiterGeneration = m_watchGeneration;
+        m_watchLock.Release();
+        const UINT numEvents = (UINT)handles.size();
+        handles.push_back(m_watchesChanged);
+        handles.push_back(m_wake);
+        ASSERT(handles.size() <= MAXIMUM_WAIT_OBJECTS);
+
+        DWORD index = ::WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, INFINITE) - WAIT_OBJECT_0;
+        if (index < numEvents)
+        {
+            // the service may have been unwatched while we waited
+            m_watchLock.Acquire();
+            for (const auto& w : m_watches)
+            {
+                if (w.m_event == handles[index])
+                {
+                    w.m_pService->Kick();
+                    break;
+                }
+            }
+            m_watchLock.Release();
+        }
+
+        m_waiterTaken = false;
+
+        // hand off waiting on the events to another parked worker
+        if (m_numParked > 1)
+        {
+            ::ReleaseSemaphore(m_wake, 1, nullptr);
+        }
+    }
+    else
+    {
+        ::WaitForSingleObject(m_wake, INFINITE);
+    }
+
+    m_numParked--;
+    m_numParks.fetch_add(1, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::WorkerThread(UINT in_workerIndex)
+{
+    t_pJobSystem = this;
+    t_workerIndex = in_workerIndex;
+    Worker* pWorker = m_workers[in_workerIndex].get();
+
+    Task task;
+    while (!m_exit)
+    {
+        if (TryGetTask(pWorker, in_workerIndex, task))
+        {
+            RunTask(pWorker, task);
+            continue;
+        }
+
+        // spin briefly before parking: streaming work tends to arrive in bursts
+        for (UINT i = 0; (i < m_spinCount) && (0 == m_numQueued) && (!m_exit); i++)
+        {
+            _mm_pause();
+        }
+
+        if (0 == m_numQueued)
+        {
+            Park();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// a dependency that has already completed is ignored
+//-----------------------------------------------------------------------------
+Streaming::JobSystem::JobHandle Streaming::JobSystem::Submit(std::function<void()> in_function, int in_priority,
+    const JobHandle* in_pDependencies, UINT in_numDependencies)
+{
+    auto job = std::make_shared<Job>();
+    job->m_function = std::move(in_function);
+    job->m_priority = in_priority;
+
+    for (UINT i = 0; i < in_numDependencies; i++)
+    {
+        auto& d = *in_pDependencies[i];
+        d.m_lock.Acquire();
+        if (!d.m_done)
+        {
+            job->m_numDependencies++;
+            d.m_dependents.push_back(job);
+        }
+        d.m_lock.Release();
+    }
+
+    // release the submitting thread's hold
+    if (1 == job->m_numDependencies.fetch_sub(1))
+    {
+        Schedule(job);
+    }
+
+    return job;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Schedule(const JobHandle& in_job)
+{
+    Task task;
+    task.m_priority = in_job->m_priority;
+    task.m_function = [this, in_job]
+    {
+        in_job->m_function();
+        in_job->m_function = nullptr;
+        Complete(*in_job);
+    };
+    Enqueue(std::move(task));
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Complete(Job& in_job)
+{
+    std::vector<JobHandle> dependents;
+
+    in_job.m_lock.Acquire();
+    in_job.m_done = true;
+    dependents.swap(in_job.m_dependents);
+    in_job.m_lock.Release();
+
+    in_job.m_completed = true;
+
+    for (auto& d : dependents)
+    {
+        if (1 == d->m_numDependencies.fetch_sub(1))
+        {
+            Schedule(d);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// help rather than wait
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Wait(const JobHandle& in_job)
+{
+    Worker* pWorker = (this == t_pJobSystem) ? m_workers[t_workerIndex].get() : nullptr;
+    UINT workerIndex = pWorker ? t_workerIndex : 0;
+
+    Task task;
+    while (!in_job->m_completed)
+    {
+        if (TryGetTask(pWorker, workerIndex, task))
+        {
+            RunTask(pWorker, task);
+        }
+        else
+        {
+            _mm_pause();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::WatchEvents(const HANDLE* in_pEvents, UINT in_numEvents, Service* in_pService)
+{
+    m_watchLock.Acquire();
+    for (UINT i = 0; i < in_numEvents; i++)
+    {
+        m_watches.push_back({ in_pEvents[i], in_pService });
+    }
+    m_watchGeneration++;
+    m_watchLock.Release();
+
+    ::SetEvent(m_watchesChanged);
+}
+
+//-----------------------------------------------------------------------------
+// returns after the waiter no longer waits on the service's events, so the caller may close them
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::UnwatchEvents(Service* in_pService)
+{
+    m_watchLock.Acquire();
+    m_watches.erase(std::remove_if(m_watches.begin(), m_watches.end(),
+        [&](const Watch& w) { return w.m_pService == in_pService; }), m_watches.end());
+    UINT64 generation = ++m_watchGeneration;
+    m_watchLock.Release();
+
+    ::SetEvent(m_watchesChanged);
+
+    while (m_waiterTaken && (m_waiterGeneration < generation))
+    {
+        std::this_thread::yield();
+    }
+}
+
+//=============================================================================
+//=============================================================================
+Streaming::JobSystem::Service::Service(JobSystem& in_jobSystem, std::function<bool()> in_function, int in_priority) :
+    m_jobSystem(in_jobSystem), m_function(std::move(in_function)), m_priority(in_priority)
+{
+}
+
+Streaming::JobSystem::Service::~Service()
+{
+    ASSERT(0 == m_requests);
+}
+
+//-----------------------------------------------------------------------------
+// only the first kick queues the service. later kicks are counted until it runs
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Service::Kick()
+{
+    if (0 == m_requests.fetch_add(1))
+    {
+        m_jobSystem.Enqueue({ [this] { Run(); }, m_priority });
+    }
+}
+
+//-----------------------------------------------------------------------------
+// a kick that arrives while running may have missed this run's view of the state, so run again
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Service::Run()
+{
+    const UINT numRequests = m_requests;
+
+    bool moreWork = m_function();
+
+    if (moreWork)
+    {
+        // stay scheduled (requests >= 1), but behind other tasks
+        m_requests.fetch_sub(numRequests - 1);
+        m_jobSystem.Enqueue({ [this] { Run(); }, m_priority });
+    }
+    else if (numRequests != m_requests.fetch_sub(numRequests))
+    {
+        // kicked while running
+        m_jobSystem.Enqueue({ [this] { Run(); }, m_priority });
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::JobSystem::Service::WaitIdle()
+{
+    while (m_requests)
+    {
+        std::this_thread::yield();
+    }
+}
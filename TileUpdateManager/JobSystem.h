@@ -0,0 +1,188 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+#include "Streaming.h"
+
+//=============================================================================
+// a shared pool of worker threads that replaces the dedicated streaming threads
+//
+// each worker has its own queue: it runs its newest task first, and idle workers steal the oldest
+// task from other workers. tasks submitted from outside the pool go to a shared queue.
+// idle workers spin briefly, then park. one parked worker also waits on external events (e.g. fences)
+//
+// Job: runs once, after its dependencies. Wait() runs other tasks while waiting
+// Service: a recurring task that replaces a "wait for a flag, then work" thread loop.
+//     Kick() schedules it, and it never runs concurrently with itself.
+//     if kicked while running, it runs again. if it returns true (more work), it is re-queued behind other tasks
+//
+// every task has a priority class with the semantics of Streaming::SetThreadPriority(),
+// applied to the worker before the task runs
+//=============================================================================
+namespace Streaming
+{
+    class JobSystem
+    {
+    public:
+        // in_affinityMask: 0 = any processor. otherwise, passed to SetThreadAffinityMask() for every worker
+        JobSystem(UINT in_numWorkers, UINT64 in_affinityMask = 0, UINT in_spinCount = 1024);
+        ~JobSystem();
+
+        UINT GetNumWorkers() const { return (UINT)m_workers.size(); }
+
+        //--------------------------------------------
+        // one-shot tasks with dependencies
+        //--------------------------------------------
+        class Job;
+        using JobHandle = std::shared_ptr<Job>;
+
+        // the job is queued when all of its dependencies have completed
+        JobHandle Submit(std::function<void()> in_function, int in_priority,
+            const JobHandle* in_pDependencies = nullptr, UINT in_numDependencies = 0);
+
+        // run other tasks until the job has completed. may be called from any thread
+        void Wait(const JobHandle& in_job);
+
+        //--------------------------------------------
+        // recurring tasks
+        //--------------------------------------------
+        class Service
+        {
+        public:
+            // in_function returns true if it has more work to do
+            Service(JobSystem& in_jobSystem, std::function<bool()> in_function, int in_priority);
+            ~Service();
+
+            // any thread: run the service (again)
+            void Kick();
+
+            // returns after no run is queued or in progress. the caller must stop kicking first
+            void WaitIdle();
+        private:
+            friend class JobSystem;
+            JobSystem& m_jobSystem;
+            const std::function<bool()> m_function;
+            const int m_priority;
+
+            // > 0 while queued or running. kicks while running are counted so the service runs again
+            std::atomic<UINT> m_requests{ 0 };
+            void Run();
+        };
+
+        // kick the service whenever one of the events is signaled. the events must be auto-reset
+        void WatchEvents(const HANDLE* in_pEvents, UINT in_numEvents, Service* in_pService);
+        void UnwatchEvents(Service* in_pService);
+
+        //-------------------------------------------
+        // statistics
+        //-------------------------------------------
+        UINT64 GetNumTasks() const { return m_numTasksRun; }
+        UINT64 GetNumSteals() const { return m_numSteals; }
+        UINT64 GetNumParks() const { return m_numParks; }
+    private:
+        struct Task
+        {
+            std::function<void()> m_function;
+            int m_priority{ 0 };
+        };
+
+        struct Worker
+        {
+            Streaming::Lock m_lock;
+            std::deque<Task> m_tasks; // owner takes from the back, thieves from the front
+            std::thread m_thread;
+            int m_priority{ 0 }; // priority class currently applied to this thread
+        };
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        // tasks submitted from threads outside the pool
+        Streaming::Lock m_sharedLock;
+        std::deque<Task> m_sharedTasks;
+
+        std::atomic<UINT> m_numQueued{ 0 };
+        std::atomic<UINT> m_numParked{ 0 };
+        std::atomic<bool> m_exit{ false };
+        HANDLE m_wake{ nullptr }; // semaphore, released once per wake
+
+        // external events and the services they kick
+        struct Watch
+        {
+            HANDLE m_event;
+            Service* m_pService;
+        };
+        Streaming::Lock m_watchLock;
+        std::vector<Watch> m_watches;
+        UINT64 m_watchGeneration{ 0 };        // under m_watchLock. incremented when m_watches changes
+        HANDLE m_watchesChanged{ nullptr };   // wakes the waiter to re-read m_watches
+        std::atomic<bool> m_waiterTaken{ false }; // one parked worker waits on the watched events
+        std::atomic<UINT64> m_waiterGeneration{ 0 }; // the m_watches the waiter is waiting on
+
+        const UINT m_spinCount;
+
+        void Enqueue(Task&& in_task);
+        bool TryGetTask(Worker* in_pWorker, UINT in_workerIndex, Task& out_task);
+        void RunTask(Worker* in_pWorker, Task& in_task);
+        void Park();
+        void WorkerThread(UINT in_workerIndex);
+
+        void Schedule(const JobHandle& in_job); // all dependencies have completed
+        void Complete(Job& in_job);
+
+        std::atomic<UINT64> m_numTasksRun{ 0 };
+        std::atomic<UINT64> m_numSteals{ 0 };
+        std::atomic<UINT64> m_numParks{ 0 };
+    };
+
+    //--------------------------------------------
+    //--------------------------------------------
+    class JobSystem::Job
+    {
+    public:
+        bool GetCompleted() const { return m_completed; }
+    private:
+        friend class JobSystem;
+        std::function<void()> m_function;
+        int m_priority{ 0 };
+
+        // the submitting thread holds 1 until all dependencies have been registered
+        std::atomic<UINT> m_numDependencies{ 1 };
+
+        Streaming::Lock m_lock;
+        bool m_done{ false }; // under m_lock. once set, dependents are not added
+        std::vector<JobHandle> m_dependents;
+
+        std::atomic<bool> m_completed{ false };
+    };
+}
@@ -27,10 +27,6 @@
 #include "pch.h"
 #include "MappingUpdater.h"
 
-std::vector<D3D12_TILE_RANGE_FLAGS> Streaming::MappingUpdater::m_rangeFlagsMap;   // all NONE
-std::vector<D3D12_TILE_RANGE_FLAGS> Streaming::MappingUpdater::m_rangeFlagsUnMap; // all NULL
-std::vector<UINT> Streaming::MappingUpdater::m_rangeTileCounts; // all 1s
-
 //=============================================================================
 // Internal class that constructs commands that set
 // virtual-to-physical mapping for the reserved resource
@@ -38,18 +34,11 @@ std::vector<UINT> Streaming::MappingUpdater::m_rangeTileCounts; // all 1s
 Streaming::MappingUpdater::MappingUpdater(UINT in_maxTileMappingUpdatesPerApiCall) :
     m_maxTileMappingUpdatesPerApiCall(std::max(UINT(1), in_maxTileMappingUpdatesPerApiCall))
 {
-    // paranoia: make sure static arrays are sized to the maximum of requested sizes
-    UINT size = std::max(m_maxTileMappingUpdatesPerApiCall, (UINT)m_rangeTileCounts.size());
-
-    // these will never change size
-    m_rangeFlagsMap.assign(size, D3D12_TILE_RANGE_FLAG_NONE);
-    m_rangeFlagsUnMap.assign(size, D3D12_TILE_RANGE_FLAG_NULL);
-    m_rangeTileCounts.assign(size, 1);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void Streaming::MappingUpdater::Map(ID3D12CommandQueue* in_pCommandQueue, ID3D12Resource* in_pResource, ID3D12Heap* in_pHeap,
+void Streaming::MappingUpdater::Map(DeviceQueue* in_pQueue, DeviceTiledResource* in_pResource, DeviceHeap* in_pHeap,
     const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords,
     const std::vector<UINT>& in_indices)
 {
@@ -61,24 +50,13 @@ void Streaming::MappingUpdater::Map(ID3D12CommandQueue* in_pCommandQueue, ID3D12
         UINT numRegions = std::min(numTotal, m_maxTileMappingUpdatesPerApiCall);
         numTotal -= numRegions;
 
-        in_pCommandQueue->UpdateTileMappings(
-            in_pResource,
-            numRegions,
-            &in_coords[numTotal],
-            nullptr,
-            in_pHeap,
-            numRegions,
-            m_rangeFlagsMap.data(),
-            &in_indices[numTotal],
-            m_rangeTileCounts.data(),
-            D3D12_TILE_MAPPING_FLAG_NONE
-        );
+        in_pQueue->UpdateTileMappings(in_pResource, numRegions, &in_coords[numTotal], in_pHeap, &in_indices[numTotal]);
     }
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void Streaming::MappingUpdater::UnMap(ID3D12CommandQueue* in_pCommandQueue, ID3D12Resource* in_pResource,
+void Streaming::MappingUpdater::UnMap(DeviceQueue* in_pQueue, DeviceTiledResource* in_pResource,
     const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords)
 {
     UINT numTotal = (UINT)in_coords.size();
@@ -87,17 +65,7 @@ void Streaming::MappingUpdater::UnMap(ID3D12CommandQueue* in_pCommandQueue, ID3D
         UINT numRegions = std::min(numTotal, m_maxTileMappingUpdatesPerApiCall);
         numTotal -= numRegions;
 
-        in_pCommandQueue->UpdateTileMappings(
-            in_pResource,
-            numRegions,
-            &in_coords[numTotal],
-            nullptr,
-            nullptr,
-            numRegions,
-            m_rangeFlagsUnMap.data(),
-            nullptr,
-            m_rangeTileCounts.data(),
-            D3D12_TILE_MAPPING_FLAG_NONE
-        );
+        // a null heap unmaps
+        in_pQueue->UpdateTileMappings(in_pResource, numRegions, &in_coords[numTotal], nullptr, nullptr);
     }
 }
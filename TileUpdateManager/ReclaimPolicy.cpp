@@ -0,0 +1,132 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#include "ReclaimPolicy.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UINT Streaming::ReclaimPolicy::GetNextMip(const Candidate& in_candidate, UINT in_mip)
+{
+    while ((in_mip < in_candidate.m_maxMip) && (0 == in_candidate.m_numTiles[in_mip]))
+    {
+        in_mip++;
+    }
+    return in_mip;
+}
+
+//-----------------------------------------------------------------------------
+// greedy: repeatedly reclaim the least valuable mip of any candidate
+// releasing a mip makes the candidate's next mip the finest, which is re-queued at its (higher) value
+// a candidate may therefore give up several mips, but always finest-first, so min mip maps stay consistent
+//-----------------------------------------------------------------------------
+UINT Streaming::ReclaimPolicy::Select(std::vector<UINT>& out_reclaimMips, const std::vector<Candidate>& in_candidates,
+    UINT in_numTilesNeeded, float in_demandValue)
+{
+    const UINT numCandidates = (UINT)in_candidates.size();
+    out_reclaimMips.resize(numCandidates);
+
+    const auto compare = [](const Entry& a, const Entry& b) { return a.first > b.first; };
+
+    m_queue.clear();
+    for (UINT i = 0; i < numCandidates; i++)
+    {
+        const auto& c = in_candidates[i];
+        out_reclaimMips[i] = c.m_finestMip;
+
+        UINT mip = GetNextMip(c, c.m_finestMip);
+        if (mip < c.m_maxMip)
+        {
+            m_queue.push_back({ GetValue(c.m_importance, mip), i });
+        }
+    }
+    std::make_heap(m_queue.begin(), m_queue.end(), compare);
+
+    UINT numFreed = 0;
+    while ((numFreed < in_numTilesNeeded) && m_queue.size())
+    {
+        std::pop_heap(m_queue.begin(), m_queue.end(), compare);
+        Entry e = m_queue.back();
+        m_queue.pop_back();
+
+        // everything remaining is worth at least as much as what is being requested
+        if (e.first >= in_demandValue)
+        {
+            break;
+        }
+
+        const auto& c = in_candidates[e.second];
+        UINT mip = GetNextMip(c, out_reclaimMips[e.second]);
+        numFreed += c.m_numTiles[mip];
+        out_reclaimMips[e.second] = mip + 1;
+
+        mip = GetNextMip(c, mip + 1);
+        if (mip < c.m_maxMip)
+        {
+            m_queue.push_back({ GetValue(c.m_importance, mip), e.second });
+            std::push_heap(m_queue.begin(), m_queue.end(), compare);
+        }
+    }
+
+    return numFreed;
+}
+
+//-----------------------------------------------------------------------------
+// the candidate being promoted never victimizes itself: its remaining mips are at least as coarse
+// as the mip it wants back, so are worth at least in_value
+//-----------------------------------------------------------------------------
+bool Streaming::ReclaimPolicy::Promote(std::vector<UINT>& out_reclaimMips, UINT& out_numFreed, const std::vector<Candidate>& in_candidates,
+    UINT in_numTilesNeeded, UINT in_numFree, float in_value)
+{
+    const UINT numCandidates = (UINT)in_candidates.size();
+    out_reclaimMips.resize(numCandidates);
+    for (UINT i = 0; i < numCandidates; i++)
+    {
+        out_reclaimMips[i] = in_candidates[i].m_finestMip;
+    }
+
+    out_numFreed = 0;
+    if (in_numTilesNeeded <= in_numFree)
+    {
+        return true;
+    }
+
+    const UINT shortfall = in_numTilesNeeded - in_numFree;
+    out_numFreed = Select(out_reclaimMips, in_candidates, shortfall, in_value);
+    if (out_numFreed >= shortfall)
+    {
+        return true;
+    }
+
+    // not enough cheaper tiles: reclaim nothing
+    out_numFreed = 0;
+    for (UINT i = 0; i < numCandidates; i++)
+    {
+        out_reclaimMips[i] = in_candidates[i].m_finestMip;
+    }
+    return false;
+}
@@ -0,0 +1,73 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+
+#include <vector>
+
+//=============================================================================
+// when a heap is full, choose which resources give up their finest referenced mips
+// so the space can go to coarser, more valuable tiles
+//
+// has no dependencies on D3D or StreamingResource, so it can be exercised on the CPU with synthetic candidates
+//=============================================================================
+namespace Streaming
+{
+    class ReclaimPolicy
+    {
+    public:
+        struct Candidate
+        {
+            float m_importance{ 0 };      // e.g. visible area, reduced by time since last visible
+            UINT m_finestMip{ 0 };        // finest mip currently referenced
+            UINT m_maxMip{ 0 };           // mips >= this (packed mips) can't be reclaimed
+            std::vector<UINT> m_numTiles; // # tiles holding heap space, per mip
+        };
+
+        // coarser tiles cover more of the resource, so are worth more
+        static float GetValue(float in_importance, UINT in_mip) { return in_importance * float(1 << in_mip); }
+
+        // visits candidate mips in order of increasing value until enough tiles would be freed
+        // only mips worth less than in_demandValue are reclaimed
+        // out_reclaimMips receives, per candidate, the finest mip it may keep (== m_finestMip if unchanged)
+        // returns # tiles that would be freed
+        UINT Select(std::vector<UINT>& out_reclaimMips, const std::vector<Candidate>& in_candidates,
+            UINT in_numTilesNeeded, float in_demandValue);
+
+        // re-promotion: a candidate whose feedback is clamped wants in_numTilesNeeded tiles worth in_value
+        // it may have them if they fit in in_numFree, or if mips worth less than in_value can be reclaimed to make room
+        // out_reclaimMips receives the victims (as Select()), out_numFreed the # tiles they free
+        // returns false, with no victims, if the demand isn't worth it
+        bool Promote(std::vector<UINT>& out_reclaimMips, UINT& out_numFreed, const std::vector<Candidate>& in_candidates,
+            UINT in_numTilesNeeded, UINT in_numFree, float in_value);
+    private:
+        using Entry = std::pair<float, UINT>; // value, candidate index
+        std::vector<Entry> m_queue; // min-heap on value
+
+        // next mip at or coarser than in_mip that holds heap space. returns m_maxMip if none
+        static UINT GetNextMip(const Candidate& in_candidate, UINT in_mip);
+    };
+}
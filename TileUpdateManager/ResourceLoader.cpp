@@ -0,0 +1,158 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#include "ResourceLoader.h"
+#include "Streaming.h"
+#include "StreamingResourceBase.h"
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Streaming::ResourceLoader::ResourceLoader(UINT in_numThreads, int in_threadPriority) :
+    m_numThreads(std::max(in_numThreads, (UINT)1))
+    , m_threadPriority(in_threadPriority)
+{
+}
+
+//-----------------------------------------------------------------------------
+// resources still in the queue are abandoned. the application should have destroyed them already
+//-----------------------------------------------------------------------------
+Streaming::ResourceLoader::~ResourceLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto& t : m_threads)
+    {
+        t.join();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::ResourceLoader::Queue(StreamingResourceBase* const* in_ppResources, UINT in_numResources)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.insert(m_queue.end(), in_ppResources, in_ppResources + in_numResources);
+
+        if (0 == m_threads.size())
+        {
+            for (UINT i = 0; i < m_numThreads; i++)
+            {
+                m_threads.emplace_back([this] { LoaderThread(); });
+                Streaming::SetThreadPriority(m_threads.back(), m_threadPriority);
+            }
+        }
+    }
+
+    if (1 == in_numResources)
+    {
+        m_workAvailable.notify_one();
+    }
+    else
+    {
+        m_workAvailable.notify_all();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::ResourceLoader::Wait(StreamingResourceBase* const* in_ppResources, UINT in_numResources)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (UINT i = 0; i < in_numResources; i++)
+    {
+        while (!in_ppResources[i]->GetInitialized())
+        {
+            // help rather than wait
+            if (m_queue.size())
+            {
+                LoadNext(lock);
+            }
+            else
+            {
+                m_loadComplete.wait(lock);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::ResourceLoader::Cancel(StreamingResourceBase* in_pResource)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto i = std::find(m_queue.begin(), m_queue.end(), in_pResource);
+    if (m_queue.end() != i)
+    {
+        m_queue.erase(i);
+        return;
+    }
+
+    m_loadComplete.wait(lock, [&] { return m_loading.end() == std::find(m_loading.begin(), m_loading.end(), in_pResource); });
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::ResourceLoader::LoaderThread()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (1)
+    {
+        m_workAvailable.wait(lock, [&] { return m_exit || m_queue.size(); });
+        if (m_exit)
+        {
+            break;
+        }
+
+        LoadNext(lock);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::ResourceLoader::LoadNext(std::unique_lock<std::mutex>& in_lock)
+{
+    auto pResource = m_queue.front();
+    m_queue.pop_front();
+    m_loading.push_back(pResource);
+
+    // file i/o and resource creation happen outside the lock
+    in_lock.unlock();
+    pResource->Initialize();
+    in_lock.lock();
+
+    m_loading.erase(std::find(m_loading.begin(), m_loading.end(), pResource));
+    m_loadComplete.notify_all();
+}
@@ -0,0 +1,76 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//=============================================================================
+// a pool of threads that initialize StreamingResources created asynchronously:
+// parse the file header, create internal resources, and read the packed mips
+// threads are started on first use
+//=============================================================================
+namespace Streaming
+{
+    class StreamingResourceBase;
+
+    class ResourceLoader
+    {
+    public:
+        ResourceLoader(UINT in_numThreads, int in_threadPriority);
+        ~ResourceLoader();
+
+        // the resources must not be accessed by any other thread until StreamingResourceBase::GetInitialized()
+        void Queue(StreamingResourceBase* const* in_ppResources, UINT in_numResources);
+
+        // the calling thread loads queued resources until all of these have initialized
+        void Wait(StreamingResourceBase* const* in_ppResources, UINT in_numResources);
+
+        // if the resource has not started loading, remove it from the queue
+        // if it is loading, returns after it has finished
+        void Cancel(StreamingResourceBase* in_pResource);
+    private:
+        const UINT m_numThreads;
+        const int m_threadPriority;
+
+        std::vector<std::thread> m_threads;
+        void LoaderThread();
+
+        // pops the next resource and initializes it. called with the lock held
+        void LoadNext(std::unique_lock<std::mutex>& in_lock);
+
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable; // loader threads wait for Queue()
+        std::condition_variable m_loadComplete;  // Cancel() waits for a load in progress
+        std::deque<StreamingResourceBase*> m_queue;
+        std::vector<StreamingResourceBase*> m_loading;
+        bool m_exit{ false };
+    };
+}
@@ -59,6 +59,10 @@ struct StreamingHeap
     virtual void Destroy() = 0;
 
     virtual UINT GetNumTilesAllocated() const = 0;
+
+    // mip bias currently added to feedback for resources in this heap (see TileUpdateManagerDesc::m_targetHeapOccupancy)
+    // fractional part indicates progress towards the next whole mip
+    virtual float GetFeedbackBias() const = 0;
 };
 
 //=============================================================================
@@ -143,6 +147,50 @@ struct TileUpdateManagerDesc
 
     // true: use Microsoft DirectStorage. false: use internal file streaming system
     bool m_useDirectStorage{ true };
+
+    // speculatively reference tiles in the direction of feedback motion and one mip finer when feedback trends finer
+    // prefetched tiles are loaded after requested tiles and are released first when the heap is nearly full
+    bool m_enablePrefetch{ false };
+
+    // dilate feedback to neighboring regions before it is applied
+    // reduces late loads where filtering crosses region (tile) boundaries, at the cost of more resident tiles
+    UINT m_feedbackDilationRadius{ 0 };  // in regions. 0 disables
+    UINT m_feedbackDilationMipBias{ 0 }; // neighbors get the dilated mip + bias. e.g. 1: neighbors of a mip 0 request get mip 1
+    // optional bias per dilated mip, overrides m_feedbackDilationMipBias for the mips it covers
+    // e.g. { 2, 1, 0 }: neighbors of mip 0 get mip 2, of mip 1 get mip 2, of mip 2 and coarser get the same mip
+    // a bias of 255 stops dilation from that mip, e.g. to dilate only coarse mips where a region covers more of the screen
+    std::vector<UINT> m_feedbackDilationMipBiasPerMip;
+
+    // count feedback regions that requested a tile that was not resident, see GetTotalNumLateRegions()
+    // costs a residency lookup per requested region each time feedback is processed. always on while dilation is enabled
+    bool m_enableLateRegionStatistics{ false };
+
+    // per-heap closed-loop control of a feedback mip bias that degrades resolution gracefully when a heap fills
+    // the controller watches heap occupancy, pending loads, and evictions to hold occupancy near this target
+    // e.g. 0.9 for 90%. 0 disables
+    float m_targetHeapOccupancy{ 0 };
+
+    // when a heap can't fit pending loads, evict the finest referenced tiles of the least important resources
+    // so the space goes to coarser tiles, e.g. of newly visible objects. reclaimed mips are restored as space frees up
+    bool m_enableReclaim{ false };
+
+    // threads that read files for TileUpdateManager::CreateStreamingResourceAsync(). started on first use
+    UINT m_numLoaderThreads{ 4 };
+
+    // 0: dedicated threads for processing feedback, updating residency, submitting, monitoring fences, and (reference streamer) copying
+    // otherwise, that work runs as tasks on a shared pool of this many work-stealing threads, and feedback is processed in parallel
+    UINT m_numWorkerThreads{ 0 };
+    UINT64 m_workerAffinityMask{ 0 }; // 0: any processor. otherwise, SetThreadAffinityMask() of each worker
+
+    // StreamingResources created from the same file in the same heap share tiles: a tile is uploaded once
+    // and mapped into every resource that references it. by default, every resource is treated as unique
+    bool m_shareTilesByFile{ false };
+
+    // run headless on a software device: no gpu, m_pDirectCommandQueue is ignored. Windows only, like the rest of the library
+    // tile mappings are tracked in memory, tile data is read but discarded, and fences complete after m_softwareDeviceLatencyMs
+    // feedback comes from QueueSoftwareFeedback() instead of QueueFeedback(), and EndFrame() returns null command lists
+    bool m_softwareDevice{ false };
+    float m_softwareDeviceLatencyMs{ 1 };
 };
 
 //=============================================================================
@@ -165,6 +213,15 @@ struct TileUpdateManager
     //--------------------------------------------
     virtual StreamingResource* CreateStreamingResource(const std::wstring& in_filename, StreamingHeap* in_pHeap) = 0;
 
+    // returns immediately. the file header and packed mips are read by a loader thread
+    // until GetPackedMipsResident() returns true, only call GetPackedMipsResident(), QueueEviction(), and Destroy()
+    virtual StreamingResource* CreateStreamingResourceAsync(const std::wstring& in_filename, StreamingHeap* in_pHeap) = 0;
+
+    // same result as CreateStreamingResource() for each file, appended to out_resources
+    // the files are read in parallel by the loader threads (and the calling thread), and returns when all are done
+    // the batch gets space in the residency map together, and its packed mips are requested together
+    virtual void CreateStreamingResources(std::vector<StreamingResource*>& out_resources, const std::vector<std::wstring>& in_filenames, StreamingHeap* in_pHeap) = 0;
+
     //--------------------------------------------
     // Call BeginFrame() first,
     // once for all TileUpdateManagers that share heap/upload buffers
@@ -180,6 +237,10 @@ struct TileUpdateManager
     // descriptor required to create Clear() and Resolve() commands
     virtual void QueueFeedback(StreamingResource* in_pResource, D3D12_GPU_DESCRIPTOR_HANDLE in_gpuDescriptor) = 0;
 
+    // software device only (see TileUpdateManagerDesc::m_softwareDevice): feedback supplied by the application
+    // GetMinMipMapWidth() x GetMinMipMapHeight() bytes, one finest-sampled mip per region. 0xff means not sampled
+    virtual void QueueSoftwareFeedback(StreamingResource* in_pResource, const BYTE* in_pMinMips) = 0;
+
     //--------------------------------------------
     // Call EndFrame() last, paired with each BeginFrame() and after all draw commands
     // returns two command lists:
@@ -219,10 +280,26 @@ struct TileUpdateManager
     //--------------------------------------------
     virtual void SetVisualizationMode(UINT in_mode) = 0;
     virtual void CaptureTraceFile(bool in_captureTrace) = 0; // capture a trace file of tile uploads
+    virtual void CaptureFeedbackFile(bool in_captureFeedback) = 0; // capture the feedback consumed by each resource to a binary file (see FeedbackCapture.h)
     virtual float GetGpuStreamingTime() const = 0;
     virtual float GetCpuProcessFeedbackTime() = 0; // approx. cpu time spent processing feedback last frame. expected usage is to average over many frames
     virtual UINT GetTotalNumUploads() const = 0;   // number of tiles uploaded so far
     virtual UINT GetTotalNumEvictions() const = 0; // number of tiles evicted so far
     virtual float GetTotalTileCopyLatency() const = 0; // very approximate average latency of tile upload from request to completion
     virtual UINT GetTotalNumSubmits() const = 0;   // number of fence signals for uploads. when using DS, equals number of calls to IDStorageQueue::Submit()
+
+    // prefetch statistics (see TileUpdateManagerDesc::m_enablePrefetch)
+    // accuracy = hits / requests. bandwidth overhead = prefetch uploads / total uploads
+    virtual UINT GetTotalNumPrefetchRequests() const = 0; // number of regions that received speculative references
+    virtual UINT GetTotalNumPrefetchHits() const = 0;     // number of those regions later requested by feedback
+    virtual UINT GetTotalNumPrefetchUploads() const = 0;  // number of tiles uploaded due to prefetch
+
+    // late-load statistics: late rate = late regions / feedback regions
+    // measured on undilated feedback, so can compare with and without TileUpdateManagerDesc::m_feedbackDilationRadius
+    virtual UINT GetTotalNumFeedbackRegions() const = 0; // number of regions with feedback requests processed
+    virtual UINT GetTotalNumLateRegions() const = 0;     // number of those regions that requested a tile that was not resident (see TileUpdateManagerDesc::m_enableLateRegionStatistics)
+
+    virtual UINT GetTotalNumReclaimedTiles() const = 0; // number of referenced tiles released due to heap pressure (see TileUpdateManagerDesc::m_enableReclaim)
+
+    virtual UINT GetTotalNumSharedTileMappings() const = 0; // number of tiles mapped from another resource's upload (see TileUpdateManagerDesc::m_shareTilesByFile)
 };
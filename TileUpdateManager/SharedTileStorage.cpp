@@ -0,0 +1,103 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#include "pch.h"
+
+#include "SharedTileStorage.h"
+
+//-----------------------------------------------------------------------------
+// dimensions match the TileMappingState of each resource created from the file
+//-----------------------------------------------------------------------------
+Streaming::SharedTileStorage::SharedTileStorage(UINT in_numMips, const D3D12_SUBRESOURCE_TILING* in_pTiling) :
+    m_mipOffsets(in_numMips)
+    , m_mipWidths(in_numMips)
+{
+    UINT numTiles = 0;
+    for (UINT mip = 0; mip < in_numMips; mip++)
+    {
+        m_mipOffsets[mip] = numTiles;
+        m_mipWidths[mip] = in_pTiling[mip].WidthInTiles;
+        numTiles += in_pTiling[mip].WidthInTiles * in_pTiling[mip].HeightInTiles;
+    }
+
+    m_refcounts.resize(numTiles, 0);
+    m_heapIndices.resize(numTiles, UINT(-1));
+    m_states = std::vector<std::atomic<State>>(numTiles);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::SharedTileStorage::BeginLoad(const D3D12_TILED_RESOURCE_COORDINATE& in_coord, UINT in_heapIndex)
+{
+    UINT i = GetIndex(in_coord);
+    ASSERT(0 == m_refcounts[i]);
+    ASSERT(State::NotLoaded == m_states[i]);
+
+    m_refcounts[i] = 1;
+    m_heapIndices[i] = in_heapIndex;
+    m_states[i].store(State::Loading, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UINT Streaming::SharedTileStorage::AddRef(const D3D12_TILED_RESOURCE_COORDINATE& in_coord)
+{
+    UINT i = GetIndex(in_coord);
+    ASSERT(State::Loaded == m_states[i]);
+
+    m_refcounts[i]++;
+    return m_heapIndices[i];
+}
+
+//-----------------------------------------------------------------------------
+// a resource only releases tiles it holds, and never while its own copy is in flight
+//-----------------------------------------------------------------------------
+bool Streaming::SharedTileStorage::Release(const D3D12_TILED_RESOURCE_COORDINATE& in_coord)
+{
+    UINT i = GetIndex(in_coord);
+    ASSERT(m_refcounts[i]);
+    ASSERT(State::Loaded == m_states[i]);
+
+    m_refcounts[i]--;
+    if (0 == m_refcounts[i])
+    {
+        m_heapIndices[i] = UINT(-1);
+        m_states[i].store(State::NotLoaded, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// publish: the tile may now be mapped by other resources
+//-----------------------------------------------------------------------------
+void Streaming::SharedTileStorage::NotifyLoaded(const D3D12_TILED_RESOURCE_COORDINATE& in_coord)
+{
+    UINT i = GetIndex(in_coord);
+    ASSERT(State::Loading == m_states[i]);
+
+    m_states[i].store(State::Loaded, std::memory_order_release);
+}
@@ -0,0 +1,85 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+//=============================================================================
+// tiles of one file in one heap, shared by every StreamingResource created from that file
+// (see TileUpdateManagerDesc::m_shareTilesByFile)
+//
+// a tile is loaded into the heap once, by the first resource that references it
+// other resources map the same heap tile into their reserved resource without a copy
+// the reference count is of resources holding the tile. the last one to release it frees the heap tile
+//=============================================================================
+namespace Streaming
+{
+    class SharedTileStorage
+    {
+    public:
+        SharedTileStorage(UINT in_numMips, const D3D12_SUBRESOURCE_TILING* in_pTiling);
+
+        enum class State : UINT8
+        {
+            NotLoaded = 0,
+            Loading,  // a resource is copying the tile into the heap
+            Loaded    // the tile is in the heap and can be mapped
+        };
+
+        //-------------------------------------------
+        // called by the ProcessFeedback thread (or the application thread when streaming has stopped)
+        //-------------------------------------------
+        State GetState(const D3D12_TILED_RESOURCE_COORDINATE& in_coord) const { return m_states[GetIndex(in_coord)].load(std::memory_order_acquire); }
+
+        // first reference. the caller copies the tile into in_heapIndex
+        void BeginLoad(const D3D12_TILED_RESOURCE_COORDINATE& in_coord, UINT in_heapIndex);
+
+        // reference a loaded tile. returns the heap index to map
+        UINT AddRef(const D3D12_TILED_RESOURCE_COORDINATE& in_coord);
+
+        // returns true if that was the last reference, in which case the caller frees the heap index
+        bool Release(const D3D12_TILED_RESOURCE_COORDINATE& in_coord);
+
+        //-------------------------------------------
+        // called by the DataUploader fence monitor thread
+        //-------------------------------------------
+        void NotifyLoaded(const D3D12_TILED_RESOURCE_COORDINATE& in_coord);
+    private:
+        std::vector<UINT> m_mipOffsets; // start of each mip in the arrays below
+        std::vector<UINT> m_mipWidths;  // in tiles
+
+        std::vector<UINT> m_refcounts;
+        std::vector<UINT> m_heapIndices;
+        std::vector<std::atomic<State>> m_states;
+
+        UINT GetIndex(const D3D12_TILED_RESOURCE_COORDINATE& in_coord) const
+        {
+            return m_mipOffsets[in_coord.Subresource] + (in_coord.Y * m_mipWidths[in_coord.Subresource]) + in_coord.X;
+        }
+    };
+}
@@ -74,6 +74,73 @@ void Streaming::SimpleAllocator::Free(const UINT* in_pIndices, UINT in_numIndice
     m_index += in_numIndices;
 }
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UINT Streaming::BlockAllocator::Allocate(UINT in_numBytes)
+{
+    UINT numBytes = GetAlignedSize(in_numBytes);
+
+    for (auto i = m_freeBlocks.begin(); i != m_freeBlocks.end(); i++)
+    {
+        if (i->second >= numBytes)
+        {
+            UINT offset = i->first;
+            UINT remaining = i->second - numBytes;
+            m_freeBlocks.erase(i);
+            if (remaining)
+            {
+                m_freeBlocks[offset + numBytes] = remaining;
+            }
+            return offset;
+        }
+    }
+    return InvalidOffset;
+}
+
+//-----------------------------------------------------------------------------
+// merge with the free blocks before and after, if adjacent
+//-----------------------------------------------------------------------------
+void Streaming::BlockAllocator::Free(UINT in_offset, UINT in_numBytes)
+{
+    UINT offset = in_offset;
+    UINT numBytes = GetAlignedSize(in_numBytes);
+    ASSERT((offset + numBytes) <= m_capacity);
+
+    auto next = m_freeBlocks.lower_bound(offset);
+    ASSERT((m_freeBlocks.end() == next) || (next->first >= offset + numBytes));
+    if ((m_freeBlocks.end() != next) && (next->first == offset + numBytes))
+    {
+        numBytes += next->second;
+        next = m_freeBlocks.erase(next);
+    }
+
+    if (m_freeBlocks.begin() != next)
+    {
+        auto prev = std::prev(next);
+        ASSERT(prev->first + prev->second <= offset);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += numBytes;
+            return;
+        }
+    }
+
+    m_freeBlocks[offset] = numBytes;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::BlockAllocator::Grow(UINT in_capacity)
+{
+    ASSERT(in_capacity >= m_capacity);
+    if (in_capacity > m_capacity)
+    {
+        UINT oldCapacity = m_capacity;
+        m_capacity = in_capacity;
+        Free(oldCapacity, in_capacity - oldCapacity);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // uses a lockless ringbuffer so allocate can be on a different thread than free
 //-----------------------------------------------------------------------------
@@ -137,3 +204,153 @@ void Streaming::AllocatorMT::Free(UINT i)
     m_indices[baseIndex] = i;
     m_ringBuffer.Free();
 }
+
+//-----------------------------------------------------------------------------
+// slot i starts free for position i
+//-----------------------------------------------------------------------------
+Streaming::RingBufferMPSC::RingBufferMPSC(UINT in_size) :
+    m_size(in_size), m_sequence(in_size)
+{
+    for (UINT i = 0; i < in_size; i++)
+    {
+        m_sequence[i] = i;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// writers race for the write position. losers retry with the updated position
+//-----------------------------------------------------------------------------
+bool Streaming::RingBufferMPSC::Allocate(UINT& out_index)
+{
+    UINT64 pos = m_writerIndex.load(std::memory_order_relaxed);
+    while (1)
+    {
+        UINT64 sequence = m_sequence[pos % m_size].load(std::memory_order_acquire);
+        if (sequence == pos)
+        {
+            if (m_writerIndex.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                out_index = UINT(pos % m_size);
+                return true;
+            }
+        }
+        else if (sequence < pos)
+        {
+            return false; // the reader hasn't freed this slot from the previous lap
+        }
+        else
+        {
+            pos = m_writerIndex.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// only the writer that claimed the slot touches it until it is published
+//-----------------------------------------------------------------------------
+void Streaming::RingBufferMPSC::Publish(UINT in_index)
+{
+    UINT64 pos = m_sequence[in_index].load(std::memory_order_relaxed);
+    m_sequence[in_index].store(pos + 1, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+// a later slot may be published before an earlier one. only count the consecutive ones
+//-----------------------------------------------------------------------------
+UINT Streaming::RingBufferMPSC::GetReadyToRead() const
+{
+    const UINT64 end = m_readerIndex + m_size;
+    while ((m_readyIndex < end) && ((m_readyIndex + 1) == m_sequence[m_readyIndex % m_size].load(std::memory_order_acquire)))
+    {
+        m_readyIndex++;
+    }
+    return UINT(m_readyIndex - m_readerIndex);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::RingBufferMPSC::Free(UINT in_n)
+{
+    ASSERT(in_n <= GetReadyToRead());
+    for (UINT i = 0; i < in_n; i++)
+    {
+        m_sequence[m_readerIndex % m_size].store(m_readerIndex + m_size, std::memory_order_release);
+        m_readerIndex++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// every index starts in the free list: slot i contains index i, published for position i
+//-----------------------------------------------------------------------------
+Streaming::AllocatorMPSC::AllocatorMPSC(UINT in_maxNumElements) :
+    m_slots(in_maxNumElements)
+{
+    for (UINT i = 0; i < in_maxNumElements; i++)
+    {
+        m_slots[i].m_index = i;
+        m_slots[i].m_sequence = i + 1;
+    }
+    m_freeIndex = in_maxNumElements;
+}
+
+Streaming::AllocatorMPSC::~AllocatorMPSC()
+{
+#ifdef _DEBUG
+    ASSERT(0 == GetAllocated());
+    // verify all indices accounted for and unique
+    std::vector<UINT> indices;
+    for (const auto& s : m_slots) { indices.push_back(s.m_index); }
+    std::sort(indices.begin(), indices.end());
+    for (UINT i = 0; i < (UINT)indices.size(); i++)
+    {
+        ASSERT(i == indices[i]);
+    }
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// multi-threaded allocator (any number of allocators, single releaser)
+//-----------------------------------------------------------------------------
+bool Streaming::AllocatorMPSC::Allocate(UINT& out_index)
+{
+    const UINT64 size = m_slots.size();
+    UINT64 pos = m_allocateIndex.load(std::memory_order_relaxed);
+    while (1)
+    {
+        auto& slot = m_slots[pos % size];
+        UINT64 sequence = slot.m_sequence.load(std::memory_order_acquire);
+        if (sequence == (pos + 1))
+        {
+            if (m_allocateIndex.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                out_index = slot.m_index;
+                slot.m_sequence.store(pos + size, std::memory_order_release); // slot may be re-used by Free()
+                return true;
+            }
+        }
+        else if (sequence < (pos + 1))
+        {
+            return false; // empty
+        }
+        else
+        {
+            pos = m_allocateIndex.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// the free list can never overflow, but an allocator that won the slot may not have finished reading it
+//-----------------------------------------------------------------------------
+void Streaming::AllocatorMPSC::Free(UINT in_index)
+{
+    const UINT64 pos = m_freeIndex.load(std::memory_order_relaxed);
+    auto& slot = m_slots[pos % m_slots.size()];
+    while (slot.m_sequence.load(std::memory_order_acquire) != pos)
+    {
+        _mm_pause();
+    }
+    slot.m_index = in_index;
+    slot.m_sequence.store(pos + 1, std::memory_order_release);
+    m_freeIndex.store(pos + 1, std::memory_order_release);
+}
@@ -28,6 +28,8 @@
 
 #include <d3d12.h>
 #include <vector>
+#include <atomic>
+#include <map>
 
 #include "Streaming.h"
 
@@ -60,6 +62,33 @@ namespace Streaming
         UINT m_index;
     };
 
+    //==================================================
+    // variable-size blocks within a range that can grow, e.g. the shared residency map
+    // sizes are rounded up to the alignment. free blocks are coalesced
+    // not thread safe
+    //==================================================
+    class BlockAllocator
+    {
+    public:
+        BlockAllocator(UINT in_alignment) : m_alignment(in_alignment) {}
+
+        static const UINT InvalidOffset = UINT(-1);
+
+        // first fit. returns InvalidOffset if there is no free block large enough
+        UINT Allocate(UINT in_numBytes);
+        void Free(UINT in_offset, UINT in_numBytes);
+
+        // extend the range. space between the old and new capacity becomes free
+        void Grow(UINT in_capacity);
+
+        UINT GetCapacity() const { return m_capacity; }
+        UINT GetAlignedSize(UINT in_numBytes) const { return (in_numBytes + m_alignment - 1) & ~(m_alignment - 1); }
+    private:
+        const UINT m_alignment;
+        UINT m_capacity{ 0 };
+        std::map<UINT, UINT> m_freeBlocks; // offset -> size, ordered by offset so neighbors can be merged
+    };
+
     //==================================================
     // lock-free ringbuffer with single writer and single reader
     //==================================================
@@ -141,4 +170,124 @@ namespace Streaming
         std::vector<UINT> m_indices;
         RingBuffer m_ringBuffer;
     };
+
+    //==================================================
+    // lock-free list of objects that need attention. any thread may Push(), a single thread Drain()s
+    // intrusive: T must have a member "T* m_pNextDirty" that only this list touches
+    // the list does not prevent duplicates. the caller pushes an object only if it isn't already in the list,
+    // e.g. by exchanging an atomic flag that is cleared when the object is visited
+    //==================================================
+    template<typename T> class DirtyList
+    {
+    public:
+        void Push(T* in_p)
+        {
+            T* pHead = m_pHead.load(std::memory_order_relaxed);
+            do
+            {
+                in_p->m_pNextDirty = pHead;
+            } while (!m_pHead.compare_exchange_weak(pHead, in_p, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        // visit every object pushed so far, most recent first
+        // objects may be pushed again (from within in_function or by other threads) while this runs
+        template<typename F> void Drain(F in_function)
+        {
+            T* p = m_pHead.exchange(nullptr, std::memory_order_acquire);
+            while (p)
+            {
+                T* pNext = p->m_pNextDirty; // read before in_function(), after which p might be pushed again
+                in_function(p);
+                p = pNext;
+            }
+        }
+
+        // must not be called concurrently with Drain()
+        void Remove(T* in_p)
+        {
+            Drain([&](T* p) { if (p != in_p) { Push(p); } });
+        }
+
+        bool IsEmpty() const { return nullptr == m_pHead.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<T*> m_pHead{ nullptr };
+    };
+
+    //==================================================
+    // bounded ringbuffer with multiple writers and a single reader
+    // writers claim a slot with a CAS on the shared write position, fill their data, then Publish()
+    // the reader never CASes: a slot is ready when its sequence number says it was published
+    // positions are 64-bit so they never wrap
+    //==================================================
+    class RingBufferMPSC
+    {
+    public:
+        RingBufferMPSC(UINT in_size);
+
+        //-------------------------
+        // writer methods, any thread
+        //-------------------------
+        bool Allocate(UINT& out_index); // claim a slot to write. returns false if full
+        void Publish(UINT in_index);    // notify reader the slot is ready
+
+        //-------------------------
+        // reader methods, single thread
+        //-------------------------
+        UINT GetReadyToRead() const; // how many consecutive slots have been published
+        UINT GetReadIndex(UINT in_offset = 0) const // can start reading here
+        {
+            ASSERT(in_offset < GetReadyToRead());
+            return UINT((m_readerIndex + in_offset) % m_size);
+        }
+        void Free(UINT in_n = 1); // return entries to writers
+
+        UINT GetSize() const { return m_size; }
+    private:
+        static constexpr UINT CACHE_LINE_SIZE{ 64 };
+
+        const UINT m_size;
+        // per slot: position + 1 when published, position + size when free for the next lap
+        std::vector<std::atomic<UINT64>> m_sequence;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<UINT64> m_writerIndex{ 0 };
+        alignas(CACHE_LINE_SIZE) UINT64 m_readerIndex{ 0 };
+        mutable UINT64 m_readyIndex{ 0 }; // published up to here. avoids re-scanning in GetReadyToRead()
+        BYTE m_padding[CACHE_LINE_SIZE - 2 * sizeof(UINT64)];
+    };
+
+    //==================================================
+    // like AllocatorMT, but any number of threads may allocate. a single thread frees.
+    // the free list is a ringbuffer of indices: allocate CASes the read position, free uses plain stores
+    //==================================================
+    class AllocatorMPSC
+    {
+    public:
+        AllocatorMPSC(UINT in_maxNumElements);
+        virtual ~AllocatorMPSC();
+
+        bool Allocate(UINT& out_index); // any thread. returns false if none available
+        void Free(UINT in_index);       // single thread
+
+        // approximate if allocations are in progress
+        UINT GetAvailable() const
+        {
+            const UINT64 allocateIndex = m_allocateIndex.load(std::memory_order_acquire); // read first, so the difference can't be negative
+            return UINT(m_freeIndex.load(std::memory_order_relaxed) - allocateIndex);
+        }
+        UINT GetCapacity() const { return (UINT)m_slots.size(); }
+        UINT GetAllocated() const { return GetCapacity() - GetAvailable(); }
+    private:
+        static constexpr UINT CACHE_LINE_SIZE{ 64 };
+
+        struct Slot
+        {
+            std::atomic<UINT64> m_sequence{ 0 };
+            UINT m_index{ 0 };
+        };
+        std::vector<Slot> m_slots;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<UINT64> m_allocateIndex{ 0 };
+        alignas(CACHE_LINE_SIZE) std::atomic<UINT64> m_freeIndex{ 0 };
+        BYTE m_padding[CACHE_LINE_SIZE - sizeof(UINT64)];
+    };
 }
@@ -29,10 +29,9 @@
 #include <d3d12.h>
 #include <wrl.h>
 #include <vector>
-#include <synchapi.h>
-#pragma comment(lib, "Synchronization.lib")
 
 #include "DebugHelper.h"
+#include "SynchronizationFlag.h"
 
 namespace Streaming
 {
@@ -48,13 +47,22 @@ namespace Streaming
         ID3D12Resource* GetResource() const { return m_resource.Get(); }
         void* GetData() const { return m_pData; }
 
-        void Allocate(ID3D12Device* in_pDevice, UINT in_numBytes)
+        // optionally copy the contents of the previous buffer (up to the smaller of the two sizes)
+        // a null device (software device) allocates host memory instead of an upload heap
+        void Allocate(ID3D12Device* in_pDevice, UINT in_numBytes, bool in_preserveData = false)
         {
-            if (m_pData)
+            if (nullptr == in_pDevice)
             {
-                m_resource->Unmap(0, nullptr);
+                if (!in_preserveData) { m_hostData.clear(); }
+                m_hostData.resize(in_numBytes, 0);
+                m_pData = m_hostData.data();
+                return;
             }
 
+            ComPtr<ID3D12Resource> oldResource;
+            oldResource.Swap(m_resource);
+            void* pOldData = m_pData;
+
             const auto uploadHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
             const auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(in_numBytes);
             in_pDevice->CreateCommittedResource(
@@ -63,9 +71,20 @@ namespace Streaming
                 D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
                 IID_PPV_ARGS(&m_resource));
             m_resource->Map(0, nullptr, reinterpret_cast<void**>(&m_pData));
+
+            if (pOldData)
+            {
+                if (in_preserveData)
+                {
+                    UINT oldNumBytes = (UINT)oldResource->GetDesc().Width;
+                    memcpy(m_pData, pOldData, std::min(oldNumBytes, in_numBytes));
+                }
+                oldResource->Unmap(0, nullptr);
+            }
         }
     private:
         ComPtr<ID3D12Resource> m_resource;
+        std::vector<BYTE> m_hostData;
         void* m_pData{ nullptr };
     };
 
@@ -82,29 +101,6 @@ namespace Streaming
         const UINT m_alignment;
     };
 
-    //==================================================
-    // a single thread may wait on this flag, which may be set by any number of threads
-    //==================================================
-    class SynchronizationFlag
-    {
-    public:
-        void Set()
-        { 
-            m_flag = true;
-            WakeByAddressSingle(&m_flag);
-        }
-
-        void Wait()
-        {
-            // note: msdn recommends verifying that the value really changed, but we're not.
-            bool undesiredValue = false;
-            WaitOnAddress(&m_flag, &undesiredValue, sizeof(bool), INFINITE);
-            m_flag = false;
-        };
-    private:
-        bool m_flag{ false };
-    };
-
     inline void SetThreadPriority(std::thread& in_thread, int in_priority)
     {
         if (in_priority) // 0 = default (do nothing). -1 = efficiency. otherwise, performance.
@@ -116,7 +112,7 @@ namespace Streaming
     }
 
     //==================================================
-    // unused
+    // spin lock for short critical sections
     //==================================================
     class Lock
     {
@@ -36,6 +36,49 @@ void Streaming::Heap::Destroy()
     delete this;
 }
 
+//-----------------------------------------------------------------------------
+// closed-loop control of the feedback bias for resources in this heap
+// without it, a full heap stops loading and resources that need tiles stay stale indefinitely
+//
+// demand is the fraction of the heap that is allocated or waiting to be allocated (pending loads)
+// evicting a large fraction of the heap each frame while above target is churn, which adds to the error
+// the bias rises quickly to relieve pressure, and falls slowly to avoid pumping
+// only whole mips are applied to feedback. the fractional part is the integrated error.
+//-----------------------------------------------------------------------------
+void Streaming::Heap::UpdateFeedbackBias(float in_targetOccupancy)
+{
+    const float capacity = (float)m_heapAllocator.GetCapacity();
+    const float demand = float(m_heapAllocator.GetAllocated() + m_numPendingLoads) / capacity;
+
+    float error = demand - in_targetOccupancy;
+    if (error > 0)
+    {
+        error += float(m_numEvictions) / capacity;
+    }
+
+    const float deadband = 0.02f;
+    const float increaseGain = 0.5f; // mips per frame per unit of error
+    const float decreaseGain = 0.1f;
+    const float maxBias = 8.0f;
+
+    float bias = m_feedbackBias;
+    if (error > deadband)
+    {
+        bias += increaseGain * error;
+    }
+    else if (error < -deadband)
+    {
+        bias += decreaseGain * error;
+    }
+    bias = std::clamp(bias, 0.0f, maxBias);
+
+    m_feedbackBias = bias;
+    m_feedbackMipBias = (UINT8)bias;
+
+    m_numPendingLoads = 0;
+    m_numEvictions = 0;
+}
+
 //-----------------------------------------------------------------------------
 // create an "atlas" texture that covers the entire heap
 //-----------------------------------------------------------------------------
@@ -165,63 +208,70 @@ ID3D12Resource* Streaming::Atlas::ComputeCoordFromTileIndex(D3D12_TILED_RESOURCE
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-Streaming::Heap::Heap(ID3D12CommandQueue* in_pQueue, UINT in_maxNumTilesHeap) : m_heapAllocator(in_maxNumTilesHeap)
+Streaming::Heap::Heap(Device* in_pDevice, UINT in_maxNumTilesHeap) : m_heapAllocator(in_maxNumTilesHeap)
 {
-    ComPtr<ID3D12Device> device;
-    in_pQueue->GetDevice(IID_PPV_ARGS(&device));
-
     // create a heap to store streaming tiles
     // should be smaller than the entire surface
-    const UINT64 heapSize = UINT64(in_maxNumTilesHeap) * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
-    CD3DX12_HEAP_DESC heapDesc(heapSize, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_DENY_BUFFERS | D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES);
-    ThrowIfFailed(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_tileHeap)));
+    m_tileHeap = in_pDevice->CreateHeap(in_maxNumTilesHeap);
 }
 
 Streaming::Heap::~Heap()
 {
-    for (auto p : m_atlases)
+    AtlasNode* pNode = m_pAtlases;
+    while (pNode)
     {
-        delete p;
+        AtlasNode* pNext = pNode->m_pNext;
+        delete pNode->m_pAtlas;
+        delete pNode;
+        pNode = pNext;
     }
 }
 
 //-----------------------------------------------------------------------------
-// creation of new StreamingResource must verify there is an atlas for that format
+// FIXME: this is an O(n) search. for very small n, is this fine?
 //-----------------------------------------------------------------------------
-void Streaming::Heap::AllocateAtlas(ID3D12CommandQueue* in_pQueue, const DXGI_FORMAT in_format)
+Streaming::Atlas* Streaming::Heap::FindAtlas(const DXGI_FORMAT in_format) const
 {
-    Streaming::Atlas* pAtlas = nullptr;
-    for (auto p : m_atlases)
+    for (const AtlasNode* pNode = m_pAtlases; pNode; pNode = pNode->m_pNext)
     {
-        if (p->GetFormat() == in_format)
+        if (pNode->m_pAtlas->GetFormat() == in_format)
         {
-            pAtlas = p;
-            break;
+            return pNode->m_pAtlas;
         }
     }
-    if (nullptr == pAtlas)
-    {
-        pAtlas = new Streaming::Atlas(m_tileHeap.Get(), in_pQueue, m_heapAllocator.GetCapacity(), in_format);
-        m_atlases.push_back(pAtlas);
-    }
+    return nullptr;
 }
 
 //-----------------------------------------------------------------------------
-// find the corresponding coordinate into an atlas for this linear heap (tile) index
+// creation of new StreamingResource must verify there is an atlas for that format
+// streaming threads may be searching concurrently. publish the new atlas after it is complete
 //-----------------------------------------------------------------------------
-ID3D12Resource* Streaming::Heap::ComputeCoordFromTileIndex(D3D12_TILED_RESOURCE_COORDINATE& out_coord, UINT in_index, const DXGI_FORMAT in_format)
+void Streaming::Heap::AllocateAtlas(DeviceQueue* in_pQueue, const DXGI_FORMAT in_format)
 {
-    Streaming::Atlas* pAtlas = nullptr;
-
-    // FIXME: this is an O(n) search. for very small n, is this fine?
-    for (auto p : m_atlases)
+    ID3D12CommandQueue* pQueue = in_pQueue->GetD3D12Queue();
+    if ((nullptr != pQueue) && (nullptr == FindAtlas(in_format)))
     {
-        if (p->GetFormat() == in_format)
+        m_atlasLock.Acquire();
+
+        // another thread may have added it while this one waited
+        if (nullptr == FindAtlas(in_format))
         {
-            pAtlas = p;
-            break;
+            AtlasNode* pNode = new AtlasNode;
+            pNode->m_pAtlas = new Streaming::Atlas(GetHeap(), pQueue, m_heapAllocator.GetCapacity(), in_format);
+            pNode->m_pNext = m_pAtlases;
+            m_pAtlases = pNode;
         }
+
+        m_atlasLock.Release();
     }
+}
+
+//-----------------------------------------------------------------------------
+// find the corresponding coordinate into an atlas for this linear heap (tile) index
+//-----------------------------------------------------------------------------
+ID3D12Resource* Streaming::Heap::ComputeCoordFromTileIndex(D3D12_TILED_RESOURCE_COORDINATE& out_coord, UINT in_index, const DXGI_FORMAT in_format)
+{
+    Streaming::Atlas* pAtlas = FindAtlas(in_format);
     ASSERT(pAtlas);
 
     return pAtlas->ComputeCoordFromTileIndex(out_coord, in_index);
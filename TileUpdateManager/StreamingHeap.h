@@ -28,6 +28,7 @@
 
 #include "Streaming.h" // for ComPtr
 #include "SimpleAllocator.h"
+#include "Device.h"
 #include "SamplerFeedbackStreaming.h"
 
 //==================================================
@@ -69,24 +70,55 @@ namespace Streaming
         //-----------------------------------------------------------------
         virtual void Destroy() override;
         virtual UINT GetNumTilesAllocated() const override { return m_heapAllocator.GetAllocated(); }
+        virtual float GetFeedbackBias() const override { return m_feedbackBias; }
         //-----------------------------------------------------------------
         // end external APIs
         //-----------------------------------------------------------------
 
-        Heap(ID3D12CommandQueue* in_pQueue, UINT in_maxNumTilesHeap);
+        Heap(Device* in_pDevice, UINT in_maxNumTilesHeap);
         virtual ~Heap();
 
-        // allocate atlases for a format. does nothing if format already has an atlas
-        void AllocateAtlas(ID3D12CommandQueue* in_pQueue, const DXGI_FORMAT in_format);
+        // allocate atlases for a format. does nothing if format already has an atlas, or if the queue isn't d3d12 (nothing is copied)
+        void AllocateAtlas(DeviceQueue* in_pQueue, const DXGI_FORMAT in_format);
 
         ID3D12Resource* ComputeCoordFromTileIndex(D3D12_TILED_RESOURCE_COORDINATE& out_coord, UINT in_index, const DXGI_FORMAT in_format);
-        ID3D12Heap* GetHeap() const { return m_tileHeap.Get(); }
+        ID3D12Heap* GetHeap() const { return m_tileHeap->GetD3D12Heap(); }
+        DeviceHeap* GetDeviceHeap() const { return m_tileHeap.get(); }
         SimpleAllocator& GetAllocator() { return m_heapAllocator; }
 
+        //-------------------------------------------
+        // feedback bias control. called by the ProcessFeedback thread
+        //-------------------------------------------
+        // inputs accumulate until the next UpdateFeedbackBias()
+        void AddPendingLoads(UINT in_numPendingLoads) { m_numPendingLoads += in_numPendingLoads; }
+        void AddEvictions(UINT in_numEvictions) { m_numEvictions += in_numEvictions; }
+
+        // once per frame: adjust the bias to hold occupancy near the target
+        void UpdateFeedbackBias(float in_targetOccupancy);
+
+        // whole mips to add to the feedback of resources in this heap
+        UINT8 GetFeedbackMipBias() const { return m_feedbackMipBias; }
+
     private:
         SimpleAllocator m_heapAllocator;
 
-        std::vector<Streaming::Atlas*> m_atlases;
-        ComPtr<ID3D12Heap> m_tileHeap; // heap to hold tiles resident in GPU memory
+        std::atomic<float> m_feedbackBias{ 0 }; // read by the application for statistics
+        UINT8 m_feedbackMipBias{ 0 };
+        UINT m_numPendingLoads{ 0 };
+        UINT m_numEvictions{ 0 };
+
+        // atlases are added by the application or loader threads while other threads search for them
+        // an append-only list: nodes are complete before they are published and never change after,
+        // so readers need no lock and there is no limit on the number of formats. writers are serialized by m_atlasLock
+        struct AtlasNode
+        {
+            Streaming::Atlas* m_pAtlas{ nullptr };
+            AtlasNode* m_pNext{ nullptr };
+        };
+        std::atomic<AtlasNode*> m_pAtlases{ nullptr };
+        Streaming::Lock m_atlasLock;
+        Streaming::Atlas* FindAtlas(const DXGI_FORMAT in_format) const;
+
+        std::unique_ptr<DeviceHeap> m_tileHeap; // heap to hold tiles resident in GPU memory
     };
 }
@@ -33,6 +33,10 @@
 
 #include "StreamingHeap.h"
 #include "DataUploader.h"
+#include "SharedTileStorage.h"
+#include "FeedbackCapture.h"
+
+#include <emmintrin.h> // SSE2 for feedback dilation
 
 /*-----------------------------------------------------------------------------
 * Rules regarding order of operations:
@@ -60,16 +64,21 @@ Streaming::StreamingResourceBase::StreamingResourceBase(
     , m_pHeap(in_pHeap)
     , m_pFileHandle(in_pFileHandle)
     , m_filename(in_filename)
-    , m_textureFileInfo(in_filename)
 {
-    m_resources = std::make_unique<Streaming::InternalResources>(in_pTileUpdateManager->GetDevice(), m_textureFileInfo, (UINT)m_queuedFeedback.size());
-    m_tileMappingState.Init(m_resources->GetPackedMipInfo().NumStandardMips, m_resources->GetTiling());
+}
 
-    // no packed mips. odd, but possible. no need to check/update this variable again.
-    if (0 == m_resources->GetPackedMipInfo().NumTilesForPackedMips)
-    {
-        m_packedMipStatus = PackedMipStatus::RESIDENT;
-    }
+//-----------------------------------------------------------------------------
+// parse the file header, create internal resources, and read the packed mips
+// called by the application thread, or by a loader thread for resources created asynchronously
+// until complete, no other thread may access this object
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::Initialize()
+{
+    ASSERT(!m_initialized);
+
+    m_pTextureFileInfo = std::make_unique<Streaming::XeTexture>(m_filename);
+    m_resources = std::make_unique<Streaming::InternalResources>(m_pTileUpdateManager->GetDevice(), *m_pTextureFileInfo, (UINT)m_queuedFeedback.size());
+    m_tileMappingState.Init(m_resources->GetPackedMipInfo().NumStandardMips, m_resources->GetTiling());
 
     // initialize a structure that holds ref counts with dimensions equal to min-mip-map
     // set the bottom-most bits, representing the packed mips as being resident
@@ -81,41 +90,64 @@ Streaming::StreamingResourceBase::StreamingResourceBase(
     ASSERT(m_maxMip);
 
     m_tileReferences.resize(m_tileReferencesWidth * m_tileReferencesHeight, m_maxMip);
+    m_numReferencedTiles.assign(m_maxMip, 0);
     m_minMipMap.resize(m_tileReferences.size(), m_maxMip);
 
+    if (m_pTileUpdateManager->GetPrefetchEnabled())
+    {
+        m_feedbackMips.resize(m_tileReferences.size(), m_maxMip);
+        m_prefetchMips.resize(m_tileReferences.size(), m_maxMip);
+    }
+
     // make sure my heap has an atlas corresponding to my format
-    m_pHeap->AllocateAtlas(in_pTileUpdateManager->GetMappingQueue(), m_textureFileInfo.GetFormat());
+    m_pHeap->AllocateAtlas(m_pTileUpdateManager->GetMappingQueue(), m_pTextureFileInfo->GetFormat());
+
+    // share tiles with other resources created from the same file in the same heap
+    if (m_pTileUpdateManager->GetShareTilesByFile())
+    {
+        m_pSharedTiles = m_pTileUpdateManager->GetSharedTileStorage(m_filename, m_pHeap,
+            m_resources->GetPackedMipInfo().NumStandardMips, m_resources->GetTiling());
+    }
 
     // Load packed mips. packed mips are not streamed or evicted.
     LoadPackedMips();
+
+    m_initialized.store(true, std::memory_order_release);
 }
 
 //-----------------------------------------------------------------------------
 // destroy this object
-// Free() all heap allocations, then release the heap
+// TileUpdateManager stops tracking it and Free()s all heap allocations while streaming continues
 //-----------------------------------------------------------------------------
 Streaming::StreamingResourceBase::~StreamingResourceBase()
 {
     // do not delete StreamingResource between BeginFrame() and EndFrame(). It's complicated.
     ASSERT(!m_pTileUpdateManager->GetWithinFrame());
 
-    // other threads are manipulating the eviction and load arrays. stop them.
-    m_pTileUpdateManager->Finish();
+    // returns when no other thread references this object
+    m_pTileUpdateManager->Remove(this);
+
+    m_pendingEvictions.Clear();
+    m_pendingTileLoads.clear();
+    m_pendingPrefetchLoads.clear();
+}
 
-    // remove this object's allocations from the heap, which might be shared
-    m_tileMappingState.FreeHeapAllocations(m_pHeap);
+//-----------------------------------------------------------------------------
+// remove this object's allocations from the heap, which might be shared
+// called by the thread that owns heap allocation after all UpdateLists for this object have completed
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::FreeHeapAllocations()
+{
+    ASSERT(0 == m_numUpdateListsInFlight);
+
+    m_tileMappingState.FreeHeapAllocations(m_pHeap, m_pSharedTiles.get());
 
     // debug message workaround if exit before packed mips load, or no mips
     if (m_packedMipHeapIndices.size())
     {
         m_pHeap->GetAllocator().Free(m_packedMipHeapIndices);
+        m_packedMipHeapIndices.clear();
     }
-
-    m_pendingEvictions.Clear();
-    m_pendingTileLoads.clear();
-
-    // tell TileUpdateManager to stop tracking
-    m_pTileUpdateManager->Remove(this);
 }
 
 //-----------------------------------------------------------------------------
@@ -135,7 +167,7 @@ void Streaming::StreamingResourceBase::SetResidencyMapOffsetBase(UINT in_residen
 // Upload or Evict tiles to match the incoming requested minimum mip
 // if fails to adjust tile reference, then sets out_needRetry = true. Unchanged otherwise.
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::SetMinMip(UINT8 in_current, UINT in_x, UINT in_y, UINT in_s)
+void Streaming::StreamingResourceBase::SetMinMip(UINT8 in_current, UINT in_x, UINT in_y, UINT in_s, UINT in_prefetchBelow)
 {
     // what mip level is currently referenced at this tile?
     UINT8 s = in_current;
@@ -145,7 +177,7 @@ void Streaming::StreamingResourceBase::SetMinMip(UINT8 in_current, UINT in_x, UI
     while (s > in_s)
     {
         s -= 1; // already have "this" tile. e.g. have s == 1, desired in_s == 0, start with 0.
-        AddTileRef(in_x >> s, in_y >> s, s);
+        AddTileRef(in_x >> s, in_y >> s, s, s < in_prefetchBelow);
     }
 
     // decref mips we don't need
@@ -160,8 +192,10 @@ void Streaming::StreamingResourceBase::SetMinMip(UINT8 in_current, UINT in_x, UI
 //-----------------------------------------------------------------------------
 // add to refcount for a tile
 // if first time, add tile to list of pending loads
+// speculative (prefetch) tiles are added to the low-priority list
+// a new generation makes any pending eviction of this tile stale
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::AddTileRef(UINT in_x, UINT in_y, UINT in_s)
+void Streaming::StreamingResourceBase::AddTileRef(UINT in_x, UINT in_y, UINT in_s, bool in_prefetch)
 {
     auto& refCount = m_tileMappingState.GetRefCount(in_x, in_y, in_s);
 
@@ -171,7 +205,16 @@ void Streaming::StreamingResourceBase::AddTileRef(UINT in_x, UINT in_y, UINT in_
     // need to allocate?
     if (0 == refCount)
     {
-        m_pendingTileLoads.push_back(D3D12_TILED_RESOURCE_COORDINATE{ in_x, in_y, 0, in_s });
+        UINT32 generation = m_tileMappingState.NextGeneration(in_x, in_y, in_s);
+        m_numReferencedTiles[in_s]++;
+
+        // if resident or loading, the tile was rescued from eviction. no need to load.
+        if (TileMappingState::Residency::NotResident == m_tileMappingState.GetResidency(in_x, in_y, in_s))
+        {
+            auto& pendingLoads = in_prefetch ? m_pendingPrefetchLoads : m_pendingTileLoads;
+            pendingLoads.push_back({ D3D12_TILED_RESOURCE_COORDINATE{ in_x, in_y, 0, in_s }, generation });
+            m_numLivePendingLoads++;
+        }
     }
     refCount++;
 }
@@ -179,6 +222,7 @@ void Streaming::StreamingResourceBase::AddTileRef(UINT in_x, UINT in_y, UINT in_
 //-----------------------------------------------------------------------------
 // reduce ref count
 // if 0, add tile to list of pending evictions
+// a new generation makes any pending load of this tile stale
 //-----------------------------------------------------------------------------
 void Streaming::StreamingResourceBase::DecTileRef(UINT in_x, UINT in_y, UINT in_s)
 {
@@ -189,8 +233,19 @@ void Streaming::StreamingResourceBase::DecTileRef(UINT in_x, UINT in_y, UINT in_
     // last refrence? try to evict
     if (1 == refCount)
     {
-        // queue up a decmapping request that will release the heap index after mapping and clear the resident flag
-        m_pendingEvictions.Append(D3D12_TILED_RESOURCE_COORDINATE{ in_x, in_y, 0, in_s });
+        UINT32 generation = m_tileMappingState.NextGeneration(in_x, in_y, in_s);
+        m_numReferencedTiles[in_s]--;
+
+        // not resident? the load has not been issued, and is now abandoned
+        if (TileMappingState::Residency::NotResident == m_tileMappingState.GetResidency(in_x, in_y, in_s))
+        {
+            m_numLivePendingLoads--;
+        }
+        else
+        {
+            // queue up a decmapping request that will release the heap index after mapping and clear the resident flag
+            m_pendingEvictions.Append({ D3D12_TILED_RESOURCE_COORDINATE{ in_x, in_y, 0, in_s }, generation });
+        }
     }
     refCount--;
 }
@@ -204,6 +259,7 @@ void Streaming::StreamingResourceBase::TileMappingState::Init(UINT in_numMips, c
     m_refcounts.resize(in_numMips);
     m_heapIndices.resize(in_numMips);
     m_resident.resize(in_numMips);
+    m_generations.resize(in_numMips);
 
     for (UINT mip = 0; mip < in_numMips; mip++)
     {
@@ -212,6 +268,7 @@ void Streaming::StreamingResourceBase::TileMappingState::Init(UINT in_numMips, c
         m_refcounts[mip].resize(height);
         m_heapIndices[mip].resize(height);
         m_resident[mip].resize(height);
+        m_generations[mip].resize(height);
 
         for (auto& row : m_refcounts[mip])
         {
@@ -225,23 +282,34 @@ void Streaming::StreamingResourceBase::TileMappingState::Init(UINT in_numMips, c
         {
             row.assign(width, 0);
         }
+        for (auto& row : m_generations[mip])
+        {
+            row.assign(width, 0);
+        }
     }
 }
 
 //-----------------------------------------------------------------------------
 // remove all allocations from the (shared) heap
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::TileMappingState::FreeHeapAllocations(Streaming::Heap* in_pHeap)
+void Streaming::StreamingResourceBase::TileMappingState::FreeHeapAllocations(Streaming::Heap* in_pHeap, SharedTileStorage* in_pSharedTiles)
 {
-    for (auto& layer : m_heapIndices)
+    for (UINT s = 0; s < (UINT)m_heapIndices.size(); s++)
     {
-        for (auto& row : layer)
+        auto& layer = m_heapIndices[s];
+        for (UINT y = 0; y < (UINT)layer.size(); y++)
         {
-            for (auto& i : row)
+            auto& row = layer[y];
+            for (UINT x = 0; x < (UINT)row.size(); x++)
             {
+                auto& i = row[x];
                 if (TileMappingState::InvalidIndex != i)
                 {
-                    in_pHeap->GetAllocator().Free(i);
+                    // a shared tile is only freed by the last resource that holds it
+                    if ((nullptr == in_pSharedTiles) || in_pSharedTiles->Release(D3D12_TILED_RESOURCE_COORDINATE{ x, y, 0, s }))
+                    {
+                        in_pHeap->GetAllocator().Free(i);
+                    }
                     i = TileMappingState::InvalidIndex;
                 }
             }
@@ -296,8 +364,11 @@ UINT8 Streaming::StreamingResourceBase::TileMappingState::GetMinResidentMip()
 //-----------------------------------------------------------------------------
 void Streaming::StreamingResourceBase::SetResidencyChanged()
 {
-    m_tileResidencyChanged = true;
-    m_pTileUpdateManager->SetResidencyChanged();
+    // only the first change since the last UpdateMinMipMap() adds this to the TUM's dirty list
+    if (!m_tileResidencyChanged.exchange(true))
+    {
+        m_pTileUpdateManager->SetResidencyChanged(this);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -357,7 +428,11 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
                         noTiles = false;
                         changed = true;
                         refCount = 0;
-                        m_pendingEvictions.Append(D3D12_TILED_RESOURCE_COORDINATE{ x, y, 0, s });
+                        UINT32 generation = m_tileMappingState.NextGeneration(x, y, s);
+                        if (TileMappingState::Residency::NotResident != m_tileMappingState.GetResidency(x, y, s))
+                        {
+                            m_pendingEvictions.Append({ D3D12_TILED_RESOURCE_COORDINATE{ x, y, 0, s }, generation });
+                        }
                     }
                 }
             }
@@ -368,11 +443,16 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
         }
 
         // abandon all pending loads - all refcounts are 0
+        m_numReferencedTiles.assign(m_maxMip, 0);
+        m_numClampedRegions = 0;
         m_pendingTileLoads.clear();
+        ClearPrefetch();
+        m_numLivePendingLoads = 0;
     }
     else
     {
         UINT feedbackIndex = 0;
+        UINT64 latestFeedbackFenceValue = 0;
 
         //------------------------------------------------------------------
         // determine if there is feedback to process
@@ -380,7 +460,6 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
         //------------------------------------------------------------------
         {
             bool feedbackFound = false;
-            UINT64 latestFeedbackFenceValue = 0;
             for (UINT i = 0; i < (UINT)m_queuedFeedback.size(); i++)
             {
                 if (m_queuedFeedback[i].m_feedbackQueued)
@@ -404,6 +483,8 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
             {
                 return;
             }
+
+            m_feedbackFenceValue = in_frameFenceCompletedValue;
         }
 
         //------------------------------------------------------------------
@@ -411,34 +492,63 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
         //------------------------------------------------------------------
         {
             // mapped host feedback buffer
-            UINT8* pResolvedData = nullptr;
-            ID3D12Resource* pResolvedResource = m_resources->GetResolvedReadback(feedbackIndex);
-            pResolvedResource->Map(0, nullptr, (void**)&pResolvedData);
+            UINT rowPitch = 0;
+            const UINT8* pResolvedData = m_resources->MapFeedback(feedbackIndex, rowPitch);
 
-            TileReference* pTileRow = m_tileReferences.data();
-            for (UINT y = 0; y < height; y++)
+            if (auto pCapture = m_pTileUpdateManager->GetFeedbackCapture())
             {
-                for (UINT x = 0; x < width; x++)
-                {
-                    // clamp to the maximum we are tracking (not tracking packed mips)
-                    UINT8 desired = std::min(pResolvedData[x], m_maxMip);
-                    UINT8 initialValue = pTileRow[x];
-                    if (desired != initialValue) { changed = true; }
-                    SetMinMip(initialValue, x, y, desired);
-                    pTileRow[x] = desired;
-                } // end loop over x
-                pTileRow += width;
+                pCapture->Append(m_feedbackCaptureID, m_filename, m_pHeap, m_pHeap->GetAllocator().GetCapacity(),
+                    latestFeedbackFenceValue, width, height, pResolvedData, rowPitch);
+            }
 
-#if RESOLVE_TO_TEXTURE
-                pResolvedData += (width + 0x0ff) & ~0x0ff;
-#else
-                pResolvedData += width;
-#endif
+            // measure requests (and optionally those for tiles that were not resident) using the raw feedback
+            // skipped unless reclaim needs importance or the late-region rate was requested
+            const bool countLate = m_pTileUpdateManager->GetLateRegionStatisticsEnabled();
+            if (countLate || m_pTileUpdateManager->GetReclaimEnabled())
+            {
+                CountFeedbackRegions(pResolvedData, rowPitch, countLate);
+            }
 
-            } // end loop over y
+            // optionally widen feedback to neighboring regions
+            const UINT8* pFeedback = pResolvedData;
+            if (m_pTileUpdateManager->GetFeedbackDilationRadius())
+            {
+                pFeedback = DilateFeedback(pResolvedData, rowPitch);
+                rowPitch = m_dilationPitch;
+            }
 
-            D3D12_RANGE emptyRange{ 0,0 };
-            pResolvedResource->Unmap(0, &emptyRange);
+            if (m_pTileUpdateManager->GetPrefetchEnabled())
+            {
+                changed = ProcessFeedbackPrefetch(pFeedback, rowPitch);
+            }
+            else
+            {
+                // coarsen requests if the heap is under pressure
+                const UINT bias = m_pHeap->GetFeedbackMipBias();
+                const UINT reclaimMip = m_reclaimMip;
+                UINT numClamped = 0;
+
+                TileReference* pTileRow = m_tileReferences.data();
+                for (UINT y = 0; y < height; y++)
+                {
+                    for (UINT x = 0; x < width; x++)
+                    {
+                        // clamp to the maximum we are tracking (not tracking packed mips)
+                        const UINT requested = pFeedback[x] + bias;
+                        numClamped += (requested < reclaimMip);
+                        UINT8 desired = (UINT8)std::min(std::max(requested, reclaimMip), (UINT)m_maxMip);
+                        UINT8 initialValue = pTileRow[x];
+                        if (desired != initialValue) { changed = true; }
+                        SetMinMip(initialValue, x, y, desired);
+                        pTileRow[x] = desired;
+                    } // end loop over x
+                    pTileRow += width;
+                    pFeedback += rowPitch;
+                } // end loop over y
+                m_numClampedRegions = numClamped;
+            }
+
+            m_resources->UnmapFeedback(feedbackIndex);
         }
 
         // if there was a change, then it's no longer "zeroed"
@@ -447,11 +557,20 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
             m_refCountsZero = false;
         }
 
-        // abandon pending loads that are no longer relevant
-        AbandonPendingLoads();
+        // loads and evictions that are no longer relevant have a stale generation and are dropped when dequeued
+        // however, if the heap is full, pending loads are not dequeued
+        if ((m_pendingTileLoads.size() + m_pendingPrefetchLoads.size()) > (2 * m_numLivePendingLoads))
+        {
+            DropStalePendingLoads();
+        }
 
-        // clear pending evictions that are no longer relevant
-        m_pendingEvictions.Rescue(m_tileMappingState);
+        // prefetch references were released if the heap is full.
+        // remaining (live) loads are for tiles that feedback now requires, so promote them
+        if (m_pendingPrefetchLoads.size() && (m_pHeap->GetAllocator().GetAvailable() < GetPrefetchHeapReserve()))
+        {
+            m_pendingTileLoads.insert(m_pendingTileLoads.end(), m_pendingPrefetchLoads.begin(), m_pendingPrefetchLoads.end());
+            m_pendingPrefetchLoads.clear();
+        }
     }
 
     // update min mip map to adjust to new references
@@ -463,28 +582,433 @@ void Streaming::StreamingResourceBase::ProcessFeedback(UINT64 in_frameFenceCompl
 }
 
 //-----------------------------------------------------------------------------
-// drop pending loads that are no longer relevant
+// count regions with a request, and optionally regions where the gpu wanted a mip that was not resident
+// uses the raw (not dilated) feedback, so rates with and without dilation are comparable
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::AbandonPendingLoads()
+void Streaming::StreamingResourceBase::CountFeedbackRegions(const UINT8* in_pResolvedData, UINT in_rowPitch, bool in_countLate)
 {
-    UINT numPending = (UINT)m_pendingTileLoads.size();
-    for (UINT i = 0; i < numPending;)
+    const UINT width = GetNumTilesWidth();
+    const UINT height = GetNumTilesHeight();
+
+    UINT numRegions = 0;
+    UINT numLate = 0;
+    for (UINT y = 0; y < height; y++)
     {
-        auto& c = m_pendingTileLoads[i];
-        if (m_tileMappingState.GetRefCount(c))
+        if (in_countLate)
         {
-            i++; // refcount still non-0, still want to load this tile
+            for (UINT x = 0; x < width; x++)
+            {
+                UINT8 desired = in_pResolvedData[x];
+                if (desired < m_maxMip)
+                {
+                    numRegions++;
+                    if (TileMappingState::Residency::Resident != m_tileMappingState.GetResidency(x >> desired, y >> desired, desired))
+                    {
+                        numLate++;
+                    }
+                }
+            }
         }
-        // on abandon, swap a later tile in and re-try the check
-        // this re-orders the queue, but we can tolerate that
-        // because the residency map is built bottom-up
         else
         {
-            numPending--;
-            c = m_pendingTileLoads[numPending];
+            for (UINT x = 0; x < width; x++)
+            {
+                numRegions += (in_pResolvedData[x] < m_maxMip);
+            }
+        }
+        in_pResolvedData += in_rowPitch;
+    }
+
+    if (in_countLate)
+    {
+        m_pTileUpdateManager->AddFeedbackStatistics(numRegions, numLate);
+    }
+    m_numVisibleRegions = numRegions;
+}
+
+//-----------------------------------------------------------------------------
+// resources that cover more of the screen are more important
+// resources that have not been visible recently (no feedback) are less important
+//-----------------------------------------------------------------------------
+float Streaming::StreamingResourceBase::GetImportance(UINT64 in_frameFenceValue) const
+{
+    UINT64 age = (in_frameFenceValue > m_feedbackFenceValue) ? (in_frameFenceValue - m_feedbackFenceValue) : 0;
+    return float(m_numVisibleRegions) / float(1 + age);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UINT Streaming::StreamingResourceBase::GetCoarsestPendingLoad() const
+{
+    UINT mip = 0;
+    for (const auto& t : m_pendingTileLoads)
+    {
+        if (t.m_generation == m_tileMappingState.GetGeneration(t.m_coord))
+        {
+            mip = std::max(mip, t.m_coord.Subresource);
+        }
+    }
+    return mip;
+}
+
+//-----------------------------------------------------------------------------
+// counts are kept up to date as references change, so this is O(# mips) rather than O(# tiles)
+// a referenced tile holds heap space or is a pending load. releasing either reduces the shortfall by 1
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::GetReclaimCandidate(ReclaimPolicy::Candidate& out_candidate, UINT64 in_frameFenceValue) const
+{
+    out_candidate.m_importance = GetImportance(in_frameFenceValue);
+    out_candidate.m_maxMip = m_maxMip;
+    out_candidate.m_numTiles.assign(m_numReferencedTiles.begin(), m_numReferencedTiles.end());
+
+    UINT finestMip = 0;
+    while ((finestMip < m_maxMip) && (0 == m_numReferencedTiles[finestMip]))
+    {
+        finestMip++;
+    }
+    out_candidate.m_finestMip = finestMip;
+}
+
+//-----------------------------------------------------------------------------
+// relaxing lets clamped regions request m_reclaimMip - 1. a tile of that mip covers 4^mip regions,
+// so the # tiles is estimated from the clamped regions assuming they are contiguous
+//-----------------------------------------------------------------------------
+bool Streaming::StreamingResourceBase::GetClampedDemand(float& out_value, UINT& out_numTiles, UINT64 in_frameFenceValue) const
+{
+    if ((0 == m_reclaimMip) || (0 == m_numClampedRegions))
+    {
+        return false;
+    }
+
+    const UINT mip = m_reclaimMip - 1U;
+    out_value = ReclaimPolicy::GetValue(GetImportance(in_frameFenceValue), mip);
+    out_numTiles = (m_numClampedRegions + (1U << (2 * mip)) - 1) >> (2 * mip);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// release references to the finest mips, top-down (finest first), exactly as if feedback had requested in_mip
+// the tiles are evicted via the usual delay, so the min mip map is updated before their mappings are removed
+// until relaxed, feedback for mips finer than in_mip is ignored
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::Reclaim(UINT8 in_mip)
+{
+    m_reclaimMip = std::min(std::max(m_reclaimMip, in_mip), m_maxMip);
+
+    const UINT width = GetNumTilesWidth();
+    const UINT height = GetNumTilesHeight();
+
+    bool changed = false;
+    UINT tileIndex = 0;
+    for (UINT y = 0; y < height; y++)
+    {
+        for (UINT x = 0; x < width; x++)
+        {
+            UINT8 initialValue = m_tileReferences[tileIndex];
+            if (initialValue < m_reclaimMip)
+            {
+                changed = true;
+                SetMinMip(initialValue, x, y, m_reclaimMip);
+                m_tileReferences[tileIndex] = m_reclaimMip;
+                // any speculative references were released
+                if (m_prefetchMips.size()) { m_prefetchMips[tileIndex] = m_maxMip; }
+            }
+            tileIndex++;
+        }
+    }
+
+    if (changed)
+    {
+        SetResidencyChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// min-filter feedback over a (2r+1)x(2r+1) neighborhood of regions
+// neighbors receive the minimum plus a bias that depends on the minimum, e.g. with bias 1 the neighbors of a mip 0 region want mip 1
+// separable: horizontal pass into m_dilationScratch, vertical pass into m_dilatedFeedback
+// each pass processes 16 regions at a time
+//-----------------------------------------------------------------------------
+const UINT8* Streaming::StreamingResourceBase::DilateFeedback(const UINT8* in_pResolvedData, UINT in_rowPitch)
+{
+    const UINT width = GetNumTilesWidth();
+    const UINT height = GetNumTilesHeight();
+    const UINT radius = m_pTileUpdateManager->GetFeedbackDilationRadius();
+    const UINT8* pDilationMips = m_pTileUpdateManager->GetFeedbackDilationMips(); // null if no bias
+
+    const UINT simdWidth = sizeof(__m128i);
+    m_dilationPitch = (width + simdWidth - 1) & ~(simdWidth - 1);
+    m_dilationScratch.resize(m_dilationPitch * height);
+    m_dilatedFeedback.resize(m_dilationPitch * height);
+
+    // out-of-bounds regions must not contribute, so pad with the coarsest possible value
+    m_dilationRow.assign(m_dilationPitch + (2 * radius), 0xff);
+
+    // horizontal pass
+    const UINT8* pSrc = in_pResolvedData;
+    for (UINT y = 0; y < height; y++)
+    {
+        memcpy(&m_dilationRow[radius], pSrc, width);
+        BYTE* pDst = &m_dilationScratch[y * m_dilationPitch];
+        for (UINT x = 0; x < width; x += simdWidth)
+        {
+            const BYTE* pWindow = &m_dilationRow[x];
+            __m128i m = _mm_loadu_si128((const __m128i*)pWindow);
+            for (UINT i = 1; i <= 2 * radius; i++)
+            {
+                m = _mm_min_epu8(m, _mm_loadu_si128((const __m128i*)(pWindow + i)));
+            }
+            _mm_store_si128((__m128i*)(pDst + x), m);
+        }
+        pSrc += in_rowPitch;
+    }
+
+    // vertical pass, then apply the per-mip bias. the original value of a region is always kept
+    pSrc = in_pResolvedData;
+    for (UINT y = 0; y < height; y++)
+    {
+        const UINT y0 = (y > radius) ? y - radius : 0;
+        const UINT y1 = std::min(y + radius, height - 1);
+
+        BYTE* pDst = &m_dilatedFeedback[y * m_dilationPitch];
+        for (UINT x = 0; x < width; x += simdWidth)
+        {
+            __m128i m = _mm_load_si128((const __m128i*)&m_dilationScratch[y0 * m_dilationPitch + x]);
+            for (UINT i = y0 + 1; i <= y1; i++)
+            {
+                m = _mm_min_epu8(m, _mm_load_si128((const __m128i*)&m_dilationScratch[i * m_dilationPitch + x]));
+            }
+            _mm_store_si128((__m128i*)(pDst + x), m);
+        }
+
+        if (pDilationMips)
+        {
+            // table lookup per region. SSE2 has no byte shuffle, and this is one pass vs. 2r+1 per filter pass
+            for (UINT x = 0; x < width; x++)
+            {
+                pDst[x] = std::min(pSrc[x], pDilationMips[pDst[x]]);
+            }
+        }
+        pSrc += in_rowPitch;
+    }
+
+    return m_dilatedFeedback.data();
+}
+
+//-----------------------------------------------------------------------------
+// drop pending loads that are no longer relevant
+// called only when most pending loads are stale, so amortized cost is O(1) per load
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::DropStalePendingLoads()
+{
+    for (auto p : { &m_pendingTileLoads, &m_pendingPrefetchLoads })
+    {
+        auto& pendingLoads = *p;
+        UINT numPending = (UINT)pendingLoads.size();
+        for (UINT i = 0; i < numPending;)
+        {
+            auto& t = pendingLoads[i];
+            if (t.m_generation == m_tileMappingState.GetGeneration(t.m_coord))
+            {
+                i++; // still want to load this tile
+            }
+            // on abandon, swap a later tile in and re-try the check
+            // this re-orders the queue, but we can tolerate that
+            // because the residency map is built bottom-up
+            else
+            {
+                numPending--;
+                t = pendingLoads[numPending];
+            }
         }
+        pendingLoads.resize(numPending);
     }
-    m_pendingTileLoads.resize(numPending);
+}
+
+//-----------------------------------------------------------------------------
+// the ProcessFeedback thread only needs to visit resources with work it can act on
+//-----------------------------------------------------------------------------
+bool Streaming::StreamingResourceBase::IsStale()
+{
+    return (m_pendingEvictions.HasReady() ||
+        (m_numLivePendingLoads && (m_pendingTileLoads.size() ||
+            // prefetches are only actionable if there is heap space beyond the reserve
+            (m_pendingPrefetchLoads.size() && (m_pHeap->GetAllocator().GetAvailable() > GetPrefetchHeapReserve())))));
+}
+
+//-----------------------------------------------------------------------------
+// heap space that prefetch may not use
+// if fewer tiles than this are available, all prefetched tiles are released
+//-----------------------------------------------------------------------------
+UINT Streaming::StreamingResourceBase::GetPrefetchHeapReserve() const
+{
+    return m_pHeap->GetAllocator().GetCapacity() / 8;
+}
+
+//-----------------------------------------------------------------------------
+// drop all speculative state. refcounts are handled by the caller
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::ClearPrefetch()
+{
+    m_pendingPrefetchLoads.clear();
+    m_feedbackMotion.m_valid = false;
+    m_prefetchMips.assign(m_prefetchMips.size(), m_maxMip);
+}
+
+//-----------------------------------------------------------------------------
+// fold feedback into the tile references, adding speculative references
+//
+// the feedback "center of mass" (weighted towards finer mips) moves with the camera in region space.
+// predict the next desired mip of each region by sampling the current feedback against the direction of motion,
+// and one mip finer if the average desired mip is trending finer (e.g. approaching an object)
+// regions where the prediction is finer than feedback get references to the additional mips
+//
+// loads of speculative tiles are low priority (see QueueTiles())
+// if the heap is nearly full, predictions stop and speculative references are released,
+// so prefetched tiles are the first to be evicted
+//
+// returns true if any tile references changed
+//-----------------------------------------------------------------------------
+bool Streaming::StreamingResourceBase::ProcessFeedbackPrefetch(const UINT8* in_pFeedback, UINT in_rowPitch)
+{
+    const UINT width = GetNumTilesWidth();
+    const UINT height = GetNumTilesHeight();
+
+    //------------------------------------------------------------------
+    // copy feedback, clamped to the maximum we are tracking, and measure it
+    //------------------------------------------------------------------
+    FeedbackMotion motion;
+    {
+        // coarsen requests if the heap is under pressure
+        const UINT bias = m_pHeap->GetFeedbackMipBias();
+        const UINT reclaimMip = m_reclaimMip;
+
+        float sumWeight = 0;
+        float sumX = 0;
+        float sumY = 0;
+        UINT sumMip = 0;
+        UINT numVisible = 0;
+        UINT numClamped = 0;
+
+        const UINT8* pFeedback = in_pFeedback;
+        TileReference* pFeedbackRow = m_feedbackMips.data();
+        for (UINT y = 0; y < height; y++)
+        {
+            for (UINT x = 0; x < width; x++)
+            {
+                const UINT requested = pFeedback[x] + bias;
+                numClamped += (requested < reclaimMip);
+                UINT8 desired = (UINT8)std::min(std::max(requested, reclaimMip), (UINT)m_maxMip);
+                pFeedbackRow[x] = desired;
+                if (desired < m_maxMip)
+                {
+                    float weight = float(m_maxMip - desired);
+                    sumWeight += weight;
+                    sumX += weight * x;
+                    sumY += weight * y;
+                    sumMip += desired;
+                    numVisible++;
+                }
+            }
+            pFeedbackRow += width;
+            pFeedback += in_rowPitch;
+        }
+        m_numClampedRegions = numClamped;
+
+        if (numVisible)
+        {
+            motion.m_centroidX = sumX / sumWeight;
+            motion.m_centroidY = sumY / sumWeight;
+            motion.m_meanMip = float(sumMip) / float(numVisible);
+            motion.m_valid = true;
+        }
+    }
+
+    //------------------------------------------------------------------
+    // compare against the previous feedback to get motion and mip trend
+    //------------------------------------------------------------------
+    INT dx = 0;
+    INT dy = 0;
+    bool finer = false;
+    bool predict = false;
+    if (motion.m_valid && m_feedbackMotion.m_valid &&
+        (m_pHeap->GetAllocator().GetAvailable() >= GetPrefetchHeapReserve()))
+    {
+        // large jumps are more likely a change of view (or new objects in view) than motion
+        const float maxMotion = 4.0f; // in regions
+        const float minMipTrend = 0.05f;
+
+        float moveX = motion.m_centroidX - m_feedbackMotion.m_centroidX;
+        float moveY = motion.m_centroidY - m_feedbackMotion.m_centroidY;
+        if ((moveX >= -maxMotion) && (moveX <= maxMotion) && (moveY >= -maxMotion) && (moveY <= maxMotion))
+        {
+            // round to nearest region
+            dx = INT(moveX + ((moveX < 0) ? -0.5f : 0.5f));
+            dy = INT(moveY + ((moveY < 0) ? -0.5f : 0.5f));
+            finer = motion.m_meanMip < (m_feedbackMotion.m_meanMip - minMipTrend);
+            predict = dx || dy || finer;
+        }
+    }
+    m_feedbackMotion = motion;
+
+    //------------------------------------------------------------------
+    // update the refcount of each tile based on feedback + prediction
+    //------------------------------------------------------------------
+    bool changed = false;
+    UINT numRequests = 0;
+    UINT numHits = 0;
+
+    UINT tileIndex = 0;
+    for (UINT y = 0; y < height; y++)
+    {
+        for (UINT x = 0; x < width; x++)
+        {
+            const UINT8 desired = m_feedbackMips[tileIndex];
+
+            // did feedback come to request what was prefetched?
+            UINT8 prefetched = m_prefetchMips[tileIndex];
+            if ((prefetched < m_maxMip) && (desired <= prefetched))
+            {
+                numHits++;
+                prefetched = m_maxMip;
+            }
+
+            UINT8 target = desired;
+            if (predict)
+            {
+                INT sx = std::clamp(INT(x) - dx, 0, INT(width) - 1);
+                INT sy = std::clamp(INT(y) - dy, 0, INT(height) - 1);
+                UINT8 predicted = m_feedbackMips[sy * width + sx];
+                if (finer && predicted && (predicted < m_maxMip))
+                {
+                    predicted--;
+                }
+                target = std::min(target, predicted);
+            }
+
+            if (target < desired)
+            {
+                if (target < prefetched) { numRequests++; }
+                m_prefetchMips[tileIndex] = target;
+            }
+            else
+            {
+                m_prefetchMips[tileIndex] = m_maxMip;
+            }
+
+            UINT8 initialValue = m_tileReferences[tileIndex];
+            if (target != initialValue) { changed = true; }
+            // mips finer than desired are speculative
+            SetMinMip(initialValue, x, y, target, desired);
+            m_tileReferences[tileIndex] = target;
+
+            tileIndex++;
+        } // end loop over x
+    } // end loop over y
+
+    m_pTileUpdateManager->AddPrefetchStatistics(numRequests, numHits, 0);
+
+    return changed;
 }
 
 //-----------------------------------------------------------------------------
@@ -497,16 +1021,30 @@ UINT Streaming::StreamingResourceBase::QueueTiles()
     UINT uploadsRequested = 0;
 
     // pushes as many tiles as it can into a single UpdateList
-    if (m_pendingTileLoads.size() && m_pHeap->GetAllocator().GetAvailable())
+    if ((m_pendingTileLoads.size() || m_pendingPrefetchLoads.size()) && m_pHeap->GetAllocator().GetAvailable())
     {
         UpdateList scratchUL;
 
         // queue as many new tiles as possible
-        QueuePendingTileLoads(&scratchUL);
+        if (m_pendingTileLoads.size())
+        {
+            QueuePendingTileLoads(&scratchUL, m_pendingTileLoads, m_pHeap->GetAllocator().GetAvailable());
+        }
+
+        // prefetch only with heap space that remains beyond the reserve
+        const UINT numAvailable = m_pHeap->GetAllocator().GetAvailable();
+        const UINT reserve = GetPrefetchHeapReserve();
+        if (m_pendingPrefetchLoads.size() && (numAvailable > reserve))
+        {
+            UINT numRequired = (UINT)scratchUL.m_coords.size();
+            QueuePendingTileLoads(&scratchUL, m_pendingPrefetchLoads, numAvailable - reserve);
+            m_pTileUpdateManager->AddPrefetchStatistics(0, 0, (UINT)scratchUL.m_coords.size() - numRequired);
+        }
+
         uploadsRequested = (UINT)scratchUL.m_coords.size(); // number of uploads in UpdateList
 
         // only allocate an UpdateList if we have updates
-        if (scratchUL.m_coords.size())
+        if (scratchUL.m_coords.size() || scratchUL.m_mapCoords.size())
         {
             // calling function checked for availability, so UL allocation must succeed
             UpdateList* pUpdateList = m_pTileUpdateManager->AllocateUpdateList(this);
@@ -514,6 +1052,8 @@ UINT Streaming::StreamingResourceBase::QueueTiles()
 
             pUpdateList->m_coords.swap(scratchUL.m_coords);
             pUpdateList->m_heapIndices.swap(scratchUL.m_heapIndices);
+            pUpdateList->m_mapCoords.swap(scratchUL.m_mapCoords);
+            pUpdateList->m_mapHeapIndices.swap(scratchUL.m_mapHeapIndices);
 
             m_pTileUpdateManager->SubmitUpdateList(*pUpdateList);
         }
@@ -564,21 +1104,28 @@ Note that the multi-frame delay for evictions prevents allocation of an index th
 //-----------------------------------------------------------------------------
 UINT Streaming::StreamingResourceBase::QueuePendingTileEvictions()
 {
-    if (0 == m_pendingEvictions.GetReadyToEvict().size()) { return 0; }
+    if (!m_pendingEvictions.HasReady()) { return 0; }
 
-    auto& pendingEvictions = m_pendingEvictions.GetReadyToEvict();
-
-    UINT numDelayed = 0;
     UINT numEvictions = 0;
-    for (auto& coord : pendingEvictions)
+
+    // visit each eviction at most once. delayed evictions are re-queued at the back
+    PendingTile tile;
+    for (UINT numToVisit = m_pendingEvictions.GetNumPending(); numToVisit && m_pendingEvictions.PopReady(tile); numToVisit--)
     {
+        // stale? the tile was referenced again after this eviction was queued (it may have been released again since,
+        // in which case there is a newer eviction)
+        if (tile.m_generation != m_tileMappingState.GetGeneration(tile.m_coord))
+        {
+            continue;
+        }
+
+        const auto& coord = tile.m_coord;
+
         // if the heap index is valid, but the tile is not resident, there's a /pending load/
         // a pending load might be streaming OR it might be in the pending list
-        // if in the pending list, we will observe if the refcount is 0 and abandon the load
+        // if in the pending list, it is stale and will be abandoned
 
-        // NOTE! assumes refcount is 0
-        // ProcessFeedback() clears all pending evictions with refcount > 0
-        // Hence, ProcessFeedback() must be called before this function
+        // NOTE! the generation is unchanged, so refcount is 0
         ASSERT(0 == m_tileMappingState.GetRefCount(coord));
 
         auto residency = m_tileMappingState.GetResidency(coord);
@@ -591,7 +1138,12 @@ UINT Streaming::StreamingResourceBase::QueuePendingTileEvictions()
 
             m_tileMappingState.SetResidency(coord, TileMappingState::Residency::NotResident);
             UINT& heapIndex = m_tileMappingState.GetHeapIndex(coord);
-            m_pHeap->GetAllocator().Free(heapIndex);
+
+            // a shared tile stays in the heap while other resources map it
+            if ((nullptr == m_pSharedTiles) || m_pSharedTiles->Release(coord))
+            {
+                m_pHeap->GetAllocator().Free(heapIndex);
+            }
             heapIndex = TileMappingState::InvalidIndex;
 
             numEvictions++;
@@ -600,8 +1152,7 @@ UINT Streaming::StreamingResourceBase::QueuePendingTileEvictions()
         // try again later
         else if (TileMappingState::Residency::Loading == residency)
         {
-            pendingEvictions[numDelayed] = coord;
-            numDelayed++;
+            m_pendingEvictions.Delay(tile);
         }
         // if evicting or not resident, drop
 
@@ -610,11 +1161,10 @@ UINT Streaming::StreamingResourceBase::QueuePendingTileEvictions()
 
     if (numEvictions)
     {
+        m_pHeap->AddEvictions(numEvictions);
         SetResidencyChanged();
     }
 
-    // replace the ready evictions with just the delayed evictions.
-    pendingEvictions.resize(numDelayed);
     return numEvictions;
 }
 
@@ -623,39 +1173,78 @@ UINT Streaming::StreamingResourceBase::QueuePendingTileEvictions()
 // FIFO order: work from the front of the array
 // NOTE: greedy, takes every available UpdateList if it can
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::QueuePendingTileLoads(Streaming::UpdateList* out_pUpdateList)
+void Streaming::StreamingResourceBase::QueuePendingTileLoads(Streaming::UpdateList* out_pUpdateList,
+    std::vector<PendingTile>& in_pendingLoads, UINT in_maxCopies)
 {
     ASSERT(out_pUpdateList);
-    ASSERT(m_pHeap->GetAllocator().GetAvailable());
+    ASSERT(in_maxCopies);
+    ASSERT(in_maxCopies <= m_pHeap->GetAllocator().GetAvailable());
 
     // clamp to heap availability
-    UINT maxCopies = std::min((UINT)m_pendingTileLoads.size(), m_pHeap->GetAllocator().GetAvailable());
+    UINT maxCopies = std::min((UINT)in_pendingLoads.size(), in_maxCopies);
 
     UINT skippedIndex = 0;
     UINT numConsumed = 0;
-    for (auto& coord : m_pendingTileLoads)
+    for (auto& tile : in_pendingLoads)
     {
         numConsumed++;
 
+        // stale? the tile was released after this load was queued (it may have been referenced again since,
+        // in which case there is a newer load)
+        if (tile.m_generation != m_tileMappingState.GetGeneration(tile.m_coord))
+        {
+            continue;
+        }
+
+        const auto& coord = tile.m_coord;
+
         // if the heap index is not valid, but the tile is resident, there's a /pending eviction/
         // a pending eviction might be streaming
 
-        // NOTE! assumes refcount is non-zero
-        // ProcessFeedback() clears all pending loads with refcount == 0
-        // Hence, ProcessFeedback() must be called before this function
+        // NOTE! the generation is unchanged, so refcount is non-zero
         ASSERT(m_tileMappingState.GetRefCount(coord));
 
         auto residency = m_tileMappingState.GetResidency(coord);
-        // only load if definitely not resident
-        if (TileMappingState::Residency::NotResident == residency)
+
+        // shared storage: if another resource is loading this tile, wait for it. if it has loaded it, map it.
+        auto sharedState = SharedTileStorage::State::NotLoaded;
+        if (m_pSharedTiles && (TileMappingState::Residency::NotResident == residency))
         {
-            UINT heapIndex = m_pHeap->GetAllocator().Allocate();
+            sharedState = m_pSharedTiles->GetState(coord);
+        }
 
+        if (SharedTileStorage::State::Loading == sharedState)
+        {
+            // accumulate skipped tiles at front of the pending list
+            in_pendingLoads[skippedIndex] = tile;
+            skippedIndex++;
+        }
+        // only load if definitely not resident
+        else if (TileMappingState::Residency::NotResident == residency)
+        {
             m_tileMappingState.SetResidency(coord, TileMappingState::Residency::Loading);
-            m_tileMappingState.GetHeapIndex(coord) = heapIndex;
+            m_numLivePendingLoads--;
+
+            if (SharedTileStorage::State::Loaded == sharedState)
+            {
+                UINT heapIndex = m_pSharedTiles->AddRef(coord);
+                m_tileMappingState.GetHeapIndex(coord) = heapIndex;
+
+                out_pUpdateList->m_mapCoords.push_back(coord);
+                out_pUpdateList->m_mapHeapIndices.push_back(heapIndex);
+            }
+            else
+            {
+                UINT heapIndex = m_pHeap->GetAllocator().Allocate();
+                m_tileMappingState.GetHeapIndex(coord) = heapIndex;
+                if (m_pSharedTiles)
+                {
+                    m_pSharedTiles->BeginLoad(coord, heapIndex);
+                }
 
-            out_pUpdateList->m_coords.push_back(coord);
-            out_pUpdateList->m_heapIndices.push_back(heapIndex);
+                out_pUpdateList->m_coords.push_back(coord);
+                out_pUpdateList->m_heapIndices.push_back(heapIndex);
+            }
 
             // limit # of copies in a single updatelist
             maxCopies--;
@@ -668,18 +1257,16 @@ void Streaming::StreamingResourceBase::QueuePendingTileLoads(Streaming::UpdateLi
         else if (TileMappingState::Residency::Evicting == residency)
         {
             // accumulate skipped tiles at front of the pending list
-            m_pendingTileLoads[skippedIndex] = coord;
+            in_pendingLoads[skippedIndex] = tile;
             skippedIndex++;
         }
         // if loading or resident, drop
-
-        // else: refcount 0 or tile was rescued by QueuePendingTileEvictions()? abandon this load. also drops duplicate adds.
     }
 
     // delete consumed tiles, which are in-between the skipped tiles and the still-pending tiles
     if (numConsumed)
     {
-        m_pendingTileLoads.erase(m_pendingTileLoads.begin() + skippedIndex, m_pendingTileLoads.begin() + numConsumed);
+        in_pendingLoads.erase(in_pendingLoads.begin() + skippedIndex, in_pendingLoads.begin() + numConsumed);
     }
 }
 
@@ -692,10 +1279,9 @@ void Streaming::StreamingResourceBase::UpdateMinMipMap()
 {
     // m_tileResidencyChanged is an atomic that forms a happens-before relationship between this thread and DataUploader Notify* routines
     // m_tileResidencyChanged is also set when ClearAll() evicts everything
+    // clearing it allows the next change to add this resource to the dirty list again
 
-    if (!m_tileResidencyChanged) return;
-
-    m_tileResidencyChanged = false;
+    if (!m_tileResidencyChanged.exchange(false)) return;
 
     // FIXME? sometimes the notifications come out-of-order
     //ASSERT(m_packedMipsResident);
@@ -767,68 +1353,44 @@ void Streaming::StreamingResourceBase::UpdateMinMipMap()
 // class used to delay decmaps by a number of frames = # swap buffers
 // easy way to prevent decmapping an in-flight tile
 //=============================================================================
-Streaming::StreamingResourceBase::EvictionDelay::EvictionDelay(UINT in_numSwapBuffers)
+Streaming::StreamingResourceBase::EvictionDelay::EvictionDelay(UINT in_numSwapBuffers) :
+    // an eviction becomes ready after it has been through all but one of the (former) per-frame buckets
+    m_delay(in_numSwapBuffers - 1)
 {
-    m_mappings.resize(in_numSwapBuffers);
+    // start small: most resources rarely evict. Push() doubles the ring as needed, after which steady state doesn't reallocate
+    m_entries.resize(16);
 }
 
 //-----------------------------------------------------------------------------
-// step pending evictions once per frame
+// add to the back of the ring. if full, double its size
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::EvictionDelay::NextFrame()
+void Streaming::StreamingResourceBase::EvictionDelay::Push(const PendingTile& in_tile, UINT in_frame)
 {
-    // start with A, B, C
-    // after swaps, have C, A, B
-    // then insert C, A, BC
-    // then clear 0, A, BC
-    UINT lastMapping = (UINT)m_mappings.size() - 1;
-    for (UINT i = lastMapping; i > 0; i--)
+    UINT size = (UINT)m_entries.size();
+    if (size == m_count)
     {
-        m_mappings[i].swap(m_mappings[i - 1]);
+        // unwrap so the entries are contiguous from the front, then grow
+        std::rotate(m_entries.begin(), m_entries.begin() + m_head, m_entries.end());
+        m_head = 0;
+        size *= 2;
+        m_entries.resize(size);
     }
-    m_mappings.back().insert(m_mappings.back().end(), m_mappings[0].begin(), m_mappings[0].end());
-    m_mappings[0].clear();
+    m_entries[(m_head + m_count) & (size - 1)] = { in_tile, in_frame };
+    m_count++;
 }
 
 //-----------------------------------------------------------------------------
-// dump all pending evictions. return heap indices to heap
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::EvictionDelay::Clear()
+bool Streaming::StreamingResourceBase::EvictionDelay::PopReady(PendingTile& out_tile)
 {
-    for (auto& i : m_mappings)
+    if (!HasReady())
     {
-        i.clear();
-    }
-}
-
-//-----------------------------------------------------------------------------
-// drop pending evictions for tiles that now have non-zero refcount
-//-----------------------------------------------------------------------------
-void Streaming::StreamingResourceBase::EvictionDelay::Rescue(const Streaming::StreamingResourceBase::TileMappingState& in_tileMappingState)
-{
-    // note: it is possible even for the most recent evictions to have refcount > 0
-    // because a tile can be evicted then loaded again within a single ProcessFeedback() call
-    for (auto& evictions : m_mappings)
-    {
-        UINT numPending = (UINT)evictions.size();
-        for (UINT i = 0; i < numPending;)
-        {
-            auto& c = evictions[i];
-            // on rescue, swap a later tile in and re-try the check
-            // this re-orders the queue, but we can tolerate that
-            // because the residency map is built bottom-up
-            if (in_tileMappingState.GetRefCount(c))
-            {
-                numPending--;
-                c = evictions[numPending];
-            }
-            else // refcount still 0, this tile may still be evicted
-            {
-                i++;
-            }
-        }
-        evictions.resize(numPending);
+        return false;
     }
+    out_tile = m_entries[m_head].m_tile;
+    m_head = (m_head + 1) & ((UINT)m_entries.size() - 1);
+    m_count--;
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -836,7 +1398,7 @@ void Streaming::StreamingResourceBase::EvictionDelay::Rescue(const Streaming::St
 void Streaming::StreamingResourceBase::LoadPackedMips()
 {
     UINT numBytes = 0;
-    UINT offset = m_textureFileInfo.GetPackedMipFileOffset(&numBytes, &m_packedMipsUncompressedSize);
+    UINT offset = m_pTextureFileInfo->GetPackedMipFileOffset(&numBytes, &m_packedMipsUncompressedSize);
     m_packedMips.resize(numBytes);
     std::ifstream inFile(m_filename.c_str(), std::ios::binary);
     inFile.seekg(offset);
@@ -864,6 +1426,14 @@ bool Streaming::StreamingResourceBase::InitPackedMips()
         return true;
     }
 
+    // no packed mips. odd, but possible. no need to check/update this variable again.
+    // not set during Initialize(): an asynchronous resource must not report resident before it has a residency map
+    if (0 == m_resources->GetPackedMipInfo().NumTilesForPackedMips)
+    {
+        m_packedMipStatus = PackedMipStatus::RESIDENT;
+        return true;
+    }
+
     // allocate heap space
     // only allocate if all required tiles can be allocated at once
     if ((PackedMipStatus::HEAP_RESERVED > m_packedMipStatus) &&
@@ -926,6 +1496,20 @@ void Streaming::StreamingResourceBase::ResolveFeedback(ID3D12GraphicsCommandList
     m_resources->ResolveFeedback(out_pCmdList, m_readbackIndex);
 }
 
+//-----------------------------------------------------------------------------
+// software device: the feedback is ready when the frame fence says the frame completed, as for a resolve
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceBase::WriteFeedback(const BYTE* in_pMinMips)
+{
+    m_readbackIndex = (m_readbackIndex + 1) % m_queuedFeedback.size();
+
+    m_resources->WriteFeedback(m_readbackIndex, in_pMinMips);
+
+    auto& f = m_queuedFeedback[m_readbackIndex];
+    f.m_renderFenceForFeedback = m_pTileUpdateManager->GetFrameFenceValue();
+    f.m_feedbackQueued = true;
+}
+
 #if RESOLVE_TO_TEXTURE
 //-----------------------------------------------------------------------------
 // call after resolving to read back to CPU
@@ -944,15 +1528,16 @@ void Streaming::StreamingResourceBase::ClearAllocations()
 {
     ASSERT(!m_pTileUpdateManager->GetWithinFrame());
 
-    m_pTileUpdateManager->Finish();
-
-    m_tileMappingState.FreeHeapAllocations(m_pHeap);
+    // NOTE: TUM::SetVisualizationMode() has already stopped the streaming threads and drained the DataUploader
+    m_tileMappingState.FreeHeapAllocations(m_pHeap, m_pSharedTiles.get());
     m_tileMappingState.Init(m_resources->GetPackedMipInfo().NumStandardMips, m_resources->GetTiling());
     m_tileReferences.assign(m_tileReferences.size(), m_maxMip);
     m_minMipMap.assign(m_minMipMap.size(), m_maxMip);
 
     m_pendingEvictions.Clear();
     m_pendingTileLoads.clear();
+    ClearPrefetch();
+    m_numLivePendingLoads = 0;
 
     // want to upload a residency of all maxMip
     // NOTE: UpdateMinMipMap() will see there are no tiles resident,
@@ -34,10 +34,13 @@ Base class for StreamingResource
 #include <vector>
 #include <d3d12.h>
 #include <string>
+#include <memory>
 
 #include "SamplerFeedbackStreaming.h"
 #include "InternalResources.h"
 #include "XeTexture.h"
+#include "ReclaimPolicy.h"
+#include "SimpleAllocator.h" // for DirtyList
 
 namespace Streaming
 {
@@ -45,6 +48,7 @@ namespace Streaming
     struct UpdateList;
     class Heap;
     class FileHandle;
+    class SharedTileStorage;
 
     //=============================================================================
     // unpacked mips are dynamically loaded/evicted, preserving a min-mip-map
@@ -78,6 +82,10 @@ namespace Streaming
             Streaming::TileUpdateManagerSR* in_pTileUpdateManager,
             Heap* in_pHeap);
 
+        // reads the file. must complete before the resource is handed to the streaming threads
+        void Initialize();
+        bool GetInitialized() const { return m_initialized.load(std::memory_order_acquire); }
+
         virtual ~StreamingResourceBase();
 
         // called whenever a new StreamingResource is created - even one other than "this"
@@ -109,6 +117,9 @@ namespace Streaming
         // call after drawing to get feedback
         void ResolveFeedback(ID3D12GraphicsCommandList1* out_pCmdList);
 
+        // software device: instead of a resolve, copy feedback provided by the application (GetNumTilesWidth() x GetNumTilesHeight() bytes)
+        void WriteFeedback(const BYTE* in_pMinMips);
+
 #if RESOLVE_TO_TEXTURE
         // call after resolving to read back to CPU
         void ReadbackFeedback(ID3D12GraphicsCommandList* out_pCmdList);
@@ -139,33 +150,70 @@ namespace Streaming
         // returns # tiles evicted
         UINT QueuePendingTileEvictions();
 
-        bool IsStale()
-        {
-            return (m_pendingTileLoads.size() || m_pendingEvictions.GetReadyToEvict().size());
-        }
+        // returns true if there are loads or evictions that can be acted upon
+        bool IsStale();
 
         bool InitPackedMips();
 
+        // true while in the ProcessFeedback thread's list of stale resources
+        bool GetStaleQueued() const { return m_staleQueued; }
+        void SetStaleQueued(bool in_queued) { m_staleQueued = in_queued; }
+
         //-------------------------------------
         // end called by TUM::ProcessFeedbackThread
         //-------------------------------------
 
         // immediately evicts all except packed mips
-        // called by TUM::SetVisualizationMode()
+        // called by TUM::SetVisualizationMode() after the streaming threads have stopped
         void ClearAllocations();
 
+        // called by TUM when removing this resource
+        UINT GetNumUpdateListsInFlight() const { return m_numUpdateListsInFlight; }
+        void FreeHeapAllocations();
+
         UINT GetNumTilesWidth() const { return m_tileReferencesWidth; }
         UINT GetNumTilesHeight() const { return m_tileReferencesHeight; }
 
+        // used by TUM to control heap occupancy
+        Streaming::Heap* GetHeap() const { return m_pHeap; }
+        UINT GetNumPendingLoads() const { return m_numLivePendingLoads; }
+        UINT GetNumPendingEvictions() const { return m_pendingEvictions.GetNumPending(); }
+
+        //-------------------------------------
+        // heap pressure: reclaim referenced tiles. called by TUM::ProcessFeedbackThread
+        //-------------------------------------
+        // visible area (in regions) reduced by # frames since feedback was last processed
+        float GetImportance(UINT64 in_frameFenceValue) const;
+
+        // coarsest mip among pending loads (only valid if there are pending loads)
+        UINT GetCoarsestPendingLoad() const;
+
+        // fill in the # referenced tiles per mip. O(# mips)
+        void GetReclaimCandidate(ReclaimPolicy::Candidate& out_candidate, UINT64 in_frameFenceValue) const;
+
+        // release references to mips finer than in_mip, and ignore feedback for them until relaxed
+        void Reclaim(UINT8 in_mip);
+
+        // if the most recent feedback asked for mips finer than the reclaim mip, the value of relaxing by one mip
+        // and an estimate of the # tiles it would load. returns false if feedback was not clamped
+        bool GetClampedDemand(float& out_value, UINT& out_numTiles, UINT64 in_frameFenceValue) const;
+
+        // allow feedback to request one mip finer than the current reclaim mip
+        void RelaxReclaim() { if (m_reclaimMip) { m_reclaimMip--; } }
+        UINT8 GetReclaimMip() const { return m_reclaimMip; }
+
     protected:
         const std::wstring m_filename;
 
         // object that streams data from a file
-        const Streaming::XeTexture m_textureFileInfo;
+        std::unique_ptr<Streaming::XeTexture> m_pTextureFileInfo;
         std::unique_ptr<Streaming::InternalResources> m_resources;
         std::unique_ptr<Streaming::FileHandle> m_pFileHandle;
         Streaming::Heap* m_pHeap{ nullptr };
 
+        // tiles shared with other resources created from the same file. null if sharing is disabled
+        std::shared_ptr<Streaming::SharedTileStorage> m_pSharedTiles;
+
         // packed mip status
         enum class PackedMipStatus : UINT32
         {
@@ -177,6 +225,8 @@ namespace Streaming
         };
         PackedMipStatus m_packedMipStatus{ PackedMipStatus::UNINITIALIZED };
 
+        std::atomic<bool> m_initialized{ false }; // set by Initialize(), possibly on a loader thread
+
         UINT m_packedMipsUncompressedSize{ 0 };
 
         // bytes for packed mips
@@ -224,6 +274,11 @@ namespace Streaming
 
             UINT32& GetHeapIndex(const D3D12_TILED_RESOURCE_COORDINATE& in_coord) { return m_heapIndices[in_coord.Subresource][in_coord.Y][in_coord.X]; }
 
+            // incremented whenever the refcount changes between 0 and non-0
+            // pending loads and evictions record the generation when queued. if it has changed since, they are stale
+            UINT32 NextGeneration(UINT x, UINT y, UINT s) { return ++m_generations[s][y][x]; }
+            UINT32 GetGeneration(const D3D12_TILED_RESOURCE_COORDINATE& in_coord) const { return m_generations[in_coord.Subresource][in_coord.Y][in_coord.X]; }
+
             // checks refcount of bottom-most non-packed tile(s). If none are in use, we know nothing is resident.
             // used in UpdateMinMipMap()
             bool GetAnyRefCount();
@@ -233,7 +288,7 @@ namespace Streaming
             UINT8 GetMinResidentMip();
 
             // remove all mappings from a heap. useful when removing an object from a scene
-            void FreeHeapAllocations(Streaming::Heap* in_pHeap);
+            void FreeHeapAllocations(Streaming::Heap* in_pHeap, SharedTileStorage* in_pSharedTiles);
 
             UINT GetWidth(UINT in_s) const { return (UINT)m_resident[in_s][0].size(); }
             UINT GetHeight(UINT in_s) const { return (UINT)m_resident[in_s].size(); }
@@ -247,6 +302,7 @@ namespace Streaming
             TileLayer<BYTE> m_resident;
             TileLayer<UINT32> m_refcounts;
             TileLayer<UINT32> m_heapIndices;
+            TileLayer<UINT32> m_generations;
         };
         TileMappingState m_tileMappingState;
 
@@ -261,28 +317,65 @@ namespace Streaming
         std::atomic<bool> m_setZeroRefCounts{ false };
 
     private:
+        // a queued load or eviction, valid only while the tile's generation is unchanged
+        struct PendingTile
+        {
+            D3D12_TILED_RESOURCE_COORDINATE m_coord;
+            UINT32 m_generation;
+        };
+
         // do not immediately decmap:
         // need to withhold until in-flight command buffers have completed
+        // FIFO stamped with the frame of each eviction, in a ring that only grows if full (steady state does not reallocate)
         class EvictionDelay
         {
         public:
             EvictionDelay(UINT in_numSwapBuffers);
 
-            using MappingCoords = std::vector<D3D12_TILED_RESOURCE_COORDINATE>;
-            void Append(D3D12_TILED_RESOURCE_COORDINATE in_coord) { m_mappings[0].push_back(in_coord); }
-            MappingCoords& GetReadyToEvict() { return m_mappings.back(); }
+            void Append(const PendingTile& in_tile) { Push(in_tile, m_frame); }
+
+            // true if the oldest eviction has waited long enough
+            bool HasReady() const { return m_count && ((m_frame - m_entries[m_head].m_frame) >= m_delay); }
 
-            void NextFrame();
-            void Clear();
+            // remove the oldest eviction if it has waited long enough
+            bool PopReady(PendingTile& out_tile);
 
-            // drop pending evictions for tiles that now have non-zero refcount
-            void Rescue(const TileMappingState& in_tileMappingState);
+            // re-queue an eviction that can't complete yet. it is ready again when it reaches the front
+            void Delay(const PendingTile& in_tile) { Push(in_tile, m_frame - m_delay); }
+
+            void NextFrame() { m_frame++; }
+            void Clear() { m_head = 0; m_count = 0; }
+
+            // includes stale evictions
+            UINT GetNumPending() const { return m_count; }
         private:
-            std::vector<MappingCoords> m_mappings;
+            struct Entry
+            {
+                PendingTile m_tile;
+                UINT m_frame;
+            };
+            std::vector<Entry> m_entries; // size is a power of 2
+            UINT m_head{ 0 };
+            UINT m_count{ 0 };
+            UINT m_frame{ 0 };
+            const UINT m_delay;
+
+            void Push(const PendingTile& in_tile, UINT in_frame);
         };
         EvictionDelay m_pendingEvictions;
 
-        std::vector<D3D12_TILED_RESOURCE_COORDINATE> m_pendingTileLoads;
+        // stale loads are dropped when dequeued (see QueuePendingTileLoads())
+        std::vector<PendingTile> m_pendingTileLoads;
+
+        // loads due to prefetch. lower priority than m_pendingTileLoads
+        std::vector<PendingTile> m_pendingPrefetchLoads;
+
+        // # loads in the above that are not stale
+        UINT m_numLivePendingLoads{ 0 };
+
+        // per standard mip, # tiles with a non-0 refcount. maintained where refcounts change between 0 and non-0
+        // so heap pressure (GetReclaimCandidate) doesn't have to walk the tiles
+        std::vector<UINT> m_numReferencedTiles;
 
         //--------------------------------------------------------
         // for public interface
@@ -299,10 +392,20 @@ namespace Streaming
         std::vector<BYTE, Streaming::AlignedAllocator<BYTE>> m_minMipMap; // local version of min mip map, rectified in UpdateMinMipMap()
 
         // non-packed mip copy complete notification
+        // also indicates this resource is in the TUM's list of dirty resources
         std::atomic<bool> m_tileResidencyChanged{ false };
 
-        // drop pending loads that are no longer relevant
-        void AbandonPendingLoads();
+        // link for TileUpdateManagerBase::m_dirtyResources
+        friend class Streaming::DirtyList<StreamingResourceBase>;
+        StreamingResourceBase* m_pNextDirty{ nullptr };
+
+        // UpdateLists that reference this object. incremented on allocation, decremented by DataUploader when freed
+        std::atomic<UINT> m_numUpdateListsInFlight{ 0 };
+
+        bool m_staleQueued{ false }; // ProcessFeedback thread only
+
+        // stale loads that can't be dequeued (e.g. the heap is full) accumulate. compact when most are stale
+        void DropStalePendingLoads();
 
         // index to next min-mip feedback resolve target
         UINT m_readbackIndex;
@@ -317,15 +420,65 @@ namespace Streaming
         std::vector<QueuedFeedback> m_queuedFeedback;
 
         // update internal mapping and refcounts for each tile
-        void SetMinMip(UINT8 in_current, UINT in_x, UINT in_y, UINT in_s);
+        // mips less than in_prefetchBelow are speculative (their loads are low priority)
+        void SetMinMip(UINT8 in_current, UINT in_x, UINT in_y, UINT in_s, UINT in_prefetchBelow = 0);
 
         // AddRef, which requires allocation, might fail
-        void AddTileRef(UINT in_x, UINT in_y, UINT in_s);
+        void AddTileRef(UINT in_x, UINT in_y, UINT in_s, bool in_prefetch = false);
 
         // DecRef may decline
         void DecTileRef(UINT in_x, UINT in_y, UINT in_s);
 
-        void QueuePendingTileLoads(Streaming::UpdateList* out_pUpdateList); // returns # tiles queued
+        void QueuePendingTileLoads(Streaming::UpdateList* out_pUpdateList,
+            std::vector<PendingTile>& in_pendingLoads, UINT in_maxCopies);
+
+        //--------------------------------------------------------
+        // feedback dilation: widen requests to neighboring regions
+        // hides late loads where filtering crosses region boundaries
+        //--------------------------------------------------------
+        // returns dilated feedback with row pitch m_dilationPitch
+        const UINT8* DilateFeedback(const UINT8* in_pResolvedData, UINT in_rowPitch);
+        std::vector<BYTE, Streaming::AlignedAllocator<BYTE>> m_dilationScratch; // horizontal pass
+        std::vector<BYTE, Streaming::AlignedAllocator<BYTE>> m_dilatedFeedback; // output
+        std::vector<BYTE> m_dilationRow; // one row of feedback padded by the radius on each side
+        UINT m_dilationPitch{ 0 };
+
+        // count regions with a feedback request (for reclaim importance)
+        // optionally also count those that requested a tile that was not resident (the gpu sampled a coarser mip)
+        void CountFeedbackRegions(const UINT8* in_pResolvedData, UINT in_rowPitch, bool in_countLate);
+
+        //--------------------------------------------------------
+        // heap pressure
+        //--------------------------------------------------------
+        UINT8 m_reclaimMip{ 0 };         // feedback may not request mips finer than this
+        UINT m_numClampedRegions{ 0 };   // # regions whose request was coarsened to m_reclaimMip, from the most recent feedback
+        UINT m_numVisibleRegions{ 0 };   // # regions with a feedback request, from the most recent feedback
+        UINT64 m_feedbackFenceValue{ 0 }; // frame fence value when feedback was last processed
+        UINT32 m_feedbackCaptureID{ UINT32(-1) }; // assigned by FeedbackCapture::Append() when feedback capture is enabled
+
+        //--------------------------------------------------------
+        // prefetch: extrapolate the next feedback from the motion between the previous two
+        //--------------------------------------------------------
+        // fold feedback into m_tileReferences, adding speculative references. returns true if references changed
+        bool ProcessFeedbackPrefetch(const UINT8* in_pFeedback, UINT in_rowPitch);
+
+        // drop all speculative state. refcounts are handled by the caller
+        void ClearPrefetch();
+
+        // do not prefetch (and release prefetched tiles) if the heap has fewer than this many tiles available
+        UINT GetPrefetchHeapReserve() const;
+
+        std::vector<TileReference> m_feedbackMips; // most recent feedback, clamped to m_maxMip
+        std::vector<TileReference> m_prefetchMips; // per region, finest mip referenced only due to prefetch (m_maxMip if none)
+
+        struct FeedbackMotion
+        {
+            float m_centroidX{ 0 }; // feedback center of mass in region space, weighted towards finer mips
+            float m_centroidY{ 0 };
+            float m_meanMip{ 0 };   // average desired mip of visible regions
+            bool m_valid{ false };
+        };
+        FeedbackMotion m_feedbackMotion;
 
         void LoadPackedMips();
 
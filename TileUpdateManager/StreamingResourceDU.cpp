@@ -28,36 +28,17 @@
 #include "StreamingResourceDU.h"
 #include "StreamingHeap.h"
 #include "TileUpdateManagerSR.h"
+#include "SharedTileStorage.h"
 
 //-----------------------------------------------------------------------------
 // can map the packed mips as soon as we have heap indices
 //-----------------------------------------------------------------------------
-void Streaming::StreamingResourceDU::MapPackedMips(ID3D12CommandQueue* in_pCommandQueue)
+void Streaming::StreamingResourceDU::MapPackedMips(DeviceQueue* in_pQueue)
 {
-    UINT firstSubresource = GetPackedMipInfo().NumStandardMips;
-
     // mapping packed mips is different from regular tiles: must be mapped before we can use copytextureregion() instead of copytiles()
-    UINT numTiles = GetPackedMipInfo().NumTilesForPackedMips;
-
-    std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags(numTiles, D3D12_TILE_RANGE_FLAG_NONE);
-
-    // if the number of standard (not packed) mips is n, then start updating at subresource n
-    D3D12_TILED_RESOURCE_COORDINATE resourceRegionStartCoordinates{ 0, 0, 0, firstSubresource };
-    D3D12_TILE_REGION_SIZE resourceRegionSizes{ numTiles, FALSE, 0, 0, 0 };
-
     // perform packed mip tile mapping on the copy queue
-    in_pCommandQueue->UpdateTileMappings(
-        GetTiledResource(),
-        1, // numRegions
-        &resourceRegionStartCoordinates,
-        &resourceRegionSizes,
-        m_pHeap->GetHeap(),
-        numTiles,
-        rangeFlags.data(),
-        m_packedMipHeapIndices.data(),
-        nullptr,
-        D3D12_TILE_MAPPING_FLAG_NONE
-    );
+    in_pQueue->MapPackedMips(GetDeviceTiledResource(), GetPackedMipInfo().NumStandardMips,
+        GetPackedMipInfo().NumTilesForPackedMips, m_pHeap->GetDeviceHeap(), m_packedMipHeapIndices.data());
 
     // DataUploader will synchronize around a mapping fence before uploading packed mips
 }
@@ -66,6 +47,26 @@ void Streaming::StreamingResourceDU::MapPackedMips(ID3D12CommandQueue* in_pComma
 // DataUploader has completed updating a reserved texture tile
 //-----------------------------------------------------------------------------
 void Streaming::StreamingResourceDU::NotifyCopyComplete(const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords)
+{
+    for (const auto& t : in_coords)
+    {
+        ASSERT(TileMappingState::Residency::Loading == m_tileMappingState.GetResidency(t));
+        m_tileMappingState.SetResidency(t, TileMappingState::Residency::Resident);
+
+        // other resources created from the same file may now map this tile
+        if (m_pSharedTiles)
+        {
+            m_pSharedTiles->NotifyLoaded(t);
+        }
+    }
+
+    SetResidencyChanged();
+}
+
+//-----------------------------------------------------------------------------
+// DataUploader has mapped tiles that were loaded by another resource
+//-----------------------------------------------------------------------------
+void Streaming::StreamingResourceDU::NotifyMapped(const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords)
 {
     for (const auto& t : in_coords)
     {
@@ -37,17 +37,24 @@ namespace Streaming
     class StreamingResourceDU : private StreamingResourceBase
     {
     public:
-        const XeTexture* GetTextureFileInfo() const { return &m_textureFileInfo; }
-        Streaming::Heap* GetHeap() const { return m_pHeap; }
+        const XeTexture* GetTextureFileInfo() const { return m_pTextureFileInfo.get(); }
+        using StreamingResourceBase::GetHeap;
 
         // just for packed mips
         const D3D12_PACKED_MIP_INFO& GetPackedMipInfo() const { return m_resources->GetPackedMipInfo(); }
 
         void NotifyCopyComplete(const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords);
+        void NotifyMapped(const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords); // tiles from shared storage
         void NotifyPackedMips();
         void NotifyEvicted(const std::vector<D3D12_TILED_RESOURCE_COORDINATE>& in_coords);
 
+        // an UpdateList for this resource was allocated or freed
+        // the free must be the last access: the resource may be deleted as soon as the count reaches 0
+        void AddUpdateList() { m_numUpdateListsInFlight.fetch_add(1, std::memory_order_relaxed); }
+        void ReleaseUpdateList() { m_numUpdateListsInFlight.fetch_sub(1, std::memory_order_release); }
+
         ID3D12Resource* GetTiledResource() const { return m_resources->GetTiledResource(); }
+        DeviceTiledResource* GetDeviceTiledResource() const { return m_resources->GetDeviceTiledResource(); }
 
         const FileHandle* GetFileHandle() const { return m_pFileHandle.get(); }
         const std::wstring& GetFileName() const { return m_filename; }
@@ -55,6 +62,6 @@ namespace Streaming
         std::vector<BYTE>& GetPaddedPackedMips(UINT& out_uncompressedSize) { out_uncompressedSize = m_packedMipsUncompressedSize; return m_packedMips; }
 
         // packed mips are treated differently from regular tiles: they aren't tracked by the data structure, and share heap indices
-        void MapPackedMips(ID3D12CommandQueue* in_pCommandQueue);
+        void MapPackedMips(DeviceQueue* in_pQueue);
     };
 }
@@ -0,0 +1,180 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <immintrin.h> // for _mm_pause()
+
+#ifdef _WIN32
+#include <synchapi.h>
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+//==================================================
+// a single thread may wait on this flag, which may be set by any number of threads
+//
+// Wait() spins briefly before parking in the kernel (WaitOnAddress on windows, futex on linux)
+// Set() only enters the kernel if the waiter is parked
+// a Set() is never lost: if it happens before Wait(), Wait() returns immediately
+// multiple Set()s before a Wait() are coalesced into one
+//
+// the spin adapts to how soon the flag tends to be set:
+//   set while spinning: the limit moves toward twice the spins it took
+//   set shortly after parking: the spin almost paid off, double it
+//   set long after parking: spinning was wasted, halve it
+//==================================================
+namespace Streaming
+{
+    class SynchronizationFlag
+    {
+    public:
+        static constexpr std::uint32_t INFINITE_WAIT = 0xffffffff;
+
+        // in_maxSpin = 0: never spin, always park
+        // with one processor, spinning only delays the thread that would set the flag
+        SynchronizationFlag(std::uint32_t in_maxSpin = 4096) :
+            m_maxSpin(GetMultiprocessor() ? in_maxSpin : 0), m_minSpin(std::min(m_maxSpin, MIN_SPIN)), m_spinLimit(m_minSpin) {}
+
+        void Set()
+        {
+            if (PARKED == m_state.exchange(SET))
+            {
+                WakeOne(m_state);
+            }
+        }
+
+        // returns true if the flag was set (and clears it), false on timeout
+        bool Wait(std::uint32_t in_timeoutMs = INFINITE_WAIT)
+        {
+            const std::uint32_t spinLimit = m_spinLimit;
+            for (std::uint32_t i = 0; i < spinLimit; i++)
+            {
+                if (SET == m_state.load(std::memory_order_relaxed))
+                {
+                    m_spinLimit = std::clamp(m_spinLimit - m_spinLimit / 8 + (2 * i) / 8, m_minSpin, m_maxSpin);
+                    m_state.exchange(CLEAR, std::memory_order_acquire);
+                    return true;
+                }
+                _mm_pause();
+            }
+
+            // only the waiter clears the flag, so it is either CLEAR or SET here
+            std::uint32_t expected = CLEAR;
+            if (m_state.compare_exchange_strong(expected, PARKED))
+            {
+                m_numParks++;
+                const auto parkTime = std::chrono::steady_clock::now();
+                const auto deadline = parkTime + std::chrono::milliseconds(in_timeoutMs);
+
+                // wakeups may be spurious
+                while (PARKED == m_state.load(std::memory_order_acquire))
+                {
+                    std::uint32_t timeoutMs = INFINITE_WAIT;
+                    if (INFINITE_WAIT != in_timeoutMs)
+                    {
+                        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                        if (remaining <= 0)
+                        {
+                            break;
+                        }
+                        timeoutMs = (std::uint32_t)remaining;
+                    }
+                    WaitOnValue(m_state, PARKED, timeoutMs);
+                }
+
+                const auto parkedTime = std::chrono::steady_clock::now() - parkTime;
+                if (parkedTime < SHORT_PARK)
+                {
+                    m_spinLimit = std::min(std::max(m_spinLimit * 2, m_minSpin), m_maxSpin);
+                }
+                else
+                {
+                    m_spinLimit = std::max(m_spinLimit / 2, m_minSpin);
+                }
+            }
+
+            // SET, or still PARKED after a timeout
+            return SET == m_state.exchange(CLEAR, std::memory_order_acquire);
+        }
+
+        //-------------------------------------------
+        // statistics, for the waiting thread
+        //-------------------------------------------
+        std::uint64_t GetNumParks() const { return m_numParks; }
+        std::uint32_t GetSpinLimit() const { return m_spinLimit; }
+    private:
+        enum : std::uint32_t { CLEAR = 0, SET, PARKED };
+        static constexpr std::uint32_t MIN_SPIN = 64;
+        // a park this short means the flag was set about when a longer spin would have seen it
+        static constexpr std::chrono::microseconds SHORT_PARK{ 50 };
+
+        std::atomic<std::uint32_t> m_state{ CLEAR };
+
+        // only accessed by the waiting thread
+        const std::uint32_t m_maxSpin;
+        const std::uint32_t m_minSpin;
+        std::uint32_t m_spinLimit;
+        std::uint64_t m_numParks{ 0 };
+
+        static bool GetMultiprocessor()
+        {
+            static const bool multiprocessor = std::thread::hardware_concurrency() > 1;
+            return multiprocessor;
+        }
+
+        // block while in_value == in_undesired. may return early
+        static void WaitOnValue(std::atomic<std::uint32_t>& in_value, std::uint32_t in_undesired, std::uint32_t in_timeoutMs)
+        {
+#ifdef _WIN32
+            ::WaitOnAddress(&in_value, &in_undesired, sizeof(in_undesired), (INFINITE_WAIT == in_timeoutMs) ? INFINITE : in_timeoutMs);
+#else
+            timespec timeout{ time_t(in_timeoutMs / 1000), long(in_timeoutMs % 1000) * 1000000 };
+            ::syscall(SYS_futex, (std::uint32_t*)&in_value, FUTEX_WAIT_PRIVATE, in_undesired,
+                (INFINITE_WAIT == in_timeoutMs) ? nullptr : &timeout, nullptr, 0);
+#endif
+        }
+
+        static void WakeOne(std::atomic<std::uint32_t>& in_value)
+        {
+#ifdef _WIN32
+            ::WakeByAddressSingle(&in_value);
+#else
+            ::syscall(SYS_futex, (std::uint32_t*)&in_value, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+        }
+    };
+}
@@ -35,15 +35,18 @@
 #include "StreamingResourceBase.h"
 #include "DataUploader.h"
 #include "StreamingHeap.h"
+#include "FeedbackCapture.h"
 
 //--------------------------------------------
 // instantiate streaming library
 //--------------------------------------------
 TileUpdateManager* TileUpdateManager::Create(const TileUpdateManagerDesc& in_desc)
 {
-    Streaming::ComPtr<ID3D12Device8> device;
-    in_desc.m_pDirectCommandQueue->GetDevice(IID_PPV_ARGS(&device));
-    return new Streaming::TileUpdateManagerBase(in_desc, device.Get());
+    if (in_desc.m_softwareDevice)
+    {
+        return new Streaming::TileUpdateManagerBase(in_desc, Streaming::CreateSoftwareDevice(in_desc.m_softwareDeviceLatencyMs));
+    }
+    return new Streaming::TileUpdateManagerBase(in_desc, Streaming::CreateD3D12Device(in_desc.m_pDirectCommandQueue));
 }
 
 void Streaming::TileUpdateManagerBase::Destroy()
@@ -57,7 +60,7 @@ void Streaming::TileUpdateManagerBase::Destroy()
 //--------------------------------------------
 StreamingHeap* Streaming::TileUpdateManagerBase::CreateStreamingHeap(UINT in_maxNumTilesHeap)
 {
-    auto pStreamingHeap = new Streaming::Heap(m_dataUploader.GetMappingQueue(), in_maxNumTilesHeap);
+    auto pStreamingHeap = new Streaming::Heap(m_device.get(), in_maxNumTilesHeap);
     return (StreamingHeap*)pStreamingHeap;
 }
 
@@ -66,19 +69,61 @@ StreamingHeap* Streaming::TileUpdateManagerBase::CreateStreamingHeap(UINT in_max
 //--------------------------------------------
 StreamingResource* Streaming::TileUpdateManagerBase::CreateStreamingResource(const std::wstring& in_filename, StreamingHeap* in_pHeap)
 {
-    // if threads are running, stop them. they have state that depends on knowing the # of StreamingResources
-    Finish();
+    ASSERT(!GetWithinFrame());
 
+    // streaming continues. the new resource is handed to the streaming threads by the next BeginFrame()
     Streaming::FileHandle* pFileHandle = m_dataUploader.OpenFile(in_filename);
     auto pRsrc = new Streaming::StreamingResourceBase(in_filename, pFileHandle, (Streaming::TileUpdateManagerSR*)this, (Streaming::Heap*)in_pHeap);
-    m_streamingResources.push_back(pRsrc);
-    m_numStreamingResourcesChanged = true;
+    pRsrc->Initialize();
+    m_newStreamingResources.push_back(pRsrc);
+
+    return (StreamingResource*)pRsrc;
+}
 
-    m_havePackedMipsToLoad = true;
+//-----------------------------------------------------------------------------
+// the file is opened by the calling thread, so the handle matches the current file streamer
+// the rest of the file work is done by a loader thread. BeginFrame() hands the resource to the streaming threads once it is done
+//-----------------------------------------------------------------------------
+StreamingResource* Streaming::TileUpdateManagerBase::CreateStreamingResourceAsync(const std::wstring& in_filename, StreamingHeap* in_pHeap)
+{
+    ASSERT(!GetWithinFrame());
+
+    Streaming::FileHandle* pFileHandle = m_dataUploader.OpenFile(in_filename);
+    auto pRsrc = new Streaming::StreamingResourceBase(in_filename, pFileHandle, (Streaming::TileUpdateManagerSR*)this, (Streaming::Heap*)in_pHeap);
+    m_newStreamingResources.push_back(pRsrc);
+    m_resourceLoader.Queue(&pRsrc, 1);
 
     return (StreamingResource*)pRsrc;
 }
 
+//-----------------------------------------------------------------------------
+// create many resources at once. the calling thread helps the loader threads, then waits for the batch
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::CreateStreamingResources(std::vector<StreamingResource*>& out_resources,
+    const std::vector<std::wstring>& in_filenames, StreamingHeap* in_pHeap)
+{
+    ASSERT(!GetWithinFrame());
+
+    const UINT numResources = (UINT)in_filenames.size();
+    if (0 == numResources)
+    {
+        return;
+    }
+
+    const size_t firstNew = m_newStreamingResources.size();
+    for (const auto& filename : in_filenames)
+    {
+        Streaming::FileHandle* pFileHandle = m_dataUploader.OpenFile(filename);
+        auto pRsrc = new Streaming::StreamingResourceBase(filename, pFileHandle, (Streaming::TileUpdateManagerSR*)this, (Streaming::Heap*)in_pHeap);
+        m_newStreamingResources.push_back(pRsrc);
+        out_resources.push_back((StreamingResource*)pRsrc);
+    }
+
+    StreamingResourceBase** ppResources = &m_newStreamingResources[firstNew];
+    m_resourceLoader.Queue(ppResources, numResources);
+    m_resourceLoader.Wait(ppResources, numResources);
+}
+
 //-----------------------------------------------------------------------------
 // set which file streaming system to use
 // will reset even if previous setting was the same. so?
@@ -98,6 +143,10 @@ void Streaming::TileUpdateManagerBase::UseDirectStorage(bool in_useDS)
     {
         s->SetFileHandle(&m_dataUploader);
     }
+    for (auto& s : m_newStreamingResources)
+    {
+        s->SetFileHandle(&m_dataUploader);
+    }
 
     delete pOldStreamer;
 }
@@ -130,6 +179,18 @@ void Streaming::TileUpdateManagerBase::QueueFeedback(StreamingResource* in_pReso
 #endif
 }
 
+//-----------------------------------------------------------------------------
+// software device: stands in for the resolve of QueueFeedback()
+// the feedback becomes visible to the ProcessFeedback thread when the frame fence says this frame has completed
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::QueueSoftwareFeedback(StreamingResource* in_pResource, const BYTE* in_pMinMips)
+{
+    ASSERT(m_softwareDevice);
+    ASSERT(GetWithinFrame());
+
+    ((Streaming::StreamingResourceBase*)in_pResource)->WriteFeedback(in_pMinMips);
+}
+
 //-----------------------------------------------------------------------------
 // returns (approximate) cpu time for processing feedback in the previous frame
 // since processing happens asynchronously, this time should be averaged
@@ -146,10 +207,17 @@ float Streaming::TileUpdateManagerBase::GetGpuStreamingTime() const { return m_d
 float Streaming::TileUpdateManagerBase::GetTotalTileCopyLatency() const { return m_dataUploader.GetApproximateTileCopyLatency(); }
 
 // the total time the GPU spent resolving feedback during the previous frame
-float Streaming::TileUpdateManagerBase::GetGpuTime() const { return m_gpuTimerResolve.GetTimes()[m_renderFrameIndex].first; }
+float Streaming::TileUpdateManagerBase::GetGpuTime() const { return m_pGpuTimerResolve ? m_pGpuTimerResolve->GetTimes()[m_renderFrameIndex].first : 0; }
 UINT Streaming::TileUpdateManagerBase::GetTotalNumUploads() const { return m_dataUploader.GetTotalNumUploads(); }
 UINT Streaming::TileUpdateManagerBase::GetTotalNumEvictions() const { return m_dataUploader.GetTotalNumEvictions(); }
 UINT Streaming::TileUpdateManagerBase::GetTotalNumSubmits() const { return m_numTotalSubmits; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumPrefetchRequests() const { return m_numTotalPrefetchRequests; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumPrefetchHits() const { return m_numTotalPrefetchHits; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumPrefetchUploads() const { return m_numTotalPrefetchUploads; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumFeedbackRegions() const { return m_numTotalFeedbackRegions; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumLateRegions() const { return m_numTotalLateRegions; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumReclaimedTiles() const { return m_numTotalReclaimedTiles; }
+UINT Streaming::TileUpdateManagerBase::GetTotalNumSharedTileMappings() const { return m_dataUploader.GetTotalNumSharedMappings(); }
 
 void Streaming::TileUpdateManagerBase::SetVisualizationMode(UINT in_mode)
 {
@@ -168,6 +236,27 @@ void Streaming::TileUpdateManagerBase::CaptureTraceFile(bool in_captureTrace)
     m_dataUploader.CaptureTraceFile(in_captureTrace);
 }
 
+//-----------------------------------------------------------------------------
+// the capture file is created on first use, and closed when the TileUpdateManager is destroyed
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::CaptureFeedbackFile(bool in_captureFeedback)
+{
+    if (in_captureFeedback && (nullptr == m_pFeedbackCapture))
+    {
+        int index = 0;
+        while (1)
+        {
+            std::wstring unique = L"feedbackCapture_" + std::to_wstring(++index) + L".bin";
+            if (!std::filesystem::exists(unique))
+            {
+                m_pFeedbackCapture = std::make_unique<Streaming::FeedbackCapture>(unique);
+                break;
+            }
+        }
+    }
+    m_captureFeedback = in_captureFeedback;
+}
+
 //-----------------------------------------------------------------------------
 // Call this method once for each TileUpdateManager that shares heap/upload buffers
 // expected to be called once per frame, before anything is drawn.
@@ -180,30 +269,45 @@ void Streaming::TileUpdateManagerBase::BeginFrame(ID3D12DescriptorHeap* in_pDesc
 
     StartThreads();
 
-    m_processFeedbackFlag.Set();
+    // new resources that have been initialized can start streaming. others may still be loading
+    auto readyEnd = std::stable_partition(m_newStreamingResources.begin(), m_newStreamingResources.end(),
+        [](const StreamingResourceBase* p) { return p->GetInitialized(); });
+    const UINT numReady = UINT(readyEnd - m_newStreamingResources.begin());
 
-    // if new StreamingResources have been created...
-    if (m_numStreamingResourcesChanged)
+    // if StreamingResources have been created...
+    if (numReady)
     {
-        m_numStreamingResourcesChanged = false;
-        AllocateResidencyMap(in_minmipmapDescriptorHandle);
+        // the residency thread can't write residency maps while the buffer may move
+        m_residencyLock.Acquire();
+        AllocateResidencyMap(in_minmipmapDescriptorHandle, m_newStreamingResources.data(), numReady);
+        m_streamingResources.insert(m_streamingResources.end(), m_newStreamingResources.begin(), readyEnd);
+        m_residencyLock.Release();
+
+        // new resources have a residency map, so can start streaming
+        PostResourceCommands(ResourceCommand::Type::ADD, m_newStreamingResources.data(), numReady);
+        m_newStreamingResources.erase(m_newStreamingResources.begin(), readyEnd);
     }
 
+    WakeProcessFeedback();
+
     // the frame fence is used to optimize readback of feedback
     // only read back the feedback after the frame that writes to it has completed
     // note the signal is for the previous frame, the value is for "this" frame
-    m_directCommandQueue->Signal(m_frameFence.Get(), m_frameFenceValue);
+    m_device->GetDirectQueue()->Signal(m_frameFence.get(), m_frameFenceValue);
     m_frameFenceValue++;
 
     m_renderFrameIndex = (m_renderFrameIndex + 1) % m_numSwapBuffers;
-    for (auto& cl : m_commandLists)
+    if (!m_softwareDevice)
     {
-        auto& allocator = cl.m_allocators[m_renderFrameIndex];
-        allocator->Reset();
-        ThrowIfFailed(cl.m_commandList->Reset(allocator.Get(), nullptr));
+        for (auto& cl : m_commandLists)
+        {
+            auto& allocator = cl.m_allocators[m_renderFrameIndex];
+            allocator->Reset();
+            ThrowIfFailed(cl.m_commandList->Reset(allocator.Get(), nullptr));
+        }
+        ID3D12DescriptorHeap* ppHeaps[] = { in_pDescriptorHeap };
+        GetCommandList(CommandListName::Before)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
     }
-    ID3D12DescriptorHeap* ppHeaps[] = { in_pDescriptorHeap };
-    GetCommandList(CommandListName::Before)->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
     // capture cpu time spent processing feedback
     {
@@ -243,6 +347,14 @@ TileUpdateManager::CommandLists Streaming::TileUpdateManagerBase::EndFrame()
         }
     }
 
+    // software device: no command lists. packed mips needed no transition, and feedback came from QueueSoftwareFeedback()
+    if (m_softwareDevice)
+    {
+        m_packedMipTransitionBarriers.clear();
+        m_withinFrame = false;
+        return TileUpdateManager::CommandLists{ nullptr, nullptr };
+    }
+
     //------------------------------------------------------------------
     // before draw calls, do the following:
     //     - clear feedback buffers
@@ -298,7 +410,7 @@ TileUpdateManager::CommandLists Streaming::TileUpdateManagerBase::EndFrame()
 
         if (m_feedbackReadbacks.size())
         {
-            m_gpuTimerResolve.BeginTimer(pCommandList, m_renderFrameIndex);
+            m_pGpuTimerResolve->BeginTimer(pCommandList, m_renderFrameIndex);
 
             // transition all feedback resources UAV->RESOLVE_SOURCE
             // also transition the (non-opaque) resolved resources COPY_SOURCE->RESOLVE_DEST
@@ -316,7 +428,7 @@ TileUpdateManager::CommandLists Streaming::TileUpdateManagerBase::EndFrame()
             pCommandList->ResourceBarrier((UINT)m_barrierResolveSrcToUav.size(), m_barrierResolveSrcToUav.data());
             m_barrierResolveSrcToUav.clear();
 
-            m_gpuTimerResolve.EndTimer(pCommandList, m_renderFrameIndex);
+            m_pGpuTimerResolve->EndTimer(pCommandList, m_renderFrameIndex);
 #if RESOLVE_TO_TEXTURE
             // copy readable feedback buffers to cpu
             for (auto& t : m_feedbackReadbacks)
@@ -326,7 +438,7 @@ TileUpdateManager::CommandLists Streaming::TileUpdateManagerBase::EndFrame()
 #endif
             m_feedbackReadbacks.clear();
 
-            m_gpuTimerResolve.ResolveTimer(pCommandList, m_renderFrameIndex);
+            m_pGpuTimerResolve->ResolveTimer(pCommandList, m_renderFrameIndex);
         }
 
         pCommandList->Close();
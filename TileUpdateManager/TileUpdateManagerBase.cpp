@@ -30,43 +30,69 @@
 #include "StreamingResourceBase.h"
 #include "XeTexture.h"
 #include "StreamingHeap.h"
-#include "BitVector.h"
+#include "SharedTileStorage.h"
+#include "FeedbackCapture.h"
 
 //=============================================================================
 // constructor for streaming library base class
 //=============================================================================
-Streaming::TileUpdateManagerBase::TileUpdateManagerBase(const TileUpdateManagerDesc& in_desc, ID3D12Device8* in_pDevice) :// required for constructor
-m_numSwapBuffers(in_desc.m_swapChainBufferCount)
-, m_gpuTimerResolve(in_pDevice, in_desc.m_swapChainBufferCount, D3D12GpuTimer::TimerType::Direct)
+Streaming::TileUpdateManagerBase::TileUpdateManagerBase(const TileUpdateManagerDesc& in_desc, std::unique_ptr<Streaming::Device> in_device) :// required for constructor
+m_device(std::move(in_device))
+, m_softwareDevice(nullptr == m_device->GetD3D12Device())
+, m_numSwapBuffers(in_desc.m_swapChainBufferCount)
 , m_renderFrameIndex(0)
-, m_directCommandQueue(in_desc.m_pDirectCommandQueue)
-, m_device(in_pDevice)
 , m_commandLists((UINT)CommandListName::Num)
 , m_maxTileMappingUpdatesPerApiCall(in_desc.m_maxTileMappingUpdatesPerApiCall)
 , m_addAliasingBarriers(in_desc.m_addAliasingBarriers)  
 , m_minNumUploadRequests(in_desc.m_minNumUploadRequests)
 , m_threadPriority((int)in_desc.m_threadPriority)
-, m_dataUploader(in_pDevice, in_desc.m_maxNumCopyBatches, in_desc.m_stagingBufferSizeMB, in_desc.m_maxTileMappingUpdatesPerApiCall, m_threadPriority)
+, m_enablePrefetch(in_desc.m_enablePrefetch)
+, m_targetHeapOccupancy(in_desc.m_targetHeapOccupancy)
+, m_feedbackDilationRadius(in_desc.m_feedbackDilationRadius)
+, m_lateRegionStatistics(in_desc.m_enableLateRegionStatistics || (0 != in_desc.m_feedbackDilationRadius))
+, m_enableReclaim(in_desc.m_enableReclaim)
+, m_shareTilesByFile(in_desc.m_shareTilesByFile)
+, m_pJobSystem(in_desc.m_numWorkerThreads ? std::make_unique<Streaming::JobSystem>(in_desc.m_numWorkerThreads, in_desc.m_workerAffinityMask) : nullptr)
+, m_dataUploader(m_device.get(), in_desc.m_maxNumCopyBatches, in_desc.m_stagingBufferSizeMB, in_desc.m_maxTileMappingUpdatesPerApiCall, m_threadPriority, m_pJobSystem.get())
+, m_resourceLoader(in_desc.m_numLoaderThreads, m_threadPriority)
 {
-    ASSERT(D3D12_COMMAND_LIST_TYPE_DIRECT == m_directCommandQueue->GetDesc().Type);
+    m_frameFence = m_device->CreateFence(0, L"Streaming::TileUpdateManagerBase::m_frameFence");
 
-    ThrowIfFailed(in_pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_frameFence)));
-    m_frameFence->SetName(L"Streaming::TileUpdateManagerBase::m_frameFence");
+    // feedback values are mips, or 0xff where there was no request. saturating keeps 0xff and lets a bias disable dilation
+    bool anyDilationMipBias = (0 != in_desc.m_feedbackDilationMipBias);
+    for (auto b : in_desc.m_feedbackDilationMipBiasPerMip) { anyDilationMipBias = anyDilationMipBias || (0 != b); }
+    if (anyDilationMipBias)
+    {
+        const auto& perMip = in_desc.m_feedbackDilationMipBiasPerMip;
+        m_feedbackDilationMips.resize(256);
+        for (UINT mip = 0; mip < 256; mip++)
+        {
+            UINT bias = (mip < perMip.size()) ? perMip[mip] : in_desc.m_feedbackDilationMipBias;
+            m_feedbackDilationMips[mip] = (UINT8)std::min(mip + std::min(bias, 255u), 255u);
+        }
+    }
+
+    ID3D12Device8* pDevice = m_device->GetD3D12Device();
+    if (pDevice)
+    {
+        ASSERT(D3D12_COMMAND_LIST_TYPE_DIRECT == m_device->GetDirectQueue()->GetD3D12Queue()->GetDesc().Type);
+        m_pGpuTimerResolve = std::make_unique<D3D12GpuTimer>(pDevice, m_numSwapBuffers, D3D12GpuTimer::TimerType::Direct);
+    }
 
     const UINT numAllocators = m_numSwapBuffers;
-    for (UINT c = 0; c < (UINT)CommandListName::Num; c++)
+    for (UINT c = 0; pDevice && (c < (UINT)CommandListName::Num); c++)
     {
         auto& cl = m_commandLists[c];
         cl.m_allocators.resize(numAllocators);
         for (UINT i = 0; i < numAllocators; i++)
         {
-            ThrowIfFailed(in_pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&cl.m_allocators[i])));
+            ThrowIfFailed(pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&cl.m_allocators[i])));
 
             std::wstringstream name;
             name << "Streaming::TileUpdateManagerBase::m_commandLists.m_allocators[" << c << "][" << i << "]";
             cl.m_allocators[i]->SetName(name.str().c_str());
         }
-        ThrowIfFailed(in_pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, cl.m_allocators[m_renderFrameIndex].Get(), nullptr, IID_PPV_ARGS(&cl.m_commandList)));
+        ThrowIfFailed(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, cl.m_allocators[m_renderFrameIndex].Get(), nullptr, IID_PPV_ARGS(&cl.m_commandList)));
 
         std::wstringstream name;
         name << "Streaming::TileUpdateManagerBase::m_commandLists.m_commandList[" << c << "]";
@@ -84,6 +110,22 @@ Streaming::TileUpdateManagerBase::~TileUpdateManagerBase()
 {
     // force DataUploader to flush now, rather than waiting for its destructor
     Finish();
+
+    // software device: the last frame fence signal may still be pending on the direct queue, which outlives the fence
+    if (m_softwareDevice)
+    {
+        while (m_frameFence->GetCompletedValue() < m_frameFenceValue - 1)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // services may have been kicked while the DataUploader drained
+    if (m_pProcessFeedbackService)
+    {
+        m_pProcessFeedbackService->WaitIdle();
+        m_pResidencyService->WaitIdle();
+    }
 }
 
 
@@ -100,6 +142,39 @@ void Streaming::TileUpdateManagerBase::StartThreads()
 
     m_threadsRunning = true;
 
+    // the ProcessFeedback thread starts with the current set of resources
+    // commands posted before a previous Finish() are obsolete
+    m_feedbackResources = m_streamingResources;
+    m_packedMipsPending = m_streamingResources; // InitPackedMips() returns quickly if already requested
+    m_resourceCommands.clear();
+    m_numResourceCommandsDone = m_numResourceCommandsPosted;
+
+    m_staleResources.reserve(m_feedbackResources.size());
+    m_uploadsRequested = 0;
+    m_previousFrameFenceValue = m_frameFenceValue;
+
+    if (m_pJobSystem)
+    {
+        if (nullptr == m_pProcessFeedbackService)
+        {
+            m_pProcessFeedbackService = std::make_unique<Streaming::JobSystem::Service>(*m_pJobSystem, [this]
+                {
+                    return m_threadsRunning && ProcessFeedbackPass();
+                }, m_threadPriority);
+
+            m_pResidencyService = std::make_unique<Streaming::JobSystem::Service>(*m_pJobSystem, [this]
+                {
+                    if (m_threadsRunning) { UpdateResidency(); }
+                    return false;
+                }, m_threadPriority);
+        }
+
+        // resources may have become dirty while stopped
+        m_pProcessFeedbackService->Kick();
+        m_pResidencyService->Kick();
+        return;
+    }
+
     // process sampler feedback buffers, generate upload and eviction commands
     m_processFeedbackThread = std::thread([&]
         {
@@ -112,11 +187,7 @@ void Streaming::TileUpdateManagerBase::StartThreads()
             while (m_threadsRunning)
             {
                 m_residencyChangedFlag.Wait();
-
-                for (auto p : m_streamingResources)
-                {
-                    p->UpdateMinMipMap();
-                }
+                UpdateResidency();
             }
         });
 
@@ -124,9 +195,108 @@ void Streaming::TileUpdateManagerBase::StartThreads()
     Streaming::SetThreadPriority(m_updateResidencyThread, m_threadPriority);
 }
 
+//-----------------------------------------------------------------------------
+// only visit resources that changed, rather than every resource
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::UpdateResidency()
+{
+    m_residencyLock.Acquire();
+    m_dirtyResources.Drain([](StreamingResourceBase* p) { p->UpdateMinMipMap(); });
+    m_residencyLock.Release();
+}
+
+//-----------------------------------------------------------------------------
+// called by the application thread
+// commands are executed in order by the ProcessFeedback thread
+//-----------------------------------------------------------------------------
+UINT64 Streaming::TileUpdateManagerBase::PostResourceCommand(ResourceCommand::Type in_type, StreamingResourceBase* in_pResource)
+{
+    return PostResourceCommands(in_type, &in_pResource, 1);
+}
+
+//-----------------------------------------------------------------------------
+// post the same command for many resources, e.g. a batch of new resources, with one lock and one wake
+//-----------------------------------------------------------------------------
+UINT64 Streaming::TileUpdateManagerBase::PostResourceCommands(ResourceCommand::Type in_type, StreamingResourceBase* const* in_ppResources, UINT in_numResources)
+{
+    m_resourceCommandLock.Acquire();
+    for (UINT i = 0; i < in_numResources; i++)
+    {
+        m_resourceCommands.push_back({ in_type, in_ppResources[i] });
+    }
+    m_numResourceCommandsPosted += in_numResources;
+    UINT64 ticket = m_numResourceCommandsPosted;
+    m_resourceCommandLock.Release();
+
+    WakeProcessFeedback();
+
+    return ticket;
+}
+
+//-----------------------------------------------------------------------------
+// the ProcessFeedback thread reaches its safe point at least once per loop, so the wait is short
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::WaitResourceCommand(UINT64 in_ticket)
+{
+    while (m_numResourceCommandsDone < in_ticket)
+    {
+        _mm_pause();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// safe point: the ProcessFeedback thread holds no references into its list of resources
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::ProcessResourceCommands(std::vector<StreamingResourceBase*>& io_staleResources, UINT& io_uploadsRequested)
+{
+    m_resourceCommandLock.Acquire();
+    m_resourceCommandsScratch.swap(m_resourceCommands);
+    m_resourceCommandLock.Release();
+
+    if (0 == m_resourceCommandsScratch.size())
+    {
+        return;
+    }
+
+    for (const auto& c : m_resourceCommandsScratch)
+    {
+        auto p = c.m_pResource;
+        switch (c.m_type)
+        {
+        case ResourceCommand::Type::ADD:
+            m_feedbackResources.push_back(p);
+            m_packedMipsPending.push_back(p);
+            break;
+
+        case ResourceCommand::Type::DETACH:
+            m_feedbackResources.erase(std::remove(m_feedbackResources.begin(), m_feedbackResources.end(), p), m_feedbackResources.end());
+            io_staleResources.erase(std::remove(io_staleResources.begin(), io_staleResources.end(), p), io_staleResources.end());
+            m_packedMipsPending.erase(std::remove(m_packedMipsPending.begin(), m_packedMipsPending.end(), p), m_packedMipsPending.end());
+
+            // the resource waits for its UpdateLists to complete. uploads waiting for a signal would never complete.
+            if (io_uploadsRequested)
+            {
+                SignalFileStreamer();
+                io_uploadsRequested = 0;
+            }
+            break;
+
+        case ResourceCommand::Type::RELEASE:
+            p->FreeHeapAllocations();
+            break;
+
+        default:
+            ASSERT(0);
+        }
+    }
+
+    m_numResourceCommandsDone += m_resourceCommandsScratch.size();
+    m_resourceCommandsScratch.clear();
+}
+
 //-----------------------------------------------------------------------------
 // per frame, call StreamingResource::ProcessFeedback()
-// expects the no change in # of streaming resources during thread lifetime
+// resources are added and removed by commands at the top of the loop
 //-----------------------------------------------------------------------------
 void Streaming::TileUpdateManagerBase::SignalFileStreamer()
 {
@@ -135,126 +305,332 @@ void Streaming::TileUpdateManagerBase::SignalFileStreamer()
 }
 void Streaming::TileUpdateManagerBase::ProcessFeedbackThread()
 {
-    // array of indices to resources that need tiles loaded/evicted
-    std::vector<UINT> staleResources;
-    staleResources.reserve(m_streamingResources.size());
+    while (m_threadsRunning)
+    {
+        if (!ProcessFeedbackPass())
+        {
+            m_processFeedbackFlag.Wait();
+        }
+    }
+    ProcessFeedbackFlush();
+}
 
-    // flags to prevent duplicates in the staleResources array
-    BitVector<UINT32> pending(m_streamingResources.size(), 0);
+//-----------------------------------------------------------------------------
+// StreamingResourceBase::GetStaleQueued() prevents duplicates in m_staleResources
+//-----------------------------------------------------------------------------
+bool Streaming::TileUpdateManagerBase::ProcessFeedbackPass()
+{
+    // add or remove streaming resources
+    ProcessResourceCommands(m_staleResources, m_uploadsRequested);
 
-    UINT uploadsRequested = 0; // remember if any work was queued so we can signal afterwards
-    UINT64 previousFrameFenceValue = m_frameFenceValue;
-    while (m_threadsRunning)
+    // prioritize loading packed mips, as objects shouldn't be displayed until packed mips load
+    // only visits resources that are waiting, so a large batch of new resources doesn't rescan every resource
+    if (m_packedMipsPending.size())
     {
-        // DEBUG: verify that no streaming resources have been added/removed during thread lifetime
-        ASSERT(m_streamingResources.size() == pending.size());
+        m_packedMipsPending.erase(std::remove_if(m_packedMipsPending.begin(), m_packedMipsPending.end(),
+            [](StreamingResourceBase* p) { return p->InitPackedMips(); }), m_packedMipsPending.end());
+
+        if (m_packedMipsPending.size())
+        {
+            return true; // still working on loading packed mips. don't move on to other streaming tasks yet.
+        }
+    }
+
+    bool flushPendingUploadRequests = false;
 
-        // prioritize loading packed mips, as objects shouldn't be displayed until packed mips load
-        bool expected = true;
-        if (m_havePackedMipsToLoad.compare_exchange_weak(expected, false))
+    // process feedback buffers once per frame
+    {
+        UINT64 frameFenceValue = m_frameFence->GetCompletedValue();
+        if (m_previousFrameFenceValue != frameFenceValue)
         {
-            for (auto p : m_streamingResources)
+            m_previousFrameFenceValue = frameFenceValue;
+
+            // flush any pending uploads from previous frame
+            if (m_uploadsRequested) { flushPendingUploadRequests = true; }
+
+            auto startTime = m_cpuTimer.GetTime();
+
+            // adjust feedback bias before applying this frame's feedback
+            if (m_targetHeapOccupancy > 0) { UpdateFeedbackBias(); }
+
+            // make room for pending loads, or restore previously reclaimed mips
+            if (m_enableReclaim) { ReclaimHeapTiles(frameFenceValue); }
+
+            ProcessFeedbackResources(frameFenceValue);
+            // add the amount of time we just spent processing feedback for a single frame
+            m_processFeedbackTime += UINT64(m_cpuTimer.GetTime() - startTime);
+        }
+    }
+
+    // push uploads and evictions for stale resources
+    {
+        UINT numEvictions = 0;
+        UINT newStaleSize = 0; // track number of stale resources, then resize the array to the updated number
+        for (auto p : m_staleResources)
+        {
+            if (m_dataUploader.GetNumUpdateListsAvailable()
+                // with DirectStorage Queue::EnqueueRequest() can block.
+                // when there are many pending uploads, there can be multiple frames of waiting.
+                // if we wait too long in this loop, we miss calling ProcessFeedback() above which adds pending uploads & evictions
+                // this is a vicious feedback cycle that leads to even more pending requests, and even longer delays.
+                // the following check avoids enqueueing more uploads if the frame has changed:
+                && (m_frameFence->GetCompletedValue() == m_previousFrameFenceValue)
+                && m_threadsRunning) // don't add work while exiting
             {
-                if (!p->InitPackedMips())
-                {
-                    m_havePackedMipsToLoad = true; // did not finish uploading packed mips, keep trying
-                }
+                m_uploadsRequested += p->QueueTiles();
+            }
+
+            // tiles that are "loading" can't be evicted. as soon as they arrive, they can be.
+            // note: since we aren't unmapping evicted tiles, we can evict even if no UpdateLists are available
+            numEvictions += p->QueuePendingTileEvictions();
+
+            if (p->IsStale()) // still have work to do?
+            {
+                // keep stale resource in compacted array while retaining oldest-first ordering
+                m_staleResources[newStaleSize] = p;
+                newStaleSize++;
             }
-            if (m_havePackedMipsToLoad)
+            else
             {
-                continue; // still working on loading packed mips. don't move on to other streaming tasks yet.
+                p->SetStaleQueued(false); // clear the flag that prevents duplicates
             }
         }
+        m_staleResources.resize(newStaleSize); // compact array
+        if (numEvictions) { m_dataUploader.AddEvictions(numEvictions); }
+    }
 
-        bool flushPendingUploadRequests = false;
+    // if there are uploads, maybe signal depending on heuristic to minimize # signals
+    if (m_uploadsRequested)
+    {
+        // tell the file streamer to signal the corresponding fence
+        if ((flushPendingUploadRequests) || // flush requests from previous frame
+            (0 == m_staleResources.size()) || // flush because there's no more work to be done (no stale resources, all feedback has been processed)
+            // if we need updatelists and there is a minimum amount of pending work, go ahead and submit
+            // this minimum heuristic prevents "storms" of submits with too few tiles to sustain good throughput
+            ((0 == m_dataUploader.GetNumUpdateListsAvailable()) && (m_uploadsRequested > m_minNumUploadRequests)))
+        {
+            SignalFileStreamer();
+            m_uploadsRequested = 0;
+        }
+    }
+
+    // nothing to do? wait for next frame
+    // development note: do not Wait() if m_uploadsRequested != 0. safe because m_uploadsRequested was cleared above.
+    if (0 == m_staleResources.size())
+    {
+        ASSERT(0 == m_uploadsRequested);
+        return false;
+    }
+    return true;
+}
 
-        // process feedback buffers once per frame
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::ProcessFeedbackFlush()
+{
+    // if thread exits, flush any pending uploads
+    if (m_uploadsRequested) { SignalFileStreamer(); }
+    m_uploadsRequested = 0;
+
+    // the next thread starts with an empty list of stale resources
+    for (auto p : m_staleResources) { p->SetStaleQueued(false); }
+    m_staleResources.clear();
+}
+
+//-----------------------------------------------------------------------------
+// with a job system, resources are processed in parallel. a job that depends on all of them
+// then queues stale resources in order. the calling thread helps while it waits
+// safe because the ProcessFeedback thread, which owns heap allocation, is the caller
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::ProcessFeedbackResources(UINT64 in_frameFenceValue)
+{
+    auto queueStaleResources = [this]
+    {
+        for (auto p : m_feedbackResources)
         {
-            UINT64 frameFenceValue = m_frameFence->GetCompletedValue();
-            if (previousFrameFenceValue != frameFenceValue)
+            if (p->IsStale() && !p->GetStaleQueued())
             {
-                previousFrameFenceValue = frameFenceValue;
+                m_staleResources.push_back(p);
+                p->SetStaleQueued(true);
+            }
+        }
+    };
 
-                // flush any pending uploads from previous frame
-                if (uploadsRequested) { flushPendingUploadRequests = true; }
+    const UINT numResources = (UINT)m_feedbackResources.size();
+    if ((nullptr == m_pJobSystem) || (numResources <= m_feedbackJobSize))
+    {
+        for (auto p : m_feedbackResources)
+        {
+            p->ProcessFeedback(in_frameFenceValue);
+        }
+        queueStaleResources();
+        return;
+    }
 
-                auto startTime = m_cpuTimer.GetTime();
-                for (UINT i = 0; i < m_streamingResources.size(); i++)
+    m_feedbackJobs.clear();
+    for (UINT i = 0; i < numResources; i += m_feedbackJobSize)
+    {
+        const UINT end = std::min(i + m_feedbackJobSize, numResources);
+        m_feedbackJobs.push_back(m_pJobSystem->Submit([this, i, end, in_frameFenceValue]
+            {
+                for (UINT j = i; j < end; j++)
                 {
-                    m_streamingResources[i]->ProcessFeedback(frameFenceValue);
-                    if (m_streamingResources[i]->IsStale() && !pending[i])
-                    {
-                        staleResources.push_back(i);
-                        pending[i] = 1;
-                    }
+                    m_feedbackResources[j]->ProcessFeedback(in_frameFenceValue);
                 }
-                // add the amount of time we just spent processing feedback for a single frame
-                m_processFeedbackTime += UINT64(m_cpuTimer.GetTime() - startTime);
-            }
+            }, m_threadPriority));
+    }
+
+    auto queueStale = m_pJobSystem->Submit(queueStaleResources, m_threadPriority, m_feedbackJobs.data(), (UINT)m_feedbackJobs.size());
+    m_pJobSystem->Wait(queueStale);
+}
+
+//-----------------------------------------------------------------------------
+// heaps are not tracked by TUM, so discover them from the StreamingResources
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::GatherHeaps()
+{
+    m_heaps.clear();
+    for (auto p : m_feedbackResources)
+    {
+        Streaming::Heap* pHeap = p->GetHeap();
+        if (m_heaps.end() == std::find(m_heaps.begin(), m_heaps.end(), pHeap))
+        {
+            m_heaps.push_back(pHeap);
         }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// the pending load backlog of each heap is one input to its controller
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::UpdateFeedbackBias()
+{
+    GatherHeaps();
+
+    for (auto p : m_feedbackResources)
+    {
+        p->GetHeap()->AddPendingLoads(p->GetNumPendingLoads());
+    }
 
-        // push uploads and evictions for stale resources
+    for (auto pHeap : m_heaps)
+    {
+        pHeap->UpdateFeedbackBias(m_targetHeapOccupancy);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// graceful degradation when a heap is full
+// if pending loads don't fit in the space that is available or soon will be (pending evictions),
+// reclaim the least valuable referenced tiles: the finest mips of the least important resources.
+// only tiles worth less than the most valuable demand are reclaimed (see ReclaimPolicy)
+//
+// reclaimed resources ignore feedback for the mips they gave up, so that demand never becomes pending loads.
+// instead, it is measured where feedback is clamped, and counts as demand here. a clamped resource is relaxed
+// (re-promoted) one mip when it fits in the free space, or when it is worth more than the victims that make room
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::ReclaimHeapTiles(UINT64 in_frameFenceValue)
+{
+    GatherHeaps();
+
+    for (auto pHeap : m_heaps)
+    {
+        UINT numPendingLoads = 0;
+        UINT numPendingEvictions = 0;
+        float demandValue = 0;
+        m_reclaimResources.clear();
+        m_clampedDemands.clear();
+        for (auto p : m_feedbackResources)
         {
-            UINT numEvictions = 0;
-            UINT newStaleSize = 0; // track number of stale resources, then resize the array to the updated number
-            for (auto resourceIndex : staleResources)
+            if (pHeap == p->GetHeap())
             {
-                if (m_dataUploader.GetNumUpdateListsAvailable()
-                    // with DirectStorage Queue::EnqueueRequest() can block.
-                    // when there are many pending uploads, there can be multiple frames of waiting.
-                    // if we wait too long in this loop, we miss calling ProcessFeedback() above which adds pending uploads & evictions
-                    // this is a vicious feedback cycle that leads to even more pending requests, and even longer delays.
-                    // the following check avoids enqueueing more uploads if the frame has changed:
-                    && (m_frameFence->GetCompletedValue() == previousFrameFenceValue)
-                    && m_threadsRunning) // don't add work while exiting
+                m_reclaimResources.push_back(p);
+                numPendingLoads += p->GetNumPendingLoads();
+                numPendingEvictions += p->GetNumPendingEvictions();
+
+                ClampedDemand d{ 0, 0, p };
+                if (p->GetClampedDemand(d.m_value, d.m_numTiles, in_frameFenceValue))
                 {
-                    uploadsRequested += m_streamingResources[resourceIndex]->QueueTiles();
+                    m_clampedDemands.push_back(d);
                 }
+            }
+        }
 
-                // tiles that are "loading" can't be evicted. as soon as they arrive, they can be.
-                // note: since we aren't unmapping evicted tiles, we can evict even if no UpdateLists are available
-                numEvictions += m_streamingResources[resourceIndex]->QueuePendingTileEvictions();
+        const UINT numAvailable = pHeap->GetAllocator().GetAvailable() + numPendingEvictions;
+        const UINT numResources = (UINT)m_reclaimResources.size();
 
-                if (m_streamingResources[resourceIndex]->IsStale()) // still have work to do?
-                {
-                    // keep stale resource in compacted array while retaining oldest-first ordering
-                    staleResources[newStaleSize] = resourceIndex;
-                    newStaleSize++;
-                }
-                else
-                {
-                    pending[resourceIndex] = 0; // clear the flag that prevents duplicates
-                }
+        if ((numPendingLoads <= numAvailable) && m_clampedDemands.empty())
+        {
+            continue;
+        }
+
+        m_reclaimCandidates.resize(numResources);
+        for (UINT i = 0; i < numResources; i++)
+        {
+            auto p = m_reclaimResources[i];
+            p->GetReclaimCandidate(m_reclaimCandidates[i], in_frameFenceValue);
+            if (p->GetNumPendingLoads())
+            {
+                float value = ReclaimPolicy::GetValue(m_reclaimCandidates[i].m_importance, p->GetCoarsestPendingLoad());
+                demandValue = std::max(demandValue, value);
             }
-            staleResources.resize(newStaleSize); // compact array
-            if (numEvictions) { m_dataUploader.AddEvictions(numEvictions); }
         }
 
-        // if there are uploads, maybe signal depending on heuristic to minimize # signals
-        if (uploadsRequested)
+        // most valuable clamped demand first
+        std::sort(m_clampedDemands.begin(), m_clampedDemands.end(),
+            [](const ClampedDemand& a, const ClampedDemand& b) { return a.m_value > b.m_value; });
+
+        if (numPendingLoads > numAvailable)
         {
-            // tell the file streamer to signal the corresponding fence
-            if ((flushPendingUploadRequests) || // flush requests from previous frame
-                (0 == staleResources.size()) || // flush because there's no more work to be done (no stale resources, all feedback has been processed)
-                // if we need updatelists and there is a minimum amount of pending work, go ahead and submit
-                // this minimum heuristic prevents "storms" of submits with too few tiles to sustain good throughput
-                ((0 == m_dataUploader.GetNumUpdateListsAvailable()) && (uploadsRequested > m_minNumUploadRequests)))
+            // the most valuable clamped demand competes with pending loads for space
+            UINT numTilesNeeded = numPendingLoads - numAvailable;
+            if (m_clampedDemands.size() && (m_clampedDemands[0].m_value > demandValue))
             {
-                SignalFileStreamer();
-                uploadsRequested = 0;
+                demandValue = m_clampedDemands[0].m_value;
+                numTilesNeeded += m_clampedDemands[0].m_numTiles;
+            }
+
+            UINT numReclaimed = m_reclaimPolicy.Select(m_reclaimMips, m_reclaimCandidates, numTilesNeeded, demandValue);
+            ApplyReclaim();
+            if (numReclaimed) { m_numTotalReclaimedTiles.fetch_add(numReclaimed, std::memory_order_relaxed); }
+        }
+        else
+        {
+            // re-promote while the free space lasts. then at most one promotion that takes space from cheaper tiles,
+            // since victims change the candidates
+            UINT numFree = numAvailable - numPendingLoads;
+            for (const auto& d : m_clampedDemands)
+            {
+                if (d.m_numTiles <= numFree)
+                {
+                    numFree -= d.m_numTiles;
+                    d.m_pResource->RelaxReclaim();
+                    continue;
+                }
+
+                UINT numReclaimed = 0;
+                if (m_reclaimPolicy.Promote(m_reclaimMips, numReclaimed, m_reclaimCandidates, d.m_numTiles, numFree, d.m_value))
+                {
+                    ApplyReclaim();
+                    if (numReclaimed) { m_numTotalReclaimedTiles.fetch_add(numReclaimed, std::memory_order_relaxed); }
+                    d.m_pResource->RelaxReclaim();
+                }
+                break;
             }
         }
+    }
+}
 
-        // nothing to do? wait for next frame
-        // development note: do not Wait() if uploadsRequested != 0. safe because uploadsRequested was cleared above.
-        if (0 == staleResources.size())
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::ApplyReclaim()
+{
+    for (UINT i = 0; i < (UINT)m_reclaimResources.size(); i++)
+    {
+        if (m_reclaimMips[i] > m_reclaimCandidates[i].m_finestMip)
         {
-            ASSERT(0 == uploadsRequested);
-            m_processFeedbackFlag.Wait();
+            m_reclaimResources[i]->Reclaim((UINT8)m_reclaimMips[i]);
         }
     }
-    // if thread exits, flush any pending uploads
-    if (uploadsRequested) { SignalFileStreamer(); }
 }
 
 //-----------------------------------------------------------------------------
@@ -273,18 +649,28 @@ void Streaming::TileUpdateManagerBase::Finish()
         // don't want UpdateResidency to write to min maps when that might be replaced
         m_threadsRunning = false;
 
-        // wake up threads so they can exit
-        m_processFeedbackFlag.Set();
-        m_residencyChangedFlag.Set();
-
-        if (m_processFeedbackThread.joinable())
+        if (m_pJobSystem)
         {
-            m_processFeedbackThread.join();
+            // the services see m_threadsRunning is false and return
+            m_pProcessFeedbackService->WaitIdle();
+            m_pResidencyService->WaitIdle();
+            ProcessFeedbackFlush();
         }
-
-        if (m_updateResidencyThread.joinable())
+        else
         {
-            m_updateResidencyThread.join();
+            // wake up threads so they can exit
+            m_processFeedbackFlag.Set();
+            m_residencyChangedFlag.Set();
+
+            if (m_processFeedbackThread.joinable())
+            {
+                m_processFeedbackThread.join();
+            }
+
+            if (m_updateResidencyThread.joinable())
+            {
+                m_updateResidencyThread.join();
+            }
         }
     }
     // now we are no longer producing work for the DataUploader, so its commands can be drained
@@ -292,58 +678,158 @@ void Streaming::TileUpdateManagerBase::Finish()
 }
 
 //-----------------------------------------------------------------------------
-// allocate residency map buffer large enough for numswapbuffers * min mip map buffers for each StreamingResource
-// StreamingResource::SetResidencyMapOffsetBase() will populate the residency map with latest
-// descriptor handle required to update the assoiated shader resource view
+// remove one resource without draining the pipeline:
+// 1. the residency thread and the ProcessFeedback thread stop referencing it
+// 2. its in-flight UpdateLists complete (they notify the resource)
+// 3. the ProcessFeedback thread, which owns heap allocation, returns its heap space
 //-----------------------------------------------------------------------------
-void Streaming::TileUpdateManagerBase::AllocateResidencyMap(D3D12_CPU_DESCRIPTOR_HANDLE in_descriptorHandle)
+void Streaming::TileUpdateManagerBase::RemoveStreamingResource(StreamingResourceBase* in_pResource)
 {
-    static const UINT alignment = 32; // these are bytes, so align by 32 corresponds to SIMD32
-    static const UINT minBufferSize = 64 * 1024; // multiple of 64KB page
+    ASSERT(!GetWithinFrame());
+
+    // not yet streaming? then only a loader thread might know about it
+    auto i = std::find(m_newStreamingResources.begin(), m_newStreamingResources.end(), in_pResource);
+    if (m_newStreamingResources.end() != i)
+    {
+        m_resourceLoader.Cancel(in_pResource);
+        m_newStreamingResources.erase(i);
+        return;
+    }
+
+    m_residencyLock.Acquire();
+    m_streamingResources.erase(std::remove(m_streamingResources.begin(), m_streamingResources.end(), in_pResource), m_streamingResources.end());
+    m_residencyLock.Release();
 
-    UINT oldBufferSize = 0;
-    if (nullptr != m_residencyMap.GetResource())
+    if (m_threadsRunning)
     {
-        oldBufferSize = (UINT)m_residencyMap.GetResource()->GetDesc().Width;
+        WaitResourceCommand(PostResourceCommand(ResourceCommand::Type::DETACH, in_pResource));
     }
 
-    // allocate residency map buffer large enough for numswapbuffers * min mip map buffers for each StreamingResource
-    m_residencyMapOffsets.resize(m_streamingResources.size());
-    UINT offset = 0;
-    for (UINT i = 0; i < (UINT)m_residencyMapOffsets.size(); i++)
+    // no more UpdateLists can be allocated for this resource
+    while (in_pResource->GetNumUpdateListsInFlight())
     {
-        m_residencyMapOffsets[i] = offset;
+        _mm_pause();
+    }
 
-        UINT minMipMapSize = m_streamingResources[i]->GetNumTilesWidth() * m_streamingResources[i]->GetNumTilesHeight();
+    if (m_threadsRunning)
+    {
+        WaitResourceCommand(PostResourceCommand(ResourceCommand::Type::RELEASE, in_pResource));
+    }
+    else
+    {
+        in_pResource->FreeHeapAllocations();
+    }
 
-        offset += minMipMapSize;
+    // nothing can mark the resource dirty anymore. make sure the residency thread won't visit it
+    // other resources keep their residency map offsets. the space may be re-used by resources added later
+    m_residencyLock.Acquire();
+    m_dirtyResources.Remove(in_pResource);
+    m_residencyMapAllocator.Free(in_pResource->GetMinMipMapOffset(), in_pResource->GetNumTilesWidth() * in_pResource->GetNumTilesHeight());
+    m_residencyLock.Release();
+}
 
-        offset = (offset + alignment - 1) & ~(alignment-1);
+//-----------------------------------------------------------------------------
+// find or create the tile storage for a file in a heap
+// called from StreamingResourceBase::Initialize(), which may run on a resource loader thread
+//-----------------------------------------------------------------------------
+std::shared_ptr<Streaming::SharedTileStorage> Streaming::TileUpdateManagerBase::FindSharedTileStorage(
+    const std::wstring& in_filename, Streaming::Heap* in_pHeap,
+    UINT in_numMips, const D3D12_SUBRESOURCE_TILING* in_pTiling)
+{
+    // different spellings of the same path should share
+    std::error_code ec;
+    std::wstring filename = std::filesystem::weakly_canonical(in_filename, ec);
+    if (ec) { filename = in_filename; }
+
+    std::shared_ptr<SharedTileStorage> pStorage;
+
+    m_sharedTileStorageLock.Acquire();
+
+    auto& entry = m_sharedTileStorage[{ filename, in_pHeap }];
+    pStorage = entry.lock();
+    if (nullptr == pStorage)
+    {
+        pStorage = std::make_shared<SharedTileStorage>(in_numMips, in_pTiling);
+        entry = pStorage;
     }
 
-    if (offset > oldBufferSize)
+    // forget storage whose resources have all been destroyed
+    for (auto i = m_sharedTileStorage.begin(); i != m_sharedTileStorage.end();)
     {
-        UINT bufferSize = std::max(offset, minBufferSize);
-        m_residencyMap.Allocate(m_device.Get(), bufferSize);
+        if (i->second.expired()) { i = m_sharedTileStorage.erase(i); }
+        else { i++; }
+    }
 
-        CreateMinMipMapView(in_descriptorHandle);
+    m_sharedTileStorageLock.Release();
+
+    return pStorage;
+}
+
+//-----------------------------------------------------------------------------
+// sub-allocate space in the shared residency map for new StreamingResources
+// existing resources keep their offsets. if there is not enough space, the buffer grows geometrically
+// and the current contents are copied once
+// StreamingResource::SetResidencyMapOffsetBase() will populate the residency map with its current state
+//-----------------------------------------------------------------------------
+void Streaming::TileUpdateManagerBase::AllocateResidencyMap(D3D12_CPU_DESCRIPTOR_HANDLE in_descriptorHandle,
+    StreamingResourceBase* const* in_ppResources, UINT in_numResources)
+{
+    static const UINT minBufferSize = 64 * 1024; // multiple of 64KB page
+
+    std::vector<UINT> offsets(in_numResources);
+    UINT numBytesNeeded = 0; // space required by resources that did not fit
+    for (UINT i = 0; i < in_numResources; i++)
+    {
+        UINT minMipMapSize = in_ppResources[i]->GetNumTilesWidth() * in_ppResources[i]->GetNumTilesHeight();
+        offsets[i] = m_residencyMapAllocator.Allocate(minMipMapSize);
+        if (BlockAllocator::InvalidOffset == offsets[i])
+        {
+            numBytesNeeded += m_residencyMapAllocator.GetAlignedSize(minMipMapSize);
+        }
+    }
+
+    if (numBytesNeeded)
+    {
+        UINT oldBufferSize = m_residencyMapAllocator.GetCapacity();
+        UINT bufferSize = std::max(2 * oldBufferSize, oldBufferSize + numBytesNeeded);
+        bufferSize = std::max(bufferSize, minBufferSize);
+        bufferSize = (bufferSize + minBufferSize - 1) & ~(minBufferSize - 1);
+
+        // software device: host memory
+        m_residencyMap.Allocate(m_device->GetD3D12Device(), bufferSize, true);
+        m_residencyMapAllocator.Grow(bufferSize);
+
+        if (!m_softwareDevice)
+        {
+            CreateMinMipMapView(in_descriptorHandle);
+        }
 
 #if COPY_RESIDENCY_MAPS
         const auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
         const auto resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-        m_device->CreateCommittedResource(
+        m_device->GetD3D12Device()->CreateCommittedResource(
             &heapProperties,
             D3D12_HEAP_FLAG_NONE, &resourceDesc,
             D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr,
             IID_PPV_ARGS(&m_residencyMapLocal));
         m_residencyMapLocal->SetName(L"m_residencyMapLocal");
 #endif
+
+        // the new space is contiguous at the end of the buffer, so these must succeed
+        for (UINT i = 0; i < in_numResources; i++)
+        {
+            if (BlockAllocator::InvalidOffset == offsets[i])
+            {
+                offsets[i] = m_residencyMapAllocator.Allocate(in_ppResources[i]->GetNumTilesWidth() * in_ppResources[i]->GetNumTilesHeight());
+                ASSERT(BlockAllocator::InvalidOffset != offsets[i]);
+            }
+        }
     }
 
     // set offsets AFTER allocating resource. allows StreamingResource to initialize buffer state
-    for (UINT i = 0; i < (UINT)m_streamingResources.size(); i++)
+    for (UINT i = 0; i < in_numResources; i++)
     {
-        m_streamingResources[i]->SetResidencyMapOffsetBase(m_residencyMapOffsets[i]);
+        in_ppResources[i]->SetResidencyMapOffsetBase(offsets[i]);
     }
 }
 
@@ -359,9 +845,9 @@ void Streaming::TileUpdateManagerBase::CreateMinMipMapView(D3D12_CPU_DESCRIPTOR_
     srvDesc.Shader4ComponentMapping = D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(0, 0, 0, 0);
 
 #if COPY_RESIDENCY_MAPS
-    m_device->CreateShaderResourceView(m_residencyMapLocal.Get(), &srvDesc, in_descriptorHandle);
+    m_device->GetD3D12Device()->CreateShaderResourceView(m_residencyMapLocal.Get(), &srvDesc, in_descriptorHandle);
 #else
-    m_device->CreateShaderResourceView(m_residencyMap.GetResource(), &srvDesc, in_descriptorHandle);
+    m_device->GetD3D12Device()->CreateShaderResourceView(m_residencyMap.GetResource(), &srvDesc, in_descriptorHandle);
 #endif
 }
 
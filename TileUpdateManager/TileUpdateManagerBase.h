@@ -47,12 +47,17 @@ Draw loop:
 #include <vector>
 #include <memory>
 #include <thread>
+#include <map>
 
 #include "SamplerFeedbackStreaming.h"
 #include "D3D12GpuTimer.h"
 #include "Timer.h"
 #include "Streaming.h" // for ComPtr
 #include "DataUploader.h"
+#include "Device.h"
+#include "ReclaimPolicy.h"
+#include "ResourceLoader.h"
+#include "JobSystem.h"
 
 #define COPY_RESIDENCY_MAPS 0
 
@@ -68,6 +73,8 @@ namespace Streaming
     class DataUploader;
     class Heap;
     struct UpdateList;
+    class SharedTileStorage;
+    class FeedbackCapture;
 
     class TileUpdateManagerBase : public ::TileUpdateManager
     {
@@ -78,44 +85,69 @@ namespace Streaming
         virtual void Destroy() override;
         virtual StreamingHeap* CreateStreamingHeap(UINT in_maxNumTilesHeap) override;
         virtual StreamingResource* CreateStreamingResource(const std::wstring& in_filename, StreamingHeap* in_pHeap) override;
+        virtual StreamingResource* CreateStreamingResourceAsync(const std::wstring& in_filename, StreamingHeap* in_pHeap) override;
+        virtual void CreateStreamingResources(std::vector<StreamingResource*>& out_resources, const std::vector<std::wstring>& in_filenames, StreamingHeap* in_pHeap) override;
         virtual void BeginFrame(ID3D12DescriptorHeap* in_pDescriptorHeap, D3D12_CPU_DESCRIPTOR_HANDLE in_minmipmapDescriptorHandle) override;
         virtual void QueueFeedback(StreamingResource* in_pResource, D3D12_GPU_DESCRIPTOR_HANDLE in_gpuDescriptor) override;
+        virtual void QueueSoftwareFeedback(StreamingResource* in_pResource, const BYTE* in_pMinMips) override;
         virtual CommandLists EndFrame() override;
         virtual void UseDirectStorage(bool in_useDS) override;
         virtual bool GetWithinFrame() const  override { return m_withinFrame; }
         virtual float GetGpuTime() const override;
         virtual void SetVisualizationMode(UINT in_mode) override;
         virtual void CaptureTraceFile(bool in_captureTrace) override;
+        virtual void CaptureFeedbackFile(bool in_captureFeedback) override;
         virtual float GetGpuStreamingTime() const override;
         virtual float GetCpuProcessFeedbackTime() override;
         virtual UINT GetTotalNumUploads() const override;
         virtual UINT GetTotalNumEvictions() const override;
         virtual float GetTotalTileCopyLatency() const override;
         virtual UINT GetTotalNumSubmits() const override;
+        virtual UINT GetTotalNumPrefetchRequests() const override;
+        virtual UINT GetTotalNumPrefetchHits() const override;
+        virtual UINT GetTotalNumPrefetchUploads() const override;
+        virtual UINT GetTotalNumFeedbackRegions() const override;
+        virtual UINT GetTotalNumLateRegions() const override;
+        virtual UINT GetTotalNumReclaimedTiles() const override;
+        virtual UINT GetTotalNumSharedTileMappings() const override;
         //-----------------------------------------------------------------
         // end external APIs
         //-----------------------------------------------------------------
 
         //--------------------------------------------
         // force all outstanding commands to complete.
-        // used internally when everthing must drain, e.g. to delete or create a StreamingResource
+        // used internally when everthing must drain, e.g. to change the file streamer
         //--------------------------------------------
         void Finish();
 
-        TileUpdateManagerBase(const struct TileUpdateManagerDesc& in_desc, ID3D12Device8* in_pDevice); // required for constructor
+        //--------------------------------------------
+        // stop tracking a StreamingResource while streaming continues
+        // returns after no thread references it and its heap space has been returned
+        //--------------------------------------------
+        void RemoveStreamingResource(StreamingResourceBase* in_pResource);
+
+        TileUpdateManagerBase(const struct TileUpdateManagerDesc& in_desc, std::unique_ptr<Streaming::Device> in_device); // required for constructor
 
         virtual ~TileUpdateManagerBase();
 
     protected:
-        ComPtr<ID3D12Device8> m_device;
+        std::unique_ptr<Streaming::Device> m_device;
+        const bool m_softwareDevice{ false }; // no gpu: no command lists, feedback from QueueSoftwareFeedback()
 
         const UINT m_numSwapBuffers;
 
         // track the objects that this resource created
         // used to discover which resources have been updated within a frame
+        // only modified by the application thread outside of BeginFrame()/EndFrame(), and under m_residencyLock
         std::vector<StreamingResourceBase*> m_streamingResources;
+
+        // created since the previous BeginFrame(). they start streaming once initialized and given space in the residency map
+        std::vector<StreamingResourceBase*> m_newStreamingResources;
         UINT64 m_frameFenceValue{ 0 };
 
+        // optional: replaces the streaming threads. declared before, so destroyed after, the DataUploader that uses it
+        std::unique_ptr<Streaming::JobSystem> m_pJobSystem;
+
         Streaming::DataUploader m_dataUploader;
 
         // each StreamingResource writes current uploaded tile state to min mip map, separate data for each frame
@@ -124,18 +156,49 @@ namespace Streaming
 
         Streaming::SynchronizationFlag m_residencyChangedFlag;
 
-        // allocating/deallocating StreamingResources requires reallocation of shared resources
-        bool m_numStreamingResourcesChanged{ false };
+        // resources whose residency changed since the residency thread last visited them
+        Streaming::DirtyList<StreamingResourceBase> m_dirtyResources;
+
+        // held by the residency thread while it writes the residency map
+        // and by the application thread while it changes m_streamingResources or reallocates the residency map
+        Streaming::Lock m_residencyLock;
 
         std::atomic<bool> m_packedMipTransition{ false }; // flag that we need to transition a resource due to packed mips
 
-    private:
-        // direct queue is used to monitor progress of render frames so we know when feedback buffers are ready to be used
-        ComPtr<ID3D12CommandQueue> m_directCommandQueue;
+        const bool m_enablePrefetch{ false }; // speculative tile references, see StreamingResourceBase::ProcessFeedback()
 
+        // prefetch statistics, written by the ProcessFeedback thread
+        std::atomic<UINT> m_numTotalPrefetchRequests{ 0 };
+        std::atomic<UINT> m_numTotalPrefetchHits{ 0 };
+        std::atomic<UINT> m_numTotalPrefetchUploads{ 0 };
+
+        const float m_targetHeapOccupancy{ 0 }; // 0 disables feedback bias control
+
+        const UINT m_feedbackDilationRadius{ 0 };
+        // maps the dilated (neighborhood minimum) mip to the mip neighbors request. empty if all mip biases are 0
+        std::vector<UINT8> m_feedbackDilationMips;
+
+        // late-load statistics, written by the ProcessFeedback thread
+        const bool m_lateRegionStatistics{ false };
+        std::atomic<UINT> m_numTotalFeedbackRegions{ 0 };
+        std::atomic<UINT> m_numTotalLateRegions{ 0 };
+
+        const bool m_enableReclaim{ false }; // reclaim referenced tiles under heap pressure
+        std::atomic<UINT> m_numTotalReclaimedTiles{ 0 };
+
+        // tiles shared by resources created from the same file in the same heap
+        // the storage lives as long as some resource holds it. may be accessed by resource loader threads
+        const bool m_shareTilesByFile{ false };
+        std::map<std::pair<std::wstring, Streaming::Heap*>, std::weak_ptr<Streaming::SharedTileStorage>> m_sharedTileStorage;
+        Streaming::Lock m_sharedTileStorageLock;
+        std::shared_ptr<Streaming::SharedTileStorage> FindSharedTileStorage(const std::wstring& in_filename, Streaming::Heap* in_pHeap,
+            UINT in_numMips, const D3D12_SUBRESOURCE_TILING* in_pTiling);
+
+    private:
         // the frame fence is used to optimize readback of feedback by StreamingResource
         // only read back the feedback after the frame that writes to it has completed
-        ComPtr<ID3D12Fence> m_frameFence;
+        // it is signaled on the device's direct queue, to monitor progress of render frames
+        std::unique_ptr<DeviceFence> m_frameFence;
 
         struct FeedbackReadback
         {
@@ -151,11 +214,78 @@ namespace Streaming
 
         Streaming::SynchronizationFlag m_processFeedbackFlag;
 
-        std::atomic<bool> m_havePackedMipsToLoad{ false };
+        std::vector<StreamingResourceBase*> m_packedMipsPending; // ProcessFeedback thread: resources whose packed mips have not been requested
 
         void StartThreads();
         void ProcessFeedbackThread();
 
+        // one iteration of the ProcessFeedback thread. returns true if there is more work, i.e. don't wait for the next frame
+        bool ProcessFeedbackPass();
+        // when the ProcessFeedback thread stops: submit pending uploads, forget stale resources
+        void ProcessFeedbackFlush();
+        std::vector<StreamingResourceBase*> m_staleResources; // resources that need tiles loaded/evicted, oldest first
+        UINT m_uploadsRequested{ 0 }; // remember if any work was queued so we can signal afterwards
+        UINT64 m_previousFrameFenceValue{ 0 };
+
+        // apply this frame's feedback to every resource, in parallel if there is a job system
+        void ProcessFeedbackResources(UINT64 in_frameFenceValue);
+        static const UINT m_feedbackJobSize{ 16 }; // resources per job
+        std::vector<Streaming::JobSystem::JobHandle> m_feedbackJobs; // scratch
+
+        //---------------------------------------------------------------------------
+        // StreamingResources are added and removed without stopping the ProcessFeedback thread
+        // it has its own list of resources, changed by commands at the top of its loop (a safe point)
+        //---------------------------------------------------------------------------
+        struct ResourceCommand
+        {
+            enum class Type : UINT
+            {
+                ADD,     // start streaming
+                DETACH,  // stop streaming. submits any uploads that have been queued
+                RELEASE  // return heap space. only after in-flight UpdateLists have completed
+            };
+            Type m_type;
+            StreamingResourceBase* m_pResource;
+        };
+        std::vector<ResourceCommand> m_resourceCommands;
+        std::vector<ResourceCommand> m_resourceCommandsScratch; // ProcessFeedback thread
+        Streaming::Lock m_resourceCommandLock;
+        UINT64 m_numResourceCommandsPosted{ 0 };
+        std::atomic<UINT64> m_numResourceCommandsDone{ 0 };
+
+        // returns a ticket to wait on
+        UINT64 PostResourceCommand(ResourceCommand::Type in_type, StreamingResourceBase* in_pResource);
+        UINT64 PostResourceCommands(ResourceCommand::Type in_type, StreamingResourceBase* const* in_ppResources, UINT in_numResources);
+        void WaitResourceCommand(UINT64 in_ticket);
+
+        // called by the ProcessFeedback thread
+        void ProcessResourceCommands(std::vector<StreamingResourceBase*>& io_staleResources, UINT& io_uploadsRequested);
+        std::vector<StreamingResourceBase*> m_feedbackResources; // ProcessFeedback thread's copy of m_streamingResources
+
+        // heaps are not tracked by TUM. find the heaps used by StreamingResources
+        void GatherHeaps();
+        std::vector<Streaming::Heap*> m_heaps; // scratch
+
+        // once per frame, update the feedback bias of every heap used by a StreamingResource
+        void UpdateFeedbackBias();
+
+        // once per frame, reclaim referenced tiles from heaps that can't fit their pending loads
+        void ReclaimHeapTiles(UINT64 in_frameFenceValue);
+        Streaming::ReclaimPolicy m_reclaimPolicy;
+        std::vector<StreamingResourceBase*> m_reclaimResources;      // scratch: resources in a heap
+        std::vector<ReclaimPolicy::Candidate> m_reclaimCandidates;  // scratch: corresponding candidates
+        std::vector<UINT> m_reclaimMips;                            // scratch: results
+        struct ClampedDemand
+        {
+            float m_value;
+            UINT m_numTiles;
+            StreamingResourceBase* m_pResource;
+        };
+        std::vector<ClampedDemand> m_clampedDemands;                // scratch: resources whose feedback was clamped by reclaim
+
+        // reclaim the mips in m_reclaimMips (from ReclaimPolicy) of m_reclaimResources
+        void ApplyReclaim();
+
         //---------------------------------------------------------------------------
         // TUM creates 2 command lists to be executed Before & After application draw
         // these clear & resolve feedback buffers, coalescing all their barriers
@@ -176,17 +306,22 @@ namespace Streaming
 
         UINT m_renderFrameIndex{ 0 };
 
-        D3D12GpuTimer m_gpuTimerResolve; // time for feedback resolve
+        std::unique_ptr<D3D12GpuTimer> m_pGpuTimerResolve; // time for feedback resolve. only with a d3d12 device
 
         RawCpuTimer m_cpuTimer;
         std::atomic<INT64> m_processFeedbackTime{ 0 }; // sum of cpu timer times since start
         INT64 m_previousFeedbackTime{ 0 }; // m_processFeedbackTime at time of last query
         float m_processFeedbackFrameTime{ 0 }; // cpu time spent processing feedback for the most recent frame
 
+        // created the first time capture is enabled, written by ProcessFeedback while m_captureFeedback is set
+        std::unique_ptr<FeedbackCapture> m_pFeedbackCapture;
+        std::atomic<bool> m_captureFeedback{ false };
+
         // are we between BeginFrame and EndFrame? useful for debugging
         std::atomic<bool> m_withinFrame{ false };
 
-        void AllocateResidencyMap(D3D12_CPU_DESCRIPTOR_HANDLE in_descriptorHandle);
+        void AllocateResidencyMap(D3D12_CPU_DESCRIPTOR_HANDLE in_descriptorHandle,
+            StreamingResourceBase* const* in_ppResources, UINT in_numResources);
 
         struct CommandList
         {
@@ -208,16 +343,28 @@ namespace Streaming
 
         // UpdateResidency thread's lifetime is bound to m_processFeedbackThread
         std::thread m_updateResidencyThread;
+        void UpdateResidency();
+
+        // with a job system, the threads above are services. created once, they return immediately while stopped
+        std::unique_ptr<Streaming::JobSystem::Service> m_pProcessFeedbackService;
+        std::unique_ptr<Streaming::JobSystem::Service> m_pResidencyService;
+        void WakeProcessFeedback() { if (m_pProcessFeedbackService) { m_pProcessFeedbackService->Kick(); } else { m_processFeedbackFlag.Set(); } }
+        void WakeResidency() { if (m_pResidencyService) { m_pResidencyService->Kick(); } else { m_residencyChangedFlag.Set(); } }
 
         // the min mip map is shared. it must be created (at least) every time a StreamingResource is created/destroyed
         void CreateMinMipMapView(D3D12_CPU_DESCRIPTOR_HANDLE in_descriptor);
 
-        std::vector<UINT> m_residencyMapOffsets; // one min mip map for each StreamingResource
+        // one min mip map for each StreamingResource, 32-byte aligned (SIMD32)
+        Streaming::BlockAllocator m_residencyMapAllocator{ 32 };
 
         //-------------------------------------------
         // statistics
         //-------------------------------------------
         std::atomic<UINT> m_numTotalSubmits{ 0 };
+
+        // initializes resources from CreateStreamingResourceAsync()
+        // declared last so its threads exit before the objects they use are destroyed
+        Streaming::ResourceLoader m_resourceLoader;
     };
 }
 /*
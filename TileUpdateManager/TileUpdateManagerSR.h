@@ -62,17 +62,13 @@ namespace Streaming
     class TileUpdateManagerSR : public TileUpdateManagerBase
     {
     public:
-        ID3D12Device8* GetDevice() const { return m_device.Get(); }
+        Device* GetDevice() const { return m_device.get(); }
 
         UINT GetNumSwapBuffers() const { return m_numSwapBuffers; }
 
         // stop tracking this StreamingResource. Called by its destructor
-        void Remove(StreamingResourceBase* in_pResource)
-        {
-            ASSERT(!GetWithinFrame());
-            m_streamingResources.erase(std::remove(m_streamingResources.begin(), m_streamingResources.end(), in_pResource), m_streamingResources.end());
-            m_numStreamingResourcesChanged = true;
-        }
+        // returns after its in-flight work has completed and its heap space has been freed
+        void Remove(StreamingResourceBase* in_pResource) { RemoveStreamingResource(in_pResource); }
 
         UploadBuffer& GetResidencyMap() { return m_residencyMap; }
 
@@ -91,11 +87,51 @@ namespace Streaming
 
         void NotifyPackedMips() { m_packedMipTransition = true; } // called when a StreamingResource has recieved its packed mips
 
-        ID3D12CommandQueue* GetMappingQueue() const
+        DeviceQueue* GetMappingQueue() const
         {
             return m_dataUploader.GetMappingQueue();
         }
 
-        void SetResidencyChanged() { m_residencyChangedFlag.Set(); }
+        // called when a resource first becomes dirty. the residency thread will only visit dirty resources
+        void SetResidencyChanged(StreamingResourceBase* in_pResource)
+        {
+            m_dirtyResources.Push(in_pResource);
+            WakeResidency();
+        }
+
+        bool GetPrefetchEnabled() const { return m_enablePrefetch; }
+
+        // called by ProcessFeedback thread
+        void AddPrefetchStatistics(UINT in_numRequests, UINT in_numHits, UINT in_numUploads)
+        {
+            if (in_numRequests) { m_numTotalPrefetchRequests.fetch_add(in_numRequests, std::memory_order_relaxed); }
+            if (in_numHits) { m_numTotalPrefetchHits.fetch_add(in_numHits, std::memory_order_relaxed); }
+            if (in_numUploads) { m_numTotalPrefetchUploads.fetch_add(in_numUploads, std::memory_order_relaxed); }
+        }
+
+        bool GetShareTilesByFile() const { return m_shareTilesByFile; }
+
+        // returns the storage shared by all resources created from this file in this heap
+        std::shared_ptr<Streaming::SharedTileStorage> GetSharedTileStorage(const std::wstring& in_filename, Streaming::Heap* in_pHeap,
+            UINT in_numMips, const D3D12_SUBRESOURCE_TILING* in_pTiling)
+        {
+            return FindSharedTileStorage(in_filename, in_pHeap, in_numMips, in_pTiling);
+        }
+
+        // null unless feedback capture is enabled
+        FeedbackCapture* GetFeedbackCapture() const { return m_captureFeedback ? m_pFeedbackCapture.get() : nullptr; }
+
+        UINT GetFeedbackDilationRadius() const { return m_feedbackDilationRadius; }
+        const UINT8* GetFeedbackDilationMips() const { return m_feedbackDilationMips.size() ? m_feedbackDilationMips.data() : nullptr; }
+
+        bool GetLateRegionStatisticsEnabled() const { return m_lateRegionStatistics; }
+        bool GetReclaimEnabled() const { return m_enableReclaim; }
+
+        // called by ProcessFeedback thread
+        void AddFeedbackStatistics(UINT in_numRegions, UINT in_numLate)
+        {
+            m_numTotalFeedbackRegions.fetch_add(in_numRegions, std::memory_order_relaxed);
+            m_numTotalLateRegions.fetch_add(in_numLate, std::memory_order_relaxed);
+        }
     };
 }
@@ -0,0 +1,106 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <windows.h>
+
+//=============================================================================
+// binary trace of the DirectStorage requests and submits made by FileStreamerDS
+// written by TraceWriter, played back by tracePlayer (which also converts to/from the older json format)
+//
+// file: FileHeader, then a sequence of records, each starting with a RecordType
+//     RESOURCE: ResourceRecord
+//     STRING:   StringRecord, then m_length bytes of UTF-8 (not terminated)
+//     REQUEST:  RequestRecord
+//     SUBMIT:   SubmitRecord
+// requests are buffered per thread, so records are not in submit order and may precede
+// the resource or string they refer to. readers group requests by m_submitIndex
+//=============================================================================
+namespace Streaming
+{
+    namespace TraceFile
+    {
+        constexpr UINT32 MAGIC = 0x52544653; // "SFTR"
+        constexpr UINT32 VERSION = 1;
+
+        enum class RecordType : UINT32
+        {
+            RESOURCE = 1,
+            STRING,
+            REQUEST,
+            SUBMIT
+        };
+
+        struct FileHeader
+        {
+            UINT32 m_magic{ MAGIC };
+            UINT32 m_version{ VERSION };
+            UINT64 m_ticksPerSecond{ 0 }; // units of SubmitRecord::m_time
+        };
+
+        // a reserved resource that received tiles
+        struct ResourceRecord
+        {
+            UINT64 m_resourceID;
+            UINT32 m_format;
+            UINT32 m_width;
+            UINT32 m_height;
+            UINT32 m_mipLevels;
+        };
+
+        // a source file name, relative to the media directory
+        struct StringRecord
+        {
+            UINT32 m_stringID;
+            UINT32 m_length;
+        };
+
+        // one tile read from a file into a resource
+        struct RequestRecord
+        {
+            UINT64 m_resourceID;
+            UINT64 m_offset;
+            UINT32 m_submitIndex;
+            UINT32 m_fileID; // StringRecord::m_stringID
+            UINT32 m_numBytes;
+            UINT32 m_compressionFormat;
+            UINT32 m_x;
+            UINT32 m_y;
+            UINT32 m_subresource;
+            UINT32 m_reserved{ 0 };
+        };
+
+        // the requests with the same submit index were submitted together
+        struct SubmitRecord
+        {
+            UINT64 m_time; // ticks since the trace started
+            UINT32 m_submitIndex;
+            UINT32 m_numRequests;
+        };
+    }
+}
@@ -0,0 +1,178 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include "pch.h"
+
+#include "TraceWriter.h"
+
+namespace
+{
+    std::atomic<UINT64> g_nextTraceWriterID{ 1 };
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Streaming::TraceWriter::TraceWriter(const std::wstring& in_filename) :
+    m_file(in_filename, std::ios::out | std::ios::binary | std::ios::trunc)
+    , m_writerID(g_nextTraceWriterID++)
+{
+    LARGE_INTEGER frequency{};
+    ::QueryPerformanceFrequency(&frequency);
+
+    TraceFile::FileHeader header;
+    header.m_ticksPerSecond = (UINT64)frequency.QuadPart;
+    m_file.write((const char*)&header, sizeof(header));
+
+    LARGE_INTEGER ticks{};
+    ::QueryPerformanceCounter(&ticks);
+    m_startTicks = ticks.QuadPart;
+}
+
+Streaming::TraceWriter::~TraceWriter()
+{
+    for (auto& b : m_threadBuffers)
+    {
+        Flush(*b);
+    }
+    m_file.close();
+}
+
+//-----------------------------------------------------------------------------
+// find the calling thread's buffer. the lock is only taken the first time
+// a thread traces to this writer, or when it alternates between writers
+//-----------------------------------------------------------------------------
+Streaming::TraceWriter::ThreadBuffer& Streaming::TraceWriter::GetThreadBuffer()
+{
+    thread_local UINT64 t_writerID{ 0 };
+    thread_local ThreadBuffer* t_pBuffer{ nullptr };
+
+    if (m_writerID != t_writerID)
+    {
+        const auto threadID = std::this_thread::get_id();
+
+        m_lock.Acquire();
+
+        t_pBuffer = nullptr;
+        for (auto& b : m_threadBuffers)
+        {
+            if (threadID == b->m_threadID)
+            {
+                t_pBuffer = b.get();
+                break;
+            }
+        }
+        if (nullptr == t_pBuffer)
+        {
+            m_threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+            t_pBuffer = m_threadBuffers.back().get();
+            t_pBuffer->m_threadID = threadID;
+            t_pBuffer->m_data.reserve(BUFFER_SIZE);
+        }
+        t_writerID = m_writerID;
+
+        m_lock.Release();
+    }
+
+    return *t_pBuffer;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::TraceWriter::Flush(ThreadBuffer& in_buffer)
+{
+    if (in_buffer.m_data.size())
+    {
+        m_lock.Acquire();
+        m_file.write((const char*)in_buffer.m_data.data(), in_buffer.m_data.size());
+        m_lock.Release();
+
+        in_buffer.m_data.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// the resource and file name records are written the first time they are referenced
+//-----------------------------------------------------------------------------
+void Streaming::TraceWriter::Request(UINT32 in_submitIndex,
+    ID3D12Resource* in_pDstResource, const D3D12_TILED_RESOURCE_COORDINATE& in_dstCoord,
+    const std::wstring& in_srcFilename, UINT64 in_srcOffset, UINT32 in_srcNumBytes, UINT32 in_compressionFormat)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    m_lock.Acquire();
+    bool newResource = m_resources.insert(in_pDstResource).second;
+    auto s = m_strings.find(in_srcFilename);
+    bool newString = (m_strings.end() == s);
+    if (newString)
+    {
+        s = m_strings.insert({ in_srcFilename, (UINT32)m_strings.size() }).first;
+    }
+    UINT32 fileID = s->second;
+    m_lock.Release();
+
+    if (newResource)
+    {
+        auto desc = in_pDstResource->GetDesc();
+        Append(buffer, TraceFile::RecordType::RESOURCE, TraceFile::ResourceRecord{ (UINT64)in_pDstResource,
+            (UINT32)desc.Format, (UINT32)desc.Width, (UINT32)desc.Height, (UINT32)desc.MipLevels });
+    }
+
+    if (newString)
+    {
+        std::wstring wideFilename = std::filesystem::path(in_srcFilename).filename().wstring();
+        std::string filename;
+        int bufLen = ::WideCharToMultiByte(CP_UTF8, 0, wideFilename.c_str(), (int)wideFilename.size(), NULL, 0, NULL, NULL);
+        filename.resize(bufLen);
+        ::WideCharToMultiByte(CP_UTF8, 0, wideFilename.c_str(), (int)wideFilename.size(), filename.data(), bufLen, NULL, NULL);
+
+        Append(buffer, TraceFile::RecordType::STRING, TraceFile::StringRecord{ fileID, (UINT32)filename.size() });
+        buffer.m_data.insert(buffer.m_data.end(), filename.begin(), filename.end());
+    }
+
+    TraceFile::RequestRecord r{};
+    r.m_resourceID = (UINT64)in_pDstResource;
+    r.m_offset = in_srcOffset;
+    r.m_submitIndex = in_submitIndex;
+    r.m_fileID = fileID;
+    r.m_numBytes = in_srcNumBytes;
+    r.m_compressionFormat = in_compressionFormat;
+    r.m_x = in_dstCoord.X;
+    r.m_y = in_dstCoord.Y;
+    r.m_subresource = in_dstCoord.Subresource;
+    Append(buffer, TraceFile::RecordType::REQUEST, r);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Streaming::TraceWriter::Submit(UINT32 in_submitIndex, UINT32 in_numRequests)
+{
+    LARGE_INTEGER ticks{};
+    ::QueryPerformanceCounter(&ticks);
+
+    Append(GetThreadBuffer(), TraceFile::RecordType::SUBMIT,
+        TraceFile::SubmitRecord{ UINT64(ticks.QuadPart - m_startTicks), in_submitIndex, in_numRequests });
+}
@@ -0,0 +1,93 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <d3d12.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Streaming.h"
+#include "TraceFile.h"
+
+//=============================================================================
+// writes a TraceFile incrementally while streaming
+// records are appended to a buffer owned by the calling thread, which is written to the file
+// when full, so tracing costs a copy per request instead of a file write (or a json node)
+//=============================================================================
+namespace Streaming
+{
+    class TraceWriter
+    {
+    public:
+        TraceWriter(const std::wstring& in_filename);
+        ~TraceWriter(); // writes the remaining buffers. threads that trace must have stopped
+
+        // in_srcFilename may be a full path, only the file name is recorded
+        void Request(UINT32 in_submitIndex,
+            ID3D12Resource* in_pDstResource, const D3D12_TILED_RESOURCE_COORDINATE& in_dstCoord,
+            const std::wstring& in_srcFilename, UINT64 in_srcOffset, UINT32 in_srcNumBytes, UINT32 in_compressionFormat);
+
+        void Submit(UINT32 in_submitIndex, UINT32 in_numRequests);
+    private:
+        static constexpr UINT BUFFER_SIZE = 64 * 1024;
+
+        struct ThreadBuffer
+        {
+            std::thread::id m_threadID;
+            std::vector<BYTE> m_data;
+        };
+
+        std::ofstream m_file;
+        Lock m_lock; // protects the file, the buffer list, and the resource/string tables
+
+        const UINT64 m_writerID; // distinguishes this writer in the calling threads' buffer caches
+        std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+
+        INT64 m_startTicks{ 0 };
+
+        std::unordered_set<ID3D12Resource*> m_resources;
+        std::unordered_map<std::wstring, UINT32> m_strings;
+
+        ThreadBuffer& GetThreadBuffer();
+        void Flush(ThreadBuffer& in_buffer);
+
+        template<typename T> void Append(ThreadBuffer& in_buffer, TraceFile::RecordType in_type, const T& in_record)
+        {
+            if (in_buffer.m_data.size() + sizeof(in_type) + sizeof(T) > BUFFER_SIZE) { Flush(in_buffer); }
+            auto pType = (const BYTE*)&in_type;
+            in_buffer.m_data.insert(in_buffer.m_data.end(), pType, pType + sizeof(in_type));
+            auto pRecord = (const BYTE*)&in_record;
+            in_buffer.m_data.insert(in_buffer.m_data.end(), pRecord, pRecord + sizeof(T));
+        }
+    };
+}
@@ -39,5 +39,7 @@ void Streaming::UpdateList::Reset(Streaming::StreamingResourceDU* in_pStreamingR
     m_coords.clear();         // indicates standard tile map & upload
     m_heapIndices.clear();    // because AddUpdate() does a push_back()
     m_evictCoords.clear();    // indicates tiles to un-map
+    m_mapCoords.clear();      // indicates tiles to map without upload
+    m_mapHeapIndices.clear();
     m_copyLatencyTimer = 0;   // clear latency timer
 }
@@ -77,8 +77,13 @@ namespace Streaming
         // tile evictions:
         std::vector<D3D12_TILED_RESOURCE_COORDINATE> m_evictCoords;
 
+        // tiles already in the heap (shared storage), map only:
+        std::vector<D3D12_TILED_RESOURCE_COORDINATE> m_mapCoords;
+        std::vector<UINT> m_mapHeapIndices;
+
         UINT GetNumStandardUpdates() const { return (UINT)m_coords.size(); }
         UINT GetNumEvictions() const { return (UINT)m_evictCoords.size(); }
+        UINT GetNumMapOnly() const { return (UINT)m_mapCoords.size(); }
 
         void Reset(Streaming::StreamingResourceDU* in_pStreamingResource);
 
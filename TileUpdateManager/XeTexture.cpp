@@ -72,6 +72,47 @@ UINT Streaming::XeTexture::GetPackedMipFileOffset(UINT* out_pNumBytesTotal, UINT
     return packedOffset;
 }
 
+//-----------------------------------------------------------------------------
+// the tile shape isn't stored. derive it from the dimensions of the first mip, tile shapes are powers of 2
+//-----------------------------------------------------------------------------
+void Streaming::XeTexture::GetTiling(UINT* out_pNumTilesTotal, D3D12_PACKED_MIP_INFO* out_pPackedMipInfo,
+    D3D12_TILE_SHAPE* out_pTileShape, UINT in_numSubresources, D3D12_SUBRESOURCE_TILING* out_pTiling) const
+{
+    const auto& mipInfo = m_fileHeader.m_mipInfo;
+
+    *out_pNumTilesTotal = mipInfo.m_numTilesForStandardMips + mipInfo.m_numTilesForPackedMips;
+
+    out_pPackedMipInfo->NumStandardMips = (UINT8)mipInfo.m_numStandardMips;
+    out_pPackedMipInfo->NumPackedMips = (UINT8)mipInfo.m_numPackedMips;
+    out_pPackedMipInfo->NumTilesForPackedMips = mipInfo.m_numTilesForPackedMips;
+    out_pPackedMipInfo->StartTileIndexInOverallResource = mipInfo.m_numTilesForStandardMips;
+
+    auto RoundUpPow2 = [](UINT in_value) { UINT v = 1; while (v < in_value) { v <<= 1; } return v; };
+
+    *out_pTileShape = D3D12_TILE_SHAPE{ 1, 1, 1 };
+    if (mipInfo.m_numStandardMips)
+    {
+        const auto& mip0 = m_subresourceInfo[0].m_standardMipInfo;
+        out_pTileShape->WidthInTexels = RoundUpPow2((GetImageWidth() + mip0.m_widthTiles - 1) / mip0.m_widthTiles);
+        out_pTileShape->HeightInTexels = RoundUpPow2((GetImageHeight() + mip0.m_heightTiles - 1) / mip0.m_heightTiles);
+    }
+
+    const UINT numSubresources = std::min(in_numSubresources, (UINT)m_subresourceInfo.size());
+    for (UINT s = 0; s < numSubresources; s++)
+    {
+        if (s < mipInfo.m_numStandardMips)
+        {
+            const auto& data = m_subresourceInfo[s].m_standardMipInfo;
+            out_pTiling[s] = D3D12_SUBRESOURCE_TILING{ data.m_widthTiles, (UINT16)data.m_heightTiles,
+                (UINT16)data.m_depthTiles, data.m_subresourceTileIndex };
+        }
+        else
+        {
+            out_pTiling[s] = D3D12_SUBRESOURCE_TILING{ 0, 0, 0, D3D12_PACKED_TILE };
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 // compute linear tile index from subresource info
 //-----------------------------------------------------------------------------
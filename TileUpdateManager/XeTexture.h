@@ -54,6 +54,11 @@ namespace Streaming
 
         UINT GetPackedMipFileOffset(UINT* out_pNumBytesTotal, UINT* out_pNumBytesUncompressed) const;
 
+        // tile properties recorded when the file was created, same layout as ID3D12Device::GetResourceTiling()
+        // used when there is no device to query, e.g. a software Device
+        void GetTiling(UINT* out_pNumTilesTotal, D3D12_PACKED_MIP_INFO* out_pPackedMipInfo,
+            D3D12_TILE_SHAPE* out_pTileShape, UINT in_numSubresources, D3D12_SUBRESOURCE_TILING* out_pTiling) const;
+
         XeTexture(const std::wstring& in_filename);
     protected:
         XeTexture(const XeTexture&) = delete;
@@ -0,0 +1,453 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+// replays a feedback capture through TileUpdateManager on a software device, without a gpu
+// the feedback drives the same ProcessFeedback, eviction, and residency logic as the application;
+// tile data is read from the files but discarded, and each copy/mapping completes -latency ms after submission
+// create captures with the command line parameter "-captureFeedback"
+// for example, "expanse.exe -timingStart 100 -timingStop 600 -captureFeedback"
+// then "feedbackReplay.exe -capture feedbackCapture_1.bin -latency 2"
+// per frame, reports tiles loaded and evicted, heap occupancy, cpu time, late regions, prefetch, and reclaim
+// to A/B a policy, replay the same capture with different policy parameters (-prefetch, -dilationRadius, -reclaim...)
+// or with each build of a code change, and compare
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <d3d12.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <filesystem>
+#include <algorithm>
+#include <sstream>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "SamplerFeedbackStreaming.h"
+#include "FeedbackCapture.h"
+
+#pragma comment(lib, "TileUpdateManager.lib")
+#pragma comment(lib, "d3d12.lib")
+
+#define ErrorMessage(...) { std::wcout << AutoString::Concat(__VA_ARGS__) << std::endl; exit(-1); }
+
+struct Params
+{
+    std::wstring m_captureFile;
+    std::wstring m_mediaDir;       // if a captured file doesn't exist, look for a file with the same name here
+    float m_latencyMs{ 2 };        // simulated latency of uploads and mapping
+    float m_frameTimeMs{ 16.67f }; // minimum time per frame. 0: as fast as possible
+    UINT m_heapSizeTiles{ 0 };     // 0: heap sizes from the capture
+    UINT m_numWorkerThreads{ 0 };  // see TileUpdateManagerDesc::m_numWorkerThreads
+    std::wstring m_csvFile;        // optionally write per-frame statistics
+
+    // policies, see TileUpdateManagerDesc
+    bool m_enablePrefetch{ false };
+    UINT m_dilationRadius{ 0 };
+    UINT m_dilationMipBias{ 0 };
+    std::vector<UINT> m_dilationMipBiasPerMip;
+    float m_targetHeapOccupancy{ 0 };
+    bool m_enableReclaim{ false };
+};
+
+//-----------------------------------------------------------------------------
+// running totals reported by TileUpdateManager. per-frame values are differences
+//-----------------------------------------------------------------------------
+struct Totals
+{
+    UINT m_uploads{ 0 };
+    UINT m_evictions{ 0 };
+    UINT m_feedbackRegions{ 0 };
+    UINT m_lateRegions{ 0 };
+    UINT m_prefetchRequests{ 0 };
+    UINT m_prefetchHits{ 0 };
+    UINT m_prefetchUploads{ 0 };
+    UINT m_reclaimedTiles{ 0 };
+
+    Totals(TileUpdateManager* in_pTileUpdateManager) :
+        m_uploads(in_pTileUpdateManager->GetTotalNumUploads())
+        , m_evictions(in_pTileUpdateManager->GetTotalNumEvictions())
+        , m_feedbackRegions(in_pTileUpdateManager->GetTotalNumFeedbackRegions())
+        , m_lateRegions(in_pTileUpdateManager->GetTotalNumLateRegions())
+        , m_prefetchRequests(in_pTileUpdateManager->GetTotalNumPrefetchRequests())
+        , m_prefetchHits(in_pTileUpdateManager->GetTotalNumPrefetchHits())
+        , m_prefetchUploads(in_pTileUpdateManager->GetTotalNumPrefetchUploads())
+        , m_reclaimedTiles(in_pTileUpdateManager->GetTotalNumReclaimedTiles())
+    {}
+
+    Totals operator-(const Totals& in_b) const
+    {
+        Totals t(*this);
+        t.m_uploads -= in_b.m_uploads;
+        t.m_evictions -= in_b.m_evictions;
+        t.m_feedbackRegions -= in_b.m_feedbackRegions;
+        t.m_lateRegions -= in_b.m_lateRegions;
+        t.m_prefetchRequests -= in_b.m_prefetchRequests;
+        t.m_prefetchHits -= in_b.m_prefetchHits;
+        t.m_prefetchUploads -= in_b.m_prefetchUploads;
+        t.m_reclaimedTiles -= in_b.m_reclaimedTiles;
+        return t;
+    }
+
+    float GetLatePercent() const { return m_feedbackRegions ? (100.0f * m_lateRegions) / m_feedbackRegions : 0; }
+    float GetPrefetchAccuracy() const { return m_prefetchRequests ? float(m_prefetchHits) / m_prefetchRequests : 0; }
+};
+
+//-----------------------------------------------------------------------------
+// the capture, read entirely into memory
+//-----------------------------------------------------------------------------
+class Capture
+{
+public:
+    struct Resource
+    {
+        UINT32 m_heapID;
+        std::wstring m_filename;
+    };
+
+    struct Feedback
+    {
+        UINT32 m_resourceID;
+        UINT m_width;
+        UINT m_height;
+        size_t m_offset; // into m_minMips
+    };
+
+    std::vector<UINT32> m_heapNumTiles;   // indexed by heap id
+    std::vector<Resource> m_resources;    // indexed by resource id
+    std::vector<std::vector<Feedback>> m_frames; // one entry per frame from the first to the last captured frame, possibly empty
+    std::vector<UINT8> m_minMips;
+
+    void Read(const std::wstring& in_filename);
+};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Capture::Read(const std::wstring& in_filename)
+{
+    using Format = Streaming::FeedbackCapture;
+
+    std::ifstream inFile(in_filename, std::ios::in | std::ios::binary);
+    if (!inFile.is_open()) { ErrorMessage(L"failed to open capture ", in_filename); }
+
+    auto read = [&](auto& out_value) { return bool(inFile.read((char*)&out_value, sizeof(out_value))); };
+
+    Format::FileHeader header{};
+    if ((!read(header)) || (Format::MAGIC != header.m_magic) || (Format::VERSION != header.m_version))
+    {
+        ErrorMessage(L"not a feedback capture, or an unsupported version: ", in_filename);
+    }
+
+    // one ProcessFeedback pass records each resource's latest queued feedback, so frame numbers
+    // within the file are not in order. collect the records, then group them by frame
+    std::vector<std::pair<UINT64, Feedback>> feedback;
+    Format::RecordType recordType{};
+    while (read(recordType))
+    {
+        switch (recordType)
+        {
+        case Format::RecordType::HEAP:
+        {
+            Format::HeapRecord r{};
+            read(r);
+            if (r.m_heapID >= m_heapNumTiles.size()) { m_heapNumTiles.resize(r.m_heapID + 1, 0); }
+            m_heapNumTiles[r.m_heapID] = r.m_numTiles;
+        }
+        break;
+
+        case Format::RecordType::RESOURCE:
+        {
+            Format::ResourceRecord r{};
+            read(r);
+            if (r.m_resourceID >= m_resources.size()) { m_resources.resize(r.m_resourceID + 1); }
+            auto& resource = m_resources[r.m_resourceID];
+            resource.m_heapID = r.m_heapID;
+            resource.m_filename.resize(r.m_filenameLength);
+            inFile.read((char*)resource.m_filename.data(), r.m_filenameLength * sizeof(wchar_t));
+        }
+        break;
+
+        case Format::RecordType::FEEDBACK:
+        {
+            Format::FeedbackRecord r{};
+            read(r);
+            size_t numBytes = size_t(r.m_width) * r.m_height;
+            feedback.push_back({ r.m_frame, { r.m_resourceID, r.m_width, r.m_height, m_minMips.size() } });
+            m_minMips.resize(m_minMips.size() + numBytes);
+            inFile.read((char*)&m_minMips[m_minMips.size() - numBytes], numBytes);
+        }
+        break;
+
+        default:
+            ErrorMessage(L"corrupt capture file ", in_filename);
+        }
+
+        if (!inFile) { ErrorMessage(L"truncated capture file ", in_filename); }
+    }
+
+    if (feedback.empty()) { return; }
+
+    UINT64 firstFrame = feedback[0].first;
+    UINT64 lastFrame = firstFrame;
+    for (const auto& f : feedback)
+    {
+        firstFrame = std::min(firstFrame, f.first);
+        lastFrame = std::max(lastFrame, f.first);
+    }
+
+    // records of the same frame keep their order in the file
+    m_frames.resize(size_t(lastFrame - firstFrame) + 1);
+    for (const auto& f : feedback)
+    {
+        m_frames[size_t(f.first - firstFrame)].push_back(f.second);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// user + kernel time of all threads of this process, in seconds
+//-----------------------------------------------------------------------------
+double GetProcessCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    auto toUINT64 = [](const FILETIME& f) { return (UINT64(f.dwHighDateTime) << 32) | f.dwLowDateTime; };
+    return double(toUINT64(kernelTime) + toUINT64(userTime)) / 1e7; // 100ns units
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-capture", params.m_captureFile, L"feedback capture file (required)");
+    argParser.AddArg(L"-mediaDir", params.m_mediaDir, L"directory to search for textures not found at their captured path");
+    argParser.AddArg(L"-latency", params.m_latencyMs, L"simulated upload and mapping latency in ms");
+    argParser.AddArg(L"-frameTime", params.m_frameTimeMs, L"minimum frame time in ms. 0: as fast as possible");
+    argParser.AddArg(L"-heapSize", params.m_heapSizeTiles, L"override captured heap sizes, in 64KB tiles");
+    argParser.AddArg(L"-workerThreads", params.m_numWorkerThreads, L"run streaming work on a pool of this many threads");
+    argParser.AddArg(L"-csv", params.m_csvFile, L"write per-frame statistics to this file");
+    argParser.AddArg(L"-prefetch", params.m_enablePrefetch, L"prefetch tiles in the direction of feedback motion");
+    argParser.AddArg(L"-dilationRadius", params.m_dilationRadius, L"dilate feedback to neighboring regions (0 disables)");
+    argParser.AddArg(L"-dilationMipBias", params.m_dilationMipBias, L"dilated neighbors request this many mips coarser");
+    argParser.AddArg(L"-dilationMipBiasPerMip", [&]()
+        {
+            // comma-separated, e.g. 2,1,0
+            params.m_dilationMipBiasPerMip.clear();
+            std::wstringstream s(ArgParser::GetNextArg());
+            std::wstring b;
+            while (std::getline(s, b, L','))
+            {
+                params.m_dilationMipBiasPerMip.push_back(std::stoul(b));
+            }
+        }, L"dilation mip bias per dilated mip, e.g. 2,1,0 (255 disables dilation from that mip)");
+    argParser.AddArg(L"-targetHeapOccupancy", params.m_targetHeapOccupancy, L"bias feedback to hold heap occupancy at this fraction (0 disables)");
+    argParser.AddArg(L"-reclaim", params.m_enableReclaim, L"when a heap is full, release fine tiles of less important resources");
+    argParser.Parse();
+
+    if (params.m_captureFile.empty()) { ErrorMessage(L"-capture is required"); }
+
+    Capture capture;
+    capture.Read(params.m_captureFile);
+
+    TileUpdateManagerDesc desc;
+    desc.m_softwareDevice = true;
+    desc.m_softwareDeviceLatencyMs = params.m_latencyMs;
+    desc.m_numWorkerThreads = params.m_numWorkerThreads;
+    desc.m_useDirectStorage = false;
+    desc.m_enablePrefetch = params.m_enablePrefetch;
+    desc.m_feedbackDilationRadius = params.m_dilationRadius;
+    desc.m_feedbackDilationMipBias = params.m_dilationMipBias;
+    desc.m_feedbackDilationMipBiasPerMip = params.m_dilationMipBiasPerMip;
+    desc.m_targetHeapOccupancy = params.m_targetHeapOccupancy;
+    desc.m_enableReclaim = params.m_enableReclaim;
+    desc.m_enableLateRegionStatistics = true;
+    auto pTileUpdateManager = TileUpdateManager::Create(desc);
+
+    std::vector<StreamingHeap*> heaps;
+    UINT totalHeapTiles = 0;
+    for (auto numTiles : capture.m_heapNumTiles)
+    {
+        if (params.m_heapSizeTiles) { numTiles = params.m_heapSizeTiles; }
+        heaps.push_back(pTileUpdateManager->CreateStreamingHeap(numTiles));
+        totalHeapTiles += numTiles;
+    }
+
+    std::vector<std::wstring> filenames;
+    for (const auto& r : capture.m_resources)
+    {
+        std::wstring filename = r.m_filename;
+        if ((!std::filesystem::exists(filename)) && params.m_mediaDir.size())
+        {
+            filename = std::filesystem::path(params.m_mediaDir) / std::filesystem::path(filename).filename();
+        }
+        if (!std::filesystem::exists(filename)) { ErrorMessage(L"texture not found: ", r.m_filename); }
+        filenames.push_back(filename);
+    }
+
+    std::vector<StreamingResource*> resources;
+    for (UINT i = 0; i < (UINT)filenames.size(); i++)
+    {
+        resources.push_back(pTileUpdateManager->CreateStreamingResource(filenames[i], heaps[capture.m_resources[i].m_heapID]));
+    }
+
+    std::wcout << L"capture: " << params.m_captureFile << L" frames: " << capture.m_frames.size()
+        << L" resources: " << resources.size() << L" heaps: " << heaps.size() << L" (" << totalHeapTiles << L" tiles)"
+        << L" latency: " << params.m_latencyMs << L"ms" << std::endl;
+
+    std::wcout << L"prefetch: " << params.m_enablePrefetch
+        << L" dilation radius: " << params.m_dilationRadius << L" mip bias: " << params.m_dilationMipBias << L" per mip:";
+    for (auto b : params.m_dilationMipBiasPerMip) { std::wcout << L" " << b; }
+    std::wcout << L" target heap occupancy: " << params.m_targetHeapOccupancy
+        << L" reclaim: " << params.m_enableReclaim << std::endl;
+
+    // like the application, run frames until the packed mips are resident
+    auto pace = [&](const Timer& in_frameTimer)
+    {
+        double remainingMs = params.m_frameTimeMs - (in_frameTimer.GetTime() * 1000.0);
+        if (remainingMs > 0) { std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remainingMs)); }
+    };
+    while (1)
+    {
+        Timer frameTimer;
+        frameTimer.Start();
+        pTileUpdateManager->BeginFrame(nullptr, D3D12_CPU_DESCRIPTOR_HANDLE{});
+        pTileUpdateManager->EndFrame();
+        if (std::all_of(resources.begin(), resources.end(), [](StreamingResource* p) { return p->GetPackedMipsResident(); })) { break; }
+        pace(frameTimer);
+    }
+
+    std::wofstream csvFile;
+    if (params.m_csvFile.size())
+    {
+        csvFile.open(params.m_csvFile);
+        csvFile << L"frame,feedback,loaded,evicted,heapTiles,heapOccupancy,cpuMs,processFeedbackMs,"
+            << L"feedbackRegions,lateRegions,latePercent,prefetchRequests,prefetchHits,prefetchUploads,reclaimed" << std::endl;
+    }
+
+    std::wcout << std::setw(8) << L"frame" << std::setw(10) << L"feedback" << std::setw(10) << L"loaded" << std::setw(10) << L"evicted"
+        << std::setw(12) << L"heap tiles" << std::setw(10) << L"heap %" << std::setw(10) << L"cpu ms" << std::setw(14) << L"feedback ms"
+        << std::setw(10) << L"late %" << std::setw(10) << L"pf req" << std::setw(10) << L"pf hits" << std::setw(10) << L"pf up"
+        << std::setw(11) << L"reclaimed" << std::endl;
+
+    UINT numMismatched = 0;
+    const Totals startTotals(pTileUpdateManager);
+    Totals prevTotals = startTotals;
+    const float startTileLatency = pTileUpdateManager->GetTotalTileCopyLatency(); // sum over all tiles
+    double prevCpuTime = GetProcessCpuTime();
+    const double startCpuTime = prevCpuTime;
+
+    Timer replayTimer;
+    replayTimer.Start();
+
+    for (UINT frame = 0; frame < (UINT)capture.m_frames.size(); frame++)
+    {
+        Timer frameTimer;
+        frameTimer.Start();
+
+        pTileUpdateManager->BeginFrame(nullptr, D3D12_CPU_DESCRIPTOR_HANDLE{});
+        const auto& feedback = capture.m_frames[frame];
+        for (const auto& f : feedback)
+        {
+            auto pResource = resources[f.m_resourceID];
+            if ((f.m_width != pResource->GetMinMipMapWidth()) || (f.m_height != pResource->GetMinMipMapHeight()))
+            {
+                numMismatched++; // the file has changed since the capture
+                continue;
+            }
+            pTileUpdateManager->QueueSoftwareFeedback(pResource, &capture.m_minMips[f.m_offset]);
+        }
+        pTileUpdateManager->EndFrame();
+
+        pace(frameTimer);
+
+        const Totals totals(pTileUpdateManager);
+        const Totals f = totals - prevTotals;
+        UINT heapTiles = 0;
+        for (auto h : heaps) { heapTiles += h->GetNumTilesAllocated(); }
+        float occupancy = 100.0f * float(heapTiles) / float(std::max(totalHeapTiles, 1U));
+        double cpuTime = GetProcessCpuTime();
+        float processFeedbackMs = 1000.0f * pTileUpdateManager->GetCpuProcessFeedbackTime();
+
+        std::wcout << std::fixed << std::setprecision(2)
+            << std::setw(8) << frame << std::setw(10) << feedback.size()
+            << std::setw(10) << f.m_uploads << std::setw(10) << f.m_evictions
+            << std::setw(12) << heapTiles << std::setw(10) << occupancy
+            << std::setw(10) << 1000.0 * (cpuTime - prevCpuTime) << std::setw(14) << processFeedbackMs
+            << std::setw(10) << f.GetLatePercent() << std::setw(10) << f.m_prefetchRequests << std::setw(10) << f.m_prefetchHits
+            << std::setw(10) << f.m_prefetchUploads << std::setw(11) << f.m_reclaimedTiles << std::endl;
+
+        if (csvFile.is_open())
+        {
+            csvFile << frame << L"," << feedback.size() << L"," << f.m_uploads << L"," << f.m_evictions << L","
+                << heapTiles << L"," << occupancy << L"," << 1000.0 * (cpuTime - prevCpuTime) << L"," << processFeedbackMs << L","
+                << f.m_feedbackRegions << L"," << f.m_lateRegions << L"," << f.GetLatePercent() << L","
+                << f.m_prefetchRequests << L"," << f.m_prefetchHits << L"," << f.m_prefetchUploads << L"," << f.m_reclaimedTiles << std::endl;
+        }
+
+        prevTotals = totals;
+        prevCpuTime = cpuTime;
+    }
+
+    double replayTime = replayTimer.Stop();
+    UINT numFrames = std::max((UINT)capture.m_frames.size(), 1U);
+    const Totals total = prevTotals - startTotals;
+    UINT numLoaded = total.m_uploads;
+    float tileLatency = (pTileUpdateManager->GetTotalTileCopyLatency() - startTileLatency) / float(std::max(numLoaded, 1U));
+
+    std::wcout << std::fixed << std::setprecision(3)
+        << L"loaded: " << numLoaded << L" evicted: " << total.m_evictions
+        << L" avg cpu ms/frame: " << 1000.0 * (prevCpuTime - startCpuTime) / numFrames
+        << L" avg frame ms: " << 1000.0 * replayTime / numFrames
+        << L" avg tile latency ms: " << 1000.0f * tileLatency << std::endl;
+    std::wcout << L"feedback regions: " << total.m_feedbackRegions << L" late: " << total.m_lateRegions
+        << L" late %: " << total.GetLatePercent()
+        << L" prefetch requests: " << total.m_prefetchRequests << L" hits: " << total.m_prefetchHits
+        << L" accuracy: " << total.GetPrefetchAccuracy()
+        << L" uploads: " << total.m_prefetchUploads << L" (" << (numLoaded ? (100.0f * total.m_prefetchUploads) / numLoaded : 0) << L"% of loaded)"
+        << L" reclaimed: " << total.m_reclaimedTiles << std::endl;
+    if (numMismatched)
+    {
+        std::wcout << L"skipped " << numMismatched << L" feedback buffers that don't match their texture's dimensions" << std::endl;
+    }
+
+    for (auto p : resources) { p->Destroy(); }
+    for (auto p : heaps) { p->Destroy(); }
+    pTileUpdateManager->Destroy();
+
+    return 0;
+}
@@ -0,0 +1,313 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// measures the cpu cost and added latency of strategies for waiting on fences, like DataUploader's fence monitor thread
+// a producer thread plays the role of the gpu, signaling 2 software fences (copy then mapping) at random intervals
+// no gpu is required.
+// for example, "fenceBenchmark.exe -n 20000 -minGap 10 -maxGap 2000 -burst 8"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <algorithm>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "CompletionMonitor.h"
+
+//-----------------------------------------------------------------------------
+// cpu implementation of the fence interface used by CompletionMonitor
+//-----------------------------------------------------------------------------
+class SoftwareFence : public Streaming::CompletionSource
+{
+public:
+    virtual UINT64 GetCompletedValue() const override { return m_value; }
+
+    virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (in_value <= m_value)
+        {
+            ::SetEvent(in_event);
+        }
+        else
+        {
+            m_waiters.push_back({ in_value, in_event });
+        }
+    }
+
+    void Signal(UINT64 in_value)
+    {
+        m_value = in_value;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto i = std::remove_if(m_waiters.begin(), m_waiters.end(), [&](const Waiter& w)
+            {
+                if (w.m_value <= in_value)
+                {
+                    ::SetEvent(w.m_event);
+                    return true;
+                }
+                return false;
+            });
+        m_waiters.erase(i, m_waiters.end());
+    }
+private:
+    struct Waiter
+    {
+        UINT64 m_value;
+        HANDLE m_event;
+    };
+    std::atomic<UINT64> m_value{ 0 };
+    std::mutex m_mutex;
+    std::vector<Waiter> m_waiters;
+};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+struct Params
+{
+    UINT m_numSignals{ 10000 };
+    UINT m_minGapUs{ 10 };   // minimum time between completions in microseconds
+    UINT m_maxGapUs{ 1000 }; // maximum time between completions in microseconds
+    UINT m_maxBurst{ 4 };    // up to this many completions may be signaled back-to-back
+    int m_spinCount{ -1 };   // CompletionMonitor spin count. -1 = try several
+};
+
+enum class Strategy
+{
+    POLL,    // original fence monitor: spin on GetCompletedValue() while there is work
+    EVENT,   // SetEventOnCompletion() for every value, then wait
+    MONITOR  // CompletionMonitor: spin then park
+};
+
+struct Result
+{
+    float m_cpuUtilization{ 0 }; // fraction of one core used by the waiting thread
+    float m_averageLatencyUs{ 0 };
+    float m_maxLatencyUs{ 0 };
+    UINT64 m_numParks{ 0 };
+    UINT64 m_numRegistrations{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// user + kernel time of the calling thread in seconds
+//-----------------------------------------------------------------------------
+double GetThreadCpuTime()
+{
+    FILETIME creation, exit, kernel, user;
+    ::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel, &user);
+    auto toUINT64 = [](const FILETIME& f) { return (UINT64(f.dwHighDateTime) << 32) | f.dwLowDateTime; };
+    return double(toUINT64(kernel) + toUINT64(user)) * 1e-7; // FILETIME units are 100ns
+}
+
+//-----------------------------------------------------------------------------
+// spin until the QPC time is reached. sleep is too coarse for sub-millisecond gaps
+//-----------------------------------------------------------------------------
+void SpinUntil(const RawCpuTimer& in_timer, INT64 in_time)
+{
+    while (in_timer.GetTime() < in_time)
+    {
+        _mm_pause();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Result Run(const Params& in_params, Strategy in_strategy, UINT in_spinCount)
+{
+    RawCpuTimer timer;
+    LARGE_INTEGER frequency;
+    ::QueryPerformanceFrequency(&frequency);
+    const double ticksPerUs = double(frequency.QuadPart) / 1e6;
+
+    const UINT64 numSignals = in_params.m_numSignals;
+
+    // same schedule for every run
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<UINT> gapDis(in_params.m_minGapUs, std::max(in_params.m_minGapUs, in_params.m_maxGapUs));
+    std::uniform_int_distribution<UINT> burstDis(1, std::max(1u, in_params.m_maxBurst));
+    std::vector<INT64> gaps(numSignals + 1, 0);
+    for (UINT64 i = 1; i <= numSignals;)
+    {
+        gaps[i] = INT64(gapDis(gen) * ticksPerUs);
+        UINT burst = burstDis(gen);
+        i += burst; // the rest of the burst completes immediately
+    }
+
+    SoftwareFence copyFence;
+    SoftwareFence mappingFence;
+    std::vector<INT64> completionTimes(numSignals + 1, 0);
+
+    enum FenceIndex : UINT { FENCE_COPY = 0, FENCE_MAPPING, FENCE_NUM_FENCES };
+    Streaming::CompletionMonitor monitor(FENCE_NUM_FENCES, in_spinCount);
+    monitor.SetSource(FENCE_COPY, &copyFence);
+    monitor.SetSource(FENCE_MAPPING, &mappingFence);
+
+    HANDLE copyEvent = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    HANDLE mappingEvent = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+    Result result;
+
+    std::thread waitThread([&]
+        {
+            auto Done = [&](UINT64 v) { return (copyFence.GetCompletedValue() >= v) && (mappingFence.GetCompletedValue() >= v); };
+
+            const double startCpuTime = GetThreadCpuTime();
+            const INT64 startTime = timer.GetTime();
+
+            INT64 totalLatency = 0;
+            INT64 maxLatency = 0;
+            UINT64 next = 1;
+            while (next <= numSignals)
+            {
+                switch (in_strategy)
+                {
+                case Strategy::POLL:
+                    while (!Done(next)) { _mm_pause(); }
+                    break;
+
+                case Strategy::EVENT:
+                    if (copyFence.GetCompletedValue() < next)
+                    {
+                        copyFence.SetEventOnCompletion(next, copyEvent);
+                        ::WaitForSingleObject(copyEvent, INFINITE);
+                    }
+                    if (mappingFence.GetCompletedValue() < next)
+                    {
+                        mappingFence.SetEventOnCompletion(next, mappingEvent);
+                        ::WaitForSingleObject(mappingEvent, INFINITE);
+                    }
+                    break;
+
+                case Strategy::MONITOR:
+                    // like the fence monitor, watch the fence for the current state (copy, then mapping)
+                    while (!Done(next))
+                    {
+                        monitor.Watch((copyFence.GetCompletedValue() < next) ? FENCE_COPY : FENCE_MAPPING, next);
+                        monitor.Wait();
+                    }
+                    break;
+                }
+
+                // consume everything that has completed
+                const INT64 observedTime = timer.GetTime();
+                while ((next <= numSignals) && Done(next))
+                {
+                    INT64 latency = observedTime - completionTimes[next];
+                    totalLatency += latency;
+                    maxLatency = std::max(maxLatency, latency);
+                    next++;
+                }
+            }
+
+            const double elapsed = timer.GetSecondsSince(startTime);
+            result.m_cpuUtilization = float((GetThreadCpuTime() - startCpuTime) / elapsed);
+            result.m_averageLatencyUs = float(double(totalLatency) / double(numSignals) / ticksPerUs);
+            result.m_maxLatencyUs = float(double(maxLatency) / ticksPerUs);
+        });
+
+    // producer: copy completes, then the mapping a short time later
+    INT64 time = timer.GetTime();
+    for (UINT64 i = 1; i <= numSignals; i++)
+    {
+        time += gaps[i];
+        SpinUntil(timer, time);
+        copyFence.Signal(i);
+
+        SpinUntil(timer, time + gaps[i] / 8);
+        completionTimes[i] = timer.GetTime();
+        mappingFence.Signal(i);
+    }
+
+    waitThread.join();
+
+    ::CloseHandle(copyEvent);
+    ::CloseHandle(mappingEvent);
+
+    result.m_numParks = monitor.GetNumParks();
+    result.m_numRegistrations = monitor.GetNumRegistrations();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Print(const std::wstring& in_name, const Result& in_result)
+{
+    std::wcout << std::left << std::setw(16) << in_name << std::right << std::fixed << std::setprecision(1)
+        << std::setw(8) << in_result.m_cpuUtilization * 100.f << L"%"
+        << std::setw(12) << in_result.m_averageLatencyUs
+        << std::setw(12) << in_result.m_maxLatencyUs
+        << std::setw(10) << in_result.m_numParks
+        << std::setw(10) << in_result.m_numRegistrations << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-n", params.m_numSignals, L"number of fence values to signal");
+    argParser.AddArg(L"-minGap", params.m_minGapUs, L"minimum time between completions (microseconds)");
+    argParser.AddArg(L"-maxGap", params.m_maxGapUs, L"maximum time between completions (microseconds)");
+    argParser.AddArg(L"-burst", params.m_maxBurst, L"maximum number of completions signaled together");
+    argParser.AddArg(L"-spin", params.m_spinCount, L"CompletionMonitor spin count (default: several)");
+    argParser.Parse();
+
+    std::wcout << L"signals: " << params.m_numSignals << L" gap: " << params.m_minGapUs << L"-" << params.m_maxGapUs
+        << L"us burst: " << params.m_maxBurst << std::endl;
+    std::wcout << std::left << std::setw(16) << L"strategy" << std::right
+        << std::setw(9) << L"cpu" << std::setw(12) << L"avg us" << std::setw(12) << L"max us"
+        << std::setw(10) << L"parks" << std::setw(10) << L"events" << std::endl;
+
+    Print(L"poll", Run(params, Strategy::POLL, 0));
+    Print(L"event", Run(params, Strategy::EVENT, 0));
+
+    std::vector<UINT> spinCounts = { 0, 256, 1024, 4096, 16384 };
+    if (params.m_spinCount >= 0)
+    {
+        spinCounts = { UINT(params.m_spinCount) };
+    }
+    for (auto s : spinCounts)
+    {
+        Print(L"monitor " + std::to_wstring(s), Run(params, Strategy::MONITOR, s));
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+// ping-pong latency of Streaming::SynchronizationFlag: how long from Set() until the waiting thread runs
+// the pinger sets "ping" and waits on "pong". the responder waits on "ping", works for a while, then sets "pong"
+// the work simulates the time between a streaming thread going idle and the next wake, e.g. a frame of feedback
+//
+// "park" never spins, which is how the flag used to behave: every wake is a kernel transition
+// "adaptive" spins first, and learns how long spinning is worthwhile
+// reports one-way wake latency ((round trip - work) / 2), parks per wait, and process cpu time
+//
+// e.g. "flagBenchmark.exe -iterations 20000 -maxSpin 4096"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "SynchronizationFlag.h"
+
+struct Params
+{
+    UINT m_numIterations{ 20000 };
+    UINT m_maxSpin{ 4096 };
+};
+
+//-----------------------------------------------------------------------------
+// user + kernel time of every thread in the process, in seconds
+//-----------------------------------------------------------------------------
+double GetProcessCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    auto toSeconds = [](const FILETIME& t) { return double((UINT64(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7; }; // 100ns units
+    return toSeconds(kernelTime) + toSeconds(userTime);
+}
+
+struct Result
+{
+    double m_averageUs{ 0 };
+    double m_p50Us{ 0 };
+    double m_p99Us{ 0 };
+    double m_parksPerWait{ 0 };
+    double m_cpuSeconds{ 0 };
+    UINT m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Result Run(const Params& in_params, UINT in_maxSpin, float in_workUs)
+{
+    RawCpuTimer timer;
+    Streaming::SynchronizationFlag ping(in_maxSpin);
+    Streaming::SynchronizationFlag pong(in_maxSpin);
+    std::atomic<UINT> responses{ 0 };
+    std::atomic<bool> running{ true };
+
+    const INT64 workTicks = INT64(double(in_workUs) * 1e-6 / double(timer.GetSecondsFromDelta(1)));
+
+    std::thread responder([&]
+        {
+            while (1)
+            {
+                ping.Wait();
+                if (!running) { break; }
+
+                INT64 start = timer.GetTime();
+                while (timer.GetTime() - start < workTicks) { _mm_pause(); }
+
+                responses++;
+                pong.Set();
+            }
+        });
+
+    double startCpuTime = GetProcessCpuTime();
+
+    std::vector<float> latencies;
+    latencies.reserve(in_params.m_numIterations);
+    Result result;
+    for (UINT i = 0; i < in_params.m_numIterations; i++)
+    {
+        INT64 start = timer.GetTime();
+        ping.Set();
+        pong.Wait();
+        float roundTrip = timer.GetSecondsSince(start) * 1e6f;
+
+        latencies.push_back(std::max(0.f, roundTrip - in_workUs) / 2);
+
+        // every ping gets exactly one pong
+        if (responses != i + 1)
+        {
+            result.m_numErrors++;
+        }
+    }
+    result.m_cpuSeconds = GetProcessCpuTime() - startCpuTime;
+
+    // a timeout must not consume a set
+    if (pong.Wait(0))
+    {
+        result.m_numErrors++;
+    }
+
+    running = false;
+    ping.Set();
+    responder.join();
+
+    double sum = 0;
+    for (auto l : latencies) { sum += l; }
+    result.m_averageUs = sum / latencies.size();
+    std::sort(latencies.begin(), latencies.end());
+    result.m_p50Us = latencies[latencies.size() / 2];
+    result.m_p99Us = latencies[(latencies.size() * 99) / 100];
+
+    // the responder's statistics are safe to read after join()
+    result.m_parksPerWait = double(ping.GetNumParks() + pong.GetNumParks()) / (2.0 * in_params.m_numIterations);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-iterations", params.m_numIterations, L"round trips per measurement");
+    argParser.AddArg(L"-maxSpin", params.m_maxSpin, L"maximum spin count of the adaptive flag");
+    argParser.Parse();
+
+    std::wcout << L"iterations: " << params.m_numIterations << L" max spin: " << params.m_maxSpin << std::endl;
+    std::wcout << std::setw(10) << L"design" << std::setw(10) << L"work_us" << std::setw(12) << L"latency_us"
+        << std::setw(10) << L"p50_us" << std::setw(10) << L"p99_us" << std::setw(12) << L"parks/wait"
+        << std::setw(14) << L"cpu_seconds" << std::setw(8) << L"errors" << std::endl;
+
+    UINT numErrors = 0;
+    for (float workUs : { 0.f, 5.f, 50.f, 500.f })
+    {
+        auto print = [&](const wchar_t* in_name, const Result& r)
+        {
+            std::wcout << std::fixed << std::setprecision(3)
+                << std::setw(10) << in_name << std::setw(10) << workUs << std::setw(12) << r.m_averageUs
+                << std::setw(10) << r.m_p50Us << std::setw(10) << r.m_p99Us << std::setw(12) << r.m_parksPerWait
+                << std::setw(14) << r.m_cpuSeconds << std::setw(8) << r.m_numErrors << std::endl;
+            numErrors += r.m_numErrors;
+        };
+
+        print(L"park", Run(params, 0, workUs));
+        print(L"adaptive", Run(params, params.m_maxSpin, workUs));
+    }
+
+    return numErrors ? -1 : 0;
+}
@@ -317,6 +317,12 @@ private:
     //-------------------------------------------------------------------------
     uint32_t ReadArray(KVP& out_value, const Tokens& in_tokens, uint32_t in_tokenIndex)
     {
+        // empty array
+        if ((in_tokenIndex < in_tokens.size()) && (']' == in_tokens[in_tokenIndex][0]))
+        {
+            return in_tokenIndex + 1;
+        }
+
         while (1)
         {
             if (in_tokenIndex + 3 >= in_tokens.size()) ParseError(in_tokens, in_tokenIndex);
@@ -0,0 +1,637 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+// compares the streaming library's two threading designs doing the same simulated work:
+// dedicated threads that wait on a SynchronizationFlag or CompletionMonitor, versus services on a JobSystem
+//
+// a frame loop produces feedback for many resources every frame. the stages are:
+//   feedback: cpu work per resource (in parallel jobs with the job system), then batches of tile requests
+//   submit: assigns each batch a fence value. a simulated device completes it after the i/o latency
+//   fence monitor: wakes when a fence value completes, hands completed batches on
+//   residency: records the end-to-end latency, from the frame that requested the tiles to the residency update
+// reports latency and the process cpu time. every batch must complete exactly once
+//
+// e.g. "jobBenchmark.exe -workers 4 -resources 1000 -frames 600"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "Streaming.h"
+#include "CompletionMonitor.h"
+#include "JobSystem.h"
+
+struct Params
+{
+    UINT m_numWorkers{ 4 };            // 0: run only the dedicated threads design
+    UINT m_numResources{ 1000 };       // resources with feedback every frame
+    UINT m_workPerResource{ 500 };     // iterations of simulated feedback processing per resource per frame
+    UINT m_batchesPerFrame{ 8 };       // like UpdateLists
+    UINT m_numFrames{ 600 };
+    float m_frameTimeMs{ 4 };
+    float m_ioLatencyMs{ 0.5f };       // time for the simulated device to complete a batch
+};
+
+//-----------------------------------------------------------------------------
+// user + kernel time of every thread in the process, in seconds
+//-----------------------------------------------------------------------------
+double GetProcessCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    auto toSeconds = [](const FILETIME& t) { return double((UINT64(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7; }; // 100ns units
+    return toSeconds(kernelTime) + toSeconds(userTime);
+}
+
+//-----------------------------------------------------------------------------
+// a fence signaled by the simulated device
+//-----------------------------------------------------------------------------
+class SoftwareFence : public Streaming::CompletionSource
+{
+public:
+    virtual UINT64 GetCompletedValue() const override { return m_completedValue; }
+
+    virtual void SetEventOnCompletion(UINT64 in_value, HANDLE in_event) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_completedValue >= in_value)
+        {
+            ::SetEvent(in_event);
+        }
+        else
+        {
+            m_events.push_back({ in_value, in_event });
+        }
+    }
+
+    void Signal(UINT64 in_value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_completedValue = in_value;
+        for (UINT i = 0; i < (UINT)m_events.size();)
+        {
+            if (m_events[i].first <= in_value)
+            {
+                ::SetEvent(m_events[i].second);
+                m_events[i] = m_events.back();
+                m_events.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+private:
+    std::atomic<UINT64> m_completedValue{ 0 };
+    std::mutex m_mutex;
+    std::vector<std::pair<UINT64, HANDLE>> m_events;
+};
+
+//-----------------------------------------------------------------------------
+// completes fence values in order, each after a delay. the same for both designs
+//-----------------------------------------------------------------------------
+class Device
+{
+public:
+    Device(SoftwareFence& in_fence) : m_fence(in_fence), m_thread([this] { DeviceThread(); }) {}
+    ~Device()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    void Submit(UINT64 in_value, std::chrono::steady_clock::time_point in_completionTime)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back({ in_completionTime, in_value });
+        }
+        m_cv.notify_one();
+    }
+private:
+    SoftwareFence& m_fence;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::pair<std::chrono::steady_clock::time_point, UINT64>> m_queue;
+    bool m_exit{ false };
+    std::thread m_thread;
+
+    void DeviceThread()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_exit)
+        {
+            if (0 == m_queue.size())
+            {
+                m_cv.wait(lock);
+                continue;
+            }
+            auto next = m_queue.front();
+            if (std::chrono::steady_clock::now() < next.first)
+            {
+                m_cv.wait_until(lock, next.first);
+                continue;
+            }
+            m_queue.pop_front();
+            lock.unlock();
+            m_fence.Signal(next.second);
+            lock.lock();
+        }
+    }
+};
+
+//-----------------------------------------------------------------------------
+// the streaming stages, run by dedicated threads or by services of a job system
+//-----------------------------------------------------------------------------
+class Pipeline
+{
+public:
+    Pipeline(const Params& in_params, Streaming::JobSystem* in_pJobSystem) :
+        m_params(in_params), m_pJobSystem(in_pJobSystem), m_resources(in_params.m_numResources),
+        m_fenceMonitor(1), m_device(m_fence)
+    {
+        m_fenceMonitor.SetSource(0, &m_fence);
+        m_timer.Start();
+    }
+
+    void Start();
+    void Stop();
+
+    // the frame loop: feedback is ready for every resource
+    void NewFrame()
+    {
+        m_frameStartTime = m_timer.GetTime();
+        m_frameNumber++;
+        if (m_pFeedbackService) { m_pFeedbackService->Kick(); } else { m_feedbackFlag.Set(); }
+    }
+
+    // wait until every batch has reached the residency stage
+    bool WaitComplete(double in_timeoutSeconds)
+    {
+        Timer timer;
+        timer.Start();
+        while ((m_processedFrame != m_frameNumber) || (m_numCompleted < m_numRequested))
+        {
+            if (timer.GetTime() > in_timeoutSeconds)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return m_numCompleted == m_numRequested;
+    }
+
+    UINT64 GetNumCompleted() const { return m_numCompleted; }
+    double GetAverageLatency() const { return m_numCompleted ? m_totalLatency / double(m_numCompleted) : 0; }
+    double GetMaxLatency() const { return m_maxLatency; }
+    UINT64 GetNumErrors() const { return m_numErrors; }
+private:
+    const Params& m_params;
+    Streaming::JobSystem* const m_pJobSystem;
+    Timer m_timer;
+    std::atomic<bool> m_running{ false };
+
+    struct Batch
+    {
+        double m_requestTime{ 0 };
+        UINT64 m_fenceValue{ 0 };
+    };
+
+    //------------------------------------------
+    // feedback
+    //------------------------------------------
+    std::atomic<UINT64> m_frameNumber{ 0 };
+    std::atomic<double> m_frameStartTime{ 0 };
+    std::atomic<UINT64> m_processedFrame{ 0 };
+    std::atomic<UINT64> m_numRequested{ 0 }; // frames that arrive while processing are merged, so count batches as they are made
+    std::vector<UINT> m_resources; // the simulated per-resource state
+    std::vector<Streaming::JobSystem::JobHandle> m_jobs;
+    static const UINT m_resourcesPerJob{ 16 };
+    void ProcessResources(UINT in_start, UINT in_end);
+    bool FeedbackPass();
+
+    //------------------------------------------
+    // submit
+    //------------------------------------------
+    std::mutex m_submitMutex;
+    std::vector<Batch> m_submitQueue;
+    std::vector<Batch> m_submitScratch;
+    UINT64 m_fenceValue{ 0 };
+    void SubmitPass();
+
+    //------------------------------------------
+    // fence monitor
+    //------------------------------------------
+    SoftwareFence m_fence;
+    Streaming::CompletionMonitor m_fenceMonitor;
+    std::mutex m_monitorMutex;
+    std::vector<Batch> m_monitorQueue;
+    std::deque<Batch> m_inFlight; // ordered by fence value
+    void FenceMonitorPass();
+
+    //------------------------------------------
+    // residency
+    //------------------------------------------
+    std::mutex m_residencyMutex;
+    std::vector<Batch> m_residencyQueue;
+    std::vector<Batch> m_residencyScratch;
+    std::atomic<UINT64> m_numCompleted{ 0 };
+    double m_totalLatency{ 0 };
+    double m_maxLatency{ 0 };
+    UINT64 m_lastFenceValue{ 0 };
+    UINT64 m_numErrors{ 0 };
+    void ResidencyPass();
+
+    Device m_device;
+
+    //------------------------------------------
+    // dedicated threads
+    //------------------------------------------
+    Streaming::SynchronizationFlag m_feedbackFlag;
+    Streaming::SynchronizationFlag m_submitFlag;
+    Streaming::SynchronizationFlag m_residencyFlag;
+    std::vector<std::thread> m_threads;
+
+    //------------------------------------------
+    // or services
+    //------------------------------------------
+    std::unique_ptr<Streaming::JobSystem::Service> m_pFeedbackService;
+    std::unique_ptr<Streaming::JobSystem::Service> m_pSubmitService;
+    std::unique_ptr<Streaming::JobSystem::Service> m_pFenceMonitorService;
+    std::unique_ptr<Streaming::JobSystem::Service> m_pResidencyService;
+
+    void WakeSubmit() { if (m_pSubmitService) { m_pSubmitService->Kick(); } else { m_submitFlag.Set(); } }
+    void WakeResidency() { if (m_pResidencyService) { m_pResidencyService->Kick(); } else { m_residencyFlag.Set(); } }
+};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::ProcessResources(UINT in_start, UINT in_end)
+{
+    for (UINT i = in_start; i < in_end; i++)
+    {
+        UINT x = m_resources[i] | 1;
+        for (UINT j = 0; j < m_params.m_workPerResource; j++)
+        {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        }
+        m_resources[i] = x;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// like TileUpdateManagerBase::ProcessFeedbackResources(): parallel jobs, then a job that depends on all of them
+//-----------------------------------------------------------------------------
+bool Pipeline::FeedbackPass()
+{
+    const UINT64 frameNumber = m_frameNumber;
+    if (frameNumber == m_processedFrame)
+    {
+        return false;
+    }
+    const double requestTime = m_frameStartTime;
+
+    auto queueBatches = [&]
+    {
+        std::lock_guard<std::mutex> lock(m_submitMutex);
+        for (UINT i = 0; i < m_params.m_batchesPerFrame; i++)
+        {
+            m_submitQueue.push_back({ requestTime, 0 });
+        }
+        m_numRequested += m_params.m_batchesPerFrame;
+    };
+
+    const UINT numResources = (UINT)m_resources.size();
+    if (m_pJobSystem)
+    {
+        m_jobs.clear();
+        for (UINT i = 0; i < numResources; i += m_resourcesPerJob)
+        {
+            const UINT end = std::min(i + m_resourcesPerJob, numResources);
+            m_jobs.push_back(m_pJobSystem->Submit([this, i, end] { ProcessResources(i, end); }, 0));
+        }
+        auto join = m_pJobSystem->Submit(queueBatches, 0, m_jobs.data(), (UINT)m_jobs.size());
+        m_pJobSystem->Wait(join);
+    }
+    else
+    {
+        ProcessResources(0, numResources);
+        queueBatches();
+    }
+
+    m_processedFrame = frameNumber;
+    WakeSubmit();
+
+    // more frames may have arrived while processing
+    return m_frameNumber != m_processedFrame;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::SubmitPass()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_submitMutex);
+        m_submitScratch.swap(m_submitQueue);
+    }
+    if (0 == m_submitScratch.size())
+    {
+        return;
+    }
+
+    auto completionTime = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(UINT64(m_params.m_ioLatencyMs * 1000.f));
+    for (auto& b : m_submitScratch)
+    {
+        b.m_fenceValue = ++m_fenceValue;
+        m_device.Submit(b.m_fenceValue, completionTime);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_monitorMutex);
+        m_monitorQueue.insert(m_monitorQueue.end(), m_submitScratch.begin(), m_submitScratch.end());
+    }
+    m_submitScratch.clear();
+
+    m_fenceMonitor.Notify();
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::FenceMonitorPass()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_monitorMutex);
+        m_inFlight.insert(m_inFlight.end(), m_monitorQueue.begin(), m_monitorQueue.end());
+        m_monitorQueue.clear();
+    }
+
+    const UINT64 completedValue = m_fence.GetCompletedValue();
+    bool completed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_residencyMutex);
+        while (m_inFlight.size() && (m_inFlight.front().m_fenceValue <= completedValue))
+        {
+            m_residencyQueue.push_back(m_inFlight.front());
+            m_inFlight.pop_front();
+            completed = true;
+        }
+    }
+    if (completed)
+    {
+        WakeResidency();
+    }
+
+    if (m_inFlight.size())
+    {
+        m_fenceMonitor.Watch(0, m_inFlight.front().m_fenceValue);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::ResidencyPass()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_residencyMutex);
+        m_residencyScratch.swap(m_residencyQueue);
+    }
+
+    const double now = m_timer.GetTime();
+    for (const auto& b : m_residencyScratch)
+    {
+        // every batch exactly once, in order
+        if (b.m_fenceValue != m_lastFenceValue + 1)
+        {
+            m_numErrors++;
+        }
+        m_lastFenceValue = b.m_fenceValue;
+
+        double latency = now - b.m_requestTime;
+        m_totalLatency += latency;
+        m_maxLatency = std::max(m_maxLatency, latency);
+    }
+    m_numCompleted += m_residencyScratch.size();
+    m_residencyScratch.clear();
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::Start()
+{
+    m_running = true;
+
+    if (m_pJobSystem)
+    {
+        auto& js = *m_pJobSystem;
+        m_pFeedbackService = std::make_unique<Streaming::JobSystem::Service>(js, [this] { return m_running && FeedbackPass(); }, 0);
+        m_pSubmitService = std::make_unique<Streaming::JobSystem::Service>(js, [this] { SubmitPass(); return false; }, 0);
+        m_pResidencyService = std::make_unique<Streaming::JobSystem::Service>(js, [this] { ResidencyPass(); return false; }, 0);
+        m_pFenceMonitorService = std::make_unique<Streaming::JobSystem::Service>(js, [this]
+            {
+                m_fenceMonitor.Disarm();
+                FenceMonitorPass();
+                return m_fenceMonitor.Arm();
+            }, 0);
+
+        const auto& handles = m_fenceMonitor.GetHandles();
+        js.WatchEvents(handles.data(), (UINT)handles.size(), m_pFenceMonitorService.get());
+        m_pFenceMonitorService->Kick();
+        return;
+    }
+
+    m_threads.emplace_back([this]
+        {
+            while (m_running)
+            {
+                if (!FeedbackPass()) { m_feedbackFlag.Wait(); }
+            }
+        });
+    m_threads.emplace_back([this]
+        {
+            while (m_running)
+            {
+                m_submitFlag.Wait();
+                SubmitPass();
+            }
+        });
+    m_threads.emplace_back([this]
+        {
+            while (m_running)
+            {
+                FenceMonitorPass();
+                m_fenceMonitor.Wait();
+            }
+        });
+    m_threads.emplace_back([this]
+        {
+            while (m_running)
+            {
+                m_residencyFlag.Wait();
+                ResidencyPass();
+            }
+        });
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Pipeline::Stop()
+{
+    m_running = false;
+
+    if (m_pJobSystem)
+    {
+        m_pJobSystem->UnwatchEvents(m_pFenceMonitorService.get());
+        m_pFeedbackService->WaitIdle();
+        m_pSubmitService->WaitIdle();
+        m_pFenceMonitorService->WaitIdle();
+        m_pResidencyService->WaitIdle();
+        return;
+    }
+
+    m_feedbackFlag.Set();
+    m_submitFlag.Set();
+    m_fenceMonitor.Notify();
+    m_residencyFlag.Set();
+    for (auto& t : m_threads)
+    {
+        t.join();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+struct Result
+{
+    double m_averageLatencyMs{ 0 };
+    double m_maxLatencyMs{ 0 };
+    double m_cpuSeconds{ 0 };
+    double m_wallSeconds{ 0 };
+    UINT64 m_numBatches{ 0 };
+    UINT64 m_numErrors{ 0 };
+};
+
+Result Run(const Params& in_params, Streaming::JobSystem* in_pJobSystem)
+{
+    Result result;
+    Pipeline pipeline(in_params, in_pJobSystem);
+
+    double startCpuTime = GetProcessCpuTime();
+    Timer timer;
+    timer.Start();
+
+    pipeline.Start();
+
+    // the frame loop sleeps between frames, like a render thread waiting on the swap chain
+    auto frameTime = std::chrono::microseconds(UINT64(in_params.m_frameTimeMs * 1000.f));
+    auto nextFrame = std::chrono::steady_clock::now();
+    for (UINT i = 0; i < in_params.m_numFrames; i++)
+    {
+        pipeline.NewFrame();
+        nextFrame += frameTime;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    if (!pipeline.WaitComplete(10.0))
+    {
+        result.m_numErrors++; // timed out
+    }
+    pipeline.Stop();
+
+    result.m_wallSeconds = timer.GetTime();
+    result.m_cpuSeconds = GetProcessCpuTime() - startCpuTime;
+    result.m_averageLatencyMs = 1000.0 * pipeline.GetAverageLatency();
+    result.m_maxLatencyMs = 1000.0 * pipeline.GetMaxLatency();
+    result.m_numBatches = pipeline.GetNumCompleted();
+    result.m_numErrors += pipeline.GetNumErrors();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-workers", params.m_numWorkers, L"job system threads. 0: dedicated threads only");
+    argParser.AddArg(L"-resources", params.m_numResources, L"resources with feedback every frame");
+    argParser.AddArg(L"-work", params.m_workPerResource, L"simulated feedback work per resource");
+    argParser.AddArg(L"-batches", params.m_batchesPerFrame, L"batches of tile requests per frame");
+    argParser.AddArg(L"-frames", params.m_numFrames, L"number of frames");
+    argParser.AddArg(L"-frameTime", params.m_frameTimeMs, L"frame time in ms");
+    argParser.AddArg(L"-ioLatency", params.m_ioLatencyMs, L"simulated i/o latency in ms");
+    argParser.Parse();
+
+    std::wcout << L"resources: " << params.m_numResources << L" work: " << params.m_workPerResource
+        << L" batches/frame: " << params.m_batchesPerFrame << L" frames: " << params.m_numFrames
+        << L" frame time: " << params.m_frameTimeMs << L"ms i/o latency: " << params.m_ioLatencyMs << L"ms" << std::endl;
+    std::wcout << std::setw(12) << L"design" << std::setw(14) << L"latency_ms" << std::setw(14) << L"max_ms"
+        << std::setw(14) << L"cpu_seconds" << std::setw(12) << L"cpu_cores" << std::setw(10) << L"batches" << std::setw(8) << L"errors" << std::endl;
+
+    UINT64 numErrors = 0;
+    auto print = [&](const wchar_t* in_name, const Result& r)
+    {
+        std::wcout << std::fixed << std::setprecision(3)
+            << std::setw(12) << in_name << std::setw(14) << r.m_averageLatencyMs << std::setw(14) << r.m_maxLatencyMs
+            << std::setw(14) << r.m_cpuSeconds << std::setw(12) << r.m_cpuSeconds / r.m_wallSeconds
+            << std::setw(10) << r.m_numBatches << std::setw(8) << r.m_numErrors << std::endl;
+        numErrors += r.m_numErrors;
+    };
+
+    print(L"threads", Run(params, nullptr));
+
+    if (params.m_numWorkers)
+    {
+        Streaming::JobSystem jobSystem(params.m_numWorkers);
+        print(L"jobs", Run(params, &jobSystem));
+
+        std::wcout << L"tasks: " << jobSystem.GetNumTasks() << L" steals: " << jobSystem.GetNumSteals()
+            << L" parks: " << jobSystem.GetNumParks() << std::endl;
+    }
+
+    return numErrors ? -1 : 0;
+}
@@ -0,0 +1,304 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+// throughput benchmark for the UpdateList life cycle on the fence monitor thread, driven by software fences
+// an UpdateList waits for its copy fence, then its mapping fence, then completes (like STATE_UPLOADING -> STATE_MAP_PENDING)
+// "scan" visits every in-flight UpdateList on every pass and checks its state, which is what DataUploader used to do
+// "scheduler" suspends each UpdateList in a FenceScheduler until the value it awaits has completed
+// the fences advance at a fixed rate, so many UpdateLists are in flight but few complete on any one pass
+// every UpdateList must complete exactly once, and not before both of its fences
+// for example, "lifecycleBenchmark.exe -inFlight 1024 -passes 100000"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "FenceScheduler.h"
+
+struct Params
+{
+    UINT m_numInFlight{ 1024 };  // UpdateLists in flight, like TileUpdateManagerDesc::m_maxNumCopyBatches
+    UINT m_numPasses{ 100000 };  // fence monitor thread passes
+    UINT m_maxCopyLatency{ 64 }; // in fence values. each UpdateList's copy completes 1..max values after submission
+    UINT m_mapLatency{ 2 };      // mapping completes this many values after submission
+};
+
+enum FenceIndex : UINT
+{
+    FENCE_MAPPING = 0,
+    FENCE_COPY,
+    FENCE_NUM_FENCES
+};
+
+//-----------------------------------------------------------------------------
+// a fence that the benchmark advances, like ID3D12Fence::GetCompletedValue()
+//-----------------------------------------------------------------------------
+struct SoftwareFence
+{
+    UINT64 m_completedValue{ 0 };
+    UINT64 GetCompletedValue() const { return m_completedValue; }
+};
+
+struct Task
+{
+    enum class State { FREE, UPLOADING, MAP_PENDING };
+    State m_state{ State::FREE };
+    UINT64 m_copyFenceValue{ 0 };
+    UINT64 m_mappingFenceValue{ 0 };
+    UINT m_numCompletions{ 0 };
+};
+
+struct Result
+{
+    double m_tasksPerSecond{ 0 };
+    double m_visitsPerTask{ 0 }; // how many times a task was looked at before it completed
+    UINT64 m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// shared simulation: every pass, the fences advance by 1 and free tasks are submitted
+//-----------------------------------------------------------------------------
+class Simulation
+{
+public:
+    Simulation(const Params& in_params) : m_params(in_params), m_tasks(in_params.m_numInFlight), m_gen(42),
+        m_copyLatency(1, in_params.m_maxCopyLatency) {}
+
+    // submits every free task, calling in_onSubmit() for each
+    template<typename F> void Submit(F in_onSubmit)
+    {
+        for (auto i : m_free)
+        {
+            auto& t = m_tasks[i];
+            t.m_state = Task::State::UPLOADING;
+            t.m_copyFenceValue = m_fences[FENCE_COPY].m_completedValue + m_copyLatency(m_gen);
+            t.m_mappingFenceValue = m_fences[FENCE_MAPPING].m_completedValue + m_params.m_mapLatency;
+            m_numSubmitted++;
+            in_onSubmit(&t);
+        }
+        m_free.clear();
+    }
+
+    void AdvanceFences()
+    {
+        for (auto& f : m_fences) { f.m_completedValue++; }
+    }
+
+    void Complete(Task* in_pTask)
+    {
+        if ((m_fences[FENCE_COPY].m_completedValue < in_pTask->m_copyFenceValue) ||
+            (m_fences[FENCE_MAPPING].m_completedValue < in_pTask->m_mappingFenceValue))
+        {
+            m_numErrors++; // early
+        }
+        in_pTask->m_state = Task::State::FREE;
+        in_pTask->m_numCompletions++;
+        m_numCompleted++;
+        m_free.push_back(UINT(in_pTask - m_tasks.data()));
+    }
+
+    void Start()
+    {
+        for (UINT i = 0; i < (UINT)m_tasks.size(); i++) { m_free.push_back(i); }
+    }
+
+    UINT64 GetNumErrors() const
+    {
+        UINT64 numErrors = m_numErrors;
+        UINT64 numCompletions = 0;
+        for (const auto& t : m_tasks) { numCompletions += t.m_numCompletions; }
+        if (numCompletions != m_numCompleted) { numErrors++; }
+        if ((m_numSubmitted - m_numCompleted) > m_tasks.size()) { numErrors++; }
+        return numErrors;
+    }
+
+    const Params& m_params;
+    std::vector<Task> m_tasks;
+    SoftwareFence m_fences[FENCE_NUM_FENCES];
+    UINT64 m_numSubmitted{ 0 };
+    UINT64 m_numCompleted{ 0 };
+private:
+    std::vector<UINT> m_free;
+    std::mt19937 m_gen;
+    std::uniform_int_distribution<UINT> m_copyLatency;
+    UINT64 m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// the previous approach: every pass visits every in-flight task and checks its fences
+//-----------------------------------------------------------------------------
+Result RunScan(const Params& in_params)
+{
+    Simulation sim(in_params);
+    std::vector<Task*> inFlight;
+    UINT64 numVisits = 0;
+
+    Timer timer;
+    timer.Start();
+
+    sim.Start();
+    for (UINT pass = 0; pass < in_params.m_numPasses; pass++)
+    {
+        sim.Submit([&](Task* p) { inFlight.push_back(p); });
+        sim.AdvanceFences();
+
+        for (UINT i = 0; i < (UINT)inFlight.size();)
+        {
+            auto& t = *inFlight[i];
+            numVisits++;
+            bool done = false;
+
+            switch (t.m_state)
+            {
+            case Task::State::UPLOADING:
+                if (sim.m_fences[FENCE_COPY].GetCompletedValue() < t.m_copyFenceValue) { break; }
+                t.m_state = Task::State::MAP_PENDING;
+                [[fallthrough]];
+            case Task::State::MAP_PENDING:
+                if (sim.m_fences[FENCE_MAPPING].GetCompletedValue() < t.m_mappingFenceValue) { break; }
+                done = true;
+                break;
+            default:
+                break;
+            }
+
+            if (done)
+            {
+                // O(1) compaction, like DataUploader's monitor task array
+                inFlight[i] = inFlight.back();
+                inFlight.pop_back();
+                sim.Complete(&t);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    double t = timer.Stop();
+    return { double(sim.m_numCompleted) / t, double(numVisits) / double(std::max(sim.m_numCompleted, (UINT64)1)), sim.GetNumErrors() };
+}
+
+//-----------------------------------------------------------------------------
+// suspend each task until its awaited fence value completes
+//-----------------------------------------------------------------------------
+Result RunScheduler(const Params& in_params)
+{
+    Simulation sim(in_params);
+    Streaming::FenceScheduler<Task> scheduler(FENCE_NUM_FENCES);
+    UINT64 completedValues[FENCE_NUM_FENCES]{};
+    UINT64 numVisits = 0;
+
+    auto await = [&](Task* p, FenceIndex in_fence, UINT64 in_value)
+    {
+        if (completedValues[in_fence] >= in_value) { return true; }
+        scheduler.Await(in_fence, in_value, p);
+        return false;
+    };
+
+    auto resume = [&](Task* p)
+    {
+        numVisits++;
+        switch (p->m_state)
+        {
+        case Task::State::UPLOADING:
+            if (!await(p, FENCE_COPY, p->m_copyFenceValue)) { return; }
+            p->m_state = Task::State::MAP_PENDING;
+            [[fallthrough]];
+        case Task::State::MAP_PENDING:
+            if (!await(p, FENCE_MAPPING, p->m_mappingFenceValue)) { return; }
+            sim.Complete(p);
+            return;
+        default:
+            return;
+        }
+    };
+
+    Timer timer;
+    timer.Start();
+
+    sim.Start();
+    std::vector<Task*> submitted;
+    for (UINT pass = 0; pass < in_params.m_numPasses; pass++)
+    {
+        sim.Submit([&](Task* p) { submitted.push_back(p); });
+        sim.AdvanceFences();
+
+        for (UINT i = 0; i < FENCE_NUM_FENCES; i++) { completedValues[i] = sim.m_fences[i].GetCompletedValue(); }
+
+        for (auto p : submitted) { resume(p); }
+        submitted.clear();
+
+        for (UINT i = 0; i < FENCE_NUM_FENCES; i++)
+        {
+            scheduler.Resume(i, completedValues[i], resume);
+        }
+    }
+
+    double t = timer.Stop();
+    return { double(sim.m_numCompleted) / t, double(numVisits) / double(std::max(sim.m_numCompleted, (UINT64)1)), sim.GetNumErrors() };
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-inFlight", params.m_numInFlight, L"UpdateLists in flight");
+    argParser.AddArg(L"-passes", params.m_numPasses, L"fence monitor passes");
+    argParser.AddArg(L"-copyLatency", params.m_maxCopyLatency, L"maximum copy latency, in fence values");
+    argParser.AddArg(L"-mapLatency", params.m_mapLatency, L"mapping latency, in fence values");
+    argParser.Parse();
+
+    std::wcout << L"in flight: " << params.m_numInFlight << L" passes: " << params.m_numPasses
+        << L" copy latency: 1.." << params.m_maxCopyLatency << L" map latency: " << params.m_mapLatency << std::endl;
+    std::wcout << std::setw(10) << L"mode" << std::setw(16) << L"Mtasks/s" << std::setw(16) << L"visits/task"
+        << std::setw(10) << L"errors" << std::endl;
+
+    auto scan = RunScan(params);
+    auto scheduler = RunScheduler(params);
+
+    std::wcout << std::fixed << std::setprecision(2)
+        << std::setw(10) << L"scan" << std::setw(16) << scan.m_tasksPerSecond / 1e6 << std::setw(16) << scan.m_visitsPerTask << std::setw(10) << scan.m_numErrors << std::endl
+        << std::setw(10) << L"scheduler" << std::setw(16) << scheduler.m_tasksPerSecond / 1e6 << std::setw(16) << scheduler.m_visitsPerTask << std::setw(10) << scheduler.m_numErrors << std::endl;
+
+    return (scan.m_numErrors + scheduler.m_numErrors) ? -1 : 0;
+}
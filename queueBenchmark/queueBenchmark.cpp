@@ -0,0 +1,283 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// contention benchmark and stress test for the multi-producer queues used by DataUploader
+// 1..16 producer threads push into RingBufferMPSC / allocate from AllocatorMPSC while a single thread consumes
+// every item is validated: each must arrive exactly once and in order per producer,
+// and no index may be handed to two owners at the same time.
+// for example, "queueBenchmark.exe -iters 1000000 -slots 1024"
+// MSVC has no ThreadSanitizer. tsan/tsan.sh builds this stress test with -fsanitize=thread on Linux
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "SimpleAllocator.h"
+
+struct Params
+{
+    UINT m_numIters{ 1000000 }; // items per producer
+    UINT m_numSlots{ 1024 };    // queue capacity
+    UINT m_maxProducers{ 16 };
+};
+
+struct Result
+{
+    double m_itemsPerSecond{ 0 };
+    UINT64 m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// items encode the producer in the upper bits and a per-producer sequence number in the lower bits
+//-----------------------------------------------------------------------------
+inline UINT64 MakeItem(UINT in_producer, UINT in_sequence) { return (UINT64(in_producer) << 32) | in_sequence; }
+
+class Validator
+{
+public:
+    Validator(UINT in_numProducers) : m_expected(in_numProducers, 0) {}
+    void Check(UINT64 in_item)
+    {
+        UINT producer = UINT(in_item >> 32);
+        UINT sequence = UINT(in_item);
+        if ((producer >= m_expected.size()) || (m_expected[producer] != sequence))
+        {
+            m_numErrors++;
+        }
+        else
+        {
+            m_expected[producer]++;
+        }
+    }
+    UINT64 GetNumErrors(UINT in_numIters) const
+    {
+        UINT64 numErrors = m_numErrors;
+        for (auto e : m_expected) { if (e != in_numIters) numErrors++; } // lost items
+        return numErrors;
+    }
+private:
+    std::vector<UINT> m_expected;
+    UINT64 m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// RingBufferMPSC: producers claim, write, publish. consumer reads in order
+//-----------------------------------------------------------------------------
+Result RunRingBufferMPSC(const Params& in_params, UINT in_numProducers)
+{
+    Streaming::RingBufferMPSC ringBuffer(in_params.m_numSlots);
+    std::vector<UINT64> data(in_params.m_numSlots);
+    Validator validator(in_numProducers);
+    const UINT64 numItems = UINT64(in_params.m_numIters) * in_numProducers;
+
+    Timer timer;
+    timer.Start();
+
+    std::vector<std::thread> producers;
+    for (UINT p = 0; p < in_numProducers; p++)
+    {
+        producers.emplace_back([&, p]
+            {
+                for (UINT i = 0; i < in_params.m_numIters; i++)
+                {
+                    UINT index = 0;
+                    while (!ringBuffer.Allocate(index)) { _mm_pause(); } // full
+                    data[index] = MakeItem(p, i);
+                    ringBuffer.Publish(index);
+                }
+            });
+    }
+
+    for (UINT64 numConsumed = 0; numConsumed < numItems;)
+    {
+        UINT numReady = ringBuffer.GetReadyToRead();
+        for (UINT i = 0; i < numReady; i++)
+        {
+            validator.Check(data[ringBuffer.GetReadIndex(i)]);
+        }
+        ringBuffer.Free(numReady);
+        numConsumed += numReady;
+    }
+
+    for (auto& t : producers) { t.join(); }
+
+    return { double(numItems) / timer.Stop(), validator.GetNumErrors(in_params.m_numIters) };
+}
+
+//-----------------------------------------------------------------------------
+// baseline: the single-producer RingBuffer with producers serialized by a mutex
+//-----------------------------------------------------------------------------
+Result RunRingBufferMutex(const Params& in_params, UINT in_numProducers)
+{
+    Streaming::RingBuffer ringBuffer(in_params.m_numSlots);
+    std::vector<UINT64> data(in_params.m_numSlots);
+    std::mutex mutex;
+    Validator validator(in_numProducers);
+    const UINT64 numItems = UINT64(in_params.m_numIters) * in_numProducers;
+
+    Timer timer;
+    timer.Start();
+
+    std::vector<std::thread> producers;
+    for (UINT p = 0; p < in_numProducers; p++)
+    {
+        producers.emplace_back([&, p]
+            {
+                for (UINT i = 0; i < in_params.m_numIters;)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (ringBuffer.GetAvailableToWrite())
+                    {
+                        data[ringBuffer.GetWriteIndex()] = MakeItem(p, i);
+                        ringBuffer.Allocate();
+                        i++;
+                    }
+                }
+            });
+    }
+
+    for (UINT64 numConsumed = 0; numConsumed < numItems;)
+    {
+        UINT numReady = ringBuffer.GetReadyToRead();
+        for (UINT i = 0; i < numReady; i++)
+        {
+            validator.Check(data[ringBuffer.GetReadIndex(i)]);
+        }
+        if (numReady) { ringBuffer.Free(numReady); }
+        numConsumed += numReady;
+    }
+
+    for (auto& t : producers) { t.join(); }
+
+    return { double(numItems) / timer.Stop(), validator.GetNumErrors(in_params.m_numIters) };
+}
+
+//-----------------------------------------------------------------------------
+// AllocatorMPSC: producers allocate indices and hand them to the consumer, which frees them
+// like UpdateLists: allocated by any thread, freed by the fence monitor thread
+//-----------------------------------------------------------------------------
+Result RunAllocatorMPSC(const Params& in_params, UINT in_numProducers)
+{
+    Streaming::AllocatorMPSC allocator(in_params.m_numSlots);
+    Streaming::RingBufferMPSC completed(in_params.m_numSlots); // capacity matches the allocator, so never full
+    std::vector<UINT> data(in_params.m_numSlots);
+    std::vector<std::atomic<UINT>> owners(in_params.m_numSlots);
+    std::atomic<UINT64> numErrors{ 0 };
+    const UINT64 numItems = UINT64(in_params.m_numIters) * in_numProducers;
+
+    Timer timer;
+    timer.Start();
+
+    std::vector<std::thread> producers;
+    for (UINT p = 0; p < in_numProducers; p++)
+    {
+        producers.emplace_back([&, p]
+            {
+                for (UINT i = 0; i < in_params.m_numIters; i++)
+                {
+                    UINT index = 0;
+                    while (!allocator.Allocate(index)) { _mm_pause(); } // empty
+
+                    // detect an index that has 2 owners
+                    if (0 != owners[index].exchange(p + 1)) { numErrors++; }
+
+                    UINT slot = 0;
+                    if (!completed.Allocate(slot)) { numErrors++; continue; }
+                    data[slot] = index;
+                    completed.Publish(slot);
+                }
+            });
+    }
+
+    for (UINT64 numConsumed = 0; numConsumed < numItems;)
+    {
+        UINT numReady = completed.GetReadyToRead();
+        for (UINT i = 0; i < numReady; i++)
+        {
+            UINT index = data[completed.GetReadIndex(i)];
+            if (0 == owners[index].exchange(0)) { numErrors++; }
+            allocator.Free(index);
+        }
+        completed.Free(numReady);
+        numConsumed += numReady;
+    }
+
+    for (auto& t : producers) { t.join(); }
+
+    if (allocator.GetAvailable() != in_params.m_numSlots) { numErrors++; }
+
+    return { double(numItems) / timer.Stop(), numErrors };
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-iters", params.m_numIters, L"items per producer");
+    argParser.AddArg(L"-slots", params.m_numSlots, L"queue capacity");
+    argParser.AddArg(L"-producers", params.m_maxProducers, L"maximum number of producer threads");
+    argParser.Parse();
+
+    std::wcout << L"items per producer: " << params.m_numIters << L" slots: " << params.m_numSlots << std::endl;
+    std::wcout << std::setw(10) << L"producers"
+        << std::setw(16) << L"mpsc Mitems/s" << std::setw(16) << L"mutex Mitems/s" << std::setw(16) << L"alloc Mops/s"
+        << std::setw(10) << L"errors" << std::endl;
+
+    UINT64 totalErrors = 0;
+    for (UINT numProducers = 1; numProducers <= params.m_maxProducers; numProducers *= 2)
+    {
+        auto mpsc = RunRingBufferMPSC(params, numProducers);
+        auto mutex = RunRingBufferMutex(params, numProducers);
+        auto alloc = RunAllocatorMPSC(params, numProducers);
+
+        UINT64 numErrors = mpsc.m_numErrors + mutex.m_numErrors + alloc.m_numErrors;
+        totalErrors += numErrors;
+
+        std::wcout << std::fixed << std::setprecision(2) << std::setw(10) << numProducers
+            << std::setw(16) << mpsc.m_itemsPerSecond / 1e6
+            << std::setw(16) << mutex.m_itemsPerSecond / 1e6
+            << std::setw(16) << alloc.m_itemsPerSecond / 1e6
+            << std::setw(10) << numErrors << std::endl;
+    }
+
+    return totalErrors ? -1 : 0;
+}
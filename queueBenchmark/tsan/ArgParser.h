@@ -0,0 +1,70 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// replaces include/ArgParser.h for the TSan build: reads UINT arguments from /proc/self/cmdline. see tsan.sh
+
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <cstdlib>
+#include "windows.h"
+
+class ArgParser
+{
+public:
+    void AddArg(std::wstring in_token, UINT& out_value, std::wstring)
+    {
+        m_args.push_back({ std::string(in_token.begin(), in_token.end()), [&out_value](const std::string& s) { out_value = (UINT)std::stoul(s); } });
+    }
+
+    void Parse()
+    {
+        std::ifstream f("/proc/self/cmdline", std::ios::binary);
+        std::vector<std::string> tokens;
+        for (std::string t; std::getline(f, t, '\0');) { tokens.push_back(t); }
+
+        for (size_t i = 1; i < tokens.size(); i++)
+        {
+            bool found = false;
+            for (auto& a : m_args)
+            {
+                if ((a.m_token == tokens[i]) && (i + 1 < tokens.size()))
+                {
+                    a.m_set(tokens[++i]);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) { std::cerr << "unknown argument " << tokens[i] << "\n"; exit(-1); }
+        }
+    }
+private:
+    struct Arg { std::string m_token; std::function<void(const std::string&)> m_set; };
+    std::vector<Arg> m_args;
+};
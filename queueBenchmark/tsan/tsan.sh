@@ -0,0 +1,23 @@
+#!/bin/sh
+# builds queueBenchmark with ThreadSanitizer on Linux and runs the validating stress test
+# MSVC has no ThreadSanitizer, so the queues (TileUpdateManager/SimpleAllocator) are built here against small Win32 shims
+# the sources are copied next to the shims so their "pch.h" and "Streaming.h" includes resolve to the shims
+#
+# usage, from the repository root: queueBenchmark/tsan/tsan.sh [queueBenchmark args]
+# default args are small because TSan is slow: -iters 2000 -producers 8 -slots 64
+# exits non-zero if TSan reports a race or the benchmark finds an error
+
+set -e
+CXX=${CXX:-c++}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+cp "$ROOT"/queueBenchmark/tsan/*.h "$BUILD"
+cp "$ROOT"/queueBenchmark/queueBenchmark.cpp "$ROOT"/TileUpdateManager/SimpleAllocator.h "$ROOT"/TileUpdateManager/SimpleAllocator.cpp "$ROOT"/include/Timer.h "$BUILD"
+sed -i 's/<Windows.h>/"windows.h"/' "$BUILD"/Timer.h
+
+$CXX -std=c++17 -O1 -g -fsanitize=thread -I"$BUILD" -o "$BUILD"/queueBenchmark "$BUILD"/queueBenchmark.cpp "$BUILD"/SimpleAllocator.cpp -lpthread
+
+if [ $# -eq 0 ]; then set -- -iters 2000 -producers 8 -slots 64; fi
+TSAN_OPTIONS="halt_on_error=1 exitcode=66 ${TSAN_OPTIONS}" "$BUILD"/queueBenchmark "$@"
@@ -0,0 +1,96 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// minimal Win32 subset for building queueBenchmark with -fsanitize=thread on Linux. see tsan.sh
+// events are emulated with one mutex and condition variable, which is enough for the benchmark's handful of threads
+
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+
+typedef unsigned int UINT;
+typedef unsigned char UINT8;
+typedef unsigned char BYTE;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef int64_t INT64;
+typedef int64_t LONGLONG;
+typedef unsigned long DWORD;
+typedef int BOOL;
+
+#define FALSE 0
+#define TRUE 1
+#define INFINITE 0xffffffff
+
+struct ShimEvent { bool m_signaled{ false }; };
+typedef ShimEvent* HANDLE;
+
+inline std::mutex& ShimMutex() { static std::mutex m; return m; }
+inline std::condition_variable& ShimCv() { static std::condition_variable cv; return cv; }
+
+inline HANDLE CreateEvent(void*, BOOL, BOOL, void*) { return new ShimEvent; }
+inline void CloseHandle(HANDLE h) { delete h; }
+inline void SetEvent(HANDLE h) { std::lock_guard<std::mutex> l(ShimMutex()); h->m_signaled = true; ShimCv().notify_all(); }
+inline void ResetEvent(HANDLE h) { std::lock_guard<std::mutex> l(ShimMutex()); h->m_signaled = false; }
+
+// auto-reset semantics
+inline DWORD WaitForSingleObject(HANDLE h, DWORD)
+{
+    std::unique_lock<std::mutex> l(ShimMutex());
+    ShimCv().wait(l, [&] { return h->m_signaled; });
+    h->m_signaled = false;
+    return 0;
+}
+
+inline DWORD WaitForMultipleObjects(DWORD n, HANDLE* h, BOOL, DWORD)
+{
+    std::unique_lock<std::mutex> l(ShimMutex());
+    DWORD signaled = 0;
+    ShimCv().wait(l, [&] { for (DWORD i = 0; i < n; i++) { if (h[i]->m_signaled) { signaled = i; return true; } } return false; });
+    h[signaled]->m_signaled = false;
+    return signaled;
+}
+
+union LARGE_INTEGER { INT64 QuadPart; };
+inline void QueryPerformanceFrequency(LARGE_INTEGER* out_f) { out_f->QuadPart = 1000000000; }
+inline void QueryPerformanceCounter(LARGE_INTEGER* out_c)
+{
+    out_c->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct FILETIME { DWORD dwLowDateTime; DWORD dwHighDateTime; };
+inline HANDLE GetCurrentThread() { return nullptr; }
+inline void GetThreadTimes(HANDLE, FILETIME*, FILETIME*, FILETIME* out_kernel, FILETIME* out_user)
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    uint64_t t = (ts.tv_sec * 1000000000ull + ts.tv_nsec) / 100; // FILETIME units are 100ns
+    *out_kernel = FILETIME{ 0, 0 };
+    *out_user = FILETIME{ DWORD(t & 0xffffffff), DWORD(t >> 32) };
+}
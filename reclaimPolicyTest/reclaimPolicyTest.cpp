@@ -0,0 +1,189 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// checks the victim ordering of Streaming::ReclaimPolicy with synthetic candidates, no GPU required
+// each case lists candidates, the shortfall, and the demand value, and the expected mip each candidate keeps
+// re-promotion cases also list the free space and whether the clamped demand may have its tiles
+// prints each failure and returns the number of failed cases
+//
+// e.g. "reclaimPolicyTest.exe"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "ReclaimPolicy.h"
+
+using Candidate = Streaming::ReclaimPolicy::Candidate;
+
+struct TestCase
+{
+    const char* m_name;
+    std::vector<Candidate> m_candidates;
+    UINT m_numTilesNeeded;
+    float m_demandValue;
+    std::vector<UINT> m_expectedMips; // finest mip each candidate keeps
+    UINT m_expectedNumFreed;
+};
+
+struct PromoteCase
+{
+    const char* m_name;
+    std::vector<Candidate> m_candidates;
+    UINT m_numTilesNeeded;
+    UINT m_numFree;
+    float m_value;
+    bool m_expectedPromoted;
+    std::vector<UINT> m_expectedMips;
+    UINT m_expectedNumFreed;
+};
+
+//-----------------------------------------------------------------------------
+// prints a case result and returns true if it passed
+//-----------------------------------------------------------------------------
+bool Report(const char* in_name, bool in_passed, UINT in_numFreed, UINT in_expectedNumFreed,
+    const std::vector<UINT>& in_mips, const std::vector<UINT>& in_expectedMips)
+{
+    std::cout << (in_passed ? "pass: " : "FAIL: ") << in_name << "\n";
+    if (!in_passed)
+    {
+        std::cout << "    freed " << in_numFreed << " (expected " << in_expectedNumFreed << "), mips kept:";
+        for (auto m : in_mips) { std::cout << " " << m; }
+        std::cout << " (expected";
+        for (auto m : in_expectedMips) { std::cout << " " << m; }
+        std::cout << ")\n";
+    }
+    return in_passed;
+}
+
+//-----------------------------------------------------------------------------
+// m_finestMip is the first mip with tiles, as StreamingResourceBase::GetReclaimCandidate() computes it
+//-----------------------------------------------------------------------------
+Candidate MakeCandidate(float in_importance, std::vector<UINT> in_numTiles)
+{
+    Candidate c;
+    c.m_importance = in_importance;
+    c.m_maxMip = (UINT)in_numTiles.size();
+    c.m_numTiles = in_numTiles;
+    while ((c.m_finestMip < c.m_maxMip) && (0 == c.m_numTiles[c.m_finestMip])) { c.m_finestMip++; }
+    return c;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    const float NO_LIMIT = 1e30f;
+
+    std::vector<TestCase> testCases = {
+        { "least important candidate gives up its finest mip first",
+            { MakeCandidate(4, { 8, 4, 2, 1 }), MakeCandidate(1, { 8, 4, 2, 1 }) },
+            8, NO_LIMIT, { 0, 1 }, 8 },
+
+        { "coarse mips are worth more: value = importance * 2^mip",
+            // candidate 0 at mip 2 is worth 4, candidate 1 at mip 0 is worth 3
+            { MakeCandidate(1, { 0, 0, 4, 1 }), MakeCandidate(3, { 4, 2, 1, 1 }) },
+            4, NO_LIMIT, { 2, 1 }, 4 },
+
+        { "a candidate releases mips finest first, skipping mips without tiles",
+            { MakeCandidate(1, { 5, 0, 3, 1 }) },
+            6, NO_LIMIT, { 3 }, 8 },
+
+        { "stops once enough tiles are freed",
+            // values: candidate 0 mip 0 = 1, mip 1 = 2. candidate 1 mip 0 = 3. candidate 2 mip 0 = 8
+            { MakeCandidate(1, { 2, 2, 2, 1 }), MakeCandidate(3, { 2, 2, 2, 1 }), MakeCandidate(8, { 2, 2, 2, 1 }) },
+            4, NO_LIMIT, { 2, 0, 0 }, 4 },
+
+        { "tiles worth at least the demand are kept",
+            // values: candidate 0 mip 0 = 1, mip 1 = 2, mip 2 = 4. demand 3 allows mips 0 and 1 only
+            { MakeCandidate(1, { 4, 2, 1, 1 }) },
+            100, 3, { 2 }, 6 },
+
+        { "packed mips (>= m_maxMip) are never reclaimed",
+            { MakeCandidate(1, { 1, 1 }) },
+            100, NO_LIMIT, { 2 }, 2 },
+
+        { "nothing needed, nothing reclaimed",
+            { MakeCandidate(1, { 4, 2, 1 }) },
+            0, NO_LIMIT, { 0 }, 0 },
+
+        { "a candidate without referenced tiles is unchanged",
+            { MakeCandidate(1, { 0, 0, 0 }), MakeCandidate(2, { 3, 1, 1 }) },
+            2, NO_LIMIT, { 3, 1 }, 3 },
+    };
+
+    // candidate 0 is the reclaimed resource, with feedback clamped to mip 2. the demand is for mip 1
+    std::vector<PromoteCase> promoteCases = {
+        { "re-promotion that fits in free space reclaims nothing",
+            { MakeCandidate(8, { 0, 0, 2, 1 }), MakeCandidate(1, { 4, 2, 1, 1 }) },
+            2, 4, 16, true, { 2, 0 }, 0 },
+
+        { "re-promotion takes space from cheaper tiles",
+            // demand worth 8 * 2^1 = 16, candidate 1 mip 0 is worth 1
+            { MakeCandidate(8, { 0, 0, 2, 1 }), MakeCandidate(1, { 4, 2, 1, 1 }) },
+            2, 0, 16, true, { 2, 1 }, 4 },
+
+        { "re-promotion is refused when the only victims are worth more",
+            // demand worth 1 * 2^0 = 1, candidate 1 mip 0 is worth 4. candidate 0 never victimizes itself
+            { MakeCandidate(1, { 0, 4, 2, 1 }), MakeCandidate(4, { 4, 2, 1, 1 }) },
+            2, 0, 1, false, { 1, 0 }, 0 },
+
+        { "re-promotion is refused, with no victims, when cheaper tiles can't cover the shortfall",
+            // shortfall 10, but candidate 1 only holds 8 tiles worth less than 16
+            { MakeCandidate(8, { 0, 0, 2, 1 }), MakeCandidate(1, { 4, 2, 1, 1 }) },
+            12, 2, 16, false, { 2, 0 }, 0 },
+    };
+
+    Streaming::ReclaimPolicy policy;
+    std::vector<UINT> reclaimMips;
+    int numFailed = 0;
+
+    for (const auto& t : testCases)
+    {
+        UINT numFreed = policy.Select(reclaimMips, t.m_candidates, t.m_numTilesNeeded, t.m_demandValue);
+        bool passed = (numFreed == t.m_expectedNumFreed) && (reclaimMips == t.m_expectedMips);
+        if (!Report(t.m_name, passed, numFreed, t.m_expectedNumFreed, reclaimMips, t.m_expectedMips)) { numFailed++; }
+    }
+
+    for (const auto& t : promoteCases)
+    {
+        UINT numFreed = 0;
+        bool promoted = policy.Promote(reclaimMips, numFreed, t.m_candidates, t.m_numTilesNeeded, t.m_numFree, t.m_value);
+        bool passed = (promoted == t.m_expectedPromoted) && (numFreed == t.m_expectedNumFreed) && (reclaimMips == t.m_expectedMips);
+        if (!Report(t.m_name, passed, numFreed, t.m_expectedNumFreed, reclaimMips, t.m_expectedMips)) { numFailed++; }
+    }
+
+    const size_t numCases = testCases.size() + promoteCases.size();
+    std::cout << (numCases - numFailed) << " of " << numCases << " passed\n";
+    return numFailed;
+}
@@ -0,0 +1,263 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+// benchmark for the residency thread: how long does it take to find and update the resources whose residency changed?
+// "scan" visits every resource and checks an atomic flag, which is what TileUpdateManager used to do
+// "dirty" drains a DirtyList that holds only the resources that changed
+// every frame, a fraction of the resources change. the stress test then validates the DirtyList under contention:
+// producer threads mark resources dirty while the consumer drains, and no change may be lost
+// for example, "residencyBenchmark.exe -resources 10000 -percent 1 -frames 1000"
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "Timer.h"
+#include "SimpleAllocator.h"
+
+struct Params
+{
+    UINT m_numResources{ 10000 };
+    float m_percentChanged{ 1 };  // resources that change each frame
+    UINT m_numFrames{ 1000 };
+    UINT m_minMipMapSize{ 256 };  // bytes per resource, e.g. a 16k x 16k BC7 texture has 64x64 tiles = 4KB
+    UINT m_numProducers{ 4 };     // stress test
+    UINT m_numStressIters{ 100000 };
+};
+
+//-----------------------------------------------------------------------------
+// stands in for StreamingResourceBase: a flag that says it's dirty, and a min mip map to rewrite
+//-----------------------------------------------------------------------------
+class Resource
+{
+public:
+    Resource(UINT in_minMipMapSize) : m_minMipMap(in_minMipMapSize, 0) {}
+
+    // like StreamingResourceBase::SetResidencyChanged()
+    bool SetChanged()
+    {
+        return !m_changed.exchange(true);
+    }
+
+    // like StreamingResourceBase::UpdateMinMipMap(). returns true if there was work to do
+    bool Update()
+    {
+        if (!m_changed.exchange(false)) { return false; }
+        for (auto& b : m_minMipMap) { b++; }
+        m_numUpdates++;
+        return true;
+    }
+
+    UINT m_numUpdates{ 0 };
+    std::atomic<UINT> m_version{ 0 };    // stress test: most recent change
+    UINT m_versionSeen{ 0 };             // stress test: most recent change visible to the consumer
+
+    friend class Streaming::DirtyList<Resource>;
+private:
+    std::atomic<bool> m_changed{ false };
+    std::vector<BYTE> m_minMipMap;
+    Resource* m_pNextDirty{ nullptr };
+};
+
+struct Result
+{
+    double m_averageUs{ 0 }; // consumer time per frame
+    double m_maxUs{ 0 };
+    UINT64 m_numErrors{ 0 };
+};
+
+//-----------------------------------------------------------------------------
+// the same resources change in both modes
+//-----------------------------------------------------------------------------
+std::vector<std::vector<UINT>> ChooseChanges(const Params& in_params)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<UINT> dist(0, in_params.m_numResources - 1);
+    UINT numChanged = std::max(UINT(in_params.m_numResources * in_params.m_percentChanged / 100.f), (UINT)1);
+
+    std::vector<std::vector<UINT>> changes(in_params.m_numFrames);
+    for (auto& frame : changes)
+    {
+        frame.resize(numChanged);
+        for (auto& i : frame) { i = dist(gen); }
+    }
+    return changes;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Result Run(const Params& in_params, const std::vector<std::vector<UINT>>& in_changes, bool in_useDirtyList)
+{
+    std::vector<std::unique_ptr<Resource>> resources;
+    for (UINT i = 0; i < in_params.m_numResources; i++)
+    {
+        resources.push_back(std::make_unique<Resource>(in_params.m_minMipMapSize));
+    }
+    Streaming::DirtyList<Resource> dirtyList;
+
+    Result result;
+    UINT64 numExpected = 0;
+    UINT64 numUpdates = 0;
+    double totalTime = 0;
+
+    for (const auto& frame : in_changes)
+    {
+        // changes arrive (e.g. DataUploader notifications)
+        for (auto i : frame)
+        {
+            if (resources[i]->SetChanged())
+            {
+                numExpected++;
+                if (in_useDirtyList) { dirtyList.Push(resources[i].get()); }
+            }
+        }
+
+        // the residency thread wakes up
+        Timer timer;
+        timer.Start();
+        if (in_useDirtyList)
+        {
+            dirtyList.Drain([&](Resource* p) { if (p->Update()) { numUpdates++; } });
+        }
+        else
+        {
+            for (auto& r : resources)
+            {
+                if (r->Update()) { numUpdates++; }
+            }
+        }
+        double t = timer.Stop();
+
+        totalTime += t;
+        result.m_maxUs = std::max(result.m_maxUs, t * 1e6);
+    }
+
+    result.m_averageUs = 1e6 * totalTime / double(in_changes.size());
+    result.m_numErrors = (numExpected != numUpdates) ? 1 : 0;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+// producers repeatedly change random resources while the consumer drains
+// after everyone is done, the consumer must have seen the latest change to every resource
+//-----------------------------------------------------------------------------
+UINT64 StressTest(const Params& in_params)
+{
+    std::vector<std::unique_ptr<Resource>> resources;
+    for (UINT i = 0; i < in_params.m_numResources; i++)
+    {
+        resources.push_back(std::make_unique<Resource>(0));
+    }
+    Streaming::DirtyList<Resource> dirtyList;
+
+    auto visit = [&](Resource* p)
+    {
+        // read the version after clearing the flag: a later change will push again
+        if (p->Update()) { p->m_versionSeen = p->m_version.load(); }
+    };
+
+    std::atomic<UINT> numProducersRunning{ in_params.m_numProducers };
+    std::vector<std::thread> producers;
+    for (UINT t = 0; t < in_params.m_numProducers; t++)
+    {
+        producers.emplace_back([&, t]
+            {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<UINT> dist(0, in_params.m_numResources - 1);
+                for (UINT i = 0; i < in_params.m_numStressIters; i++)
+                {
+                    auto p = resources[dist(gen)].get();
+                    p->m_version.fetch_add(1);
+                    if (p->SetChanged()) { dirtyList.Push(p); }
+                }
+                numProducersRunning--;
+            });
+    }
+
+    while (numProducersRunning)
+    {
+        dirtyList.Drain(visit);
+    }
+    for (auto& t : producers) { t.join(); }
+    dirtyList.Drain(visit);
+
+    UINT64 numErrors = 0;
+    for (auto& r : resources)
+    {
+        if (r->m_versionSeen != r->m_version) { numErrors++; }
+    }
+    if (!dirtyList.IsEmpty()) { numErrors++; }
+    return numErrors;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    ArgParser argParser;
+    argParser.AddArg(L"-resources", params.m_numResources, L"number of resources");
+    argParser.AddArg(L"-percent", params.m_percentChanged, L"percent of resources that change each frame");
+    argParser.AddArg(L"-frames", params.m_numFrames, L"number of frames");
+    argParser.AddArg(L"-minMipMapSize", params.m_minMipMapSize, L"bytes of residency map per resource");
+    argParser.AddArg(L"-producers", params.m_numProducers, L"producer threads in the stress test");
+    argParser.AddArg(L"-stressIters", params.m_numStressIters, L"changes per producer in the stress test");
+    argParser.Parse();
+
+    auto changes = ChooseChanges(params);
+
+    std::wcout << L"resources: " << params.m_numResources << L" changed per frame: " << params.m_percentChanged
+        << L"% frames: " << params.m_numFrames << std::endl;
+    std::wcout << std::setw(10) << L"mode" << std::setw(14) << L"avg us/frame" << std::setw(14) << L"max us/frame"
+        << std::setw(10) << L"errors" << std::endl;
+
+    auto scan = Run(params, changes, false);
+    auto dirty = Run(params, changes, true);
+
+    std::wcout << std::fixed << std::setprecision(2)
+        << std::setw(10) << L"scan" << std::setw(14) << scan.m_averageUs << std::setw(14) << scan.m_maxUs << std::setw(10) << scan.m_numErrors << std::endl
+        << std::setw(10) << L"dirty" << std::setw(14) << dirty.m_averageUs << std::setw(14) << dirty.m_maxUs << std::setw(10) << dirty.m_numErrors << std::endl;
+
+    UINT64 stressErrors = StressTest(params);
+    std::wcout << L"stress test (" << params.m_numProducers << L" producers) errors: " << stressErrors << std::endl;
+
+    UINT64 totalErrors = scan.m_numErrors + dirty.m_numErrors + stressErrors;
+    return totalErrors ? -1 : 0;
+}
@@ -0,0 +1,3 @@
+rem ProcessFeedback under churn: the camera turns around every 8 frames
+rem compare the cpu_feedback column of the timing file
+demo.bat -waitforassetload -hideUI -camerarate 0 -cameraSwapFrames 8 -timingstart 200 -timingstop 1200 -timingFileFrames "cameraswap" %*
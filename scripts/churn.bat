@@ -0,0 +1,3 @@
+rem add/remove StreamingResources while streaming: an object is replaced every 4 frames
+rem compare remove_avg_ms and add_avg_ms in the timing file, and the frame times around each replacement
+call profile.bat -churnFrames 4 -timingFileFrames "churn" %*
@@ -0,0 +1,5 @@
+rem job system benchmark: dedicated streaming threads vs. a shared pool of work-stealing threads
+rem compare latency_ms, cpu_seconds and cpu_cores, and the per-frame render times, in the timing files
+call profile.bat -timingFileFrames "threads" %*
+call profile.bat -workerThreads 4 -timingFileFrames "jobs4" %*
+call profile.bat -workerThreads 2 -timingFileFrames "jobs2" %*
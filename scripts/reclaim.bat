@@ -0,0 +1,11 @@
+rem graceful degradation benchmark: heap sized at 25% of the working set
+rem the working set is measured, not assumed: capture a trace with "stress.bat -timingstart 200 -timingstop 700 -capturetrace",
+rem run "traceanalyzer.exe -file uploadTraceFile_1.bin", and pass 1/4 of its "distinct tiles in trace" as the first argument
+rem e.g. "reclaim.bat 6144" if the trace has 24576 distinct tiles. traces hold loads, not every tile sampled, so this is a lower bound
+rem compare late_rate, #uploads, and reclaimed_tiles in the two timing files
+if "%1"=="" (
+    echo usage: reclaim.bat heapSizeTiles [profile.bat arguments]
+    exit /b 1
+)
+call profile.bat -heapSizeTiles %1 -timingFileFrames "reclaim_off" %2 %3 %4 %5 %6 %7 %8 %9
+call profile.bat -heapSizeTiles %1 -reclaim -timingFileFrames "reclaim_on" %2 %3 %4 %5 %6 %7 %8 %9
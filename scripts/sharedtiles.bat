@@ -0,0 +1,4 @@
+rem tile sharing benchmark: many spheres use the same few texture files
+rem compare #uploads, shared_mappings, uploads_avoided_fraction and heap_tiles in the two timing files
+call profile.bat -timingFileFrames "share_off" %*
+call profile.bat -shareTiles -timingFileFrames "share_on" %*
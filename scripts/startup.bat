@@ -0,0 +1,4 @@
+rem startup benchmark: create 1000 spheres, then compare create_ms and ready_ms in the timing files
+rem synchronous creation reads every file on the application thread. -asyncCreate uses a pool of loader threads
+call profile.bat -maxNumObjects 1000 -numSpheres 1000 -timingFileFrames "startup_sync" %*
+call profile.bat -maxNumObjects 1000 -numSpheres 1000 -asyncCreate -timingFileFrames "startup_async" %*
@@ -0,0 +1,17 @@
+echo usage: synthetic dstdir count [DdsToXet options, e.g. -width 16384 -height 16384 -entropy 0.6]
+@echo off
+
+if not exist %1 mkdir %1
+
+set exedir=%cd%
+set outdir=%1
+set count=%2
+
+SHIFT
+SHIFT
+
+rem the seed is the file number, so the same command always produces the same files
+for /L %%i in (1,1,%count%) do (
+	echo synthetic%%i.xet
+	%exedir%\DdsToXet.exe -generate -seed %%i -out %outdir%\synthetic%%i.xet %*
+)
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 #include "TerrainGenerator.h"
@@ -63,6 +64,8 @@ struct CommandLineArgs
     bool m_updateEveryObjectEveryFrame{ false };
     float m_animationRate{ 0 };
     float m_cameraAnimationRate{ 0 }; // puts camera on a track and moves it every frame
+    UINT m_cameraSwapFrames{ 0 };     // turn the camera around every n frames, a worst case for streaming churn. 0 disables
+    UINT m_churnFrames{ 0 };          // destroy and re-create an object every n frames, measuring the latency. 0 disables
 
     bool m_showUI{ true };
     bool m_uiModeMini{ false };       // just bandwidth and heap occupancy
@@ -120,5 +123,17 @@ struct CommandLineArgs
     TerrainGenerator::Params m_terrainParams;
 
     bool m_captureTrace{ false }; // capture a trace file of tile uploads
+    bool m_captureFeedback{ false }; // capture a file of the feedback consumed by each resource
     int m_threadPriority{ 0 }; // applies to internal threads
+    bool m_enablePrefetch{ false }; // speculatively load tiles in the direction of feedback motion
+    UINT m_feedbackDilationRadius{ 0 };  // widen feedback requests to neighboring regions. 0 disables
+    UINT m_feedbackDilationMipBias{ 0 }; // dilated neighbors request this many mips coarser
+    std::vector<UINT> m_feedbackDilationMipBiasPerMip; // optional, overrides the above per dilated mip
+    float m_targetHeapOccupancy{ 0 };    // streaming library biases feedback to hold heap occupancy here. 0 disables
+    bool m_enableReclaim{ false };       // when a heap is full, release fine tiles of less important objects
+    bool m_asyncCreate{ false };         // spheres are created by CreateStreamingResourceAsync()
+    UINT m_numLoaderThreads{ 4 };        // threads that load resources created asynchronously
+    bool m_shareTiles{ false };          // objects using the same texture file share tiles in the heap
+    UINT m_numWorkerThreads{ 0 };        // 0: dedicated streaming threads. otherwise, a job system with this many workers
+    UINT64 m_workerAffinityMask{ 0 };    // job system workers run on these processors. 0: any
 };
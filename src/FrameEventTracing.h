@@ -68,14 +68,16 @@ public:
         UINT in_numUploads, UINT in_numEvictions,
         float in_cpuProcessFeedbackTime,
         float in_gpuProcessFeedbackTime,
-        UINT in_numFeedbackResolves, UINT in_numSubmits)
+        UINT in_numFeedbackResolves, UINT in_numSubmits,
+        float in_feedbackBias)
     {
         m_events.push_back({
             in_renderList.GetLatest(),
             in_updateList.GetLatest(),
             in_numUploads, in_numEvictions,
             in_cpuProcessFeedbackTime, in_gpuProcessFeedbackTime,
-            in_numFeedbackResolves, in_numSubmits });
+            in_numFeedbackResolves, in_numSubmits,
+            in_feedbackBias });
     }
 
     void WriteEvents(HWND in_hWnd, const CommandLineArgs& in_args);
@@ -92,6 +94,7 @@ private:
         float m_gpuFeedbackTime;
         UINT m_numGpuFeedbackResolves;
         UINT m_numSubmits;
+        float m_feedbackBias;
     };
 
     std::vector<FrameEvents> m_events;
@@ -119,6 +122,9 @@ inline void FrameEventTracing::WriteEvents(HWND in_hWnd, const CommandLineArgs&
     RECT windowRect;
     GetClientRect(in_hWnd, &windowRect);
 
+    std::wstringstream dilationMipBiasPerMip;
+    for (auto b : in_args.m_feedbackDilationMipBiasPerMip) { dilationMipBiasPerMip << " " << b; }
+
     *this
         << "\n" << GetCommandLineW() << "\n\n"
         << "WindowWidth/Height: " << windowRect.right - windowRect.left << " " << windowRect.bottom - windowRect.top << "\n"
@@ -127,13 +133,23 @@ inline void FrameEventTracing::WriteEvents(HWND in_hWnd, const CommandLineArgs&
         << "heap size: " << in_args.m_streamingHeapSize << "\n"
         << "num heaps: " << in_args.m_numHeaps << "\n"
         << "paintmixer: " << in_args.m_cameraPaintMixer << "\n"
+        << "camera swap frames: " << in_args.m_cameraSwapFrames << "\n"
+        << "churn frames: " << in_args.m_churnFrames << "\n"
         << "lod bias: " << in_args.m_lodBias << "\n"
         << "aliasing barriers: " << in_args.m_addAliasingBarriers << "\n"
+        << "prefetch: " << in_args.m_enablePrefetch << "\n"
+        << "feedback dilation radius: " << in_args.m_feedbackDilationRadius << " mip bias: " << in_args.m_feedbackDilationMipBias
+        << " per mip:" << dilationMipBiasPerMip.str() << "\n"
+        << "target heap occupancy: " << in_args.m_targetHeapOccupancy << "\n"
+        << "reclaim: " << in_args.m_enableReclaim << "\n"
+        << "async create: " << in_args.m_asyncCreate << " loader threads: " << in_args.m_numLoaderThreads << "\n"
+        << "share tiles: " << in_args.m_shareTiles << "\n"
+        << "worker threads: " << in_args.m_numWorkerThreads << " affinity: " << in_args.m_workerAffinityMask << "\n"
         << "media dir: " << in_args.m_mediaDir << "\n";
 
     *this << "\nTimers (ms)\n"
         << "-----------------------------------------------------------------------------------------------------------\n"
-        << "cpu_draw TUM::EndFrame exec_cmd_list wait_present total_frame_time evictions_completed copies_completed cpu_feedback feedback_resolve num_resolves num_submits\n"
+        << "cpu_draw TUM::EndFrame exec_cmd_list wait_present total_frame_time evictions_completed copies_completed cpu_feedback feedback_resolve num_resolves num_submits feedback_bias\n"
         << "-----------------------------------------------------------------------------------------------------------\n";
 
     for (auto& e : m_events)
@@ -158,6 +174,7 @@ inline void FrameEventTracing::WriteEvents(HWND in_hWnd, const CommandLineArgs&
             << " " << e.m_gpuFeedbackTime * 1000
             << " " << e.m_numGpuFeedbackResolves
             << " " << e.m_numSubmits
+            << " " << e.m_feedbackBias
 
             << std::endl;
     }
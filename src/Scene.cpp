@@ -684,6 +684,18 @@ void Scene::StartStreamingLibrary()
     tumDesc.m_minNumUploadRequests = m_args.m_minNumUploadRequests;
     tumDesc.m_useDirectStorage = m_args.m_useDirectStorage;
     tumDesc.m_threadPriority = (TileUpdateManagerDesc::ThreadPriority)m_args.m_threadPriority;
+    tumDesc.m_enablePrefetch = m_args.m_enablePrefetch;
+    tumDesc.m_feedbackDilationRadius = m_args.m_feedbackDilationRadius;
+    tumDesc.m_feedbackDilationMipBias = m_args.m_feedbackDilationMipBias;
+    tumDesc.m_feedbackDilationMipBiasPerMip = m_args.m_feedbackDilationMipBiasPerMip;
+    // the timing file reports the late-region rate
+    tumDesc.m_enableLateRegionStatistics = m_args.m_timingFrameFileName.size() && (m_args.m_timingStopFrame >= m_args.m_timingStartFrame);
+    tumDesc.m_targetHeapOccupancy = m_args.m_targetHeapOccupancy;
+    tumDesc.m_enableReclaim = m_args.m_enableReclaim;
+    tumDesc.m_numLoaderThreads = m_args.m_numLoaderThreads;
+    tumDesc.m_shareTilesByFile = m_args.m_shareTiles;
+    tumDesc.m_numWorkerThreads = m_args.m_numWorkerThreads;
+    tumDesc.m_workerAffinityMask = m_args.m_workerAffinityMask;
 
     m_pTileUpdateManager = TileUpdateManager::Create(tumDesc);
 
@@ -858,7 +870,7 @@ void Scene::LoadSpheres()
                 }
                 else
                 {
-                    o = new SceneObjects::Planet(textureFilename, pHeap, descCPU, m_pEarth);
+                    o = new SceneObjects::Planet(textureFilename, pHeap, descCPU, m_pEarth, m_args.m_asyncCreate);
                 }
                 o->SetAxis(XMVectorSet(0, 0, 1, 0));
                 o->GetModelMatrix() = SetSphereMatrix();
@@ -881,7 +893,7 @@ void Scene::LoadSpheres()
                 }
                 else
                 {
-                    o = new SceneObjects::Planet(textureFilename, pHeap, descCPU, m_pFirstSphere);
+                    o = new SceneObjects::Planet(textureFilename, pHeap, descCPU, m_pFirstSphere, m_args.m_asyncCreate);
                 }
                 o->GetModelMatrix() = SetSphereMatrix();
             }
@@ -926,6 +938,79 @@ void Scene::LoadSpheres()
     }
 }
 
+//-----------------------------------------------------------------------------
+// benchmark adding and removing StreamingResources under load
+// every n frames, destroy the most recent object and let LoadSpheres() create a replacement
+// the times include the application's object (geometry, descriptors) as well as the StreamingResource
+//-----------------------------------------------------------------------------
+void Scene::ChurnObjects()
+{
+    if ((0 == m_args.m_churnFrames) || (0 == m_frameNumber) || (m_frameNumber % m_args.m_churnFrames))
+    {
+        return;
+    }
+
+    // wait for the initial load
+    if (m_objects.size() < (UINT)m_args.m_numSpheres)
+    {
+        return;
+    }
+
+    // other objects share geometry with these
+    SceneObjects::BaseObject* pObject = m_objects.back();
+    if ((m_pTerrainSceneObject == pObject) || (m_pFirstSphere == pObject) || (m_pEarth == pObject) || (m_pSky == pObject))
+    {
+        return;
+    }
+
+    // the object may be referenced by in-flight frames. not included in the measurement.
+    WaitForGpu();
+
+    Timer timer;
+    timer.Start();
+    delete pObject;
+    m_objects.resize(m_objects.size() - 1);
+    float removeTime = (float)timer.GetTime();
+
+    timer.Start();
+    LoadSpheres();
+    float addTime = (float)timer.GetTime();
+
+    m_churnStatistics.m_numObjects++;
+    m_churnStatistics.m_totalRemoveTime += removeTime;
+    m_churnStatistics.m_maxRemoveTime = std::max(m_churnStatistics.m_maxRemoveTime, removeTime);
+    m_churnStatistics.m_totalAddTime += addTime;
+    m_churnStatistics.m_maxAddTime = std::max(m_churnStatistics.m_maxAddTime, addTime);
+}
+
+//-----------------------------------------------------------------------------
+// startup benchmark: time to create the initial objects, and until all of them can be drawn (packed mips resident)
+// compare with and without -asyncCreate
+//-----------------------------------------------------------------------------
+void Scene::MeasureStartup()
+{
+    if (m_startupStatistics.m_numObjects)
+    {
+        return;
+    }
+
+    for (const auto o : m_objects)
+    {
+        if (!o->GetPackedMipsPresent())
+        {
+            return;
+        }
+    }
+
+    m_startupStatistics.m_numObjects = (UINT)m_objects.size();
+    m_startupStatistics.m_readyTime = (float)m_startupTimer.GetTime();
+
+    std::wstringstream ss;
+    ss << "startup: " << m_startupStatistics.m_numObjects << " objects created in " << 1000.f * m_startupStatistics.m_createTime
+        << "ms, ready in " << 1000.f * m_startupStatistics.m_readyTime << "ms\n";
+    OutputDebugString(ss.str().c_str());
+}
+
 //-----------------------------------------------------------------------------
 // create MSAA color and depth targets
 //-----------------------------------------------------------------------------
@@ -1283,6 +1368,17 @@ void Scene::ScreenShot(std::wstring& in_fileName) const
     WindowCapture::CaptureRenderTarget(m_renderTargets[m_frameIndex].Get(), m_commandQueue.Get(), filename);
 }
 
+//-------------------------------------------------------------------------
+// user + kernel time of every thread in the process, in seconds
+//-------------------------------------------------------------------------
+static double GetProcessCpuTime()
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    ::GetProcessTimes(::GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    auto toSeconds = [](const FILETIME& t) { return double((UINT64(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7; }; // 100ns units
+    return toSeconds(kernelTime) + toSeconds(userTime);
+}
+
 //-------------------------------------------------------------------------
 //-------------------------------------------------------------------------
 void Scene::GatherStatistics()
@@ -1308,12 +1404,19 @@ void Scene::GatherStatistics()
         UINT numSubmitsLastFrame = latestNumSubmits - numSubmits;
         numSubmits = latestNumSubmits;
 
+        // the most-constrained heap
+        float feedbackBias = 0;
+        for (auto h : m_sharedHeaps)
+        {
+            feedbackBias = std::max(feedbackBias, h->GetFeedbackBias());
+        }
+
         m_csvFile->Append(m_renderThreadTimes, m_updateFeedbackTimes,
             m_numUploadsPreviousFrame, m_numEvictionsPreviousFrame,
             // Note: these may be off by 1 frame, but probably good enough
             m_pTileUpdateManager->GetCpuProcessFeedbackTime(),
             m_gpuProcessFeedbackTime, m_prevNumFeedbackObjects[m_frameIndex],
-            numSubmitsLastFrame);
+            numSubmitsLastFrame, feedbackBias);
 
         if (m_frameNumber == m_args.m_timingStopFrame)
         {
@@ -1336,6 +1439,94 @@ void Scene::GatherStatistics()
                 << " " << approximatePerTileLatency
                 << " " << m_pTileUpdateManager->GetTotalNumSubmits() - m_startSubmitCount
                 << "\n";
+
+            {
+                UINT numFeedbackRegions = m_pTileUpdateManager->GetTotalNumFeedbackRegions() - m_startFeedbackRegions;
+                UINT numLateRegions = m_pTileUpdateManager->GetTotalNumLateRegions() - m_startLateRegions;
+                float lateRate = numFeedbackRegions ? float(numLateRegions) / float(numFeedbackRegions) : 0;
+                *m_csvFile
+                    << "feedback_regions late_regions late_rate\n"
+                    << numFeedbackRegions
+                    << " " << numLateRegions
+                    << " " << lateRate
+                    << "\n";
+            }
+
+            {
+                // cpu time of the whole process, e.g. to compare dedicated streaming threads with a job system
+                double cpuTime = GetProcessCpuTime() - m_startProcessCpuTime;
+                *m_csvFile
+                    << "cpu_seconds cpu_cores worker_threads\n"
+                    << cpuTime
+                    << " " << cpuTime / measuredTime
+                    << " " << m_args.m_numWorkerThreads
+                    << "\n";
+            }
+
+            if (m_args.m_enablePrefetch)
+            {
+                UINT numPrefetchRequests = m_pTileUpdateManager->GetTotalNumPrefetchRequests() - m_startPrefetchRequests;
+                UINT numPrefetchHits = m_pTileUpdateManager->GetTotalNumPrefetchHits() - m_startPrefetchHits;
+                UINT numPrefetchUploads = m_pTileUpdateManager->GetTotalNumPrefetchUploads() - m_startPrefetchUploads;
+                float accuracy = numPrefetchRequests ? float(numPrefetchHits) / float(numPrefetchRequests) : 0;
+                float uploadOverhead = measuredNumUploads ? float(numPrefetchUploads) / float(measuredNumUploads) : 0;
+                *m_csvFile
+                    << "prefetch_requests prefetch_hits prefetch_accuracy prefetch_uploads prefetch_upload_fraction\n"
+                    << numPrefetchRequests
+                    << " " << numPrefetchHits
+                    << " " << accuracy
+                    << " " << numPrefetchUploads
+                    << " " << uploadOverhead
+                    << "\n";
+            }
+
+            if (m_args.m_enableReclaim)
+            {
+                *m_csvFile
+                    << "reclaimed_tiles\n"
+                    << m_pTileUpdateManager->GetTotalNumReclaimedTiles() - m_startReclaimedTiles
+                    << "\n";
+            }
+
+            if (m_args.m_shareTiles)
+            {
+                // a shared mapping is an upload that did not happen
+                UINT numSharedMappings = m_pTileUpdateManager->GetTotalNumSharedTileMappings() - m_startSharedMappings;
+                UINT numRequested = measuredNumUploads + numSharedMappings;
+                float avoided = numRequested ? float(numSharedMappings) / float(numRequested) : 0;
+                UINT numHeapTiles = 0;
+                for (auto h : m_sharedHeaps)
+                {
+                    numHeapTiles += h->GetNumTilesAllocated();
+                }
+                *m_csvFile
+                    << "shared_mappings uploads_avoided_fraction heap_tiles\n"
+                    << numSharedMappings
+                    << " " << avoided
+                    << " " << numHeapTiles
+                    << "\n";
+            }
+
+            if (m_args.m_churnFrames)
+            {
+                const auto& c = m_churnStatistics;
+                float n = (float)std::max(c.m_numObjects, (UINT)1);
+                *m_csvFile
+                    << "churn_objects remove_avg_ms remove_max_ms add_avg_ms add_max_ms\n"
+                    << c.m_numObjects
+                    << " " << 1000.f * c.m_totalRemoveTime / n
+                    << " " << 1000.f * c.m_maxRemoveTime
+                    << " " << 1000.f * c.m_totalAddTime / n
+                    << " " << 1000.f * c.m_maxAddTime
+                    << "\n";
+            }
+
+            *m_csvFile
+                << "startup_objects create_ms ready_ms\n"
+                << m_startupStatistics.m_numObjects
+                << " " << 1000.f * m_startupStatistics.m_createTime
+                << " " << 1000.f * m_startupStatistics.m_readyTime
+                << "\n";
             m_csvFile->close();
             m_csvFile = nullptr;
         }
@@ -1350,6 +1541,7 @@ void Scene::GatherStatistics()
     if (m_frameNumber == m_args.m_timingStartFrame)
     {
         m_pTileUpdateManager->CaptureTraceFile(m_args.m_captureTrace);
+        m_pTileUpdateManager->CaptureFeedbackFile(m_args.m_captureFeedback);
 
         // start timing and gathering uploads from the very beginning of the timed region
         if (m_args.m_timingFrameFileName.size())
@@ -1358,6 +1550,15 @@ void Scene::GatherStatistics()
             m_startUploadCount = m_pTileUpdateManager->GetTotalNumUploads();
             m_startSubmitCount = m_pTileUpdateManager->GetTotalNumSubmits();
             m_totalTileLatency = m_pTileUpdateManager->GetTotalTileCopyLatency();
+            m_startPrefetchRequests = m_pTileUpdateManager->GetTotalNumPrefetchRequests();
+            m_startPrefetchHits = m_pTileUpdateManager->GetTotalNumPrefetchHits();
+            m_startPrefetchUploads = m_pTileUpdateManager->GetTotalNumPrefetchUploads();
+            m_startFeedbackRegions = m_pTileUpdateManager->GetTotalNumFeedbackRegions();
+            m_startLateRegions = m_pTileUpdateManager->GetTotalNumLateRegions();
+            m_startReclaimedTiles = m_pTileUpdateManager->GetTotalNumReclaimedTiles();
+            m_startSharedMappings = m_pTileUpdateManager->GetTotalNumSharedTileMappings();
+            m_startProcessCpuTime = GetProcessCpuTime();
+            m_churnStatistics = ChurnStatistics();
             m_cpuTimer.Start();
         }
     }
@@ -1416,6 +1617,20 @@ void Scene::Animate()
         }
     }
 
+    // like SwapCameraForDemo(), but periodic: alternate between looking forward and backward
+    // nearly every visible tile changes on a swap, which stresses ProcessFeedback()
+    if (m_args.m_cameraSwapFrames)
+    {
+        bool swapped = (m_frameNumber / m_args.m_cameraSwapFrames) & 1;
+        bool swapChanged = m_frameNumber && (0 == (m_frameNumber % m_args.m_cameraSwapFrames));
+
+        // an animated camera is recomputed every frame, a static camera only changes when swapping
+        if (m_args.m_cameraAnimationRate ? swapped : swapChanged)
+        {
+            SetViewMatrix(XMMatrixMultiply(m_viewMatrix, XMMatrixRotationY(XM_PI)));
+        }
+    }
+
     // spin objects
     float rotation = m_args.m_animationRate * 0.01f;
 
@@ -1603,7 +1818,11 @@ void Scene::DrawUI()
         UINT numTilesVirtual = 0;
         for (auto& o : m_objects)
         {
-            numTilesVirtual += o->GetStreamingResource()->GetNumTilesVirtual();
+            // resources created asynchronously can't be queried until loaded
+            if (o->GetPackedMipsPresent())
+            {
+                numTilesVirtual += o->GetStreamingResource()->GetNumTilesVirtual();
+            }
         }
 
         UINT numTilesCommitted = 0;
@@ -1770,7 +1989,19 @@ bool Scene::Draw()
 
     // load more spheres?
     // SceneResource destruction/creation must be done outside of BeginFrame/EndFrame
-    LoadSpheres();
+    ChurnObjects();
+    if (m_objects.empty())
+    {
+        // the initial load is the startup benchmark
+        m_startupTimer.Start();
+        LoadSpheres();
+        m_startupStatistics.m_createTime = (float)m_startupTimer.GetTime();
+    }
+    else
+    {
+        LoadSpheres();
+    }
+    MeasureStartup();
 
     // after loading new objects
     if (m_args.m_waitForAssetLoad && WaitForAssetLoad())
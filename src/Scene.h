@@ -222,6 +222,29 @@ private:
     DirectX::XMMATRIX SetSphereMatrix();
     void LoadSpheres(); // progressively over multiple frames
 
+    // -churnFrames: replace an object while streaming continues, and time it
+    void ChurnObjects();
+    struct ChurnStatistics
+    {
+        UINT m_numObjects{ 0 };
+        float m_totalRemoveTime{ 0 };
+        float m_maxRemoveTime{ 0 };
+        float m_totalAddTime{ 0 };
+        float m_maxAddTime{ 0 };
+    };
+    ChurnStatistics m_churnStatistics;
+
+    // time to create the initial objects (-asyncCreate affects this), and until all of them can be drawn
+    void MeasureStartup();
+    struct StartupStatistics
+    {
+        UINT m_numObjects{ 0 }; // set once all objects are ready
+        float m_createTime{ 0 };
+        float m_readyTime{ 0 };
+    };
+    StartupStatistics m_startupStatistics;
+    Timer m_startupTimer;
+
     // each frame, update objects until timeout reached
     UINT m_queueFeedbackIndex{ 0 }; // index based on number of gpu feedback resolves per frame
     std::vector<UINT> m_prevNumFeedbackObjects; // to correlate # objects with feedback time
@@ -251,6 +274,14 @@ private:
     void GatherStatistics();
     UINT m_startUploadCount{ 0 };
     UINT m_startSubmitCount{ 0 };
+    UINT m_startPrefetchRequests{ 0 };
+    UINT m_startPrefetchHits{ 0 };
+    UINT m_startPrefetchUploads{ 0 };
+    UINT m_startFeedbackRegions{ 0 };
+    UINT m_startLateRegions{ 0 };
+    UINT m_startReclaimedTiles{ 0 };
+    UINT m_startSharedMappings{ 0 };
+    double m_startProcessCpuTime{ 0 }; // seconds, all threads
     float m_totalTileLatency{ 0 }; // per-tile upload latency. NOT the same as per-UpdateList
     Timer m_cpuTimer;
 
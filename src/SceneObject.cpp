@@ -51,7 +51,10 @@ SceneObjects::BaseObject::BaseObject(
     StreamingHeap* in_pStreamingHeap,
     ID3D12Device* in_pDevice,
     D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU,
-    BaseObject* in_pSharedObject) : m_pTileUpdateManager(in_pTileUpdateManager)
+    BaseObject* in_pSharedObject,
+    bool in_asyncCreate) : m_pTileUpdateManager(in_pTileUpdateManager)
+    , m_device(in_pDevice)
+    , m_srvBaseCPU(in_srvBaseCPU)
 {
     //---------------------------------------
     // create root signature
@@ -159,16 +162,34 @@ SceneObjects::BaseObject::BaseObject(
 
         // The tile update manager queries the streaming texture for its tile dimensions
         // The feedback resource will be allocated with a mip region size matching the tile size
-        m_pStreamingResource = in_pTileUpdateManager->CreateStreamingResource(in_filename, in_pStreamingHeap);
+        if (in_asyncCreate)
+        {
+            // views are created by Draw() once the resource has loaded
+            m_pStreamingResource = in_pTileUpdateManager->CreateStreamingResourceAsync(in_filename, in_pStreamingHeap);
+        }
+        else
+        {
+            m_pStreamingResource = in_pTileUpdateManager->CreateStreamingResource(in_filename, in_pStreamingHeap);
+            CreateViews();
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+// descriptors for this object's texture and feedback map
+// the descriptors have not been referenced by the gpu, so can be written during a frame
+//-------------------------------------------------------------------------
+void SceneObjects::BaseObject::CreateViews()
+{
+    // sampler feedback view
+    CD3DX12_CPU_DESCRIPTOR_HANDLE feedbackHandle(m_srvBaseCPU, (UINT)Descriptors::HeapOffsetFeedback, m_srvUavCbvDescriptorSize);
+    m_pStreamingResource->CreateFeedbackView(m_device.Get(), feedbackHandle);
 
-        // sampler feedback view
-        CD3DX12_CPU_DESCRIPTOR_HANDLE feedbackHandle(in_srvBaseCPU, (UINT)Descriptors::HeapOffsetFeedback, m_srvUavCbvDescriptorSize);
-        m_pStreamingResource->CreateFeedbackView(in_pDevice, feedbackHandle);
+    // texture view
+    CD3DX12_CPU_DESCRIPTOR_HANDLE textureHandle(m_srvBaseCPU, (UINT)Descriptors::HeapOffsetTexture, m_srvUavCbvDescriptorSize);
+    m_pStreamingResource->CreateStreamingView(m_device.Get(), textureHandle);
 
-        // texture view
-        CD3DX12_CPU_DESCRIPTOR_HANDLE textureHandle(in_srvBaseCPU, (UINT)Descriptors::HeapOffsetTexture, m_srvUavCbvDescriptorSize);
-        m_pStreamingResource->CreateStreamingView(in_pDevice, textureHandle);
-    }
+    m_viewsCreated = true;
 }
 
 //-------------------------------------------------------------------------
@@ -326,6 +347,11 @@ void SceneObjects::BaseObject::Draw(ID3D12GraphicsCommandList1* in_pCommandList,
     //-------------------------------------------
     if (m_pStreamingResource->GetPackedMipsResident())
     {
+        if (!m_viewsCreated)
+        {
+            CreateViews();
+        }
+
         // choose LoD if applicable
         UINT lod = 0;
         if (m_lods.size() > 1)
@@ -466,7 +492,7 @@ SceneObjects::Terrain::Terrain(const std::wstring& in_filename,
     const CommandLineArgs& in_args,
     AssetUploader& in_assetUploader) :
     BaseObject(in_filename, in_pTileUpdateManager, in_pStreamingHeap,
-        in_pDevice, in_srvBaseCPU, nullptr)
+        in_pDevice, in_srvBaseCPU, nullptr, false)
 {
     D3D12_RASTERIZER_DESC rasterizerDesc = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     D3D12_DEPTH_STENCIL_DESC depthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -525,9 +551,7 @@ SceneObjects::Terrain::Terrain(const std::wstring& in_filename,
 //-------------------------------------------------------------------------
 ID3D12Device* SceneObjects::BaseObject::GetDevice()
 {
-    ComPtr<ID3D12Device> device;
-    m_pStreamingResource->GetTiledResource()->GetDevice(IID_PPV_ARGS(&device));
-    return device.Get();
+    return m_device.Get();
 }
 
 //-------------------------------------------------------------------------
@@ -550,7 +574,7 @@ SceneObjects::Planet::Planet(const std::wstring& in_filename,
     D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU,
     const SphereGen::Properties& in_sphereProperties) :
     BaseObject(in_filename, in_pTileUpdateManager, in_pStreamingHeap,
-        in_pDevice, in_srvBaseCPU, nullptr)
+        in_pDevice, in_srvBaseCPU, nullptr, false)
 {
     D3D12_RASTERIZER_DESC rasterizerDesc = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     D3D12_DEPTH_STENCIL_DESC depthStencilDesc = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -565,9 +589,10 @@ SceneObjects::Planet::Planet(const std::wstring& in_filename,
 SceneObjects::Planet::Planet(const std::wstring& in_filename,
     StreamingHeap* in_pStreamingHeap,
     D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU,
-    Planet* in_pSharedObject) :
+    Planet* in_pSharedObject,
+    bool in_asyncCreate) :
     BaseObject(in_filename, in_pSharedObject->m_pTileUpdateManager, in_pStreamingHeap,
-        in_pSharedObject->GetDevice(), in_srvBaseCPU, in_pSharedObject)
+        in_pSharedObject->GetDevice(), in_srvBaseCPU, in_pSharedObject, in_asyncCreate)
 {
     CopyGeometry(in_pSharedObject);
 }
@@ -585,7 +610,7 @@ SceneObjects::Sky::Sky(const std::wstring& in_filename,
     UINT in_sampleCount,
     D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU) :
     BaseObject(in_filename, in_pTileUpdateManager, in_pStreamingHeap,
-        in_pDevice, in_srvBaseCPU, nullptr)
+        in_pDevice, in_srvBaseCPU, nullptr, false)
 {
     D3D12_RASTERIZER_DESC rasterizerDesc = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     rasterizerDesc.CullMode = D3D12_CULL_MODE_FRONT;
@@ -109,7 +109,8 @@ namespace SceneObjects
             StreamingHeap* in_pStreamingHeap,
             ID3D12Device* in_pDevice,
             D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU,
-            BaseObject* in_pSharedObject);  // to share root sig, etc.
+            BaseObject* in_pSharedObject,   // to share root sig, etc.
+            bool in_asyncCreate);           // StreamingResource loads in the background. views are created when it is ready
 
         template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
 
@@ -183,6 +184,11 @@ namespace SceneObjects
         std::wstring GetAssetFullPath(const std::wstring& in_filename);
 
         UINT m_srvUavCbvDescriptorSize{ 0 };
+
+        ComPtr<ID3D12Device> m_device;
+        D3D12_CPU_DESCRIPTOR_HANDLE m_srvBaseCPU{};
+        bool m_viewsCreated{ false };
+        void CreateViews();
     };
 
     void CreateSphere(SceneObjects::BaseObject* out_pObject,
@@ -220,7 +226,8 @@ namespace SceneObjects
         Planet(const std::wstring& in_filename,
             StreamingHeap* in_pStreamingHeap,
             D3D12_CPU_DESCRIPTOR_HANDLE in_srvBaseCPU,
-            Planet* in_pSharedObject);
+            Planet* in_pSharedObject,
+            bool in_asyncCreate);
     };
 
     // special render state (front face cull)
@@ -203,6 +203,8 @@ void ParseCommandLine(CommandLineArgs& out_args)
     argParser.AddArg(L"-cameraRate", out_args.m_cameraAnimationRate);
     argParser.AddArg(L"-rollerCoaster", out_args.m_cameraRollerCoaster);
     argParser.AddArg(L"-paintMixer", out_args.m_cameraPaintMixer);
+    argParser.AddArg(L"-cameraSwapFrames", out_args.m_cameraSwapFrames, L"turn the camera around every n frames (0 disables)");
+    argParser.AddArg(L"-churnFrames", out_args.m_churnFrames, L"destroy and re-create an object every n frames (0 disables)");
 
     argParser.AddArg(L"-visualizeMinMip", [&]() { out_args.m_visualizeMinMip = true; }, out_args.m_visualizeMinMip);
     argParser.AddArg(L"-hideFeedback", [&]() { out_args.m_showFeedbackMaps = false; }, false, L"start with no feedback viewer");
@@ -226,6 +228,28 @@ void ParseCommandLine(CommandLineArgs& out_args)
     argParser.AddArg(L"-stagingSizeMB", out_args.m_stagingSizeMB, L"DirectStorage staging buffer size");
 
     argParser.AddArg(L"-captureTrace", [&]() { out_args.m_captureTrace = true; }, false, L"capture a trace of tile requests and submits (DS only)");
+    argParser.AddArg(L"-captureFeedback", [&]() { out_args.m_captureFeedback = true; }, false, L"capture the feedback consumed by each resource, for feedbackReplay");
+    argParser.AddArg(L"-prefetch", out_args.m_enablePrefetch, L"prefetch tiles in the direction of feedback motion");
+    argParser.AddArg(L"-dilationRadius", out_args.m_feedbackDilationRadius, L"dilate feedback to neighboring regions (0 disables)");
+    argParser.AddArg(L"-dilationMipBias", out_args.m_feedbackDilationMipBias, L"dilated neighbors request this many mips coarser");
+    argParser.AddArg(L"-dilationMipBiasPerMip", [&]()
+        {
+            // comma-separated, e.g. 2,1,0
+            out_args.m_feedbackDilationMipBiasPerMip.clear();
+            std::wstringstream s(ArgParser::GetNextArg());
+            std::wstring b;
+            while (std::getline(s, b, L','))
+            {
+                out_args.m_feedbackDilationMipBiasPerMip.push_back(std::stoul(b));
+            }
+        }, L"dilation mip bias per dilated mip, e.g. 2,1,0 (255 disables dilation from that mip)");
+    argParser.AddArg(L"-targetHeapOccupancy", out_args.m_targetHeapOccupancy, L"bias feedback to hold heap occupancy at this fraction (0 disables)");
+    argParser.AddArg(L"-reclaim", out_args.m_enableReclaim, L"when a heap is full, release fine tiles of less important objects");
+    argParser.AddArg(L"-asyncCreate", out_args.m_asyncCreate, L"load sphere textures on background threads");
+    argParser.AddArg(L"-loaderThreads", out_args.m_numLoaderThreads, L"number of threads for -asyncCreate");
+    argParser.AddArg(L"-shareTiles", out_args.m_shareTiles, L"objects using the same texture file share tiles in the heap");
+    argParser.AddArg(L"-workerThreads", out_args.m_numWorkerThreads, L"run streaming work on a job system with this many threads (0: dedicated threads)");
+    argParser.AddArg(L"-workerAffinity", out_args.m_workerAffinityMask, L"processor mask for job system threads (0: any)");
 
     argParser.Parse();
 }
@@ -525,6 +549,25 @@ void LoadConfigFile(std::wstring& in_configFileName, CommandLineArgs& out_args)
             if (root.isMember("mountainSize")) out_args.m_terrainParams.m_mountainSize = root["mountainSize"].asFloat();
 
             if (root.isMember("threadPriority")) out_args.m_threadPriority = root["threadPriority"].asInt();
+            if (root.isMember("prefetch")) out_args.m_enablePrefetch = root["prefetch"].asBool();
+            if (root.isMember("dilationRadius")) out_args.m_feedbackDilationRadius = root["dilationRadius"].asUInt();
+            if (root.isMember("dilationMipBias")) out_args.m_feedbackDilationMipBias = root["dilationMipBias"].asUInt();
+            if (root.isMember("dilationMipBiasPerMip"))
+            {
+                const auto& biases = root["dilationMipBiasPerMip"];
+                out_args.m_feedbackDilationMipBiasPerMip.resize(biases.size());
+                for (UINT i = 0; i < biases.size(); i++)
+                {
+                    out_args.m_feedbackDilationMipBiasPerMip[i] = biases[i].asUInt();
+                }
+            }
+            if (root.isMember("targetHeapOccupancy")) out_args.m_targetHeapOccupancy = root["targetHeapOccupancy"].asFloat();
+            if (root.isMember("reclaim")) out_args.m_enableReclaim = root["reclaim"].asBool();
+            if (root.isMember("asyncCreate")) out_args.m_asyncCreate = root["asyncCreate"].asBool();
+            if (root.isMember("loaderThreads")) out_args.m_numLoaderThreads = root["loaderThreads"].asUInt();
+            if (root.isMember("shareTiles")) out_args.m_shareTiles = root["shareTiles"].asBool();
+            if (root.isMember("workerThreads")) out_args.m_numWorkerThreads = root["workerThreads"].asUInt();
+            if (root.isMember("workerAffinity")) out_args.m_workerAffinityMask = root["workerAffinity"].asUInt64();
         } // end if successful load
     } // end if file exists
 
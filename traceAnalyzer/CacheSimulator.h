@@ -0,0 +1,255 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+#pragma once
+
+#include <vector>
+#include <list>
+#include <string>
+#include <algorithm>
+
+//=============================================================================
+// models a streaming heap of a fixed number of tiles
+// tiles are identified by dense indices [0, numTiles) so state can be kept in arrays
+//=============================================================================
+class CacheSimulator
+{
+public:
+    CacheSimulator(UINT in_capacity) : m_capacity(in_capacity) {}
+    virtual ~CacheSimulator() {}
+
+    // returns true if the tile was resident. otherwise it is loaded, evicting a tile if full
+    virtual bool Access(UINT in_tile) = 0;
+
+    virtual const char* GetName() const = 0;
+protected:
+    const UINT m_capacity;
+};
+
+//=============================================================================
+// evicts the least recently used tile
+//=============================================================================
+class CacheLRU : public CacheSimulator
+{
+public:
+    CacheLRU(UINT in_capacity, UINT in_numTiles) : CacheSimulator(in_capacity),
+        m_resident(in_numTiles, false), m_position(in_numTiles) {}
+
+    virtual bool Access(UINT in_tile) override
+    {
+        if (m_resident[in_tile])
+        {
+            m_list.splice(m_list.begin(), m_list, m_position[in_tile]);
+            return true;
+        }
+        if (m_list.size() == m_capacity)
+        {
+            m_resident[m_list.back()] = false;
+            m_list.pop_back();
+        }
+        m_list.push_front(in_tile);
+        m_position[in_tile] = m_list.begin();
+        m_resident[in_tile] = true;
+        return false;
+    }
+
+    virtual const char* GetName() const override { return "LRU"; }
+private:
+    std::list<UINT> m_list; // most recent first
+    std::vector<bool> m_resident;
+    std::vector<std::list<UINT>::iterator> m_position;
+};
+
+//=============================================================================
+// second chance: a hand sweeps the slots, clearing reference bits, and evicts the first unreferenced tile
+//=============================================================================
+class CacheCLOCK : public CacheSimulator
+{
+public:
+    CacheCLOCK(UINT in_capacity, UINT in_numTiles) : CacheSimulator(in_capacity),
+        m_slotOfTile(in_numTiles, EMPTY) {}
+
+    virtual bool Access(UINT in_tile) override
+    {
+        UINT slot = m_slotOfTile[in_tile];
+        if (EMPTY != slot)
+        {
+            m_referenced[slot] = true;
+            return true;
+        }
+
+        if (m_tiles.size() < m_capacity)
+        {
+            slot = (UINT)m_tiles.size();
+            m_tiles.push_back(in_tile);
+            m_referenced.push_back(true);
+        }
+        else
+        {
+            while (m_referenced[m_hand])
+            {
+                m_referenced[m_hand] = false;
+                m_hand = (m_hand + 1) % m_capacity;
+            }
+            slot = m_hand;
+            m_hand = (m_hand + 1) % m_capacity;
+
+            m_slotOfTile[m_tiles[slot]] = EMPTY;
+            m_tiles[slot] = in_tile;
+            m_referenced[slot] = true;
+        }
+        m_slotOfTile[in_tile] = slot;
+        return false;
+    }
+
+    virtual const char* GetName() const override { return "CLOCK"; }
+private:
+    static constexpr UINT EMPTY = UINT(-1);
+    std::vector<UINT> m_slotOfTile;
+    std::vector<UINT> m_tiles; // per slot
+    std::vector<bool> m_referenced;
+    UINT m_hand{ 0 };
+};
+
+//=============================================================================
+// Adaptive Replacement Cache (Megiddo and Modha, FAST 2003)
+// T1 holds tiles seen once recently, T2 tiles seen at least twice. B1 and B2 remember tiles evicted from each
+// a request that hits B1 grows the target size of T1, a hit in B2 shrinks it
+// so a scan of tiles that are never requested again doesn't flush tiles that are
+//=============================================================================
+class CacheARC : public CacheSimulator
+{
+public:
+    CacheARC(UINT in_capacity, UINT in_numTiles) : CacheSimulator(in_capacity),
+        m_list(in_numTiles, NONE), m_position(in_numTiles) {}
+
+    virtual bool Access(UINT in_tile) override
+    {
+        const UINT c = m_capacity;
+        switch (m_list[in_tile])
+        {
+        case T1:
+        case T2:
+            MoveToFront(in_tile, T2);
+            return true;
+
+        case B1:
+            m_target = std::min(c, m_target + std::max(UINT(1), UINT(m_lists[B2].size() / m_lists[B1].size())));
+            Replace(false);
+            MoveToFront(in_tile, T2);
+            return false;
+
+        case B2:
+            m_target -= std::min(m_target, std::max(UINT(1), UINT(m_lists[B1].size() / m_lists[B2].size())));
+            Replace(true);
+            MoveToFront(in_tile, T2);
+            return false;
+
+        default:
+            break;
+        }
+
+        // not in any list
+        size_t l1 = m_lists[T1].size() + m_lists[B1].size();
+        size_t total = l1 + m_lists[T2].size() + m_lists[B2].size();
+        if (l1 == c)
+        {
+            if (m_lists[T1].size() < c)
+            {
+                RemoveLRU(B1);
+                Replace(false);
+            }
+            else
+            {
+                RemoveLRU(T1);
+            }
+        }
+        else if (total >= c)
+        {
+            if (total == 2 * size_t(c))
+            {
+                RemoveLRU(B2);
+            }
+            Replace(false);
+        }
+        MoveToFront(in_tile, T1);
+        return false;
+    }
+
+    virtual const char* GetName() const override { return "ARC"; }
+private:
+    enum List : BYTE { T1 = 0, T2, B1, B2, NONE };
+    std::list<UINT> m_lists[4]; // most recent first
+    std::vector<List> m_list;   // per tile
+    std::vector<std::list<UINT>::iterator> m_position;
+    UINT m_target{ 0 };         // target size of T1
+
+    void MoveToFront(UINT in_tile, List in_list)
+    {
+        List from = m_list[in_tile];
+        if (NONE == from)
+        {
+            m_lists[in_list].push_front(in_tile);
+            m_position[in_tile] = m_lists[in_list].begin();
+        }
+        else
+        {
+            m_lists[in_list].splice(m_lists[in_list].begin(), m_lists[from], m_position[in_tile]);
+        }
+        m_list[in_tile] = in_list;
+    }
+
+    void RemoveLRU(List in_list)
+    {
+        UINT tile = m_lists[in_list].back();
+        m_lists[in_list].pop_back();
+        m_list[tile] = NONE;
+    }
+
+    // evict the LRU tile of T1 or T2 into the corresponding ghost list
+    // does nothing if T1 and T2 are both empty, rather than reading back() of an empty list
+    void Replace(bool in_hitB2)
+    {
+        size_t t1 = m_lists[T1].size();
+        if ((0 == t1) && m_lists[T2].empty())
+        {
+            return;
+        }
+
+        if (t1 && ((t1 > m_target) || (in_hitB2 && (t1 == m_target))))
+        {
+            MoveToFront(m_lists[T1].back(), B1);
+        }
+        else if (m_lists[T2].size())
+        {
+            MoveToFront(m_lists[T2].back(), B2);
+        }
+        else
+        {
+            MoveToFront(m_lists[T1].back(), B1);
+        }
+    }
+};
@@ -0,0 +1,364 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// analyzes the tile requests of a trace file (see tracePlayer) to help choose a heap size
+// e.g. "traceAnalyzer.exe -file uploadTraceFile_1.bin"
+//
+// a tile is identified by its source file and offset, so the same tile loaded into different heap locations is one tile
+// traces hold the tiles that were loaded, not every tile the scene sampled: a tile requested again had been evicted.
+// so the simulations answer "how many of these loads would a heap of this size and policy have avoided?"
+//
+// - working set: distinct tiles requested in each time window (or window of submits, if the trace has no times)
+// - reuse distance: the number of distinct tiles requested between two requests for the same tile
+//   an LRU heap larger than the reuse distance would have kept the tile resident
+// - heap size sweep: hit rate and bytes read from disk of LRU, CLOCK, and ARC heaps, and the knee of each curve
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "TraceData.h"
+#include "CacheSimulator.h"
+
+#define ErrorMessage(...) { std::wcout << AutoString::Concat(__VA_ARGS__); exit(-1); }
+
+struct Params
+{
+    std::wstring m_filename;
+    float m_windowMs{ 1000.0f };
+    UINT m_windowSubmits{ 60 };  // if the trace has no submit times
+    UINT m_minHeapSizeTiles{ 256 };
+    UINT m_maxHeapSizeTiles{ 0 }; // 0: enough for every distinct tile
+    float m_kneeThreshold{ 1.0f }; // percentage points of hit rate
+    bool m_printWindows{ false };
+};
+
+//=============================================================================
+// the trace as a sequence of dense tile indices
+//=============================================================================
+struct Accesses
+{
+    std::vector<UINT> m_tiles;     // per request
+    std::vector<UINT32> m_numBytes; // per distinct tile
+    std::vector<UINT> m_submitEnd; // per submit, index of the first request of the next submit
+
+    void Build(const TraceData& in_traceData)
+    {
+        std::unordered_map<UINT64, UINT> tileIndices;
+        for (const auto& s : in_traceData.m_submits)
+        {
+            for (const auto& r : s.m_requests)
+            {
+                // XeT tile offsets are 32 bits
+                UINT64 key = (UINT64(r.m_fileIndex) << 40) | r.m_offset;
+                auto i = tileIndices.try_emplace(key, (UINT)m_numBytes.size());
+                if (i.second)
+                {
+                    m_numBytes.push_back(r.m_numBytes);
+                }
+                m_tiles.push_back(i.first->second);
+            }
+            m_submitEnd.push_back((UINT)m_tiles.size());
+        }
+    }
+
+    UINT GetNumTiles() const { return (UINT)m_numBytes.size(); }
+};
+
+//-----------------------------------------------------------------------------
+// distinct tiles per window. windows are contiguous ranges of submits
+//-----------------------------------------------------------------------------
+void WorkingSet(const Params& in_params, const TraceData& in_traceData, const Accesses& in_accesses)
+{
+    const bool haveTimes = (0 != in_traceData.m_ticksPerSecond);
+    const UINT64 windowTicks = haveTimes ? std::max(UINT64(1), UINT64(in_params.m_windowMs * in_traceData.m_ticksPerSecond / 1000.0)) : 0;
+
+    // the window a tile was last counted in, so each tile counts once per window
+    std::vector<UINT> lastWindow(in_accesses.GetNumTiles(), UINT(-1));
+    std::vector<UINT> workingSet; // per window
+
+    UINT firstRequest = 0;
+    for (UINT s = 0; s < (UINT)in_traceData.m_submits.size(); s++)
+    {
+        UINT window = haveTimes ? UINT(in_traceData.m_submits[s].m_time / windowTicks) : (s / in_params.m_windowSubmits);
+        if (window >= workingSet.size())
+        {
+            workingSet.resize(window + 1, 0);
+        }
+        for (UINT i = firstRequest; i < in_accesses.m_submitEnd[s]; i++)
+        {
+            UINT tile = in_accesses.m_tiles[i];
+            if (window != lastWindow[tile])
+            {
+                lastWindow[tile] = window;
+                workingSet[window]++;
+            }
+        }
+        firstRequest = in_accesses.m_submitEnd[s];
+    }
+    if (workingSet.empty()) { return; }
+
+    if (haveTimes)
+    {
+        std::cout << "\nworking set, " << in_params.m_windowMs << "ms windows:\n";
+    }
+    else
+    {
+        std::cout << "\nworking set, windows of " << in_params.m_windowSubmits << " submits (trace has no submit times):\n";
+    }
+
+    if (in_params.m_printWindows)
+    {
+        std::cout << "window, tiles, MB\n";
+        for (UINT i = 0; i < (UINT)workingSet.size(); i++)
+        {
+            std::cout << i << ", " << workingSet[i] << ", " << workingSet[i] / 16 << "\n";
+        }
+    }
+
+    std::vector<UINT> sorted = workingSet;
+    std::sort(sorted.begin(), sorted.end());
+    UINT64 sum = 0;
+    for (auto w : sorted) { sum += w; }
+    auto percentile = [&](float p) { return sorted[std::min(size_t(p * sorted.size()), sorted.size() - 1)]; };
+    std::cout << "# windows: " << sorted.size() << "\n";
+    std::cout << "tiles per window (average, p50, p90, max): "
+        << sum / sorted.size() << ", " << percentile(0.5f) << ", " << percentile(0.9f) << ", " << sorted.back() << "\n";
+    std::cout << "distinct tiles in trace: " << in_accesses.GetNumTiles() << " (" << in_accesses.GetNumTiles() / 16 << "MB of heap)\n";
+}
+
+//-----------------------------------------------------------------------------
+// LRU stack distance (Mattson et al. 1970) in O(n log n):
+// a binary indexed tree marks the most recent request of each tile,
+// the distance is the number of marks between the previous and current request of a tile
+//-----------------------------------------------------------------------------
+void ReuseDistance(const Accesses& in_accesses)
+{
+    const UINT numRequests = (UINT)in_accesses.m_tiles.size();
+    std::vector<UINT> tree(numRequests + 1, 0);
+    auto add = [&](UINT i, int v) { for (i++; i <= numRequests; i += i & (~i + 1)) { tree[i] += v; } };
+    auto sum = [&](UINT i) { UINT s = 0; for (; i > 0; i -= i & (~i + 1)) { s += tree[i]; } return s; }; // [0, i)
+
+    std::vector<UINT> lastRequest(in_accesses.GetNumTiles(), UINT(-1));
+
+    // bin 0 is distance 0, bin b > 0 is [2^(b-1), 2^b)
+    std::vector<UINT64> histogram;
+    UINT64 numFirstRequests = 0;
+
+    for (UINT i = 0; i < numRequests; i++)
+    {
+        UINT tile = in_accesses.m_tiles[i];
+        UINT previous = lastRequest[tile];
+        if (UINT(-1) == previous)
+        {
+            numFirstRequests++;
+        }
+        else
+        {
+            UINT distance = sum(i) - sum(previous + 1);
+            UINT bin = 0;
+            while (distance >> bin) { bin++; }
+            if (bin >= histogram.size()) { histogram.resize(bin + 1, 0); }
+            histogram[bin]++;
+            add(previous, -1);
+        }
+        add(i, 1);
+        lastRequest[tile] = i;
+    }
+
+    std::cout << "\nreuse distance (distinct tiles requested between requests for the same tile):\n";
+    std::cout << "first requests: " << numFirstRequests << " (" << (100.0 * numFirstRequests) / numRequests << "%)\n";
+    UINT64 numReused = numRequests - numFirstRequests;
+    if (0 == numReused) { return; }
+
+    std::cout << "distance, requests, %, cumulative %\n";
+    UINT64 cumulative = 0;
+    for (UINT b = 0; b < (UINT)histogram.size(); b++)
+    {
+        cumulative += histogram[b];
+        if (b < 2) { std::cout << b; }
+        else { std::cout << (1u << (b - 1)) << " - " << (1u << b) - 1; }
+        std::cout << ", " << histogram[b] << ", " << (100.0 * histogram[b]) / numReused
+            << ", " << (100.0 * cumulative) / numReused << "\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+// the knee of a hit-rate curve: the smallest heap size beyond which every doubling
+// improves the hit rate by less than the threshold (percentage points)
+// searching from the largest size handles plateaus, e.g. a scan that only hits once the heap holds all of it
+//-----------------------------------------------------------------------------
+UINT FindKnee(const std::vector<UINT>& in_heapSizes, const std::vector<double>& in_hitRates, float in_threshold)
+{
+    UINT knee = (UINT)in_heapSizes.size() - 1;
+    while (knee > 0)
+    {
+        // the last size may not be a doubling, scale the improvement to one
+        double doublings = std::log2(double(in_heapSizes[knee]) / double(in_heapSizes[knee - 1]));
+        if (((in_hitRates[knee] - in_hitRates[knee - 1]) / std::max(doublings, 1.0)) >= in_threshold)
+        {
+            break;
+        }
+        knee--;
+    }
+    return in_heapSizes[knee];
+}
+
+//-----------------------------------------------------------------------------
+// simulate each policy for each heap size
+// heap sizes double from the minimum, the last is the max (or the number of distinct tiles: only first requests miss)
+//-----------------------------------------------------------------------------
+void HeapSizeSweep(const Params& in_params, const TraceData& in_traceData, const Accesses& in_accesses)
+{
+    const UINT numTiles = in_accesses.GetNumTiles();
+    const UINT numRequests = (UINT)in_accesses.m_tiles.size();
+
+    UINT maxHeapSize = in_params.m_maxHeapSizeTiles ? in_params.m_maxHeapSizeTiles : numTiles;
+    std::vector<UINT> heapSizes;
+    for (UINT h = std::max(UINT(1), in_params.m_minHeapSizeTiles); h < maxHeapSize; h *= 2)
+    {
+        heapSizes.push_back(h);
+    }
+    heapSizes.push_back(maxHeapSize);
+
+    // bandwidth if the trace played back at the captured pace
+    double seconds = 0;
+    if (in_traceData.m_ticksPerSecond && (in_traceData.m_submits.size() > 1))
+    {
+        seconds = double(in_traceData.m_submits.back().m_time - in_traceData.m_submits.front().m_time) / in_traceData.m_ticksPerSecond;
+    }
+    const char* bandwidthUnits = (seconds > 0) ? "MB/s" : "MB";
+    const double bandwidthScale = 1.0 / (1024.0 * 1024.0 * ((seconds > 0) ? seconds : 1.0));
+
+    const char* policies[] = { "LRU", "CLOCK", "ARC" };
+    const UINT numPolicies = _countof(policies);
+    std::vector<double> hitRates[numPolicies];
+
+    std::cout << "\nheap size sweep: " << numRequests << " requests";
+    if (seconds > 0) { std::cout << " over " << seconds << "s"; }
+    std::cout << "\nheap tiles, heap MB";
+    for (auto p : policies) { std::cout << ", " << p << " hit %, " << p << " " << bandwidthUnits; }
+    std::cout << "\n";
+
+    for (UINT heapSize : heapSizes)
+    {
+        std::cout << heapSize << ", " << heapSize / 16.0;
+        for (UINT p = 0; p < numPolicies; p++)
+        {
+            std::unique_ptr<CacheSimulator> pCache;
+            switch (p)
+            {
+            case 0: pCache = std::make_unique<CacheLRU>(heapSize, numTiles); break;
+            case 1: pCache = std::make_unique<CacheCLOCK>(heapSize, numTiles); break;
+            default: pCache = std::make_unique<CacheARC>(heapSize, numTiles);
+            }
+
+            UINT64 numHits = 0;
+            UINT64 numBytesRead = 0;
+            for (UINT tile : in_accesses.m_tiles)
+            {
+                if (pCache->Access(tile)) { numHits++; }
+                else { numBytesRead += in_accesses.m_numBytes[tile]; }
+            }
+            double hitRate = (100.0 * numHits) / numRequests;
+            hitRates[p].push_back(hitRate);
+            std::cout << ", " << hitRate << ", " << numBytesRead * bandwidthScale;
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "knee (heap tiles beyond which doubling gains < " << in_params.m_kneeThreshold << "% hit rate):";
+    for (UINT p = 0; p < numPolicies; p++)
+    {
+        std::cout << " " << policies[p] << " " << FindKnee(heapSizes, hitRates[p], in_params.m_kneeThreshold);
+    }
+    std::cout << "\n";
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+
+    //---------------------------
+    // parse command line
+    //---------------------------
+    {
+        ArgParser argParser;
+        argParser.AddArg(L"-file", params.m_filename, L"<Required> trace file (json or binary)");
+        argParser.AddArg(L"-window", params.m_windowMs, L"working set window in ms");
+        argParser.AddArg(L"-windowSubmits", params.m_windowSubmits, L"working set window in submits, for traces without submit times");
+        argParser.AddArg(L"-printWindows", params.m_printWindows, L"print the working set of every window");
+        argParser.AddArg(L"-minHeap", params.m_minHeapSizeTiles, L"smallest heap size to simulate, in tiles. sizes double up to -maxHeap");
+        argParser.AddArg(L"-maxHeap", params.m_maxHeapSizeTiles, L"largest heap size to simulate, in tiles. 0: the number of distinct tiles");
+        argParser.AddArg(L"-knee", params.m_kneeThreshold, L"the knee is where doubling the heap gains less than this % hit rate");
+        argParser.Parse();
+
+        if (0 == params.m_filename.size())
+        {
+            ErrorMessage("trace file name not provided (-file filename.bin)");
+        }
+        if ((0 == params.m_windowMs) || (0 == params.m_windowSubmits))
+        {
+            ErrorMessage("-window and -windowSubmits must be non-zero");
+        }
+    }
+
+    TraceData traceData;
+    if (!traceData.Read(params.m_filename))
+    {
+        ErrorMessage("failed to read trace file: ", params.m_filename);
+    }
+
+    Accesses accesses;
+    accesses.Build(traceData);
+    std::cout << "# submits: " << traceData.m_submits.size() << ", # requests: " << accesses.m_tiles.size() << "\n";
+    if (accesses.m_tiles.empty())
+    {
+        return 0;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    WorkingSet(params, traceData, accesses);
+    ReuseDistance(accesses);
+    HeapSizeSweep(params, traceData, accesses);
+
+    return 0;
+}
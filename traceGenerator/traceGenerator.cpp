@@ -0,0 +1,534 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+// writes tracePlayer-compatible traces from parameters instead of capturing them from expanse
+// source tiles come from the XeT files in -mediaDir, so file offsets, sizes, and compression are real
+// e.g. generate media with "synthetic.bat media 20 -entropy 0.5"
+// then "traceGenerator.exe -mediaDir media -pattern 1 -zipf 1.2 -out zipf.bin"
+// and "tracePlayer.exe -mediaDir media -file zipf.bin"
+//
+// patterns:
+//   uniform: every eligible tile is equally likely
+//   zipf: a few tiles are requested very often, most rarely. ranks are a random permutation of the tiles
+//   sequential: eligible tiles in file order, wrapping around
+//   mip chain: bursts like StreamingResource::SetMinMip: a random position, from the coarsest standard mip down to a random mip
+//
+// -minBytes/-maxBytes limit requests to tiles whose compressed size is in range,
+// shaping the size distribution of the requests within what the media provides
+// submits follow the TileUpdateManager heuristic: submit once more than -minNumUploadRequests are pending, and at the end of each frame
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <deque>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "DebugHelper.h"
+#include "ArgParser.h"
+#include "XetFileHeader.h"
+#include "TraceData.h"
+
+#define ErrorMessage(...) { std::wcout << AutoString::Concat(__VA_ARGS__); exit(-1); }
+
+struct Params
+{
+    enum class Pattern : UINT
+    {
+        UNIFORM = 0,
+        ZIPF,
+        SEQUENTIAL,
+        MIPCHAIN
+    };
+
+    std::wstring m_mediaDir;
+    std::wstring m_outFilename{ L"syntheticTrace.bin" };
+    Pattern m_pattern{ Pattern::UNIFORM };
+    float m_zipfExponent{ 1.0f };
+    UINT m_numFrames{ 600 };
+    UINT m_tilesPerFrame{ 256 };
+    UINT m_minNumUploadRequests{ 2000 }; // TileUpdateManager default
+    float m_frameTimeMs{ 16.667f };
+    UINT m_heapSizeTiles{ 16384 };       // 64KB per tile * 16384 tiles -> 1GB heap
+    UINT m_minBytes{ 0 };
+    UINT m_maxBytes{ XetFileHeader::GetTileSize() };
+    UINT64 m_seed{ 1 };
+};
+
+//=============================================================================
+// the standard mip tiles of every XeT file in a directory
+//=============================================================================
+class Media
+{
+public:
+    struct File
+    {
+        std::string m_name; // UTF-8, relative to the media directory
+        UINT32 m_format;
+        UINT32 m_compressionFormat;
+        std::vector<XetFileHeader::StandardMipInfo> m_mips;
+        UINT32 m_firstTile; // index of this file's first tile in m_tiles
+    };
+
+    struct Tile
+    {
+        UINT32 m_fileIndex;
+        UINT32 m_subresource;
+        UINT32 m_x;
+        UINT32 m_y;
+        UINT32 m_offset;
+        UINT32 m_numBytes;
+    };
+
+    std::vector<File> m_files;
+    std::vector<Tile> m_tiles;
+
+    void Load(const std::wstring& in_mediaDir);
+private:
+    void LoadFile(const std::filesystem::path& in_path);
+};
+
+//-----------------------------------------------------------------------------
+// files are sorted by name so the same directory always produces the same trace
+//-----------------------------------------------------------------------------
+void Media::Load(const std::wstring& in_mediaDir)
+{
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(in_mediaDir))
+    {
+        if (0 == _wcsicmp(L".xet", entry.path().extension().c_str()))
+        {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto& p : paths)
+    {
+        LoadFile(p);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Media::LoadFile(const std::filesystem::path& in_path)
+{
+    std::ifstream inFile(in_path, std::ios::in | std::ios::binary);
+    if (!inFile.is_open()) { ErrorMessage("failed to open ", in_path); }
+
+    XetFileHeader header;
+    inFile.read((char*)&header, sizeof(header));
+    if (!inFile.good() || (XetFileHeader::GetMagic() != header.m_magic)) { ErrorMessage(in_path, " Not a valid XET file"); }
+    if (XetFileHeader::GetVersion() != header.m_version) { ErrorMessage(in_path, " Incorrect XET version"); }
+
+    std::vector<XetFileHeader::SubresourceInfo> subresourceInfo(header.m_ddsHeader.mipMapCount);
+    inFile.read((char*)subresourceInfo.data(), subresourceInfo.size() * sizeof(XetFileHeader::SubresourceInfo));
+
+    // the final entry is the packed mips, which are never requested as tiles
+    std::vector<XetFileHeader::TileData> tileData(header.m_mipInfo.m_numTilesForStandardMips + 1);
+    inFile.read((char*)tileData.data(), tileData.size() * sizeof(XetFileHeader::TileData));
+    if (!inFile.good()) { ErrorMessage(in_path, " is truncated"); }
+
+    File file;
+    std::wstring wideName = in_path.filename().wstring();
+    int bufLen = ::WideCharToMultiByte(CP_UTF8, 0, wideName.c_str(), (int)wideName.size(), NULL, 0, NULL, NULL);
+    file.m_name.resize(bufLen);
+    ::WideCharToMultiByte(CP_UTF8, 0, wideName.c_str(), (int)wideName.size(), file.m_name.data(), bufLen, NULL, NULL);
+    file.m_format = header.m_extensionHeader.dxgiFormat;
+    file.m_compressionFormat = header.m_compressionFormat;
+    file.m_firstTile = (UINT32)m_tiles.size();
+
+    UINT32 fileIndex = (UINT32)m_files.size();
+    for (UINT32 s = 0; s < header.m_mipInfo.m_numStandardMips; s++)
+    {
+        const auto& mip = subresourceInfo[s].m_standardMipInfo;
+        file.m_mips.push_back(mip);
+        for (UINT32 y = 0; y < mip.m_heightTiles; y++)
+        {
+            for (UINT32 x = 0; x < mip.m_widthTiles; x++)
+            {
+                const auto& t = tileData[mip.m_subresourceTileIndex + (y * mip.m_widthTiles) + x];
+                m_tiles.push_back(Tile{ fileIndex, s, x, y, t.m_offset, t.m_numBytes });
+            }
+        }
+    }
+    m_files.push_back(file);
+}
+
+//=============================================================================
+// fills a TraceData with requests and submits
+//=============================================================================
+class Generator
+{
+public:
+    Generator(const Params& in_params, const Media& in_media);
+
+    // returns the number of tiles that satisfy -minBytes and -maxBytes
+    UINT GetNumEligibleTiles() const { return (UINT)m_eligibleTiles.size(); }
+
+    void Generate(TraceData& out_traceData);
+private:
+    const Params& m_params;
+    const Media& m_media;
+
+    std::mt19937_64 m_rng;
+    // std distributions differ between standard library implementations. these don't.
+    UINT Uniform(UINT in_n) { return UINT(m_rng() % in_n); }
+    double UniformReal() { return double(m_rng() >> 11) * (1.0 / double(1ull << 53)); }
+
+    std::vector<bool> m_eligible;      // per tile in the media, within the requested size range
+    std::vector<UINT> m_eligibleTiles; // indices into the media tiles
+
+    std::vector<double> m_zipfCdf;     // cumulative probability of each rank
+    std::vector<UINT> m_zipfTiles;     // tile for each rank
+    UINT m_sequentialIndex{ 0 };
+    std::deque<UINT> m_mipChain;       // remaining tiles of the current burst
+
+    // destinations mirror the StreamingHeap atlases: maximum-size textures, one set per format
+    struct Destination
+    {
+        UINT32 m_format;
+        UINT32 m_firstResource;  // index into TraceData::m_resources
+        UINT32 m_widthTiles;
+        UINT32 m_tilesPerResource;
+        UINT32 m_nextTile{ 0 };  // heap tiles are re-used round-robin
+    };
+    std::vector<Destination> m_destinations;
+    std::vector<UINT> m_fileDestination; // per file, index into m_destinations
+
+    void CreateDestinations(TraceData& out_traceData);
+    UINT NextTile();
+    void AddRequest(std::vector<TraceData::Request>& out_requests, UINT in_tileIndex);
+};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+Generator::Generator(const Params& in_params, const Media& in_media) :
+    m_params(in_params), m_media(in_media), m_rng(in_params.m_seed)
+{
+    m_eligible.resize(m_media.m_tiles.size(), false);
+    for (UINT i = 0; i < (UINT)m_media.m_tiles.size(); i++)
+    {
+        UINT numBytes = m_media.m_tiles[i].m_numBytes;
+        if ((numBytes >= m_params.m_minBytes) && (numBytes <= m_params.m_maxBytes))
+        {
+            m_eligible[i] = true;
+            m_eligibleTiles.push_back(i);
+        }
+    }
+
+    if ((Params::Pattern::ZIPF == m_params.m_pattern) && m_eligibleTiles.size())
+    {
+        // Fisher-Yates, for the same reason as Uniform()
+        m_zipfTiles = m_eligibleTiles;
+        for (UINT i = (UINT)m_zipfTiles.size() - 1; i > 0; i--)
+        {
+            std::swap(m_zipfTiles[i], m_zipfTiles[Uniform(i + 1)]);
+        }
+
+        m_zipfCdf.resize(m_zipfTiles.size());
+        double sum = 0;
+        for (UINT i = 0; i < (UINT)m_zipfCdf.size(); i++)
+        {
+            sum += 1.0 / std::pow(double(i + 1), (double)m_params.m_zipfExponent);
+            m_zipfCdf[i] = sum;
+        }
+        for (auto& c : m_zipfCdf) { c /= sum; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// BC1 and BC4 have 8-byte blocks: a 64KB tile is 512x256 texels. other BC formats are 256x256
+//-----------------------------------------------------------------------------
+static void GetTileShape(UINT32 in_format, UINT& out_width, UINT& out_height)
+{
+    switch (in_format)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        out_width = 512;
+        out_height = 256;
+        break;
+    default:
+        out_width = 256;
+        out_height = 256;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Generator::CreateDestinations(TraceData& out_traceData)
+{
+    for (const auto& file : m_media.m_files)
+    {
+        UINT index = 0;
+        while ((index < m_destinations.size()) && (m_destinations[index].m_format != file.m_format)) { index++; }
+
+        if (index == m_destinations.size())
+        {
+            UINT tileWidth = 0, tileHeight = 0;
+            GetTileShape(file.m_format, tileWidth, tileHeight);
+
+            Destination d;
+            d.m_format = file.m_format;
+            d.m_firstResource = (UINT32)out_traceData.m_resources.size();
+            d.m_widthTiles = D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION / tileWidth;
+            d.m_tilesPerResource = d.m_widthTiles * (D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION / tileHeight);
+            m_destinations.push_back(d);
+
+            // only as many rows as the heap needs, so tracePlayer doesn't allocate unused tiles
+            UINT numTiles = m_params.m_heapSizeTiles;
+            while (numTiles)
+            {
+                UINT n = std::min(numTiles, d.m_tilesPerResource);
+                UINT heightTiles = (n + d.m_widthTiles - 1) / d.m_widthTiles;
+                UINT64 resourceID = out_traceData.m_resources.size() + 1;
+                out_traceData.m_resources.push_back(TraceData::Resource{ resourceID, d.m_format,
+                    d.m_widthTiles * tileWidth, heightTiles * tileHeight, 1 });
+                numTiles -= n;
+            }
+        }
+        m_fileDestination.push_back(index);
+        out_traceData.m_files.push_back(file.m_name);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// returns the index of the next tile to request, or UINT_MAX if the pattern has none
+//-----------------------------------------------------------------------------
+UINT Generator::NextTile()
+{
+    switch (m_params.m_pattern)
+    {
+    case Params::Pattern::ZIPF:
+    {
+        auto i = std::upper_bound(m_zipfCdf.begin(), m_zipfCdf.end(), UniformReal()) - m_zipfCdf.begin();
+        return m_zipfTiles[std::min(size_t(i), m_zipfTiles.size() - 1)];
+    }
+
+    case Params::Pattern::SEQUENTIAL:
+    {
+        UINT tileIndex = m_eligibleTiles[m_sequentialIndex];
+        m_sequentialIndex = (m_sequentialIndex + 1) % (UINT)m_eligibleTiles.size();
+        return tileIndex;
+    }
+
+    case Params::Pattern::MIPCHAIN:
+    {
+        // like SetMinMip(), which adds tiles from the current min mip down to the desired mip
+        // each tile covers the same position as the next-finer tile
+        while (m_mipChain.empty())
+        {
+            const auto& file = m_media.m_files[Uniform((UINT)m_media.m_files.size())];
+            UINT numMips = (UINT)file.m_mips.size();
+            if (0 == numMips) { continue; }
+
+            UINT x0 = Uniform(file.m_mips[0].m_widthTiles);
+            UINT y0 = Uniform(file.m_mips[0].m_heightTiles);
+            UINT targetMip = Uniform(numMips);
+            for (UINT s = numMips; s > targetMip; s--)
+            {
+                const auto& mip = file.m_mips[s - 1];
+                UINT x = std::min(x0 >> (s - 1), mip.m_widthTiles - 1);
+                UINT y = std::min(y0 >> (s - 1), mip.m_heightTiles - 1);
+                UINT tileIndex = file.m_firstTile + mip.m_subresourceTileIndex + (y * mip.m_widthTiles) + x;
+                if (m_eligible[tileIndex])
+                {
+                    m_mipChain.push_back(tileIndex);
+                }
+            }
+        }
+        UINT tileIndex = m_mipChain.front();
+        m_mipChain.pop_front();
+        return tileIndex;
+    }
+
+    default:
+        return m_eligibleTiles[Uniform((UINT)m_eligibleTiles.size())];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void Generator::AddRequest(std::vector<TraceData::Request>& out_requests, UINT in_tileIndex)
+{
+    const auto& tile = m_media.m_tiles[in_tileIndex];
+    const auto& file = m_media.m_files[tile.m_fileIndex];
+    auto& dst = m_destinations[m_fileDestination[tile.m_fileIndex]];
+
+    UINT heapTile = dst.m_nextTile;
+    dst.m_nextTile = (dst.m_nextTile + 1) % m_params.m_heapSizeTiles;
+    UINT localTile = heapTile % dst.m_tilesPerResource;
+
+    TraceData::Request r{};
+    r.m_resourceIndex = dst.m_firstResource + (heapTile / dst.m_tilesPerResource);
+    r.m_coord = D3D12_TILED_RESOURCE_COORDINATE{ localTile % dst.m_widthTiles, localTile / dst.m_widthTiles, 0, 0 };
+    r.m_fileIndex = tile.m_fileIndex;
+    r.m_offset = tile.m_offset;
+    r.m_numBytes = tile.m_numBytes;
+    r.m_compressionFormat = file.m_compressionFormat;
+    out_requests.push_back(r);
+}
+
+//-----------------------------------------------------------------------------
+// submit times are in microseconds. a frame's submits are spread over the frame
+// in proportion to the number of requests made so far, so pacing replays the intended rate
+//-----------------------------------------------------------------------------
+void Generator::Generate(TraceData& out_traceData)
+{
+    CreateDestinations(out_traceData);
+    out_traceData.m_ticksPerSecond = 1000000;
+
+    const double frameTicks = double(m_params.m_frameTimeMs) * 1000.0;
+
+    TraceData::Submit pending;
+    for (UINT frame = 0; frame < m_params.m_numFrames; frame++)
+    {
+        double frameStart = frame * frameTicks;
+        for (UINT i = 0; i < m_params.m_tilesPerFrame; i++)
+        {
+            AddRequest(pending.m_requests, NextTile());
+
+            bool endOfFrame = ((i + 1) == m_params.m_tilesPerFrame);
+            if (endOfFrame || (pending.m_requests.size() > m_params.m_minNumUploadRequests))
+            {
+                pending.m_time = UINT64(frameStart + frameTicks * (i + 1) / (m_params.m_tilesPerFrame + 1));
+                out_traceData.m_submits.push_back(std::move(pending));
+                pending = TraceData::Submit();
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// size histogram in 8KB bins. uncompressed tiles are exactly 64KB and have their own bin
+//-----------------------------------------------------------------------------
+void PrintStatistics(const TraceData& in_traceData)
+{
+    const UINT numBins = 9;
+    const UINT binSize = XetFileHeader::GetTileSize() / (numBins - 1);
+    UINT64 histogram[numBins]{};
+    UINT64 numBytes = 0;
+
+    for (const auto& s : in_traceData.m_submits)
+    {
+        for (const auto& r : s.m_requests)
+        {
+            numBytes += r.m_numBytes;
+            histogram[std::min(r.m_numBytes / binSize, numBins - 1)]++;
+        }
+    }
+
+    UINT64 numRequests = in_traceData.GetNumRequests();
+    std::cout << "# submits: " << in_traceData.m_submits.size() << "\n";
+    std::cout << "# requests: " << numRequests << "\n";
+    if (0 == numRequests) { return; }
+
+    std::cout << "# bytes read: " << numBytes << " (average " << numBytes / numRequests << " bytes/request)\n";
+    std::cout << "request sizes:\n";
+    for (UINT i = 0; i < numBins; i++)
+    {
+        if (i < numBins - 1)
+        {
+            std::cout << "  " << (i * binSize) / 1024 << "KB - " << ((i + 1) * binSize) / 1024 << "KB: ";
+        }
+        else
+        {
+            std::cout << "  64KB: ";
+        }
+        std::cout << histogram[i] << " (" << (100.0 * histogram[i]) / numRequests << "%)\n";
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main()
+{
+    Params params;
+    params.m_mediaDir = std::filesystem::current_path();
+
+    //---------------------------
+    // parse command line
+    //---------------------------
+    {
+        ArgParser argParser;
+        argParser.AddArg(L"-mediaDir", params.m_mediaDir, L"directory containing XeT files. file names in the trace are relative to it");
+        argParser.AddArg(L"-out", params.m_outFilename, L"trace file to write. .json extension: json, otherwise binary");
+        argParser.AddArg(L"-pattern", (UINT&)params.m_pattern, L"uniform (0), zipf (1), sequential (2), mip chain bursts (3)");
+        argParser.AddArg(L"-zipf", params.m_zipfExponent, L"pattern 1: exponent. larger values concentrate requests on fewer tiles");
+        argParser.AddArg(L"-frames", params.m_numFrames, L"number of frames");
+        argParser.AddArg(L"-tilesPerFrame", params.m_tilesPerFrame, L"requests per frame");
+        argParser.AddArg(L"-frameTime", params.m_frameTimeMs, L"ms per frame, for submit times");
+        argParser.AddArg(L"-minNumUploadRequests", params.m_minNumUploadRequests, L"submit when more than this many requests are pending");
+        argParser.AddArg(L"-heapSizeTiles", params.m_heapSizeTiles, L"destination tiles per format, re-used round-robin");
+        argParser.AddArg(L"-minBytes", params.m_minBytes, L"only request tiles of at least this many bytes");
+        argParser.AddArg(L"-maxBytes", params.m_maxBytes, L"only request tiles of at most this many bytes");
+        argParser.AddArg(L"-seed", params.m_seed, L"random seed");
+        argParser.Parse();
+
+        if ((0 == params.m_tilesPerFrame) || (0 == params.m_heapSizeTiles))
+        {
+            ErrorMessage("-tilesPerFrame and -heapSizeTiles must be non-zero");
+        }
+    }
+
+    Media media;
+    media.Load(params.m_mediaDir);
+    if (0 == media.m_tiles.size())
+    {
+        ErrorMessage("no XeT files found in ", params.m_mediaDir);
+    }
+
+    Generator generator(params, media);
+    std::cout << "# files: " << media.m_files.size() << ", # tiles: " << media.m_tiles.size()
+        << ", # tiles in size range: " << generator.GetNumEligibleTiles() << "\n";
+    if (0 == generator.GetNumEligibleTiles())
+    {
+        ErrorMessage("no tiles between ", params.m_minBytes, " and ", params.m_maxBytes, " bytes");
+    }
+
+    TraceData traceData;
+    generator.Generate(traceData);
+    traceData.Write(params.m_outFilename);
+
+    std::wcout << "wrote " << params.m_outFilename << "\n";
+    PrintStatistics(traceData);
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <iostream>
+#include <algorithm>
+
+#include "DebugHelper.h"
+#include "CpuTracePlayer.h"
+
+//-----------------------------------------------------------------------------
+// open all the files in the trace and start the reading threads
+//-----------------------------------------------------------------------------
+CpuTracePlayer::CpuTracePlayer(const TraceData& in_traceData, const std::wstring& in_mediaDir, const Params& in_params) :
+    m_traceData(in_traceData), m_params(in_params)
+{
+    m_schedule = m_params.m_pacing.GetSchedule(m_traceData);
+
+    // overlapped, so reads from many threads on one handle proceed concurrently.
+    // synchronous i/o on a file object is serialized by the system
+    DWORD flags = FILE_ATTRIBUTE_READONLY | FILE_FLAG_OVERLAPPED | (m_params.m_unbuffered ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_RANDOM_ACCESS);
+
+    for (const auto& f : m_traceData.m_files)
+    {
+        std::wstring path = in_mediaDir + std::wstring(f.begin(), f.end());
+        HANDLE fileHandle = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (INVALID_HANDLE_VALUE == fileHandle)
+        {
+            std::wcout << "file not found: " << path << ". Did you set -mediadir?\n";
+            exit(-1);
+        }
+        m_fileHandles.push_back(fileHandle);
+    }
+
+    for (UINT i = 0; i < std::max(m_params.m_numThreads, 1u); i++)
+    {
+        m_threads.push_back(std::thread([&] { ReadThread(); }));
+    }
+}
+
+CpuTracePlayer::~CpuTracePlayer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto& t : m_threads)
+    {
+        t.join();
+    }
+
+    for (auto h : m_fileHandles)
+    {
+        ::CloseHandle(h);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// issue submits in order, each waiting for its scheduled time (if paced)
+// and until fewer than m_maxSubmitsInFlight are incomplete
+//-----------------------------------------------------------------------------
+void CpuTracePlayer::PlaybackTrace(PlaybackStatistics& out_statistics)
+{
+    const auto& submits = m_traceData.m_submits;
+    const UINT numSubmits = (UINT)submits.size();
+    const UINT maxSubmitsInFlight = std::max(m_params.m_maxSubmitsInFlight, 1u);
+
+    out_statistics = PlaybackStatistics{};
+    out_statistics.m_submitLatencies.resize(numSubmits, 0);
+    out_statistics.m_requestLatencies.resize(m_traceData.GetNumRequests(), 0);
+
+    m_pStatistics = &out_statistics;
+    m_submitTimes.assign(numSubmits, 0);
+    m_numRequestsRemaining.assign(numSubmits, 0);
+    m_numSubmitsCompleted = 0;
+    m_numBytesDecompressed = 0;
+
+    m_timer.Start();
+
+    UINT64 requestIndex = 0;
+    for (UINT s = 0; s < numSubmits; s++)
+    {
+        if (m_schedule.size())
+        {
+            Pacing::WaitUntil(m_timer, m_schedule[s]);
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_submitComplete.wait(lock, [&] { return (s - m_numSubmitsCompleted) < maxSubmitsInFlight; });
+
+        double issueTime = m_timer.GetTime();
+        m_submitTimes[s] = issueTime;
+        if (m_schedule.size())
+        {
+            m_submitTimes[s] = m_schedule[s];
+            out_statistics.m_maxIssueDelayMs = std::max(out_statistics.m_maxIssueDelayMs, float(1000. * (issueTime - m_schedule[s])));
+        }
+        const auto& requests = submits[s].m_requests;
+        if (0 == requests.size())
+        {
+            m_numSubmitsCompleted++;
+            continue;
+        }
+        m_numRequestsRemaining[s] = (UINT)requests.size();
+        for (const auto& r : requests)
+        {
+            m_queue.push_back(Work{ &r, s, requestIndex++ });
+            out_statistics.m_numFileBytesRead += r.m_numBytes;
+        }
+        lock.unlock();
+        m_workAvailable.notify_all();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_submitComplete.wait(lock, [&] { return numSubmits == m_numSubmitsCompleted; });
+    }
+
+    out_statistics.m_seconds = m_timer.GetTime();
+    out_statistics.m_numRequests = requestIndex;
+    out_statistics.m_numBytesDecompressed = m_numBytesDecompressed;
+    m_pStatistics = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// each thread has its own read buffer, completion event, and decompressor
+//-----------------------------------------------------------------------------
+void CpuTracePlayer::ReadThread()
+{
+    UINT maxNumBytes = 0;
+    for (const auto& s : m_traceData.m_submits)
+    {
+        for (const auto& r : s.m_requests)
+        {
+            maxNumBytes = std::max(maxNumBytes, r.m_numBytes);
+        }
+    }
+
+    // unbuffered reads need a sector-aligned buffer, and may extend up to a sector beyond each end of a request
+    const UINT readBufferSize = (maxNumBytes + 3 * SECTOR_SIZE) & ~(SECTOR_SIZE - 1);
+    BYTE* pReadBuffer = (BYTE*)::VirtualAlloc(nullptr, readBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    std::vector<BYTE> decompressBuffer(D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+    HANDLE readEvent = ::CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+    ComPtr<IDStorageCompressionCodec> codec;
+    if (m_params.m_decompress)
+    {
+        ThrowIfFailed(DStorageCreateCompressionCodec(DSTORAGE_COMPRESSION_FORMAT_GDEFLATE, 1, IID_PPV_ARGS(&codec)));
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (1)
+    {
+        m_workAvailable.wait(lock, [&] { return m_exit || m_queue.size(); });
+        if (m_exit)
+        {
+            break;
+        }
+
+        Work work = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+
+        Read(work, readEvent, pReadBuffer, decompressBuffer.data(), codec.Get());
+        float latencyMs = float(1000. * (m_timer.GetTime() - m_submitTimes[work.m_submitIndex]));
+
+        lock.lock();
+        m_pStatistics->m_requestLatencies[work.m_requestIndex] = latencyMs;
+        if (0 == --m_numRequestsRemaining[work.m_submitIndex])
+        {
+            m_pStatistics->m_submitLatencies[work.m_submitIndex] = latencyMs;
+            m_numSubmitsCompleted++;
+            m_submitComplete.notify_one();
+        }
+    }
+
+    ::CloseHandle(readEvent);
+    ::VirtualFree(pReadBuffer, 0, MEM_RELEASE);
+}
+
+//-----------------------------------------------------------------------------
+// positional overlapped read, waiting on this thread's event for completion
+// the event, not the shared file handle, is signaled, so concurrent reads on a handle don't wake each other
+//-----------------------------------------------------------------------------
+void CpuTracePlayer::Read(const Work& in_work, HANDLE in_readEvent, BYTE* in_pReadBuffer, BYTE* in_pDecompressBuffer, IDStorageCompressionCodec* in_pCodec)
+{
+    const auto& r = *in_work.m_pRequest;
+
+    UINT64 offset = r.m_offset;
+    UINT numBytes = r.m_numBytes;
+    const BYTE* pSrc = in_pReadBuffer;
+
+    if (m_params.m_unbuffered)
+    {
+        UINT64 alignedOffset = offset & ~UINT64(SECTOR_SIZE - 1);
+        pSrc += offset - alignedOffset;
+        numBytes = UINT((offset + numBytes - alignedOffset + SECTOR_SIZE - 1) & ~UINT64(SECTOR_SIZE - 1));
+        offset = alignedOffset;
+    }
+
+    HANDLE fileHandle = m_fileHandles[r.m_fileIndex];
+    OVERLAPPED o{};
+    o.Offset = (DWORD)offset;
+    o.OffsetHigh = (DWORD)(offset >> 32);
+    o.hEvent = in_readEvent;
+    DWORD numBytesRead = 0;
+    if (!::ReadFile(fileHandle, in_pReadBuffer, numBytes, nullptr, &o))
+    {
+        DWORD error = ::GetLastError();
+        if (ERROR_IO_PENDING != error)
+        {
+            ThrowIfFailed(HRESULT_FROM_WIN32(error));
+        }
+    }
+    if (!::GetOverlappedResult(fileHandle, &o, &numBytesRead, TRUE))
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(::GetLastError()));
+    }
+
+    if (in_pCodec && (DSTORAGE_COMPRESSION_FORMAT_GDEFLATE == r.m_compressionFormat))
+    {
+        size_t numBytesDecompressed = 0;
+        ThrowIfFailed(in_pCodec->DecompressBuffer(pSrc, r.m_numBytes,
+            in_pDecompressBuffer, D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES, &numBytesDecompressed));
+        m_numBytesDecompressed += numBytesDecompressed;
+    }
+}
@@ -0,0 +1,103 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <wrl.h>
+
+#include "Timer.h"
+#include "TraceData.h"
+#include "Playback.h"
+#include <dstorage.h>
+
+//=============================================================================
+// plays back a trace with plain file reads into host memory, without a GPU or DirectStorage queue
+// a pool of threads performs positional overlapped reads, optionally decompressing requests on the cpu
+// submits are issued in order, up to m_maxSubmitsInFlight at a time, so latencies are meaningful
+// and optionally paced (see Pacing)
+//=============================================================================
+class CpuTracePlayer
+{
+public:
+    struct Params
+    {
+        UINT m_numThreads{ 8 };          // threads reading files
+        UINT m_maxSubmitsInFlight{ 2 };  // issue the next submit when fewer than this many are incomplete
+        bool m_decompress{ true };       // decompress requests with a compression format on the reading thread
+        bool m_unbuffered{ true };       // bypass the file cache, as DirectStorage does
+        Pacing m_pacing;                 // when to issue submits, also limited by m_maxSubmitsInFlight
+    };
+
+    CpuTracePlayer(const TraceData& in_traceData, const std::wstring& in_mediaDir, const Params& in_params);
+    ~CpuTracePlayer();
+
+    void PlaybackTrace(PlaybackStatistics& out_statistics);
+private:
+    template<typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    const TraceData& m_traceData;
+    const Params m_params;
+
+    std::vector<HANDLE> m_fileHandles;
+    std::vector<double> m_schedule; // seconds from the start of playback to issue each submit, if paced
+    Timer m_timer;                  // started at the beginning of each playback
+
+    struct Work
+    {
+        const TraceData::Request* m_pRequest;
+        UINT m_submitIndex;
+        UINT64 m_requestIndex; // across all submits, into PlaybackStatistics::m_requestLatencies
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;   // reading threads wait for work
+    std::condition_variable m_submitComplete;  // PlaybackTrace() waits for the oldest submit
+    std::deque<Work> m_queue;
+    bool m_exit{ false };
+
+    std::vector<std::thread> m_threads;
+
+    // per-playback state
+    PlaybackStatistics* m_pStatistics{ nullptr };
+    std::vector<double> m_submitTimes;          // latency reference for each submit: scheduled or issue time
+    std::vector<UINT> m_numRequestsRemaining;   // per submit, under m_mutex
+    UINT m_numSubmitsCompleted{ 0 };            // in order of completion, under m_mutex
+    std::atomic<UINT64> m_numBytesDecompressed{ 0 };
+
+    void ReadThread();
+    void Read(const Work& in_work, HANDLE in_readEvent, BYTE* in_pReadBuffer, BYTE* in_pDecompressBuffer, IDStorageCompressionCodec* in_pCodec);
+
+    static constexpr UINT SECTOR_SIZE = 4096; // alignment for unbuffered reads
+};
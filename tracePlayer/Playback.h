@@ -0,0 +1,124 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "Timer.h"
+#include "TraceData.h"
+
+//=============================================================================
+// when to issue each submit during playback
+//=============================================================================
+struct Pacing
+{
+    enum class Mode : UINT
+    {
+        NONE = 0,   // back to back, as fast as possible
+        ORIGINAL,   // at the captured submit times
+        SCALED,     // at the captured submit times divided by m_speed
+        FIXED_RATE  // at m_submitsPerSecond
+    };
+    Mode m_mode{ Mode::NONE };
+    float m_speed{ 1.0f };             // SCALED: 2 plays back twice as fast as captured
+    float m_submitsPerSecond{ 60.0f }; // FIXED_RATE
+
+    // ORIGINAL and SCALED need a trace with submit times
+    bool GetNeedsSubmitTimes() const { return (Mode::ORIGINAL == m_mode) || (Mode::SCALED == m_mode); }
+
+    // seconds after the start of playback to issue each submit, or empty if not paced
+    std::vector<double> GetSchedule(const TraceData& in_traceData) const
+    {
+        std::vector<double> schedule;
+        if (Mode::NONE == m_mode)
+        {
+            return schedule;
+        }
+
+        const auto& submits = in_traceData.m_submits;
+        schedule.resize(submits.size(), 0);
+        for (UINT i = 0; i < submits.size(); i++)
+        {
+            double captured = 0;
+            if (in_traceData.m_ticksPerSecond)
+            {
+                captured = double(submits[i].m_time - submits[0].m_time) / double(in_traceData.m_ticksPerSecond);
+            }
+
+            switch (m_mode)
+            {
+            case Mode::ORIGINAL: schedule[i] = captured; break;
+            case Mode::SCALED: schedule[i] = captured / std::max(m_speed, 0.001f); break;
+            case Mode::FIXED_RATE: schedule[i] = double(i) / std::max(m_submitsPerSecond, 0.001f); break;
+            default: break;
+            }
+        }
+        return schedule;
+    }
+
+    // sleep while the target time is more than a timer tick (up to ~16ms) away, then yield
+    static void WaitUntil(const Timer& in_timer, double in_seconds)
+    {
+        while (1)
+        {
+            double remaining = in_seconds - in_timer.GetTime();
+            if (remaining <= 0) { break; }
+            if (remaining > 0.02) { ::Sleep(1); }
+            else { std::this_thread::yield(); }
+        }
+    }
+};
+
+//=============================================================================
+// results of one or more playbacks
+// latencies are measured from a submit's scheduled time when paced (so falling behind
+// the captured cadence counts against latency), otherwise from the time it was issued
+//=============================================================================
+struct PlaybackStatistics
+{
+    double m_seconds{ 0 };
+    UINT64 m_numRequests{ 0 };
+    UINT64 m_numFileBytesRead{ 0 };
+    UINT64 m_numBytesDecompressed{ 0 };
+    float m_maxIssueDelayMs{ 0 };          // paced: the furthest behind schedule a submit was issued
+    std::vector<float> m_submitLatencies;  // ms to the completion of the submit's last request
+    std::vector<float> m_requestLatencies; // ms to the completion of each request
+
+    void Append(const PlaybackStatistics& in_statistics)
+    {
+        m_seconds += in_statistics.m_seconds;
+        m_numRequests += in_statistics.m_numRequests;
+        m_numFileBytesRead += in_statistics.m_numFileBytesRead;
+        m_numBytesDecompressed += in_statistics.m_numBytesDecompressed;
+        m_maxIssueDelayMs = std::max(m_maxIssueDelayMs, in_statistics.m_maxIssueDelayMs);
+        m_submitLatencies.insert(m_submitLatencies.end(), in_statistics.m_submitLatencies.begin(), in_statistics.m_submitLatencies.end());
+        m_requestLatencies.insert(m_requestLatencies.end(), in_statistics.m_requestLatencies.begin(), in_statistics.m_requestLatencies.end());
+    }
+};
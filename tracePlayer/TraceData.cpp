@@ -0,0 +1,350 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#include <fstream>
+#include <filesystem>
+#include <map>
+
+#include "ConfigurationParser.h"
+#include "TraceFile.h"
+#include "TraceData.h"
+
+namespace
+{
+    template<typename T> void Write(std::ofstream& in_file, const T& in_value) { in_file.write((const char*)&in_value, sizeof(T)); }
+    template<typename T> bool Read(std::ifstream& in_file, T& out_value) { return (bool)in_file.read((char*)&out_value, sizeof(T)); }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool TraceData::Read(const std::wstring& in_filename)
+{
+    UINT32 magic{ 0 };
+    {
+        std::ifstream file(in_filename, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        ::Read(file, magic);
+    }
+
+    if (Streaming::TraceFile::MAGIC == magic)
+    {
+        return ReadBinary(in_filename);
+    }
+    return ReadJson(in_filename);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void TraceData::Write(const std::wstring& in_filename) const
+{
+    if (0 == _wcsicmp(L".json", std::filesystem::path(in_filename).extension().c_str()))
+    {
+        WriteJson(in_filename);
+    }
+    else
+    {
+        WriteBinary(in_filename);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UINT64 TraceData::GetNumRequests() const
+{
+    UINT64 numRequests = 0;
+    for (const auto& s : m_submits)
+    {
+        numRequests += s.m_requests.size();
+    }
+    return numRequests;
+}
+
+//-----------------------------------------------------------------------------
+// json: "resources" is an array of {rsrc, fmt, dim[3]}
+// "submits" is an array of submits, each an array of {rsrc, coord[3], file, off, size, comp}
+// optional "ticksPerSecond" and "times" (one per submit) hold the submit times
+//-----------------------------------------------------------------------------
+bool TraceData::ReadJson(const std::wstring& in_filename)
+{
+    const ConfigurationParser traceFile(in_filename);
+    const auto& root = traceFile.GetRoot();
+    if ((!traceFile.GetReadSuccess()) || (!root.isMember("resources")) || (!root.isMember("submits")))
+    {
+        return false;
+    }
+
+    std::map<UINT64, UINT32> resourceIndices;
+    for (const auto& r : root["resources"])
+    {
+        resourceIndices[r["rsrc"].asUInt64()] = (UINT32)m_resources.size();
+        m_resources.push_back(Resource{ r["rsrc"].asUInt64(), r["fmt"].asUInt(),
+            r["dim"][0].asUInt(), r["dim"][1].asUInt(), r["dim"][2].asUInt() });
+    }
+
+    if (root.isMember("ticksPerSecond") && root.isMember("times"))
+    {
+        m_ticksPerSecond = root["ticksPerSecond"].asUInt64();
+    }
+
+    std::map<std::string, UINT32> fileIndices;
+    for (const auto& s : root["submits"])
+    {
+        m_submits.resize(m_submits.size() + 1);
+        auto& submit = m_submits.back();
+        if (m_ticksPerSecond)
+        {
+            submit.m_time = root["times"][int(m_submits.size() - 1)].asUInt64();
+        }
+
+        for (const auto& r : s)
+        {
+            Request request{};
+            request.m_resourceIndex = resourceIndices[r["rsrc"].asUInt64()];
+            request.m_coord.X = r["coord"][0].asUInt();
+            request.m_coord.Y = r["coord"][1].asUInt();
+            request.m_coord.Subresource = r["coord"][2].asUInt();
+            request.m_offset = r["off"].asUInt64();
+            request.m_numBytes = r["size"].asUInt();
+            if (r.isMember("comp")) request.m_compressionFormat = r["comp"].asUInt();
+
+            const std::string& filename = r["file"].asString();
+            auto f = fileIndices.find(filename);
+            if (fileIndices.end() == f)
+            {
+                f = fileIndices.insert({ filename, (UINT32)m_files.size() }).first;
+                m_files.push_back(filename);
+            }
+            request.m_fileIndex = f->second;
+
+            submit.m_requests.push_back(request);
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void TraceData::WriteJson(const std::wstring& in_filename) const
+{
+    ConfigurationParser traceFile;
+    auto& root = traceFile.GetRoot();
+
+    // written first: the parser does not accept an array of numbers at the very end of the file
+    if (m_ticksPerSecond)
+    {
+        root["ticksPerSecond"] = m_ticksPerSecond;
+        auto& times = root["times"];
+        for (UINT i = 0; i < m_submits.size(); i++)
+        {
+            times[i] = m_submits[i].m_time;
+        }
+    }
+
+    auto& resources = root["resources"];
+    for (UINT i = 0; i < m_resources.size(); i++)
+    {
+        auto& r = resources[i];
+        r["rsrc"] = m_resources[i].m_resourceID;
+        r["fmt"] = m_resources[i].m_format;
+        r["dim"][0] = m_resources[i].m_width;
+        r["dim"][1] = m_resources[i].m_height;
+        r["dim"][2] = m_resources[i].m_mipLevels;
+    }
+
+    auto& submits = root["submits"];
+    for (UINT i = 0; i < m_submits.size(); i++)
+    {
+        auto& s = submits[i];
+        const auto& requests = m_submits[i].m_requests;
+        for (UINT j = 0; j < requests.size(); j++)
+        {
+            const auto& request = requests[j];
+            auto& r = s[j];
+            r["rsrc"] = m_resources[request.m_resourceIndex].m_resourceID;
+            r["coord"][0] = request.m_coord.X;
+            r["coord"][1] = request.m_coord.Y;
+            r["coord"][2] = request.m_coord.Subresource;
+            r["file"] = m_files[request.m_fileIndex];
+            r["off"] = request.m_offset;
+            r["size"] = request.m_numBytes;
+            if (request.m_compressionFormat) { r["comp"] = request.m_compressionFormat; }
+        }
+    }
+
+    traceFile.Write(in_filename);
+}
+
+//-----------------------------------------------------------------------------
+// requests are grouped by submit index. requests without a submit record
+// (the capture ended before they were submitted) are dropped
+//-----------------------------------------------------------------------------
+bool TraceData::ReadBinary(const std::wstring& in_filename)
+{
+    using namespace Streaming::TraceFile;
+
+    std::ifstream file(in_filename, std::ios::in | std::ios::binary);
+
+    FileHeader header;
+    if ((!::Read(file, header)) || (MAGIC != header.m_magic) || (VERSION != header.m_version))
+    {
+        return false;
+    }
+    m_ticksPerSecond = header.m_ticksPerSecond;
+
+    std::map<UINT64, UINT32> resourceIndices;
+    std::map<UINT32, UINT32> fileIndices;
+    std::map<UINT32, SubmitRecord> submits; // ordered by submit index
+    std::vector<RequestRecord> requests;
+
+    RecordType recordType;
+    while (::Read(file, recordType))
+    {
+        switch (recordType)
+        {
+        case RecordType::RESOURCE:
+        {
+            ResourceRecord r;
+            if (!::Read(file, r)) { return false; }
+            resourceIndices[r.m_resourceID] = (UINT32)m_resources.size();
+            m_resources.push_back(Resource{ r.m_resourceID, r.m_format, r.m_width, r.m_height, r.m_mipLevels });
+        }
+        break;
+
+        case RecordType::STRING:
+        {
+            StringRecord r;
+            if (!::Read(file, r)) { return false; }
+            std::string filename(r.m_length, '\0');
+            if (!file.read(filename.data(), r.m_length)) { return false; }
+            fileIndices[r.m_stringID] = (UINT32)m_files.size();
+            m_files.push_back(filename);
+        }
+        break;
+
+        case RecordType::REQUEST:
+        {
+            RequestRecord r;
+            if (!::Read(file, r)) { return false; }
+            requests.push_back(r);
+        }
+        break;
+
+        case RecordType::SUBMIT:
+        {
+            SubmitRecord r;
+            if (!::Read(file, r)) { return false; }
+            submits[r.m_submitIndex] = r;
+        }
+        break;
+
+        default:
+            return false;
+        }
+    }
+
+    std::map<UINT32, UINT32> submitIndices;
+    for (const auto& s : submits)
+    {
+        submitIndices[s.first] = (UINT32)m_submits.size();
+        m_submits.resize(m_submits.size() + 1);
+        m_submits.back().m_time = s.second.m_time;
+        m_submits.back().m_requests.reserve(s.second.m_numRequests);
+    }
+
+    for (const auto& r : requests)
+    {
+        auto s = submitIndices.find(r.m_submitIndex);
+        if (submitIndices.end() == s)
+        {
+            continue;
+        }
+
+        Request request{};
+        request.m_resourceIndex = resourceIndices[r.m_resourceID];
+        request.m_coord.X = r.m_x;
+        request.m_coord.Y = r.m_y;
+        request.m_coord.Subresource = r.m_subresource;
+        request.m_fileIndex = fileIndices[r.m_fileID];
+        request.m_offset = r.m_offset;
+        request.m_numBytes = r.m_numBytes;
+        request.m_compressionFormat = r.m_compressionFormat;
+        m_submits[s->second].m_requests.push_back(request);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// resources and file names first, then each submit's requests followed by the submit
+//-----------------------------------------------------------------------------
+void TraceData::WriteBinary(const std::wstring& in_filename) const
+{
+    using namespace Streaming::TraceFile;
+
+    std::ofstream file(in_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    FileHeader header;
+    header.m_ticksPerSecond = m_ticksPerSecond;
+    ::Write(file, header);
+
+    for (const auto& r : m_resources)
+    {
+        ::Write(file, RecordType::RESOURCE);
+        ::Write(file, ResourceRecord{ r.m_resourceID, r.m_format, r.m_width, r.m_height, r.m_mipLevels });
+    }
+
+    for (UINT i = 0; i < m_files.size(); i++)
+    {
+        ::Write(file, RecordType::STRING);
+        ::Write(file, StringRecord{ i, (UINT32)m_files[i].size() });
+        file.write(m_files[i].data(), m_files[i].size());
+    }
+
+    for (UINT i = 0; i < m_submits.size(); i++)
+    {
+        const auto& s = m_submits[i];
+        for (const auto& request : s.m_requests)
+        {
+            RequestRecord r{};
+            r.m_resourceID = m_resources[request.m_resourceIndex].m_resourceID;
+            r.m_offset = request.m_offset;
+            r.m_submitIndex = i;
+            r.m_fileID = request.m_fileIndex;
+            r.m_numBytes = request.m_numBytes;
+            r.m_compressionFormat = request.m_compressionFormat;
+            r.m_x = request.m_coord.X;
+            r.m_y = request.m_coord.Y;
+            r.m_subresource = request.m_coord.Subresource;
+            ::Write(file, RecordType::REQUEST);
+            ::Write(file, r);
+        }
+        ::Write(file, RecordType::SUBMIT);
+        ::Write(file, SubmitRecord{ s.m_time, i, (UINT32)s.m_requests.size() });
+    }
+}
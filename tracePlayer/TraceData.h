@@ -0,0 +1,91 @@
+//*********************************************************
+//
+// Copyright 2020 Intel Corporation 
+//
+// Permission is hereby granted, free of charge, to any 
+// person obtaining a copy of this software and associated 
+// documentation files(the "Software"), to deal in the Software 
+// without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, 
+// and/or sell copies of the Software, and to permit persons to 
+// whom the Software is furnished to do so, subject to the 
+// following conditions :
+// The above copyright notice and this permission notice shall 
+// be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+// HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+// DEALINGS IN THE SOFTWARE.
+//
+//*********************************************************
+
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <d3d12.h>
+#include <string>
+#include <vector>
+
+//=============================================================================
+// in-memory trace of DirectStorage requests and submits, independent of file format
+// reads and writes both the json trace format and the binary format of TraceFile.h
+//=============================================================================
+class TraceData
+{
+public:
+    struct Resource
+    {
+        UINT64 m_resourceID; // the address of the resource when captured
+        UINT32 m_format;
+        UINT32 m_width;
+        UINT32 m_height;
+        UINT32 m_mipLevels;
+    };
+
+    struct Request
+    {
+        UINT32 m_resourceIndex; // into m_resources
+        D3D12_TILED_RESOURCE_COORDINATE m_coord;
+        UINT32 m_fileIndex;     // into m_files
+        UINT64 m_offset;
+        UINT32 m_numBytes;
+        UINT32 m_compressionFormat;
+    };
+
+    struct Submit
+    {
+        UINT64 m_time{ 0 }; // in m_ticksPerSecond units since the trace started
+        std::vector<Request> m_requests;
+    };
+
+    std::vector<Resource> m_resources;
+    std::vector<std::string> m_files; // UTF-8 file names, relative to the media directory
+    std::vector<Submit> m_submits;
+    UINT64 m_ticksPerSecond{ 0 };     // 0 if the trace has no submit times (older json traces)
+
+    // detects the format from the file contents
+    bool Read(const std::wstring& in_filename);
+
+    void WriteJson(const std::wstring& in_filename) const;
+    void WriteBinary(const std::wstring& in_filename) const;
+
+    // writes json if the extension is .json, otherwise binary
+    void Write(const std::wstring& in_filename) const;
+
+    UINT64 GetNumRequests() const;
+private:
+    bool ReadJson(const std::wstring& in_filename);
+    bool ReadBinary(const std::wstring& in_filename);
+};
@@ -42,13 +42,15 @@
 #include <wrl.h>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
 
 #include "DebugHelper.h"
 #include "ArgParser.h"
-#include "ConfigurationParser.h"
 #include "d3dx12.h"
 #include "Timer.h"
 #include "tracePlayer.h"
+#include "TraceData.h"
+#include "CpuTracePlayer.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -203,15 +205,26 @@ void TracePlayer::InitDirectStorage()
 
     m_dsFactory->SetStagingBufferSize(m_params.m_stagingBufferSizeMB * 1024 * 1024);
 
+    CreateQueue();
+}
+
+//-----------------------------------------------------------------------------
+// add a DirectStorage queue and its fence
+//-----------------------------------------------------------------------------
+void TracePlayer::CreateQueue()
+{
+    m_queues.resize(m_queues.size() + 1);
+    auto& q = m_queues.back();
+
     DSTORAGE_QUEUE_DESC queueDesc{};
     queueDesc.Capacity = DSTORAGE_MAX_QUEUE_CAPACITY;
     queueDesc.Priority = DSTORAGE_PRIORITY_NORMAL;
     queueDesc.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
     queueDesc.Device = m_device.Get();
-    ThrowIfFailed(m_dsFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&m_dsQueue)));
+    ThrowIfFailed(m_dsFactory->CreateQueue(&queueDesc, IID_PPV_ARGS(&q.m_queue)));
 
-    ThrowIfFailed(m_device->CreateFence(m_fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
-    m_fenceValue++;
+    ThrowIfFailed(m_device->CreateFence(q.m_fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&q.m_fence)));
+    q.m_fenceValue++;
 }
 
 //-----------------------------------------------------------------------------
@@ -272,33 +285,35 @@ void TracePlayer::UpdateTileMappings(ID3D12Resource* in_pResource, UINT in_tileO
 }
 
 //-----------------------------------------------------------------------------
-// parse trace file in to an efficient internal representation
+// parse trace file (json or binary) in to an efficient internal representation
 // creates resources and opens files
 //-----------------------------------------------------------------------------
 void TracePlayer::LoadTraceFile()
 {
-    const ConfigurationParser traceFile(m_params.m_filename);
-
-    std::map<UINT64, ID3D12Resource*> dstResources;
-    std::map<std::string, IDStorageFile*> srcFiles;
+    TraceData traceData;
+    if (!traceData.Read(m_params.m_filename))
+    {
+        ErrorMessage("failed to read trace file: ", m_params.m_filename);
+    }
+    if (m_params.m_pacing.GetNeedsSubmitTimes() && (0 == traceData.m_ticksPerSecond))
+    {
+        ErrorMessage("trace has no submit times. Use -pacing 0 or 3, or capture a new trace");
+    }
 
     //---------------------------------
     // create destination resources
     //---------------------------------
     {
-        const auto& resources = traceFile.GetRoot()["resources"];
         UINT64 numTilesTotal{ 0 };
         std::vector<UINT> tilesPerResource;
-        for (const auto& r : resources)
+        for (const auto& r : traceData.m_resources)
         {
             UINT numTiles{ 0 };
             ID3D12Resource* pResource = CreateDestinationResource(
-                numTiles, (DXGI_FORMAT)r["fmt"].asUInt(),
-                r["dim"][0].asUInt(), r["dim"][1].asUInt(), r["dim"][2].asUInt());
+                numTiles, (DXGI_FORMAT)r.m_format, r.m_width, r.m_height, r.m_mipLevels);
             numTilesTotal += numTiles;
 
             m_dstResources.push_back(pResource);
-            dstResources[r["rsrc"].asUInt64()] = pResource;
 
             tilesPerResource.push_back(numTiles);
         }
@@ -314,69 +329,143 @@ void TracePlayer::LoadTraceFile()
     }
 
     //---------------------------------
-    // create submission array (and open files)
+    // open files
+    //---------------------------------
+    for (const auto& filename : traceData.m_files)
+    {
+        std::wstringstream wideFileName;
+        wideFileName << m_params.m_mediaDir << filename.c_str();
+        IDStorageFile* dsFile{ nullptr };
+        if (!std::filesystem::exists(wideFileName.str()))
+        {
+            ErrorMessage("file not found: ", wideFileName.str(), ". Did you set -mediadir?");
+        }
+        ThrowIfFailed(m_dsFactory->OpenFile(wideFileName.str().c_str(), IID_PPV_ARGS(&dsFile)));
+        m_fileHandles.push_back(dsFile);
+    }
+
+    //---------------------------------
+    // create submission array
     //---------------------------------
+    for (const auto& s : traceData.m_submits)
     {
-        const auto& submits = traceFile.GetRoot()["submits"];
-        for (const auto& s : submits)
+        m_submits.resize(m_submits.size() + 1);
+        auto& requestArray = m_submits.back();
+        for (const auto& r : s.m_requests)
         {
-            m_submits.resize(m_submits.size() + 1);
-            auto& requestArray = m_submits.back();
-            for (const auto& r : s)
+            Request request{};
+            request.m_dstCoord = r.m_coord;
+            request.m_pDstResource = m_dstResources[r.m_resourceIndex];
+            request.m_srcFile = m_fileHandles[r.m_fileIndex];
+            request.m_srcOffset = r.m_offset;
+            request.m_numBytes = r.m_numBytes;
+            request.m_compressionFormat = r.m_compressionFormat;
+            request.m_fileIndex = r.m_fileIndex;
+            request.m_resourceIndex = r.m_resourceIndex;
+            m_numFileBytesRead += request.m_numBytes;
+            m_numBytesWritten += D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+            requestArray.push_back(request);
+        }
+        m_numRequestsTotal += s.m_requests.size();
+    }
+
+    m_schedule = m_params.m_pacing.GetSchedule(traceData);
+}
+
+//-----------------------------------------------------------------------------
+// divide the submits among queues
+// splitting by file or resource keeps each file/resource on one queue, and a
+// submit becomes up to 1 part per queue. parts stay in submit order within a queue
+//-----------------------------------------------------------------------------
+void TracePlayer::Partition(UINT in_numQueues)
+{
+    if (in_numQueues == m_partitions.size())
+    {
+        return;
+    }
+
+    m_partitions.clear();
+    m_partitions.resize(in_numQueues);
+
+    for (UINT s = 0; s < m_submits.size(); s++)
+    {
+        if (Params::Split::ROUND_ROBIN == m_params.m_split)
+        {
+            m_partitions[s % in_numQueues].push_back(SubmitPart{ s, m_submits[s] });
+            continue;
+        }
+
+        std::vector<RequestArray> parts(in_numQueues);
+        for (const auto& r : m_submits[s])
+        {
+            UINT key = (Params::Split::FILE == m_params.m_split) ? r.m_fileIndex : r.m_resourceIndex;
+            parts[key % in_numQueues].push_back(r);
+        }
+        for (UINT q = 0; q < in_numQueues; q++)
+        {
+            if (parts[q].size())
             {
-                Request request{};
-                request.m_dstCoord.X = r["coord"][0].asUInt();
-                request.m_dstCoord.Y = r["coord"][1].asUInt();
-                request.m_dstCoord.Subresource = r["coord"][2].asUInt();
-                request.m_pDstResource = dstResources[r["rsrc"].asUInt64()];
-                request.m_srcOffset = r["off"].asUInt();
-                request.m_numBytes = r["size"].asUInt();
-                m_numFileBytesRead += request.m_numBytes;
-
-                if (r.isMember("comp")) request.m_compressionFormat = r["comp"].asUInt();
-
-                const std::string& filename = r["file"].asString();
-                auto f = srcFiles.find(filename);
-                if (srcFiles.end() == f)
-                {
-                    std::wstringstream wideFileName;
-                    wideFileName << m_params.m_mediaDir << filename.c_str();
-                    IDStorageFile* dsFile{ nullptr };
-                    if (!std::filesystem::exists(wideFileName.str()))
-                    {
-                        ErrorMessage("file not found: ", wideFileName.str(), ". Did you set -mediadir?");
-                    }
-                    ThrowIfFailed(m_dsFactory->OpenFile(wideFileName.str().c_str(), IID_PPV_ARGS(&dsFile)));
-                    m_fileHandles.push_back(dsFile);
-                    srcFiles[filename] = dsFile;
-                    request.m_srcFile = dsFile;
-                }
-                else
-                {
-                    request.m_srcFile = f->second;
-                }
-                m_numBytesWritten += D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
-                requestArray.push_back(request);
+                m_partitions[q].push_back(SubmitPart{ s, std::move(parts[q]) });
             }
-            m_numRequestsTotal += s.size();
         }
     }
 }
 
 //-----------------------------------------------------------------------------
-// execute all requests as quickly as possible
+// enqueue the parts assigned to one queue, as quickly as possible or paced
+// each part signals the queue's fence, and completions are noted by polling the fence
+// while waiting to issue the next part, so latency resolution is that of the polling
 //-----------------------------------------------------------------------------
-void TracePlayer::PlaybackTrace()
+void TracePlayer::PlaybackQueue(UINT in_queueIndex, const Timer& in_timer, std::vector<float>& out_partLatencies, float& out_maxIssueDelayMs)
 {
+    auto& queue = m_queues[in_queueIndex];
+    const auto& parts = m_partitions[in_queueIndex];
+    const UINT numParts = (UINT)parts.size();
+
     DSTORAGE_REQUEST request{};
     request.Options.DestinationType = DSTORAGE_REQUEST_DESTINATION_TILES;
     request.Destination.Tiles.TileRegionSize = D3D12_TILE_REGION_SIZE{ 1, FALSE, 0, 0, 0 };
     request.Options.SourceType = DSTORAGE_REQUEST_SOURCE_FILE;
     request.UncompressedSize = D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
 
-    for (const auto& s : m_submits)
+    out_partLatencies.assign(numParts, 0);
+    out_maxIssueDelayMs = 0;
+
+    std::vector<double> submitTimes(numParts, 0); // latency reference: scheduled or issue time
+    std::vector<UINT64> fenceValues(numParts, 0);
+    UINT numIssued = 0;
+    UINT numCompleted = 0;
+
+    auto CheckCompletion = [&]()
+    {
+        UINT64 completedValue = queue.m_fence->GetCompletedValue();
+        double t = in_timer.GetTime();
+        while ((numCompleted < numIssued) && (fenceValues[numCompleted] <= completedValue))
+        {
+            out_partLatencies[numCompleted] = float(1000. * (t - submitTimes[numCompleted]));
+            numCompleted++;
+        }
+    };
+
+    for (UINT i = 0; i < numParts; i++)
     {
-        for (const auto& r : s)
+        if (m_schedule.size())
+        {
+            double scheduledTime = m_schedule[parts[i].m_submitIndex];
+            while (in_timer.GetTime() < scheduledTime)
+            {
+                CheckCompletion();
+                std::this_thread::yield();
+            }
+            submitTimes[i] = scheduledTime;
+            out_maxIssueDelayMs = std::max(out_maxIssueDelayMs, float(1000. * (in_timer.GetTime() - scheduledTime)));
+        }
+        else
+        {
+            submitTimes[i] = in_timer.GetTime();
+        }
+
+        for (const auto& r : parts[i].m_requests)
         {
             request.Source.File.Source = r.m_srcFile;
             request.Source.File.Offset = r.m_srcOffset;
@@ -385,16 +474,85 @@ void TracePlayer::PlaybackTrace()
             request.Destination.Tiles.TiledRegionStartCoordinate = r.m_dstCoord;
             request.Options.CompressionFormat = (DSTORAGE_COMPRESSION_FORMAT)r.m_compressionFormat;
 
-            m_dsQueue->EnqueueRequest(&request);
+            queue.m_queue->EnqueueRequest(&request);
         }
-        m_fenceValue++;
-        m_dsQueue->EnqueueSignal(m_fence.Get(), m_fenceValue);
-        m_dsQueue->Submit();
+        queue.m_fenceValue++;
+        queue.m_queue->EnqueueSignal(queue.m_fence.Get(), queue.m_fenceValue);
+        queue.m_queue->Submit();
+
+        fenceValues[i] = queue.m_fenceValue;
+        numIssued++;
+        CheckCompletion();
     }
 
-    // Wait until the signal command has been processed.
-    ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));
-    WaitForSingleObject(m_fenceEvent, INFINITE);
+    // wait until the last signal has been processed
+    while (numCompleted < numParts)
+    {
+        CheckCompletion();
+        std::this_thread::yield();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// play back all submits with 1 thread per queue
+// a submit completes when all its parts have completed
+//-----------------------------------------------------------------------------
+void TracePlayer::PlaybackTrace(PlaybackStatistics& out_statistics, UINT in_numQueues)
+{
+    in_numQueues = std::max(in_numQueues, 1u);
+    while (m_queues.size() < in_numQueues)
+    {
+        CreateQueue();
+    }
+    Partition(in_numQueues);
+
+    const UINT numSubmits = (UINT)m_submits.size();
+
+    out_statistics = PlaybackStatistics{};
+
+    std::vector<std::vector<float>> partLatencies(in_numQueues);
+    std::vector<float> maxIssueDelays(in_numQueues, 0);
+
+    Timer timer;
+    timer.Start();
+
+    if (1 == in_numQueues)
+    {
+        PlaybackQueue(0, timer, partLatencies[0], maxIssueDelays[0]);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for (UINT q = 0; q < in_numQueues; q++)
+        {
+            threads.push_back(std::thread([&, q] { PlaybackQueue(q, timer, partLatencies[q], maxIssueDelays[q]); }));
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    out_statistics.m_seconds = timer.GetTime();
+    out_statistics.m_numRequests = m_numRequestsTotal;
+    out_statistics.m_numFileBytesRead = m_numFileBytesRead;
+    out_statistics.m_submitLatencies.resize(numSubmits, 0);
+
+    for (UINT q = 0; q < in_numQueues; q++)
+    {
+        out_statistics.m_maxIssueDelayMs = std::max(out_statistics.m_maxIssueDelayMs, maxIssueDelays[q]);
+
+        const auto& parts = m_partitions[q];
+        for (UINT i = 0; i < parts.size(); i++)
+        {
+            float latency = partLatencies[q][i];
+            auto& submitLatency = out_statistics.m_submitLatencies[parts[i].m_submitIndex];
+            submitLatency = std::max(submitLatency, latency);
+
+            // the requests of a part complete together, as far as the fence can tell
+            out_statistics.m_requestLatencies.insert(out_statistics.m_requestLatencies.end(), parts[i].m_requests.size(), latency);
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -447,9 +605,13 @@ std::wstring AddCommaSeparators(UINT64 in_value)
 //-----------------------------------------------------------------------------
 void TracePlayer::Inspect()
 {
-    const ConfigurationParser traceFile(m_params.m_filename);
+    TraceData traceData;
+    if (!traceData.Read(m_params.m_filename))
+    {
+        ErrorMessage("failed to read trace file: ", m_params.m_filename);
+    }
 
-    const auto& submits = traceFile.GetRoot()["submits"];
+    const auto& submits = traceData.m_submits;
     size_t numSubmits = submits.size();
     size_t maxSubmit{ 0 };
     size_t minSubmit{ size_t(-1) };
@@ -461,16 +623,16 @@ void TracePlayer::Inspect()
         if (first) { first = false; }
         else { std::cout << ","; }
 
-        size_t numRequests = s.size();
+        size_t numRequests = s.m_requests.size();
         minSubmit = std::min(minSubmit, numRequests);
         maxSubmit = std::max(maxSubmit, numRequests);
         m_numRequestsTotal += numRequests;
 
         std::cout << numRequests;
 
-        for (const auto& r : s)
+        for (const auto& r : s.m_requests)
         {
-            m_numFileBytesRead += r["size"].asUInt64();
+            m_numFileBytesRead += r.m_numBytes;
         }
     }
 
@@ -487,6 +649,87 @@ void TracePlayer::Inspect()
     std::cout << "max # requests/1 submit: " << maxSubmit << std::endl;
     std::wcout << "# bytes ssd (read): " << AddCommaSeparators(m_numFileBytesRead) << std::endl;
     std::wcout << "# bytes gpu (written): " << AddCommaSeparators(m_numBytesWritten) << std::endl;
+    if (traceData.m_ticksPerSecond && numSubmits)
+    {
+        double seconds = double(submits.back().m_time - submits.front().m_time) / double(traceData.m_ticksPerSecond);
+        std::cout << "capture duration (first to last submit): " << seconds << "s" << std::endl;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// e.g. in_percentile = 0.99f. sorts the values
+//-----------------------------------------------------------------------------
+float GetPercentile(std::vector<float>& inout_values, float in_percentile)
+{
+    if (0 == inout_values.size())
+    {
+        return 0;
+    }
+    std::sort(inout_values.begin(), inout_values.end());
+    size_t index = std::min(size_t(in_percentile * inout_values.size()), inout_values.size() - 1);
+    return inout_values[index];
+}
+
+//-----------------------------------------------------------------------------
+// latency percentiles, and how well pacing was kept
+//-----------------------------------------------------------------------------
+void PrintLatencies(PlaybackStatistics& inout_statistics, const Pacing& in_pacing)
+{
+    auto Print = [](const char* in_name, std::vector<float>& inout_latencies)
+    {
+        std::cout << in_name << " latency ms (p50, p90, p99, max): "
+            << GetPercentile(inout_latencies, 0.5f) << ", " << GetPercentile(inout_latencies, 0.9f) << ", "
+            << GetPercentile(inout_latencies, 0.99f) << ", " << GetPercentile(inout_latencies, 1.0f) << "\n";
+    };
+
+    if (Pacing::Mode::NONE != in_pacing.m_mode)
+    {
+        std::cout << "latencies are relative to the scheduled submit times. max issue delay ms: " << inout_statistics.m_maxIssueDelayMs << "\n";
+    }
+    Print("submit", inout_statistics.m_submitLatencies);
+    Print("request", inout_statistics.m_requestLatencies);
+}
+
+//-----------------------------------------------------------------------------
+// play back with CpuTracePlayer, then report bandwidth, IOPS, and latency percentiles
+//-----------------------------------------------------------------------------
+void CpuPlayback(const TracePlayer::Params& in_params, const CpuTracePlayer::Params& in_cpuParams, UINT in_numIters)
+{
+    std::cout << "loading/parsing...\n";
+    TraceData traceData;
+    if (!traceData.Read(in_params.m_filename))
+    {
+        ErrorMessage("failed to read trace file: ", in_params.m_filename);
+    }
+    if (in_cpuParams.m_pacing.GetNeedsSubmitTimes() && (0 == traceData.m_ticksPerSecond))
+    {
+        ErrorMessage("trace has no submit times. Use -pacing 0 or 3, or capture a new trace");
+    }
+
+    CpuTracePlayer cpuTracePlayer(traceData, in_params.m_mediaDir, in_cpuParams);
+
+    std::cout << "cpu playback: " << in_cpuParams.m_numThreads << " threads, " << in_cpuParams.m_maxSubmitsInFlight << " submits in flight, "
+        << (in_cpuParams.m_unbuffered ? "unbuffered" : "buffered") << (in_cpuParams.m_decompress ? ", decompressing\n" : "\n");
+    std::cout << "number of requests: " << traceData.GetNumRequests() << "\n";
+    std::cout << "executing trace, # iterations = " << in_numIters << "\n";
+
+    PlaybackStatistics total;
+    for (UINT i = 0; i < in_numIters; i++)
+    {
+        PlaybackStatistics statistics;
+        cpuTracePlayer.PlaybackTrace(statistics);
+        total.Append(statistics);
+    }
+
+    double bytesToBandwidth = 1. / (1024. * 1024. * total.m_seconds);
+    std::cout << "bandwidth (MB/s from disk): " << total.m_numFileBytesRead * bytesToBandwidth << "\n";
+    if (total.m_numBytesDecompressed)
+    {
+        std::cout << "bandwidth (MB/s decompressed): " << total.m_numBytesDecompressed * bytesToBandwidth << "\n";
+    }
+    std::cout << "IOPS: " << UINT64(total.m_numRequests / total.m_seconds) << "\n";
+
+    PrintLatencies(total, in_cpuParams.m_pacing);
 }
 
 //-----------------------------------------------------------------------------
@@ -497,6 +740,11 @@ int main()
 
     UINT numItersPlayback{ 4 };
     bool inspect{ false };
+    std::wstring convertFilename;
+    bool cpuPlayback{ false };
+    CpuTracePlayer::Params cpuParams;
+    UINT numQueues{ 1 };
+    bool sweepQueues{ false };
 
     ArgParser argParser;
     tracePlayerParams.m_mediaDir = std::filesystem::current_path();
@@ -523,16 +771,56 @@ int main()
 
         argParser.AddArg(L"-iters", numItersPlayback, L"none (0), discrete (1), integrated (2)");
         argParser.AddArg(L"-inspect", tracePlayerParams.m_inspect, L"display information about archive, do not execute");
+        argParser.AddArg(L"-convert", convertFilename, L"write the trace to this file and exit. .json extension: json, otherwise binary");
+
+        argParser.AddArg(L"-pacing", (UINT&)tracePlayerParams.m_pacing.m_mode, L"issue submits: back to back (0), at captured times (1), at captured times / speed (2), at a fixed rate (3)");
+        argParser.AddArg(L"-speed", tracePlayerParams.m_pacing.m_speed, L"pacing 2: e.g. 2 plays back twice as fast as captured");
+        argParser.AddArg(L"-rate", tracePlayerParams.m_pacing.m_submitsPerSecond, L"pacing 3: submits per second");
+
+        argParser.AddArg(L"-queues", numQueues, L"number of DirectStorage queues, each fed by its own thread");
+        argParser.AddArg(L"-split", (UINT&)tracePlayerParams.m_split, L"divide submits among queues: round-robin (0), by file (1), by resource (2)");
+        argParser.AddArg(L"-sweep", sweepQueues, L"play back with 1, 2, 4... queues, then -queues queues, and print a table");
+
+        argParser.AddArg(L"-cpu", cpuPlayback, L"play back with file reads into host memory: no GPU or DirectStorage queue");
+        argParser.AddArg(L"-threads", cpuParams.m_numThreads, L"cpu playback: number of reading threads");
+        argParser.AddArg(L"-inflight", cpuParams.m_maxSubmitsInFlight, L"cpu playback: maximum number of incomplete submits");
+        argParser.AddArg(L"-noDecompress", [&]() { cpuParams.m_decompress = false; }, false, L"cpu playback: read compressed requests without decompressing them");
+        argParser.AddArg(L"-buffered", [&]() { cpuParams.m_unbuffered = false; }, false, L"cpu playback: read through the file cache");
         argParser.Parse();
 
         if (0 == tracePlayerParams.m_filename.size())
         {
-            ErrorMessage("trace file name not provided (-file filename.json)");
+            ErrorMessage("trace file name not provided (-file filename.bin)");
         }
         if (L'\\' != tracePlayerParams.m_mediaDir.back())
         {
             tracePlayerParams.m_mediaDir.append(L"\\");
         }
+        cpuParams.m_pacing = tracePlayerParams.m_pacing;
+    }
+
+    //---------------------------
+    // convert between json and binary trace formats
+    //---------------------------
+    if (convertFilename.size())
+    {
+        TraceData traceData;
+        if (!traceData.Read(tracePlayerParams.m_filename))
+        {
+            ErrorMessage("failed to read trace file: ", tracePlayerParams.m_filename);
+        }
+        traceData.Write(convertFilename);
+        std::wcout << "wrote " << convertFilename << ": " << traceData.m_submits.size() << " submits, " << traceData.GetNumRequests() << " requests\n";
+        return 0;
+    }
+
+    //---------------------------
+    // play back trace on the cpu
+    //---------------------------
+    if (cpuPlayback)
+    {
+        CpuPlayback(tracePlayerParams, cpuParams, numItersPlayback);
+        return 0;
     }
 
     //---------------------------
@@ -549,17 +837,55 @@ int main()
     std::wcout << "file bytes to read (per iter): " << AddCommaSeparators(tracePlayer.GetNumFileBytesRead()).c_str() << "\n";
     std::cout << "number of requests: " << tracePlayer.GetNumRequests() << "\n";
     std::cout << "staging buffer size MB: " << tracePlayerParams.m_stagingBufferSizeMB << "\n";
-    std::cout << "executing trace, # iterations = " << numItersPlayback << "\n";
-    Timer timer;
-    timer.Start();
+    std::cout << "executing trace, # iterations = " << numItersPlayback << ", # queues = " << numQueues << "\n";
+
+    //---------------------------
+    // sweep the number of queues
+    //---------------------------
+    if (sweepQueues)
+    {
+        std::cout << "split: " << (UINT)tracePlayerParams.m_split << ", pacing: " << (UINT)tracePlayerParams.m_pacing.m_mode << "\n";
+        std::cout << "queues, MB/s, IOPS, submit p50 ms, submit p99 ms, request p50 ms, request p99 ms, max issue delay ms\n";
+        // powers of 2, then -queues itself if it isn't one
+        const UINT maxQueues = std::max(numQueues, 1u);
+        std::vector<UINT> queueCounts;
+        for (UINT n = 1; n < maxQueues; n *= 2)
+        {
+            queueCounts.push_back(n);
+        }
+        queueCounts.push_back(maxQueues);
+
+        for (UINT n : queueCounts)
+        {
+            PlaybackStatistics total;
+            for (UINT i = 0; i < numItersPlayback; i++)
+            {
+                PlaybackStatistics statistics;
+                tracePlayer.PlaybackTrace(statistics, n);
+                total.Append(statistics);
+            }
+            std::cout << n << ", "
+                << total.m_numFileBytesRead / (1024. * 1024. * total.m_seconds) << ", "
+                << UINT64(total.m_numRequests / total.m_seconds) << ", "
+                << GetPercentile(total.m_submitLatencies, 0.5f) << ", " << GetPercentile(total.m_submitLatencies, 0.99f) << ", "
+                << GetPercentile(total.m_requestLatencies, 0.5f) << ", " << GetPercentile(total.m_requestLatencies, 0.99f) << ", "
+                << total.m_maxIssueDelayMs << "\n";
+        }
+        return 0;
+    }
+
+    PlaybackStatistics total;
     for (UINT i = 0; i < numItersPlayback; i++)
     {
-        tracePlayer.PlaybackTrace();
+        PlaybackStatistics statistics;
+        tracePlayer.PlaybackTrace(statistics, numQueues);
+        total.Append(statistics);
     }
-    double seconds = timer.Stop();
+    double seconds = total.m_seconds;
 
     double bytesToBandwidth = numItersPlayback / (1024. * 1024. * seconds);
 
     std::wcout << "bandwidth (MB/s from disk): " << tracePlayer.GetNumFileBytesRead() * bytesToBandwidth << "\n";
     std::cout << "bandwidth (MB/s uncompressed to GPU): " << tracePlayer.GetNumBytesWritten() * bytesToBandwidth << "\n";
+    PrintLatencies(total, tracePlayerParams.m_pacing);
 }
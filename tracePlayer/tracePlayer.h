@@ -38,6 +38,8 @@
 #include <dstorage.h>
 #include <map>
 
+#include "Playback.h"
+
 class TracePlayer
 {
 public:
@@ -57,12 +59,24 @@ public:
         PreferredArchitecture m_preferredArchitecture{ PreferredArchitecture::NONE };
 
         bool m_inspect{ false }; // inspect trace only, no playback
+
+        Pacing m_pacing; // when to issue submits
+
+        // how submits are divided among queues when playing back with more than 1 queue
+        enum class Split
+        {
+            ROUND_ROBIN = 0, // whole submits, in turn
+            FILE,            // the requests of each submit, by source file
+            RESOURCE         // the requests of each submit, by destination resource
+        };
+        Split m_split{ Split::ROUND_ROBIN };
     };
 
     TracePlayer(const Params& in_params);
     ~TracePlayer();
 
-    void PlaybackTrace(); // play trace (via DirectStorage)
+    // play trace (via DirectStorage), enqueuing to in_numQueues queues each from its own thread
+    void PlaybackTrace(PlaybackStatistics& out_statistics, UINT in_numQueues = 1);
     void Inspect();       // display information about the trace, e.g. # submits
 
     UINT64 GetNumRequests() const { return m_numRequestsTotal; }
@@ -77,7 +91,15 @@ private:
     ComPtr<IDXGIFactory5> m_factory;
     ComPtr<ID3D12Device> m_device;
     ComPtr<IDStorageFactory> m_dsFactory;
-    ComPtr<IDStorageQueue> m_dsQueue;
+
+    // a DirectStorage queue with its own fence, fed by one thread during playback
+    struct Queue
+    {
+        ComPtr<IDStorageQueue> m_queue;
+        ComPtr<ID3D12Fence> m_fence;
+        UINT64 m_fenceValue{ 0 };
+    };
+    std::vector<Queue> m_queues; // created on demand
     ComPtr<ID3D12CommandQueue> m_commandQueue;
     ComPtr<ID3D12Heap> m_heap;
 
@@ -90,13 +112,26 @@ private:
         ID3D12Resource* m_pDstResource;
         D3D12_TILED_RESOURCE_COORDINATE m_dstCoord;
         IDStorageFile* m_srcFile;
-        UINT32 m_srcOffset;
+        UINT64 m_srcOffset;
         UINT32 m_numBytes;
         UINT32 m_compressionFormat{ 0 };
+        UINT32 m_fileIndex;     // for Split::FILE
+        UINT32 m_resourceIndex; // for Split::RESOURCE
     };
     typedef std::vector<Request> RequestArray;
     std::vector<RequestArray> m_submits;
 
+    // the part of a submit played back by one queue
+    struct SubmitPart
+    {
+        UINT m_submitIndex;
+        RequestArray m_requests;
+    };
+    std::vector<std::vector<SubmitPart>> m_partitions; // per queue, for the most recent # of queues
+    void Partition(UINT in_numQueues);
+    void PlaybackQueue(UINT in_queueIndex, const Timer& in_timer, std::vector<float>& out_partLatencies, float& out_maxIssueDelayMs);
+    std::vector<double> m_schedule; // seconds from the start of playback to issue each submit, if paced
+
     // release these when done
     std::vector<IDStorageFile*> m_fileHandles;
     std::vector<ID3D12Resource*> m_dstResources;
@@ -108,6 +143,7 @@ private:
     void CreateDeviceWithName();
     void CreateFence();
     void InitDirectStorage();
+    void CreateQueue();
     void LoadTraceFile();
     ID3D12Resource* CreateDestinationResource(UINT& out_numTiles, DXGI_FORMAT in_format, UINT in_width, UINT in_height, UINT in_subresourceCount);
     void UpdateTileMappings(ID3D12Resource* in_pResource, UINT in_tileOffset);